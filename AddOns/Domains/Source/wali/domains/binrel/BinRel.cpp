@@ -9,7 +9,10 @@
 #include "ProgramBddContext.hpp"
 //#include "BuddyExt.hpp"
 #include "combination.hpp"
+#include "wali/util/BddResources.hpp"
+#include "wali/util/ConfigurationVar.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <cmath>
@@ -23,16 +26,6 @@ using std::endl;
 using wali::waliErr;
 using std::cout;
 
-// ////////////////////////////
-// For large memory machines consider allocating ~1500 MB
-// 25000000 ~~ 500 MB, change the multiple to get what you need.
-#define FIVE_HUNDRED_MB 25000000
-#define BDDMEMSIZE (FIVE_HUNDRED_MB*1)
-// Find out emperically what the best ratio of memsize to cache size is
-#define MEMTOCACHE 10
-
-#define MAXMEMINC BDDMEMSIZE/10
-
 //It's a good habit to forward declare all the static functions in the
 //file so that there is an index and so that the contents of the file can
 //move around freely.
@@ -43,16 +36,48 @@ namespace wali
   {
     namespace binrel
     {
+      typedef std::pair< bdd, bool> StarCacheKey;
+      struct StarCacheHash
+      {
+        size_t operator() (StarCacheKey k) const
+        {
+          return k.first.id() << 1 & (int) k.second;
+        }
+      };
+      typedef std::tr1::unordered_map< StarCacheKey, sem_elem_t, StarCacheHash> StarCache;
+
       /**
-       * idx2Name gives strings to print for bdd level indices.
-       * This is passed to the callback function in buddy.
-       * This is currently a global so that it can be 
-       * accessed in BinRelManager.
+       * What this file keeps about the BuDDy in use (with
+       * BDD_THREAD_LOCAL, the calling thread's). It is created on first
+       * use and deleted when BuDDy is shut down.
        **/
-      RevBddContext idx2Name;
+      struct BuddyState
+      {
+        /**
+         * idx2Name gives strings to print for bdd level indices.
+         * This is passed to the callback function in buddy.
+         **/
+        RevBddContext idx2Name;
+        StarCache star_cache;
+      };
+      static BDD_TLS BuddyState * buddyState = NULL;
+
+      static BuddyState & state()
+      {
+        if(buddyState == NULL)
+          buddyState = new BuddyState();
+        return *buddyState;
+      }
+
+      /// Accessed in ProgramBddContext too
+      RevBddContext & idx2Name()
+      {
+        return state().idx2Name;
+      }
 
       static void myFddStrmHandler(std::ostream &o, int var);
       static BinRel* convert(wali::SemElem* se);
+      static BddContext::VarOrder defaultVarOrder();
 
 
       /*
@@ -65,15 +90,14 @@ namespace wali
       std::map<bdd, sem_elem_t, BddLessThan> star_cache;
       */
 
-      typedef std::pair< bdd, bool> StarCacheKey;
-      struct StarCacheHash
-      {
-        size_t operator() (StarCacheKey k) const
-        {
-          return k.first.id() << 1 & (int) k.second;
-        }
-      };
-      std::tr1::unordered_map< StarCacheKey, sem_elem_t, StarCacheHash> star_cache;
+      // Dynamic reordering (see BddContext::enableDynamicReordering). These
+      // are reset when BuDDy is shut down.
+      static BDD_TLS int reorderMethod = BDD_REORDER_NONE;
+      static BDD_TLS int reorderThreshold = 0;
+      static BDD_TLS int reorderMinNodes = 0;
+      static BDD_TLS unsigned reorderCount = 0;
+      // Variables [0, numBlockedVars) each have a reordering block
+      static BDD_TLS int numBlockedVars = 0;
 
 
       namespace details {
@@ -151,7 +175,7 @@ namespace wali
 // ////////////////////////////
 // Definitions of static members from BddContext/BinRel class
 
-int BddContext::numBddContexts = 0;
+BDD_TLS int BddContext::numBddContexts = 0;
 // ////////////////////////////
 
 std::ostream& BddInfo::print(std::ostream& o) const
@@ -178,8 +202,7 @@ namespace wali
     {
       static void myFddStrmHandler(std::ostream &o, int var)
       {
-        extern RevBddContext idx2Name;
-        o << idx2Name[var];
+        o << idx2Name()[var];
       }
 
       // Helper function that converts a SemElem
@@ -196,15 +219,56 @@ namespace wali
         // BinRel* br = static_cast<BinRel*>(se)
         return br;
       }
+
+      // The variable order picked by the macros in BinRel.hpp
+      static BddContext::VarOrder defaultVarOrder()
+      {
+#if (TENSOR_MAX_AFFINITY == 1)
+        return BddContext::ORDER_TENSOR_MAX_AFFINITY;
+#elif (TENSOR_MIN_AFFINITY == 1)
+        return BddContext::ORDER_TENSOR_MIN_AFFINITY;
+#elif (TENSOR_MATCHED_PAREN == 1)
+        return BddContext::ORDER_TENSOR_MATCHED_PAREN;
+#elif (BASE_MAX_AFFINITY_TENSOR_MIXED == 1)
+        return BddContext::ORDER_BASE_MAX_AFFINITY_TENSOR_MIXED;
+#else
+#error "Unknown bdd level arrangement macro"
+#endif
+      }
     } // namespace binrel
   } // namespace domains
 } // namespace wali
 
 
-BddContext::BddContext(int bddMemSize, int cacheSize) :
+BddContext::DetensorMethod
+  BddContext::globalDefaultDetensorMethod
+  = wali::util::ConfigurationVar<BddContext::DetensorMethod>(
+      "WALI_BINREL_DETENSOR",
+#if (DETENSOR_TOGETHER == 1)
+      BddContext::DETENSOR_METHOD_TOGETHER
+#else
+      BddContext::DETENSOR_METHOD_BIT_BY_BIT
+#endif
+    )
+    ("together",           BddContext::DETENSOR_METHOD_TOGETHER)
+    ("bit-by-bit",         BddContext::DETENSOR_METHOD_BIT_BY_BIT)
+    ("relprod",            BddContext::DETENSOR_METHOD_RELPROD)
+    ("bit-by-bit-relprod", BddContext::DETENSOR_METHOD_BIT_BY_BIT_RELPROD);
+
+
+BddContext::BddContext(int bddMemSize, int cacheSize, VarOrder order, bool dynamicReordering) :
   std::map< const std::string, bddinfo_t>(),
-  count(0)
+  count(0),
+  varOrder(order == ORDER_DEFAULT ? defaultVarOrder() : order),
+  detensorMethod(globalDefaultDetensorMethod),
+  memo(defaultMemoSize),
+  memoHits(0),
+  memoMisses(0)
 {
+#if (NWA_DETENSOR == 1)
+  // Nwa based detensor only works with TENSOR_MATCHED_PAREN variable order
+  assert(varOrder == ORDER_TENSOR_MATCHED_PAREN);
+#endif
   //If buddy has not been initialized, initialize it.
   //We handle this by keeping track of the number of BddContext objects
   //lying around. Since every BinRel also has a BddContext object in it,
@@ -213,17 +277,20 @@ BddContext::BddContext(int bddMemSize, int cacheSize) :
   if(numBddContexts == 0){
     // ///////////////////////
     // Begin initialize BuDDy
-    bddMemSize = (bddMemSize==0)?BDDMEMSIZE:bddMemSize;
-    cacheSize = (bddMemSize/MEMTOCACHE > cacheSize)? bddMemSize/MEMTOCACHE : cacheSize;
+    // The sizes come from the environment (see wali::util::BddResources),
+    // unless the caller gives them.
+    wali::util::BddResources resources = wali::util::BddResources().fromEnvironment();
+    if(bddMemSize != 0){
+      resources.initialNodes = bddMemSize;
+      if(cacheSize > 0 && bddMemSize / cacheSize < resources.cacheRatio)
+        resources.cacheRatio = std::max(1, bddMemSize / cacheSize);
+    }
     if (0 == bdd_isrunning()){
-      int rc = bdd_init(bddMemSize,cacheSize);
+      int rc = wali::util::bddInit(resources);
       if( rc < 0 ){
         *waliErr << "[ERROR] " << bdd_errstring(rc) << endl;
         assert( 0 );
       }
-      // Default is 50,000 (1 Mb),memory is cheap, so use 100,000      
-      bdd_setmaxincrease((bddMemSize/10 > MAXMEMINC)? bddMemSize/10 : MAXMEMINC);
-      // TODO: bdd_error_hook( my_error_handler );
       fdd_strm_hook( myFddStrmHandler );
     }else{
       //can not happen, unless reset fails.
@@ -236,6 +303,9 @@ BddContext::BddContext(int bddMemSize, int cacheSize) :
   numBddContexts++;
   //release mutex
 
+  if(dynamicReordering)
+    enableDynamicReordering();
+
   baseSwap = BddPairPtr(bdd_newpair());
   tensor1Swap = BddPairPtr(bdd_newpair());
   baseRightShift = BddPairPtr(bdd_newpair());
@@ -281,6 +351,8 @@ BddContext::BddContext(int bddMemSize, int cacheSize) :
 BddContext::BddContext(const BddContext& other) :
   std::map< const std::string, bddinfo_t>(other),
   count(0),
+  varOrder(other.varOrder),
+  detensorMethod(other.detensorMethod),
   baseSwap(other.baseSwap),
   tensor1Swap(other.tensor1Swap),
   baseRightShift(other.baseRightShift),
@@ -294,12 +366,16 @@ BddContext::BddContext(const BddContext& other) :
   baseSecBddContextSet(other.baseSecBddContextSet),
   tensorSecBddContextSet(other.tensorSecBddContextSet),
   commonBddContextSet23(other.commonBddContextSet23),
+  commonBddContextId23(other.commonBddContextId23),
   commonBddContextSet13(other.commonBddContextSet13),
   commonBddContextId13(other.commonBddContextId13),
   cachedBaseOne(other.cachedBaseOne),
   cachedBaseZero(other.cachedBaseZero),
   cachedTensorOne(other.cachedTensorOne),
-  cachedTensorZero(other.cachedTensorZero)
+  cachedTensorZero(other.cachedTensorZero),
+  memo(other.memo.size()),
+  memoHits(0),
+  memoMisses(0)
 {
   numBddContexts++;
 
@@ -322,6 +398,8 @@ BddContext& BddContext::operator = (const BddContext& other)
 {
   if(this!=&other){
     count=0;
+    varOrder=other.varOrder;
+    detensorMethod=other.detensorMethod;
     baseSwap=other.baseSwap;
     tensor1Swap = other.baseSwap;
     baseRightShift=other.baseRightShift;
@@ -336,11 +414,13 @@ BddContext& BddContext::operator = (const BddContext& other)
     tensorSecBddContextSet=other.tensorSecBddContextSet;
     commonBddContextSet23=other.commonBddContextSet23;
     commonBddContextSet13=other.commonBddContextSet13;
+    commonBddContextId23=other.commonBddContextId23;
     commonBddContextId13=other.commonBddContextId13;
     cachedBaseOne=other.cachedBaseOne;
     cachedBaseZero=other.cachedBaseZero;
     cachedTensorOne=other.cachedTensorOne;
     cachedTensorZero=other.cachedTensorZero;
+    setMemoSize(other.memo.size());
     populateCache();
   }
   return *this;
@@ -371,6 +451,8 @@ BddContext::~BddContext()
   commonBddContextSet13 = bddtrue;
   commonBddContextId13 = bddtrue;
 
+  memo.clear();
+
   //Delete cached BinRel objects.
   cachedBaseOne = NULL;
   cachedBaseZero = NULL;
@@ -384,17 +466,165 @@ BddContext::~BddContext()
   numBddContexts--;
   if(numBddContexts == 0){
     //All BddContexts are now dead. So we must shutdown buddy.
-    star_cache.clear();
+    delete buddyState;
+    buddyState = NULL;
     if(bdd_isrunning() != 0)
-      bdd_done();
-    //Now clear the reverse map.
-    idx2Name.clear();
+      wali::util::bddDone();
+    reorderMethod = BDD_REORDER_NONE;
+    reorderThreshold = 0;
+    reorderMinNodes = 0;
+    reorderCount = 0;
+    numBlockedVars = 0;
     //Also clean up the BinRel class
     BinRel::reset();
   }
   //release mutex
 }
 
+void BddContext::enableDynamicReordering(int method, int minNodes)
+{
+#if (NWA_DETENSOR == 1)
+  *waliErr << "[ERROR] Dynamic reordering is not available with NWA_DETENSOR." << endl;
+  assert(false);
+#endif
+  assert(method != BDD_REORDER_NONE);
+  reorderMethod = method;
+  reorderMinNodes = minNodes;
+  reorderThreshold = minNodes;
+}
+
+void BddContext::disableDynamicReordering()
+{
+  reorderMethod = BDD_REORDER_NONE;
+}
+
+bool BddContext::dynamicReorderingEnabled()
+{
+  return reorderMethod != BDD_REORDER_NONE;
+}
+
+int BddContext::reorder(int method)
+{
+  // BuDDy only moves variables that are in some block. Giving each
+  // variable its own block lets every level move freely; variables may
+  // have been added since the last time.
+  for(; numBlockedVars < bdd_varnum(); ++numBlockedVars)
+    bdd_intaddvarblock(numBlockedVars, numBlockedVars, BDD_REORDER_FIXED);
+
+  bdd_reorder(method);
+  reorderCount++;
+
+  int nodes = bdd_getnodenum();
+  reorderThreshold = std::max(2 * nodes, reorderMinNodes);
+  return nodes;
+}
+
+void BddContext::reorderIfGrown()
+{
+  if(reorderMethod != BDD_REORDER_NONE && bdd_getnodenum() >= reorderThreshold)
+    reorder(reorderMethod);
+}
+
+unsigned BddContext::numReorderings()
+{
+  return reorderCount;
+}
+
+size_t const BddContext::defaultMemoSize;
+
+void BddContext::setMemoSize(size_t entries)
+{
+  size_t size = 0;
+  if(entries > 0)
+    for(size = 1; size < entries; size <<= 1)
+      ;
+  std::vector<MemoEntry>(size).swap(memo);
+}
+
+void BddContext::clearMemo()
+{
+  std::vector<MemoEntry>(memo.size()).swap(memo);
+}
+
+namespace {
+  size_t memoSlot(int op, bdd const & left, bdd const & right, size_t size)
+  {
+    size_t h = static_cast<size_t>(op) * 741457u;
+    h ^= static_cast<size_t>(left.id()) * 12582917u;
+    h ^= static_cast<size_t>(right.id()) * 4256249u;
+    return (h ^ (h >> 16)) & (size - 1);
+  }
+}
+
+bool BddContext::lookupMemo(MemoOp op, bdd const & left, bdd const & right, bdd & result) const
+{
+  if(memo.empty())
+    return false;
+  MemoEntry const & e = memo[memoSlot(op, left, right, memo.size())];
+  if(e.op == op && e.left == left && e.right == right){
+    memoHits++;
+    result = e.result;
+    return true;
+  }
+  memoMisses++;
+  return false;
+}
+
+void BddContext::storeMemo(MemoOp op, bdd const & left, bdd const & right, bdd const & result) const
+{
+  if(memo.empty())
+    return;
+  MemoEntry & e = memo[memoSlot(op, left, right, memo.size())];
+  e.op = op;
+  e.left = left;
+  e.right = right;
+  e.result = result;
+}
+
+void BddContext::setDetensorMethod(DetensorMethod method)
+{
+  if(method == DETENSOR_METHOD_DEFAULT)
+    method = globalDefaultDetensorMethod;
+  detensorMethod = method;
+  if(method == DETENSOR_METHOD_TOGETHER || method == DETENSOR_METHOD_RELPROD)
+    buildDetensorIds();
+}
+
+void BddContext::buildDetensorIds()
+{
+  commonBddContextId23 = bddtrue;
+  commonBddContextId13 = bddtrue;
+  for(std::map<const std::string, bddinfo_t>::const_iterator ci = this->begin(); ci != this->end(); ++ci){
+    bddinfo_t varInfo = ci->second;
+    commonBddContextId23 = commonBddContextId23 &
+      fdd_equals(varInfo->tensor1Rhs, varInfo->tensor2Lhs);
+    commonBddContextId13 = commonBddContextId13 &
+      fdd_equals(varInfo->tensor1Lhs, varInfo->tensor2Lhs);
+  }
+}
+
+bdd BddContext::equateAndProject(bdd rel, Spot left, Spot right, bdd const & id, bdd const & set) const
+{
+  switch(detensorMethod){
+    case DETENSOR_METHOD_TOGETHER:
+      return bdd_exist(rel & id, set);
+    case DETENSOR_METHOD_RELPROD:
+      return bdd_relprod(rel, id, set);
+    default:
+      break;
+  }
+  for(std::map<const std::string, bddinfo_t>::const_iterator citer = this->begin(); citer != this->end(); ++citer){
+    BddInfo const & varInfo = *(citer->second);
+    bdd eq = fdd_equals(varInfo.*left, varInfo.*right);
+    bdd vars = fdd_ithset(varInfo.*left) & fdd_ithset(varInfo.*right);
+    if(detensorMethod == DETENSOR_METHOD_BIT_BY_BIT_RELPROD)
+      rel = bdd_relprod(rel, eq, vars);
+    else
+      rel = bdd_exist(rel & eq, vars);
+  }
+  return rel;
+}
+
 void BddContext::addBoolVar(std::string name)
 {
   addIntVar(name,2);
@@ -409,7 +639,6 @@ void BddContext::setIntVars(const std::map<std::string, int>& flatvars)
 
 void BddContext::createIntVars(const std::vector<std::map<std::string, int> >& vars)
 {
-  int vari;
   // First work through the variable list and create the vocabulary structure
   // This will collect information about the fdds to be created in buddy
   for(std::vector<std::map<std::string, int> >::const_iterator cvi = vars.begin(); cvi != vars.end(); ++cvi){
@@ -424,320 +653,99 @@ void BddContext::createIntVars(const std::vector<std::map<std::string, int> >& v
     }
   }
 
-#if (TENSOR_MAX_AFFINITY == 1)
-  for(std::vector<std::map<std::string, int> >::const_iterator cvi = vars.begin(); cvi != vars.end(); ++cvi){
-    std::map<std::string, int> interleavedVars = *cvi;
-    int * domains = new int[9 * interleavedVars.size()];
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      for(int j=vari * 9; j < 9 * (vari + 1); ++j)
-        domains[j] = cmi->second;
-      vari++;
-    }
-    //Now actually create the fdd levels
-    // lock mutex
-    int base = fdd_extdomain(domains, 9 * interleavedVars.size());
-    // release mutex
-    if (base < 0){
-      *waliErr << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl;
-      *waliErr << "    Aborting." << endl;
-      assert (false);
-    }
-    delete [] domains;
-    // Assign fdd levels to the variables.
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      bddinfo_t varInfo = (*this)[cmi->first];
-      int j = 9 * vari;
-      varInfo->baseLhs = base + j++;
-      varInfo->baseRhs = base + j++;
-      varInfo->baseExtra = base + j++;
-      varInfo->tensor1Lhs = base + j++;
-      varInfo->tensor1Rhs = base + j++;
-      varInfo->tensor1Extra = base + j++;
-      varInfo->tensor2Lhs = base + j++;
-      varInfo->tensor2Rhs = base + j++;
-      varInfo->tensor2Extra = base + j++;
-      vari++;  
-    }
-  }
-#elif (TENSOR_MIN_AFFINITY == 1)
-  //First the base levels
-  for(std::vector<std::map<std::string, int> >::const_iterator cvi = vars.begin(); cvi != vars.end(); ++cvi){
-    std::map<std::string, int> interleavedVars = *cvi;
-    vari = 0;
-    int * domains = new int[3 * interleavedVars.size()];
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      for(int j=vari * 3; j < 3 * (vari + 1); ++j)
-        domains[j] = cmi->second;
-      vari++;
-    }
-    //Now actually create the fdd levels
-    // lock mutex
-    int base = fdd_extdomain(domains, 3 * interleavedVars.size());
-    // release mutex
-    if (base < 0){
-      *waliErr << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl;
-      *waliErr << "    Aborting." << endl;
-      assert (false);
-    }
-    delete [] domains;
-    // Assign fdd levels to the variables.
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator ci = interleavedVars.begin(); ci != interleavedVars.end(); ++ci){
-      bddinfo_t varInfo = (*this)[ci->first];
-      int j = 3 * vari;
-      varInfo->baseLhs = base + j++;
-      varInfo->baseRhs = base + j++;
-      varInfo->baseExtra = base + j++;
-      vari++;  
-    }
-  }
-  //Next for tensor1
-  for(std::vector<std::map<std::string, int> >::const_iterator cvi = vars.begin(); cvi != vars.end(); ++cvi){
-    std::map<std::string, int> interleavedVars = *cvi;
-    vari = 0;
-    int * domains = new int[3 * interleavedVars.size()];
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      for(int j=vari * 3; j < 3 * (vari + 1); ++j)
-        domains[j] = cmi->second;
-      vari++;
-    }
-    //Now actually create the fdd levels
-    // lock mutex
-    int base = fdd_extdomain(domains, 3 * interleavedVars.size());
-    // release mutex
-    if (base < 0){
-      *waliErr << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl;
-      *waliErr << "    Aborting." << endl;
-      assert (false);
-    }
-    delete [] domains;
-    // Assign fdd levels to the variables.
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator ci = interleavedVars.begin(); ci != interleavedVars.end(); ++ci){
-      bddinfo_t varInfo = (*this)[ci->first];
-      int j = 3 * vari;
-      varInfo->tensor1Lhs = base + j++;
-      varInfo->tensor1Rhs = base + j++;
-      varInfo->tensor1Extra = base + j++;
-      vari++;  
-    }
-  }
-  //Finally for tensor2
-  for(std::vector<std::map<std::string, int> >::const_iterator cvi = vars.begin(); cvi != vars.end(); ++cvi){
-    std::map<std::string, int> interleavedVars = *cvi;
-    vari = 0;
-    int * domains = new int[3 * interleavedVars.size()];
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      for(int j=vari * 3; j < 3 * (vari + 1); ++j)
-        domains[j] = cmi->second;
-      vari++;
-    }
-    //Now actually create the fdd levels
-    // lock mutex
-    int base = fdd_extdomain(domains, 3 * interleavedVars.size());
-    // release mutex
-    if (base < 0){
-      *waliErr << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl;
-      *waliErr << "    Aborting." << endl;
-      assert (false);
-    }
-    delete [] domains;
-    // Assign fdd levels to the variables.
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator ci = interleavedVars.begin(); ci != interleavedVars.end(); ++ci){
-      bddinfo_t varInfo = (*this)[ci->first];
-      int j = 3 * vari;
-      varInfo->tensor2Lhs = base + j++;
-      varInfo->tensor2Rhs = base + j++;
-      varInfo->tensor2Extra = base + j++;
-      vari++;  
-    }
+  // The nine spots of a variable, in the orders the layouts use
+  static Spot const all[9] = {
+    &BddInfo::baseLhs, &BddInfo::baseRhs, &BddInfo::baseExtra,
+    &BddInfo::tensor1Lhs, &BddInfo::tensor1Rhs, &BddInfo::tensor1Extra,
+    &BddInfo::tensor2Lhs, &BddInfo::tensor2Rhs, &BddInfo::tensor2Extra
+  };
+  static Spot const * const base = all;
+  static Spot const * const tensor1 = all + 3;
+  static Spot const * const tensor2 = all + 6;
+  static Spot const baseReversed[3] = {
+    &BddInfo::baseExtra, &BddInfo::baseRhs, &BddInfo::baseLhs
+  };
+  static Spot const tensor1Reversed[3] = {
+    &BddInfo::tensor1Extra, &BddInfo::tensor1Rhs, &BddInfo::tensor1Lhs
+  };
+
+  switch(varOrder){
+    case ORDER_TENSOR_MAX_AFFINITY:
+      createSpots(vars, all, 9, false);
+      break;
+    case ORDER_TENSOR_MIN_AFFINITY:
+      createSpots(vars, base, 3, false);
+      createSpots(vars, tensor1, 3, false);
+      createSpots(vars, tensor2, 3, false);
+      break;
+    case ORDER_TENSOR_MATCHED_PAREN:
+      // The three levels of each bit are reversed in base and tensor1, and
+      // the variables themselves are reversed in tensor2.
+      createSpots(vars, baseReversed, 3, false);
+      createSpots(vars, tensor1Reversed, 3, false);
+      createSpots(vars, tensor2, 3, true);
+      break;
+    case ORDER_BASE_MAX_AFFINITY_TENSOR_MIXED:
+      // tensor1 and tensor2 together
+      createSpots(vars, base, 3, false);
+      createSpots(vars, tensor1, 6, false);
+      break;
+    default:
+      assert(false);
   }
 
-#elif (TENSOR_MATCHED_PAREN == 1)
-  //First the base levels
-  for(std::vector<std::map<std::string, int> >::const_iterator cvi = vars.begin(); cvi != vars.end(); ++cvi){
-    std::map<std::string, int> interleavedVars = *cvi;
-    vari = 0;
-    int * domains = new int[3 * interleavedVars.size()];
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      for(int j=vari * 3; j < 3 * (vari + 1); ++j)
-        domains[j] = cmi->second;
-      vari++;
-    }
-    //Now actually create the fdd levels
-    // lock mutex
-    int base = fdd_extdomain(domains, 3 * interleavedVars.size());
-    // release mutex
-    if (base < 0){
-      *waliErr << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl;
-      *waliErr << "    Aborting." << endl;
-      assert (false);
-    }
-    delete [] domains;
-    // Assign fdd levels to the variables.
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator ci = interleavedVars.begin(); ci != interleavedVars.end(); ++ci){
-      bddinfo_t varInfo = (*this)[ci->first];
-      int j = 3 * vari;
-      varInfo->baseExtra = base + j++;
-      varInfo->baseRhs = base + j++;
-      varInfo->baseLhs = base + j++;
-      vari++;  
-    }
-  }
-  //Next for tensor1
-  for(std::vector<std::map<std::string, int> >::const_iterator cvi = vars.begin(); cvi != vars.end(); ++cvi){
-    std::map<std::string, int> interleavedVars = *cvi;
-    vari = 0;
-    int * domains = new int[3 * interleavedVars.size()];
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      for(int j=vari * 3; j < 3 * (vari + 1); ++j)
-        domains[j] = cmi->second;
-      vari++;
-    }
-    //Now actually create the fdd levels
-    // lock mutex
-    int base = fdd_extdomain(domains, 3 * interleavedVars.size());
-    // release mutex
-    if (base < 0){
-      *waliErr << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl;
-      *waliErr << "    Aborting." << endl;
-      assert (false);
-    }
-    delete [] domains;
-    // Assign fdd levels to the variables.
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator ci = interleavedVars.begin(); ci != interleavedVars.end(); ++ci){
-      bddinfo_t varInfo = (*this)[ci->first];
-      int j = 3 * vari;
-      // In this case, tensor1 has the three levels reversed. 
-      varInfo->tensor1Extra = base + j++;
-      varInfo->tensor1Rhs = base + j++;
-      varInfo->tensor1Lhs = base + j++;
-      vari++;  
-    }
-  }
-  //Finally for tensor2
-  for(std::vector<std::map<std::string, int> >::const_reverse_iterator crvi = vars.rbegin(); crvi != vars.rend(); ++crvi){
-    std::map<std::string, int> interleavedVars = *crvi;
-    vari = 0;
-    int * domains = new int[3 * interleavedVars.size()];
-    for(std::map<std::string, int>::const_reverse_iterator crmi = interleavedVars.rbegin(); crmi != interleavedVars.rend(); ++crmi){
-      for(int j=vari * 3; j < 3 * (vari + 1); ++j)
-        domains[j] = crmi->second;
-      vari++;
-    }
-    //Now actually create the fdd levels
-    // lock mutex
-    int base = fdd_extdomain(domains, 3 * interleavedVars.size());
-    // release mutex
-    if (base < 0){
-      *waliErr << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl;
-      *waliErr << "    Aborting." << endl;
-      assert (false);
-    }
-    delete [] domains;
-    // Assign fdd levels to the variables.
-    vari = 0;
-    for(std::map<std::string, int>::const_reverse_iterator cri = interleavedVars.rbegin(); cri != interleavedVars.rend(); ++cri){
-      bddinfo_t varInfo = (*this)[cri->first];
-      int j = 3 * vari;
-      varInfo->tensor2Lhs = base + j++;
-      varInfo->tensor2Rhs = base + j++;
-      varInfo->tensor2Extra = base + j++;
-      vari++;  
-    }
-  }
-#elif (BASE_MAX_AFFINITY_TENSOR_MIXED == 1)
-  //First the base levels
-  for(std::vector<std::map<std::string, int> >::const_iterator cvi = vars.begin(); cvi != vars.end(); ++cvi){
-    std::map<std::string, int> interleavedVars = *cvi;
-    vari = 0;
-    int * domains = new int[3 * interleavedVars.size()];
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      for(int j=vari * 3; j < 3 * (vari + 1); ++j)
-        domains[j] = cmi->second;
-      vari++;
-    }
-    //Now actually create the fdd levels
-    // lock mutex
-    int base = fdd_extdomain(domains, 3 * interleavedVars.size());
-    // release mutex
-    if (base < 0){
-      *waliErr << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl;
-      *waliErr << "    Aborting." << endl;
-      assert (false);
-    }
-    delete [] domains;
-    // Assign fdd levels to the variables.
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator ci = interleavedVars.begin(); ci != interleavedVars.end(); ++ci){
-      bddinfo_t varInfo = (*this)[ci->first];
-      int j = 3 * vari;
-      varInfo->baseLhs = base + j++;
-      varInfo->baseRhs = base + j++;
-      varInfo->baseExtra = base + j++;
-      vari++;  
-    }
-  }
-  //Now mixed tensor1 and tensor2 levels
-  for(std::vector<std::map<std::string, int> >::const_iterator cvi = vars.begin(); cvi != vars.end(); ++cvi){
-    std::map<std::string, int> interleavedVars = *cvi;
-    int * domains = new int[6 * interleavedVars.size()];
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      for(int j=vari * 6; j < 6 * (vari + 1); ++j)
-        domains[j] = cmi->second;
-      vari++;
-    }
+  // Also update the reverse vocabulary for printing.
+  for(std::map<const std::string, bddinfo_t>::const_iterator ci = this->begin(); ci != this->end(); ++ci){
+    bddinfo_t varInfo = ci->second;
+    idx2Name()[varInfo->baseLhs] = ci->first;
+    idx2Name()[varInfo->baseRhs] = ci->first + "'";
+    idx2Name()[varInfo->baseExtra] = ci->first + "''";
+    idx2Name()[varInfo->tensor1Lhs] = ci->first + "_t1";
+    idx2Name()[varInfo->tensor1Rhs] = ci->first + "_t1'";
+    idx2Name()[varInfo->tensor1Extra] = ci->first + "_t1''";
+    idx2Name()[varInfo->tensor2Lhs] = ci->first + "_t2";
+    idx2Name()[varInfo->tensor2Rhs] = ci->first + "_t2'";
+    idx2Name()[varInfo->tensor2Extra] = ci->first + "_t2''";
+  } 
+
+#if (NWA_DETENSOR == 1)
+  setupLevelArray();
+#endif
+}
+
+void BddContext::createSpots(const std::vector<std::map<std::string, int> >& vars,
+                             Spot const * spots, int numSpots, bool backwards)
+{
+  for(size_t g = 0; g < vars.size(); ++g){
+    std::map<std::string, int> const & group = backwards ? vars[vars.size() - 1 - g] : vars[g];
+    std::vector<std::string> names;
+    for(std::map<std::string, int>::const_iterator cmi = group.begin(); cmi != group.end(); ++cmi)
+      names.push_back(cmi->first);
+    if(backwards)
+      std::reverse(names.begin(), names.end());
+
+    std::vector<int> domains;
+    for(size_t vari = 0; vari < names.size(); ++vari)
+      domains.insert(domains.end(), numSpots, group.find(names[vari])->second);
+    if(domains.empty())
+      continue;
+
     //Now actually create the fdd levels
     // lock mutex
-    int base = fdd_extdomain(domains, 6 * interleavedVars.size());
+    int base = fdd_extdomain(&domains[0], static_cast<int>(domains.size()));
     // release mutex
     if (base < 0){
       *waliErr << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl;
       *waliErr << "    Aborting." << endl;
       assert (false);
     }
-    delete [] domains;
     // Assign fdd levels to the variables.
-    vari = 0;
-    for(std::map<std::string, int>::const_iterator cmi = interleavedVars.begin(); cmi != interleavedVars.end(); ++cmi){
-      bddinfo_t varInfo = (*this)[cmi->first];
-      int j = 6 * vari;
-      varInfo->tensor1Lhs = base + j++;
-      varInfo->tensor1Rhs = base + j++;
-      varInfo->tensor1Extra = base + j++;
-      varInfo->tensor2Lhs = base + j++;
-      varInfo->tensor2Rhs = base + j++;
-      varInfo->tensor2Extra = base + j++;
-      vari++;  
+    for(size_t vari = 0; vari < names.size(); ++vari){
+      bddinfo_t varInfo = (*this)[names[vari]];
+      for(int j = 0; j < numSpots; ++j)
+        (*varInfo).*spots[j] = base + static_cast<int>(vari) * numSpots + j;
     }
   }
-#else
-#error "Unknown bdd level arrangement macro"
-#endif
-
-  // Also update the reverse vocabulary for printing.
-  for(std::map<const std::string, bddinfo_t>::const_iterator ci = this->begin(); ci != this->end(); ++ci){
-    bddinfo_t varInfo = ci->second;
-    idx2Name[varInfo->baseLhs] = ci->first;
-    idx2Name[varInfo->baseRhs] = ci->first + "'";
-    idx2Name[varInfo->baseExtra] = ci->first + "''";
-    idx2Name[varInfo->tensor1Lhs] = ci->first + "_t1";
-    idx2Name[varInfo->tensor1Rhs] = ci->first + "_t1'";
-    idx2Name[varInfo->tensor1Extra] = ci->first + "_t1''";
-    idx2Name[varInfo->tensor2Lhs] = ci->first + "_t2";
-    idx2Name[varInfo->tensor2Rhs] = ci->first + "_t2'";
-    idx2Name[varInfo->tensor2Extra] = ci->first + "_t2''";
-  } 
-
-#if (NWA_DETENSOR == 1)
-  setupLevelArray();
-#endif
 }
 
 void BddContext::setIntVars(const std::vector<std::map<std::string, int> >& vars)
@@ -849,16 +857,8 @@ void BddContext::setupCachedBdds()
   commonBddContextSet13 &= fdd_makeset(tensor2Lhs, this->size());
   assert(this->size() == 0 || (baseSecBddContextSet != bddfalse && tensorSecBddContextSet != bddfalse
         && tensorSecBddContextSet != bddfalse && commonBddContextSet23 != bddfalse && commonBddContextSet13 != bddfalse));
-#if (DETENSOR_TOGETHER == 1)
-  // Somehow make this efficient
-  for(std::map<const std::string, bddinfo_t>::const_iterator ci = this->begin(); ci != this->end(); ++ci){
-    bddinfo_t varInfo = ci->second;
-    commonBddContextId23 = commonBddContextId23 &
-      fdd_equals(varInfo->tensor1Rhs, varInfo->tensor2Lhs);
-    commonBddContextId13 = commonBddContextId13 & 
-      fdd_equals(varInfo->tensor1Lhs, varInfo->tensor2Lhs);
-  }
-#endif
+  if(detensorMethod == DETENSOR_METHOD_TOGETHER || detensorMethod == DETENSOR_METHOD_RELPROD)
+    buildDetensorIds();
 
   // Create cached BinRel objects
   // Somehow make this efficient
@@ -985,15 +985,15 @@ void BddContext::addIntVar(std::string name, unsigned size)
   populateCache();
   //update RevBddContext for pretty printing through buddy.
   //lock mutex
-  idx2Name[varInfo->baseLhs] = name;
-  idx2Name[varInfo->baseRhs] = name + "'";
-  idx2Name[varInfo->baseExtra] = name + "''";
-  idx2Name[varInfo->tensor1Lhs] = name + "_t1";
-  idx2Name[varInfo->tensor1Rhs] = name + "_t1'";
-  idx2Name[varInfo->tensor1Extra] = name + "_t1''";
-  idx2Name[varInfo->tensor2Lhs] = name + "_t2";
-  idx2Name[varInfo->tensor2Rhs] = name + "_t2'";
-  idx2Name[varInfo->tensor2Extra] = name + "_t2''";
+  idx2Name()[varInfo->baseLhs] = name;
+  idx2Name()[varInfo->baseRhs] = name + "'";
+  idx2Name()[varInfo->baseExtra] = name + "''";
+  idx2Name()[varInfo->tensor1Lhs] = name + "_t1";
+  idx2Name()[varInfo->tensor1Rhs] = name + "_t1'";
+  idx2Name()[varInfo->tensor1Extra] = name + "_t1''";
+  idx2Name()[varInfo->tensor2Lhs] = name + "_t2";
+  idx2Name()[varInfo->tensor2Rhs] = name + "_t2'";
+  idx2Name()[varInfo->tensor2Extra] = name + "_t2''";
   //release mutex
 }
 
@@ -1091,15 +1091,22 @@ binrel_t BinRel::Compose( binrel_t that ) const
   if (that->isOne())
     return new BinRel(*this);
 
+  BddContext::MemoOp op = isTensored ? BddContext::MEMO_COMPOSE_TENSOR : BddContext::MEMO_COMPOSE_BASE;
   bdd c;
-  if(!isTensored){
-    bdd temp1 = bdd_replace(that->rel, con->baseRightShift.get());
-    bdd temp2 = bdd_relprod(rel, temp1, con->baseSecBddContextSet);
-    c = bdd_replace(temp2, con->baseRestore.get());
-  }else{
-    bdd temp1 = bdd_replace(that->rel, con->tensorRightShift.get());
-    bdd temp2 = bdd_relprod(rel, temp1, con->tensorSecBddContextSet);
-    c = bdd_replace(temp2, con->tensorRestore.get());
+  if(!con->lookupMemo(op, rel, that->rel, c)){
+    if(!isTensored){
+      bdd temp1 = bdd_replace(that->rel, con->baseRightShift.get());
+      bdd temp2 = bdd_relprod(rel, temp1, con->baseSecBddContextSet);
+      c = bdd_replace(temp2, con->baseRestore.get());
+    }else{
+      bdd temp1 = bdd_replace(that->rel, con->tensorRightShift.get());
+      bdd temp2 = bdd_relprod(rel, temp1, con->tensorSecBddContextSet);
+      c = bdd_replace(temp2, con->tensorRestore.get());
+    }
+    con->storeMemo(op, rel, that->rel, c);
+    // Compose, Kronecker and detensor build the most nodes, so they are
+    // where dynamic reordering gets a chance to run.
+    BddContext::reorderIfGrown();
   }
 
   binrel_t ret = new BinRel(con,c,isTensored);
@@ -1130,8 +1137,17 @@ binrel_t BinRel::Union( binrel_t that ) const
   if (that->isZero())
     return new BinRel(*this);
 
+  // Union commutes, so the operands go in the memo in id order
+  bdd const & left = rel.id() < that->rel.id() ? rel : that->rel;
+  bdd const & right = rel.id() < that->rel.id() ? that->rel : rel;
+  bdd c;
+  if(!con->lookupMemo(BddContext::MEMO_UNION, left, right, c)){
+    c = rel | that->rel;
+    con->storeMemo(BddContext::MEMO_UNION, left, right, c);
+  }
+
   // Keep zero/one unique
-  binrel_t ret = new BinRel(con,rel | that->rel, isTensored);
+  binrel_t ret = new BinRel(con, c, isTensored);
   if(ret->isOne())
     return static_cast<BinRel*>(ret->one().get_ptr());
   //can't be zero.
@@ -1224,7 +1240,11 @@ binrel_t BinRel::Transpose() const
   if(this->isOne())
     return static_cast<BinRel*>(one().get_ptr());
 
-  bdd c = bdd_replace(rel, con->baseSwap.get());
+  bdd c;
+  if(!con->lookupMemo(BddContext::MEMO_TRANSPOSE, rel, bddfalse, c)){
+    c = bdd_replace(rel, con->baseSwap.get());
+    con->storeMemo(BddContext::MEMO_TRANSPOSE, rel, bddfalse, c);
+  }
   return new BinRel(con, c, isTensored);
 }
 
@@ -1244,13 +1264,18 @@ binrel_t BinRel::Kronecker(binrel_t that) const
 #endif
   if(rel == bddfalse || that->rel == bddfalse)
     return con->cachedTensorZero;
+  bdd c;
+  if(!con->lookupMemo(BddContext::MEMO_KRONECKER, rel, that->rel, c)){
 #if (NWA_DETENSOR == 1)
-  bdd c = tensorViaDetensor(that->rel); //nwa_detensor.cpp
+    c = tensorViaDetensor(that->rel); //nwa_detensor.cpp
 #else
-  bdd rel1 = bdd_replace(rel, con->move2Tensor1.get());
-  bdd rel2 = bdd_replace(that->rel, con->move2Tensor2.get());
-  bdd c = rel1 & rel2;
+    bdd rel1 = bdd_replace(rel, con->move2Tensor1.get());
+    bdd rel2 = bdd_replace(that->rel, con->move2Tensor2.get());
+    c = rel1 & rel2;
 #endif
+    con->storeMemo(BddContext::MEMO_KRONECKER, rel, that->rel, c);
+    BddContext::reorderIfGrown();
+  }
   binrel_t ret = new BinRel(con, c,true);
   if(ret->isZero())
     return static_cast<BinRel*>(ret->zero().get_ptr());
@@ -1270,20 +1295,14 @@ binrel_t BinRel::Eq23Project() const
     return new BinRel(con,bddfalse, false);
   }
 #endif
-#if (DETENSOR_TOGETHER == 1)
-  bdd rel1 = rel & con->commonBddContextId23; 
-  bdd rel2 = bdd_exist(rel1, con->commonBddContextSet23);
-  bdd c = bdd_replace(rel2, con->move2Base.get());
-#else
-  bdd rel1 = rel;
-  for(std::map<const std::string, bddinfo_t>::const_iterator citer = con->begin(); citer != con->end(); ++citer){
-    bddinfo_t varInfo = (*citer).second;
-    bdd id = fdd_equals(varInfo->tensor1Rhs, varInfo->tensor2Lhs);
-    rel1 = rel1 & id;
-    rel1 = bdd_exist(rel1, fdd_ithset(varInfo->tensor1Rhs) & fdd_ithset(varInfo->tensor2Lhs));
+  bdd c;
+  if(!con->lookupMemo(BddContext::MEMO_EQ23PROJECT, rel, bddfalse, c)){
+    bdd rel1 = con->equateAndProject(rel, &BddInfo::tensor1Rhs, &BddInfo::tensor2Lhs,
+                                     con->commonBddContextId23, con->commonBddContextSet23);
+    c = bdd_replace(rel1, con->move2Base.get());
+    con->storeMemo(BddContext::MEMO_EQ23PROJECT, rel, bddfalse, c);
+    BddContext::reorderIfGrown();
   }
-  bdd c = bdd_replace(rel1, con->move2Base.get());
-#endif
   binrel_t ret = new BinRel(con,c,false);
   if(ret->isZero())
     return static_cast<BinRel*>(ret->zero().get_ptr());
@@ -1303,20 +1322,14 @@ binrel_t BinRel::Eq13Project() const
     return new BinRel(con,bddfalse, false);
   }
 #endif
-#if (DETENSOR_TOGETHER == 1)
-  bdd rel1 = rel & con->commonBddContextId13; 
-  bdd rel2 = bdd_exist(rel1, con->commonBddContextSet13);
-  bdd c = bdd_replace(rel2, con->move2BaseTwisted.get());
-#else
-  bdd rel1 = rel;
-  for(std::map<const std::string, bddinfo_t>::const_iterator citer = con->begin(); citer != con->end(); ++citer){
-    bddinfo_t varInfo = (*citer).second;
-    bdd id = fdd_equals(varInfo->tensor1Lhs, varInfo->tensor2Lhs);
-    rel1 = rel1 & id;
-    rel1 = bdd_exist(rel1, fdd_ithset(varInfo->tensor1Lhs) & fdd_ithset(varInfo->tensor2Lhs));
+  bdd c;
+  if(!con->lookupMemo(BddContext::MEMO_EQ13PROJECT, rel, bddfalse, c)){
+    bdd rel1 = con->equateAndProject(rel, &BddInfo::tensor1Lhs, &BddInfo::tensor2Lhs,
+                                     con->commonBddContextId13, con->commonBddContextSet13);
+    c = bdd_replace(rel1, con->move2BaseTwisted.get());
+    con->storeMemo(BddContext::MEMO_EQ13PROJECT, rel, bddfalse, c);
+    BddContext::reorderIfGrown();
   }
-  bdd c = bdd_replace(rel1, con->move2BaseTwisted.get());
-#endif
   binrel_t ret = new BinRel(con,c,false);
   if(ret->isZero())
     return static_cast<BinRel*>(ret->zero().get_ptr());
@@ -1333,6 +1346,7 @@ binrel_t BinRel::Eq13Project() const
 wali::sem_elem_t BinRel::star()
 {
   StarCacheKey k(getBdd(), isTensored);
+  StarCache & star_cache = state().star_cache;
   if (star_cache.find(k) == star_cache.end()) {
     sem_elem_t w = combine(one().get_ptr());
     sem_elem_t wn = w->extend(w);
@@ -1451,6 +1465,8 @@ std::ostream& BddContext::printStats( std::ostream& o) const
   o << "#Transpose: " << numTranspose << endl;
   o << "#Eq23Project: " << numDetensor << endl;
   o << "#Eq13Project: " << numDetensorTranspose << endl;
+  o << "#Memo hits: " << memoHits << endl;
+  o << "#Memo misses: " << memoMisses << endl;
   return o;
 }
 
@@ -1465,6 +1481,8 @@ void BddContext::resetStats()
   numTranspose = 0;
   numDetensor = 0;
   numDetensorTranspose = 0;
+  memoHits = 0;
+  memoMisses = 0;
 }
 #endif //BINREL_STATS
 
@@ -85,6 +85,8 @@
  * x1t2 x1t2' x1t2'' y1t2 y1t2' y1t2'' x2t2 x2t2' x2t2'' y2t2 y2t2' y2t2'' z1t2 z1t2' z1t2'' w1t2 w1t2' w1t2'' z2t2 z2t2' z2t2'' w2t2 w2t2' w2t2''
  *
  * The tensor choice is determined by setting **exactly one** macro to 1.
+ * This only picks the default: a BddContext can be given any of these
+ * layouts when it is constructed (see BddContext::VarOrder).
  **/
 #define TENSOR_MAX_AFFINITY 1
 #define TENSOR_MIN_AFFINITY 0
@@ -109,7 +111,10 @@
  * Converts the bdd to an Nwa, enforces the constraints by Nwa intersection, and converts back to, obtain
  * the detensored bdd.
  *
- * The detensor choice is made by setting **exactly one** macro to 1
+ * The detensor choice is made by setting **exactly one** macro to 1.
+ * For (1) and (2) this only picks the default: a BddContext can switch
+ * between them, and two more, at run time (see
+ * BddContext::DetensorMethod).
  **/
 #define DETENSOR_TOGETHER 0
 #define DETENSOR_BIT_BY_BIT 1
@@ -233,15 +238,36 @@ namespace wali
           typedef std::vector<int> VocLevelArray;
 #endif
         public:
+          /**
+           * The layout of the bdd levels created by setIntVars, as
+           * described at the top of this file. ORDER_DEFAULT is the one
+           * picked by the macros there. (addIntVar always keeps base,
+           * tensor1 and tensor2 apart.)
+           */
+          enum VarOrder {
+            ORDER_DEFAULT,
+            ORDER_TENSOR_MAX_AFFINITY,
+            ORDER_TENSOR_MIN_AFFINITY,
+            ORDER_BASE_MAX_AFFINITY_TENSOR_MIXED,
+            ORDER_TENSOR_MATCHED_PAREN
+          };
+
            /** 
            * A BddContext manages the vocabularies and stores some useful bdds
            * that speed up BinRel operations.
-           * @param bddMemSize The size of memory BUDDY should be initialized
-           *        with.  Default size is used if the argument is 0.  
-           * @param cacheSize The size of cache BUDDY should be initialized
-           *        with.  Default size is used if the argument is 0.
+           * @param bddMemSize The number of nodes BUDDY should start
+           *        with.  If the argument is 0, the sizes come from
+           *        wali::util::BddResources (and the environment).
+           * @param cacheSize The size of cache BUDDY should start with (it
+           *        grows with the node table).  Default size is used if
+           *        the argument is 0.
+           * @param order The layout of the bdd levels of this context's
+           *        variables.
+           * @param dynamicReordering Whether to turn on dynamic reordering
+           *        (see enableDynamicReordering).
            */
-          BddContext(int bddMemeSize=0, int cacheSize=0);
+          BddContext(int bddMemeSize=0, int cacheSize=0,
+                     VarOrder order=ORDER_DEFAULT, bool dynamicReordering=false);
           BddContext(const BddContext& other);
           BddContext& operator = (const BddContext& other);
           virtual ~BddContext();
@@ -260,6 +286,95 @@ namespace wali
           virtual void setIntVars(const std::map<std::string, int>& vars);
           virtual void setIntVars(const std::vector<std::map<std::string, int> >& vars);
 
+          VarOrder getVarOrder() const { return varOrder; }
+
+          /**
+           * Dynamic variable reordering, with one of BuDDy's methods
+           * (BDD_REORDER_SIFT etc.). While it is on, BinRel operations
+           * reorder the variables once the number of bdd nodes in use
+           * reaches a threshold: twice the number left after the last
+           * reordering, but at least 'minNodes'. Every bdd level moves on
+           * its own.
+           *
+           * BuDDy is shared by all BddContexts, so this is a global
+           * setting; it lasts until the last BddContext goes away. It is
+           * not available with NWA_DETENSOR, which relies on the
+           * TENSOR_MATCHED_PAREN layout staying put.
+           */
+          static void enableDynamicReordering(int method = BDD_REORDER_SIFT,
+                                              int minNodes = 100000);
+          static void disableDynamicReordering();
+          static bool dynamicReorderingEnabled();
+
+          /// Reorders the variables now; returns the number of nodes in use
+          /// afterwards
+          static int reorder(int method = BDD_REORDER_SIFT);
+
+          /// Reorders if dynamic reordering is on and the threshold has been
+          /// reached
+          static void reorderIfGrown();
+
+          /// The number of reorderings done since BuDDy was initialized
+          static unsigned numReorderings();
+
+          /**
+           * Compose, Union, Kronecker, Transpose, Eq23Project and
+           * Eq13Project remember their results in a memo table keyed by
+           * the operation and the bdd node ids of the operands, so a
+           * repeated operation on the same relations costs one lookup.
+           * The table has a fixed number of slots (a power of two), and a
+           * new result evicts whatever was in its slot. The table holds
+           * references to the bdds in it, which keeps their node ids from
+           * being reused.
+           *
+           * setMemoSize rounds 'entries' up to a power of two and clears
+           * the table; 0 turns memoization off.
+           */
+          void setMemoSize(size_t entries);
+          size_t getMemoSize() const { return memo.size(); }
+          void clearMemo();
+
+          StatCount numMemoHits() const { return memoHits; }
+          StatCount numMemoMisses() const { return memoMisses; }
+
+          static size_t const defaultMemoSize = 1 << 14;
+
+          /**
+           * How Eq23Project and Eq13Project (detensor and
+           * detensorTranspose) make the two middle vocabularies equal
+           * and quantify them away.
+           *  - TOGETHER: conjoin with one bdd of the equalities for all
+           *    variables, then quantify (DETENSOR_TOGETHER).
+           *  - BIT_BY_BIT: conjoin and quantify one variable at a time
+           *    (DETENSOR_BIT_BY_BIT).
+           *  - RELPROD: as TOGETHER, but conjoin and quantify in one
+           *    pass with bdd_relprod, so the conjunction is never built.
+           *  - BIT_BY_BIT_RELPROD: as BIT_BY_BIT, with bdd_relprod.
+           * The results are the same; which is fastest depends on the
+           * variable order and the relations. (TOGETHER and RELPROD
+           * build the bdd of all the equalities, which blows up unless
+           * the tensor vocabularies are interleaved.)
+           *
+           * DETENSOR_METHOD_DEFAULT is globalDefaultDetensorMethod,
+           * which is set from the environment variable
+           * WALI_BINREL_DETENSOR ("together", "bit-by-bit", "relprod"
+           * or "bit-by-bit-relprod") and otherwise from the macros
+           * above. Detensor results are memoized (see setMemoSize) the
+           * same whatever the method.
+           */
+          enum DetensorMethod {
+            DETENSOR_METHOD_DEFAULT,
+            DETENSOR_METHOD_TOGETHER,
+            DETENSOR_METHOD_BIT_BY_BIT,
+            DETENSOR_METHOD_RELPROD,
+            DETENSOR_METHOD_BIT_BY_BIT_RELPROD
+          };
+
+          static DetensorMethod globalDefaultDetensorMethod;
+
+          void setDetensorMethod(DetensorMethod method);
+          DetensorMethod getDetensorMethod() const { return detensorMethod; }
+
 #if (NWA_DETENSOR == 1)
           /**
            * These functions are used by an NWA based implementation of detensor.
@@ -278,14 +393,56 @@ namespace wali
            **/
           void createIntVars(const std::vector<std::map<std::string, int> >& vars);
           virtual void setupCachedBdds();
+
+          /// A choice of BddInfo field, i.e., of one of the nine spots
+          typedef unsigned BddInfo::* Spot;
+
+          /**
+           * For each group in 'vars' (or each group backwards, with the
+           * variables in each backwards, if 'backwards'), creates
+           * 'numSpots' fdd domains per variable, all interleaved bit by
+           * bit, and assigns them to the given spots in that order.
+           */
+          void createSpots(const std::vector<std::map<std::string, int> >& vars,
+                           Spot const * spots, int numSpots, bool backwards);
         public:
           //using wali::Countable::count;
           int count;
         private:
           /** caches zero/one binrel objects for this context **/
           void populateCache();
+
+          enum MemoOp {
+            MEMO_NONE,
+            MEMO_COMPOSE_BASE,
+            MEMO_COMPOSE_TENSOR,
+            MEMO_UNION,
+            MEMO_TRANSPOSE,
+            MEMO_KRONECKER,
+            MEMO_EQ23PROJECT,
+            MEMO_EQ13PROJECT
+          };
+
+          /// Looks up op(left, right) in the memo table; on a hit, sets
+          /// 'result' and returns true. Unary operations pass bddfalse as
+          /// 'right'.
+          bool lookupMemo(MemoOp op, bdd const & left, bdd const & right, bdd & result) const;
+          void storeMemo(MemoOp op, bdd const & left, bdd const & right, bdd const & result) const;
+
+          /// (Re)builds commonBddContextId23 and commonBddContextId13
+          void buildDetensorIds();
+
+          /// Conjoins 'rel' with left = right, for the given spots of
+          /// every variable, and quantifies those spots away, using the
+          /// detensor method; 'id' and 'set' are that equality and those
+          /// spots for all variables.
+          bdd equateAndProject(bdd rel, Spot left, Spot right,
+                               bdd const & id, bdd const & set) const;
           
         private:
+          VarOrder varOrder;
+          DetensorMethod detensorMethod;
+
           // ///////////////////////////////
           // We use the name convention for different 
           // sets as B1,B2,B3; TL1,TL2,TL3; TR1, TR2, TR3.
@@ -329,6 +486,20 @@ namespace wali
           binrel_t cachedBaseZero;
           binrel_t cachedTensorOne;
           binrel_t cachedTensorZero;
+
+          struct MemoEntry
+          {
+            MemoOp op;
+            bdd left;
+            bdd right;
+            bdd result;
+
+            MemoEntry() : op(MEMO_NONE) {}
+          };
+
+          mutable std::vector<MemoEntry> memo;
+          mutable StatCount memoHits;
+          mutable StatCount memoMisses;
 #if (NWA_DETENSOR == 1)
           VocLevelArray tensorVocLevels;
           VocLevelArray baseLhsVocLevels;
@@ -359,7 +530,7 @@ namespace wali
         private:
           //Initialization of buddy is taken care of opaquely 
           //by keeping track of the number of BddContext objects alive
-          static int numBddContexts;
+          static BDD_TLS int numBddContexts;
       };
 
       
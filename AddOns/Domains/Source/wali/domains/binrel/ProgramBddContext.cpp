@@ -30,7 +30,7 @@ namespace wali
   {
     namespace binrel
     {
-      extern RevBddContext idx2Name;
+      RevBddContext & idx2Name();
     }
   }
 }
@@ -108,7 +108,7 @@ namespace details
   get_mapping()
   {
     std::map<int, std::string> mapping;
-    for (RevBddContext::const_iterator iter = idx2Name.begin(); iter != idx2Name.end(); ++iter)
+    for (RevBddContext::const_iterator iter = idx2Name().begin(); iter != idx2Name().end(); ++iter)
     {
       accumulate(mapping, get_partial_mapping_for_fdd(iter->second, iter->first));
     }
@@ -328,14 +328,14 @@ void ProgramBddContext::createExtraVars()
   regBInfo->baseExtra = (unsigned) base++;
   
   //To pretty print during testing, we add some names for this extra register
-  //Currently, idx2Name is a global variable in wali::domains::binrel
-  idx2Name[sizeInfo] = "__regSize";
-  idx2Name[regAInfo->baseLhs] = "__regA";
-  idx2Name[regAInfo->baseRhs] = "__regA'";
-  idx2Name[regAInfo->baseExtra] = "__regA''";
-  idx2Name[regBInfo->baseLhs] = "__regB";
-  idx2Name[regBInfo->baseRhs] = "__regB'";
-  idx2Name[regBInfo->baseExtra] = "__regB''";
+  //idx2Name is kept in BinRel.cpp, one per BuDDy
+  idx2Name()[sizeInfo] = "__regSize";
+  idx2Name()[regAInfo->baseLhs] = "__regA";
+  idx2Name()[regAInfo->baseRhs] = "__regA'";
+  idx2Name()[regAInfo->baseExtra] = "__regA''";
+  idx2Name()[regBInfo->baseLhs] = "__regB";
+  idx2Name()[regBInfo->baseRhs] = "__regB'";
+  idx2Name()[regBInfo->baseExtra] = "__regB''";
 }
 
 void ProgramBddContext::setupCachedBdds()
@@ -379,7 +379,7 @@ void ProgramBddContext::addIntVar(std::string name, unsigned siz)
       else
         sizeInfo = (unsigned) retSizeInfo;
       //To pretty print during testing, we add some names for this regsiter size fdd level.
-      idx2Name[sizeInfo] = "__regSize";
+      idx2Name()[sizeInfo] = "__regSize";
       //Now create two extra bdd levels, and the corresponding BddInfo entries to be used for manipulation
       //inside ProgramBddContext.
       //We will create indices such that we get a default variable ordering where
@@ -398,10 +398,10 @@ void ProgramBddContext::addIntVar(std::string name, unsigned siz)
         regAInfo->baseExtra = (unsigned) base + 2;
 
         //To pretty print during testing, we add some names for this extra register
-        //Currently, idx2Name is a global variable in wali::domains::binrel
-        idx2Name[regAInfo->baseLhs] = "__regA";
-        idx2Name[regAInfo->baseRhs] = "__regA'";
-        idx2Name[regAInfo->baseExtra] = "__regA''";
+        //idx2Name is kept in BinRel.cpp, one per BuDDy
+        idx2Name()[regAInfo->baseLhs] = "__regA";
+        idx2Name()[regAInfo->baseRhs] = "__regA'";
+        idx2Name()[regAInfo->baseExtra] = "__regA''";
       }
       {
         int domains2[3] = {(int)siz, (int)siz, (int)siz};
@@ -416,10 +416,10 @@ void ProgramBddContext::addIntVar(std::string name, unsigned siz)
         regBInfo->baseExtra = (unsigned) base + 2;
 
         //To pretty print during testing, we add some names for this extra register
-        //Currently, idx2Name is a global variable in wali::domains::binrel
-        idx2Name[regBInfo->baseLhs] = "__regB";
-        idx2Name[regBInfo->baseRhs] = "__regB'";
-        idx2Name[regBInfo->baseExtra] = "__regB''";
+        //idx2Name is kept in BinRel.cpp, one per BuDDy
+        idx2Name()[regBInfo->baseLhs] = "__regB";
+        idx2Name()[regBInfo->baseRhs] = "__regB'";
+        idx2Name()[regBInfo->baseExtra] = "__regB''";
       }
     }else{
       //This is when we *enlarge* the extra levels needed
@@ -437,7 +437,7 @@ void ProgramBddContext::addIntVar(std::string name, unsigned siz)
       sizeInfo = retSizeInfo;
 
       //To pretty print during testing, we add some names for this regsiter size fdd level.
-      idx2Name[sizeInfo] = "__regSize";
+      idx2Name()[sizeInfo] = "__regSize";
       //Now create two extra bdd levels, and the corresponding BddInfo entries to be used for manipulation
       //inside ProgramBddContext.
       //We will create indices such that we get a default variable ordering where
@@ -466,10 +466,10 @@ void ProgramBddContext::addIntVar(std::string name, unsigned siz)
           LOG(ERROR) << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl
             << "    Aborting." << endl;
         //To pretty print during testing, we add some names for this extra register
-        //Currently, idx2Name is a global variable in wali::domains::binrel
-        idx2Name[regAInfo->baseLhs] = "__regA";
-        idx2Name[regAInfo->baseRhs] = "__regA'";
-        idx2Name[regAInfo->baseExtra] = "__regA''";
+        //idx2Name is kept in BinRel.cpp, one per BuDDy
+        idx2Name()[regAInfo->baseLhs] = "__regA";
+        idx2Name()[regAInfo->baseRhs] = "__regA'";
+        idx2Name()[regAInfo->baseExtra] = "__regA''";
       }
       {
         int domains2[3] = {maxVal, maxVal, maxVal};
@@ -495,10 +495,10 @@ void ProgramBddContext::addIntVar(std::string name, unsigned siz)
           LOG(ERROR) << "[ERROR-BuDDy initialization] \"" << bdd_errstring(base) << "\"" << endl
             << "    Aborting." << endl;
         //To pretty print during testing, we add some names for this extra register
-        //Currently, idx2Name is a global variable in wali::domains::binrel
-        idx2Name[regBInfo->baseLhs] = "__regB";
-        idx2Name[regBInfo->baseRhs] = "__regB'";
-        idx2Name[regBInfo->baseExtra] = "__regB''";
+        //idx2Name is kept in BinRel.cpp, one per BuDDy
+        idx2Name()[regBInfo->baseLhs] = "__regB";
+        idx2Name()[regBInfo->baseRhs] = "__regB'";
+        idx2Name()[regBInfo->baseExtra] = "__regB''";
       }
     }
     maxSize = siz;
@@ -510,8 +510,8 @@ void ProgramBddContext::addIntVar(std::string name, unsigned siz)
     fdd_setpair(baseLhs2Rhs.get(), varInfo->baseLhs, varInfo->baseRhs);
 }
 
-ProgramBddContext::ProgramBddContext(int bddMemSize, int cacheSize) :
-  BddContext(bddMemSize, cacheSize),
+ProgramBddContext::ProgramBddContext(int bddMemSize, int cacheSize, VarOrder order, bool dynamicReordering) :
+  BddContext(bddMemSize, cacheSize, order, dynamicReordering),
   sizeInfo(0),
   maxSize(0),
   regAInfo(NULL),
@@ -543,8 +543,9 @@ ProgramBddContext& ProgramBddContext::operator = (const ProgramBddContext& other
 }
 
 
-ProgramBddContext::ProgramBddContext(const std::map<std::string, int>& vars, int bddMemSize, int cacheSize) :
-  BddContext(bddMemSize, cacheSize),
+ProgramBddContext::ProgramBddContext(const std::map<std::string, int>& vars, int bddMemSize, int cacheSize,
+                                     VarOrder order, bool dynamicReordering) :
+  BddContext(bddMemSize, cacheSize, order, dynamicReordering),
   sizeInfo(0),
   maxSize(0),
   regAInfo(NULL),
@@ -555,8 +556,9 @@ ProgramBddContext::ProgramBddContext(const std::map<std::string, int>& vars, int
   setIntVars(vars);
 }
 
-ProgramBddContext::ProgramBddContext(const std::vector<std::map<std::string, int> >& vars, int bddMemSize, int cacheSize) :
-  BddContext(bddMemSize, cacheSize),
+ProgramBddContext::ProgramBddContext(const std::vector<std::map<std::string, int> >& vars, int bddMemSize, int cacheSize,
+                                     VarOrder order, bool dynamicReordering) :
+  BddContext(bddMemSize, cacheSize, order, dynamicReordering),
   sizeInfo(0),
   maxSize(0),
   regAInfo(NULL),
@@ -76,13 +76,18 @@ namespace wali
            * Initialize the ProgramBddContext. 
            * @param [bddMemSize] the memory size buddy should use. Use 0 for default.
            * @param [cacheSize] the memory size buddy should use. Use 0 for default.
+           * @param [order] the layout of the bdd levels (see BddContext::VarOrder).
+           * @param [dynamicReordering] whether to turn on dynamic reordering.
            **/
-          ProgramBddContext(int bddMemSize=0, int cacheSize=0);
+          ProgramBddContext(int bddMemSize=0, int cacheSize=0,
+                            VarOrder order=ORDER_DEFAULT, bool dynamicReordering=false);
           ProgramBddContext(const ProgramBddContext& other);
           virtual ProgramBddContext& operator = (const ProgramBddContext& other);
 
-          ProgramBddContext(const std::map<std::string, int>& vars, int bddMemSize = 0, int cacheSize = 0);
-          ProgramBddContext(const std::vector<std::map<std::string, int> >& vars, int bddMemSize = 0, int cacheSize = 0);
+          ProgramBddContext(const std::map<std::string, int>& vars, int bddMemSize = 0, int cacheSize = 0,
+                            VarOrder order = ORDER_DEFAULT, bool dynamicReordering = false);
+          ProgramBddContext(const std::vector<std::map<std::string, int> >& vars, int bddMemSize = 0, int cacheSize = 0,
+                            VarOrder order = ORDER_DEFAULT, bool dynamicReordering = false);
         
           //This is left undefined. We need this declaration so that the compiler doesn't think we've
           //hidden the user defined operator = for base class BddContext. We leave it undefined so that 
@@ -0,0 +1,379 @@
+#ifndef WALI_DOMAINS_GENKILL_BIT_VECTOR_SET
+#define WALI_DOMAINS_GENKILL_BIT_VECTOR_SET
+
+#include <ostream>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "wali/Common.hpp"
+
+namespace wali {
+  namespace domains {
+    namespace genkill {
+
+      /// BitVectorSet is a Set for the GenKillXformerTemplate over a
+      /// fixed universe of elements 0 .. universeSize()-1, stored one bit
+      /// per element. Call setUniverseSize before making any sets; sets
+      /// made under different universe sizes cannot be mixed.
+      ///
+      /// The bits are hash-consed: each distinct set is stored once, and
+      /// every BitVectorSet equal to it (and so every GenKill transformer
+      /// with the same kill or gen set) points to that copy. Eq compares
+      /// pointers, and copying a set only counts a reference. Union,
+      /// Intersect and Diff go a word at a time and then look the result
+      /// up. insert and erase copy the whole set, so build a large set
+      /// from a range of elements instead.
+      ///
+      /// Like the other weights, a BitVectorSet must stay in the thread
+      /// that made it.
+      class BitVectorSet
+      {
+      public:
+        typedef boost::uint64_t Word;
+
+        static void setUniverseSize(size_t elements) { universeSizeVar() = elements; }
+        static size_t universeSize() { return universeSizeVar(); }
+
+        /// The empty set
+        BitVectorSet()
+          : m_bits(EmptySet().m_bits)
+        {
+          ++m_bits->refs;
+        }
+
+        /// The set of the elements in [first, last)
+        template<typename Iterator>
+        BitVectorSet(Iterator first, Iterator last)
+        {
+          std::vector<Word> words(wordsFor(universeSize()), Word(0));
+          for (; first != last; ++first) {
+            size_t element = *first;
+            fast_assert(element < universeSize());
+            words[element / 64] |= Word(1) << (element % 64);
+          }
+          m_bits = intern(words);
+        }
+
+        BitVectorSet(BitVectorSet const & other)
+          : m_bits(other.m_bits)
+        {
+          ++m_bits->refs;
+        }
+
+        BitVectorSet &
+        operator=(BitVectorSet const & other)
+        {
+          ++other.m_bits->refs;
+          release(m_bits);
+          m_bits = other.m_bits;
+          return *this;
+        }
+
+        ~BitVectorSet()
+        {
+          release(m_bits);
+        }
+
+
+        /// Whether 'element' is in the set. Elements outside the
+        /// universe are in no set.
+        bool
+        contains(size_t element) const
+        {
+          if (element / 64 >= m_bits->words.size()) {
+            return false;
+          }
+          return (m_bits->words[element / 64] >> (element % 64)) & 1;
+        }
+
+        void
+        insert(size_t element)
+        {
+          fast_assert(element < universeSize());
+          if (!contains(element)) {
+            std::vector<Word> words(m_bits->words);
+            words[element / 64] |= Word(1) << (element % 64);
+            replace(words);
+          }
+        }
+
+        void
+        erase(size_t element)
+        {
+          fast_assert(element < universeSize());
+          if (contains(element)) {
+            std::vector<Word> words(m_bits->words);
+            words[element / 64] &= ~(Word(1) << (element % 64));
+            replace(words);
+          }
+        }
+
+        /// The number of elements
+        size_t
+        size() const
+        {
+          size_t n = 0;
+          for (size_t i = 0; i < m_bits->words.size(); ++i) {
+            for (Word w = m_bits->words[i]; w != 0; w &= w - 1) {
+              ++n;
+            }
+          }
+          return n;
+        }
+
+        size_t
+        hash() const
+        {
+          return m_bits->hash;
+        }
+
+        /// The number of distinct sets in existence
+        static size_t
+        distinctSets()
+        {
+          return pool().size();
+        }
+
+
+        static
+        BitVectorSet const &
+        UniverseSet()
+        {
+          static size_t builtFor = universeSize();
+          static BitVectorSet u(filled(true));
+          if (builtFor != universeSize()) {
+            builtFor = universeSize();
+            u = filled(true);
+          }
+          return u;
+        }
+
+
+        static
+        BitVectorSet const &
+        EmptySet()
+        {
+          static BitVectorSet e(filled(false));
+          if (e.m_bits->words.size() != wordsFor(universeSize())) {
+            e = filled(false);
+          }
+          return e;
+        }
+
+
+        static
+        bool
+        Eq(BitVectorSet const & x, BitVectorSet const & y)
+        {
+          return x.m_bits == y.m_bits;
+        }
+
+
+        static
+        BitVectorSet
+        Diff(BitVectorSet const & x,
+             BitVectorSet const & y,
+             bool UNUSED_PARAMETER(normalizing) = false)
+        {
+          if (Eq(x, y)) {
+            return EmptySet();
+          }
+          if (Eq(x, EmptySet()) || Eq(y, EmptySet())) {
+            return x;
+          }
+          return apply(x, y, AndNot());
+        }
+
+
+        static
+        BitVectorSet
+        Union(BitVectorSet const & x,
+              BitVectorSet const & y)
+        {
+          if (Eq(x, y) || Eq(y, EmptySet())) {
+            return x;
+          }
+          if (Eq(x, EmptySet())) {
+            return y;
+          }
+          return apply(x, y, Or());
+        }
+
+
+        static
+        BitVectorSet
+        Intersect(BitVectorSet const & x,
+                  BitVectorSet const & y)
+        {
+          if (Eq(x, y) || Eq(x, EmptySet())) {
+            return x;
+          }
+          if (Eq(y, EmptySet())) {
+            return y;
+          }
+          return apply(x, y, And());
+        }
+
+
+        std::ostream &
+        print(std::ostream& o) const
+        {
+          o << "{";
+          for (size_t element = 0; element < m_bits->words.size() * 64; ++element) {
+            if (contains(element)) {
+              o << element << ", ";
+            }
+          }
+          o << "}";
+          return o;
+        }
+
+
+      private:
+        struct Bits
+        {
+          size_t refs;
+          size_t hash;
+          std::vector<Word> words;
+        };
+
+        struct BitsHash
+        {
+          size_t operator()(Bits const * bits) const { return bits->hash; }
+        };
+
+        struct BitsEqual
+        {
+          bool operator()(Bits const * left, Bits const * right) const
+          {
+            return left->words == right->words;
+          }
+        };
+
+        typedef boost::unordered_set<Bits*, BitsHash, BitsEqual> Pool;
+
+        struct Or { Word operator()(Word x, Word y) const { return x | y; } };
+        struct And { Word operator()(Word x, Word y) const { return x & y; } };
+        struct AndNot { Word operator()(Word x, Word y) const { return x & ~y; } };
+
+        Bits * m_bits;
+
+        explicit BitVectorSet(Bits * bits)
+          : m_bits(bits)
+        {}
+
+        static size_t wordsFor(size_t elements) { return (elements + 63) / 64; }
+
+        static size_t & universeSizeVar()
+        {
+          static size_t elements = 0;
+          return elements;
+        }
+
+        static Pool & pool()
+        {
+          static Pool p;
+          return p;
+        }
+
+        /// The shared copy of 'words' (whose contents are taken), with a
+        /// reference counted for the caller
+        static Bits *
+        intern(std::vector<Word> & words)
+        {
+          Bits probe;
+          probe.words.swap(words);
+          probe.hash = boost::hash_range(probe.words.begin(), probe.words.end());
+
+          Pool::iterator found = pool().find(&probe);
+          if (found != pool().end()) {
+            ++(*found)->refs;
+            return *found;
+          }
+
+          Bits * bits = new Bits;
+          bits->refs = 1;
+          bits->hash = probe.hash;
+          bits->words.swap(probe.words);
+          pool().insert(bits);
+          return bits;
+        }
+
+        static void
+        release(Bits * bits)
+        {
+          if (--bits->refs == 0) {
+            pool().erase(bits);
+            delete bits;
+          }
+        }
+
+        void
+        replace(std::vector<Word> & words)
+        {
+          Bits * old = m_bits;
+          m_bits = intern(words);
+          release(old);
+        }
+
+        static BitVectorSet
+        filled(bool full)
+        {
+          size_t elements = universeSize();
+          std::vector<Word> words(wordsFor(elements), full ? ~Word(0) : Word(0));
+          if (full && elements % 64 != 0) {
+            words.back() = (Word(1) << (elements % 64)) - 1;
+          }
+          return BitVectorSet(intern(words));
+        }
+
+        /// op applied word by word. Unrolled by four, and restrict, so
+        /// that the compiler vectorizes it even at -O2.
+        template<typename WordOp>
+        static void
+        apply(Word * WALI_RESTRICT out,
+              Word const * WALI_RESTRICT x,
+              Word const * WALI_RESTRICT y,
+              size_t n,
+              WordOp op)
+        {
+          size_t i = 0;
+          for (; i + 4 <= n; i += 4) {
+            for (size_t u = 0; u < 4; ++u) {
+              out[i + u] = op(x[i + u], y[i + u]);
+            }
+          }
+          for (; i < n; ++i) {
+            out[i] = op(x[i], y[i]);
+          }
+        }
+
+        template<typename WordOp>
+        static BitVectorSet
+        apply(BitVectorSet const & x, BitVectorSet const & y, WordOp op)
+        {
+          size_t n = x.m_bits->words.size();
+          fast_assert(n == y.m_bits->words.size());
+          std::vector<Word> words(n);
+          if (n != 0) {
+            apply(&words[0], &x.m_bits->words[0], &y.m_bits->words[0], n, op);
+          }
+          return BitVectorSet(intern(words));
+        }
+      };
+
+    } // namespace genkill
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif /* WALI_DOMAINS_GENKILL_BIT_VECTOR_SET */
@@ -23,6 +23,7 @@
 #include <cassert>
 
 #include "wali/domains/lh/AH.hpp"
+#include "wali/util/BddResources.hpp"
 
 using namespace wali::domains::lh;
 using wali::waliErr;
@@ -75,13 +76,11 @@ void AH::initialize( int num_locks )
 
   if (0 == bdd_isrunning())
   {
-    int rc = bdd_init( BDDMEMSIZE,100000 );
+    int rc = wali::util::bddInit( wali::util::BddResources(BDDMEMSIZE).fromEnvironment() );
     if( rc < 0 ) {
       *waliErr << "[ERROR] " << bdd_errstring(rc) << endl;
       assert( 0 );
     }
-    // Default is 50,000 (1 Mb),memory is cheap, so use 100,000
-    bdd_setmaxincrease(100000);
   }
   else {
     *waliErr << "[WARNING] BuDDy already initialized." << endl;
@@ -112,6 +112,7 @@ post((R,RH,U,AH,L),a) = (R',RH',U',AH',L'), where
 #include <cassert>
 
 #include "wali/domains/lh/LH.hpp"
+#include "wali/util/BddResources.hpp"
 
 using namespace wali::domains::lh;
 using wali::waliErr;
@@ -183,13 +184,11 @@ bool LH::allocate( int num_locks, int theQ )
 
   if (0 == bdd_isrunning())
   {
-    int rc = bdd_init( BDDMEMSIZE,100000 );
+    int rc = wali::util::bddInit( wali::util::BddResources(BDDMEMSIZE).fromEnvironment() );
     if( rc < 0 ) {
       *waliErr << "[ERROR] " << bdd_errstring(rc) << endl;
       assert( 0 );
     }
-    // Default is 50,000 (1 Mb),memory is cheap, so use 100,000
-    bdd_setmaxincrease(100000);
     bdd_error_hook( my_error_handler );
   }
   else {
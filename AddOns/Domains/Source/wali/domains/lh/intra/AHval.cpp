@@ -22,6 +22,7 @@
 
 #include "wali/domains/lh/intra/AHval.hpp"
 #include "wali/Common.hpp"
+#include "wali/util/BddResources.hpp"
 
 using namespace wali::domains::lh::intra;
 
@@ -57,7 +58,7 @@ void AHval::initialize( int num_locks )
 
   if (0 == bdd_isrunning())
   {
-    int rc = bdd_init( BDDMEMSIZE,100000 );
+    int rc = wali::util::bddInit( wali::util::BddResources(BDDMEMSIZE).fromEnvironment() );
     if( rc < 0 ) {
       std::cerr << "[ERROR] " << bdd_errstring(rc) << std::endl;
       assert( 0 );
@@ -67,8 +68,6 @@ void AHval::initialize( int num_locks )
     std::cerr << "[ERROR] BuDDy already initialized?" << std::endl;
     assert(0);
   }
-  // Default is 50,000 (1 Mb),memory is cheap, so use 100,000
-  bdd_setmaxincrease(100000);
 
   // End initialize BuDDy
   // ///////////////////////
@@ -0,0 +1,333 @@
+#include "wali/domains/matrix/BitMatrix.hpp"
+
+#include <wali/Common.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+namespace wali {
+  namespace domains {
+
+    namespace
+    {
+      typedef BitMatrix::Word Word;
+
+      int
+      popcount(Word w)
+      {
+#if defined(__GNUC__)
+        return __builtin_popcountll(w);
+#else
+        int n = 0;
+        for (; w != 0; w &= w - 1) {
+          ++n;
+        }
+        return n;
+#endif
+      }
+
+      /// The index of the lowest set bit of w, which must not be zero
+      int
+      lowestBit(Word w)
+      {
+#if defined(__GNUC__)
+        return __builtin_ctzll(w);
+#else
+        int n = 0;
+        for (; (w & 1) == 0; w >>= 1) {
+          ++n;
+        }
+        return n;
+#endif
+      }
+
+      // Kept to a plain loop so the compiler can vectorize it
+      void
+      orInto(Word * dest, Word const * src, size_t words)
+      {
+        for (size_t w = 0; w < words; ++w) {
+          dest[w] |= src[w];
+        }
+      }
+
+      size_t
+      wordsFor(size_t bits)
+      {
+        return (bits + 63) / 64;
+      }
+    }
+
+
+    BitMatrix::BitMatrix(size_t rows, size_t cols)
+      : m_rows(rows)
+      , m_cols(cols)
+      , m_words(wordsFor(cols))
+      , m_bits(rows * wordsFor(cols), Word(0))
+    {}
+
+
+    BitMatrix::BitMatrix(BoolMatrix::BackingMatrix const & mat)
+      : m_rows(mat.size1())
+      , m_cols(mat.size2())
+      , m_words(wordsFor(mat.size2()))
+      , m_bits(mat.size1() * wordsFor(mat.size2()), Word(0))
+    {
+      for (size_t row=0; row<m_rows; ++row) {
+        for (size_t col=0; col<m_cols; ++col) {
+          if (mat(row, col)) {
+            set(row, col);
+          }
+        }
+      }
+    }
+
+
+    size_t
+    BitMatrix::count() const
+    {
+      size_t n = 0;
+      for (size_t w=0; w<m_bits.size(); ++w) {
+        n += popcount(m_bits[w]);
+      }
+      return n;
+    }
+
+
+    BoolMatrix::BackingMatrix
+    BitMatrix::matrix() const
+    {
+      BoolMatrix::BackingMatrix mat(m_rows, m_cols);
+      for (size_t row=0; row<m_rows; ++row) {
+        for (size_t col=0; col<m_cols; ++col) {
+          mat(row, col) = get(row, col);
+        }
+      }
+      return mat;
+    }
+
+
+    BitMatrix*
+    BitMatrix::zero_raw() const
+    {
+      return new BitMatrix(m_rows, m_cols);
+    }
+
+
+    BitMatrix*
+    BitMatrix::one_raw() const
+    {
+      BitMatrix * id = new BitMatrix(m_rows, m_cols);
+      for (size_t i=0; i<std::min(m_rows, m_cols); ++i) {
+        id->set(i, i);
+      }
+      return id;
+    }
+
+
+    BitMatrix*
+    BitMatrix::extend_raw(BitMatrix * that) const
+    {
+      fast_assert(this->cols() == that->rows());
+
+      BitMatrix * result = new BitMatrix(this->rows(), that->cols());
+      if (result->m_words == 0 || m_words == 0) {
+        return result;
+      }
+
+      // ORing rows costs a row of 'that' per true entry of this
+      // matrix. The Four Russians method costs, per group of eight
+      // columns, building a 256-row table plus one row per row of this
+      // matrix; it wins once the matrices are big and not too sparse.
+      size_t groups = (m_cols + 7) / 8;
+      double byRows = double(count());
+      double fourRussians = double(groups) * double(256 + m_rows);
+      if (fourRussians < byRows) {
+        extendFourRussians(*that, *result);
+      }
+      else {
+        extendByRows(*that, *result);
+      }
+      return result;
+    }
+
+
+    void
+    BitMatrix::extendByRows(BitMatrix const & that, BitMatrix & result) const
+    {
+      for (size_t row=0; row<m_rows; ++row) {
+        Word const * lhs = rowBegin(row);
+        Word * out = result.rowBegin(row);
+        for (size_t w=0; w<m_words; ++w) {
+          for (Word bits = lhs[w]; bits != 0; bits &= bits - 1) {
+            size_t k = w * 64 + lowestBit(bits);
+            orInto(out, that.rowBegin(k), result.m_words);
+          }
+        }
+      }
+    }
+
+
+    void
+    BitMatrix::extendFourRussians(BitMatrix const & that, BitMatrix & result) const
+    {
+      size_t const words = result.m_words;
+      // table[x] is the OR of the rows of 'that' picked out by the bits
+      // of x; table[0] stays zero
+      std::vector<Word> table(256 * words, Word(0));
+
+      for (size_t first=0; first<m_cols; first+=8) {
+        size_t bits = std::min(size_t(8), m_cols - first);
+        for (size_t j=0; j<bits; ++j) {
+          Word const * src = that.rowBegin(first + j);
+          size_t half = size_t(1) << j;
+          for (size_t x=half; x<2*half; ++x) {
+            Word * dest = &table[x * words];
+            Word const * prev = &table[(x - half) * words];
+            for (size_t w=0; w<words; ++w) {
+              dest[w] = prev[w] | src[w];
+            }
+          }
+        }
+
+        // Entries past the last column are zero, so the table rows
+        // that were not rebuilt for a short last group are never read
+        size_t word = first / 64;
+        size_t shift = first % 64;
+        for (size_t row=0; row<m_rows; ++row) {
+          size_t x = size_t((rowBegin(row)[word] >> shift) & 0xff);
+          if (x != 0) {
+            orInto(result.rowBegin(row), &table[x * words], words);
+          }
+        }
+      }
+    }
+
+
+    BitMatrix*
+    BitMatrix::combine_raw(BitMatrix * that) const
+    {
+      fast_assert(this->rows() == that->rows());
+      fast_assert(this->cols() == that->cols());
+
+      BitMatrix * result = new BitMatrix(*this);
+      for (size_t w=0; w<m_bits.size(); ++w) {
+        result->m_bits[w] |= that->m_bits[w];
+      }
+      return result;
+    }
+
+
+    BitMatrix*
+    BitMatrix::star_raw() const
+    {
+      fast_assert(m_rows == m_cols);
+
+      // Warshall: after step k, row i has every j reachable from i
+      // through intermediate nodes below k, so if i reaches k it also
+      // reaches all of row k
+      BitMatrix * result = new BitMatrix(*this);
+      for (size_t i=0; i<m_rows; ++i) {
+        result->set(i, i);
+      }
+      for (size_t k=0; k<m_rows; ++k) {
+        Word const * through = result->rowBegin(k);
+        for (size_t i=0; i<m_rows; ++i) {
+          if (i != k && result->get(i, k)) {
+            orInto(result->rowBegin(i), through, m_words);
+          }
+        }
+      }
+      return result;
+    }
+
+
+    bool
+    BitMatrix::equal(BitMatrix * that) const
+    {
+      fast_assert(this->rows() == that->rows());
+      fast_assert(this->cols() == that->cols());
+
+      if (this->rows() != that->rows() || this->cols() != that->cols()) {
+        return false;
+      }
+
+      return m_bits.empty()
+        || std::memcmp(&m_bits[0], &that->m_bits[0], m_bits.size() * sizeof(Word)) == 0;
+    }
+
+
+    std::ostream &
+    BitMatrix::print(std::ostream & stream) const
+    {
+      stream << "BitMatrix: [" << m_rows << "," << m_cols << "](";
+      for (size_t row=0; row<m_rows; ++row) {
+        stream << (row == 0 ? "(" : ",(");
+        for (size_t col=0; col<m_cols; ++col) {
+          stream << (col == 0 ? "" : ",") << get(row, col);
+        }
+        stream << ")";
+      }
+      stream << ")";
+      return stream;
+    }
+
+
+    sem_elem_t
+    BitMatrix::one() const
+    {
+      return one_raw();
+    }
+
+
+    sem_elem_t
+    BitMatrix::zero() const
+    {
+      return zero_raw();
+    }
+
+
+    sem_elem_t
+    BitMatrix::extend(SemElem * se)
+    {
+      return extend_raw(down(se));
+    }
+
+
+    sem_elem_t
+    BitMatrix::combine(SemElem * se)
+    {
+      return combine_raw(down(se));
+    }
+
+
+    sem_elem_t
+    BitMatrix::star()
+    {
+      return star_raw();
+    }
+
+
+    bool
+    BitMatrix::equal(SemElem * se) const
+    {
+      return equal(down(se));
+    }
+
+
+    BitMatrix*
+    BitMatrix::down(SemElem* se) const
+    {
+      BitMatrix* bm = dynamic_cast<BitMatrix*>(se);
+      fast_assert(bm != NULL);
+      return bm;
+    }
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
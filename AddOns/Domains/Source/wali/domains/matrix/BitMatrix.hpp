@@ -0,0 +1,118 @@
+#ifndef WALI_DOMAINS_MATRIX_BIT_MATRIX_HPP
+#define WALI_DOMAINS_MATRIX_BIT_MATRIX_HPP
+
+#include <vector>
+#include <iosfwd>
+
+#include <boost/cstdint.hpp>
+
+#include "wali/SemElem.hpp"
+#include "wali/domains/matrix/Matrix.hpp"
+
+namespace wali {
+  namespace domains {
+
+    /**
+     * A boolean matrix weight, like BoolMatrix, stored one bit per
+     * entry: each row is a run of 64-bit words, and the bits past the
+     * last column are always zero.
+     *
+     * Combine is a word-wise OR. Extend ORs whole rows of the right
+     * matrix together; for larger, denser matrices it uses the "Four
+     * Russians" method, tabulating the OR of every subset of each group
+     * of eight rows so that eight entries of the left matrix are handled
+     * by one table lookup. Star is the reflexive-transitive closure,
+     * computed by Warshall's algorithm a row at a time. Equality is a
+     * memcmp.
+     */
+    class BitMatrix
+      : public SemElem
+    {
+    public:
+      typedef boost::uint64_t Word;
+
+      /// A rows x cols matrix of zeros
+      BitMatrix(size_t rows, size_t cols);
+
+      explicit BitMatrix(BoolMatrix::BackingMatrix const & mat);
+
+      size_t rows() const { return m_rows; }
+      size_t cols() const { return m_cols; }
+
+      bool
+      get(size_t row, size_t col) const
+      {
+        return (rowBegin(row)[col / 64] >> (col % 64)) & 1;
+      }
+
+      void
+      set(size_t row, size_t col, bool value = true)
+      {
+        Word bit = Word(1) << (col % 64);
+        Word & word = rowBegin(row)[col / 64];
+        word = value ? (word | bit) : (word & ~bit);
+      }
+
+      /// The number of true entries
+      size_t
+      count() const;
+
+      /// The same matrix, unpacked
+      BoolMatrix::BackingMatrix
+      matrix() const;
+
+      BitMatrix *
+      zero_raw() const;
+
+      BitMatrix *
+      one_raw() const;
+
+      BitMatrix *
+      extend_raw(BitMatrix * rhs) const;
+
+      BitMatrix *
+      combine_raw(BitMatrix * rhs) const;
+
+      BitMatrix *
+      star_raw() const;
+
+      bool
+      equal(BitMatrix * rhs) const;
+
+      std::ostream &
+      print(std::ostream & stream) const;
+
+
+      // Here are the "normal" SemElem functions that wrap those above
+      virtual sem_elem_t one() const;
+      virtual sem_elem_t zero() const;
+      virtual sem_elem_t extend(SemElem * se);
+      virtual sem_elem_t combine(SemElem * se);
+      virtual sem_elem_t star();
+      virtual bool equal(SemElem * se) const;
+
+    private:
+      BitMatrix* down(SemElem* se) const;
+
+      Word * rowBegin(size_t row) { return &m_bits[row * m_words]; }
+      Word const * rowBegin(size_t row) const { return &m_bits[row * m_words]; }
+
+      void extendByRows(BitMatrix const & rhs, BitMatrix & result) const;
+      void extendFourRussians(BitMatrix const & rhs, BitMatrix & result) const;
+
+      size_t m_rows;
+      size_t m_cols;
+      size_t m_words;             // per row
+      std::vector<Word> m_bits;   // row-major
+    };
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif
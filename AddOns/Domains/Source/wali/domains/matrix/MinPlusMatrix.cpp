@@ -0,0 +1,266 @@
+#include "wali/domains/matrix/MinPlusMatrix.hpp"
+
+#include <wali/Common.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+namespace wali {
+  namespace domains {
+
+    namespace
+    {
+      typedef MinPlusMatrix::value_type value_type;
+
+      // Column and row block sizes for extend: a block of the right
+      // matrix is 128 x 512 ints (256 KB), which stays in L2 while every
+      // row of the left matrix passes over it
+      size_t const columnBlock = 512;
+      size_t const rowBlock = 128;
+
+      /// out[j] = min(out[j], distance + in[j]) for j < n, where a sum
+      /// that would reach infinity is infinity. 'distance' must be
+      /// finite, and 'out' and 'in' must not overlap.
+      ///
+      /// This is the inner loop of extend and star. It is branch-free,
+      /// and done eight at a time, so that the compiler vectorizes it
+      /// (SSE2 or whatever the target has) even at -O2.
+      void
+      relaxRow(value_type * WALI_RESTRICT out,
+               value_type distance,
+               value_type const * WALI_RESTRICT in,
+               size_t n)
+      {
+        value_type const inf = MinPlusMatrix::infinity();
+        value_type const limit = distance > 0 ? inf - distance : inf;
+        size_t j = 0;
+        for (; j + 8 <= n; j += 8) {
+          for (size_t u = 0; u < 8; ++u) {
+            value_type sum = in[j + u] >= limit ? inf : distance + in[j + u];
+            out[j + u] = sum < out[j + u] ? sum : out[j + u];
+          }
+        }
+        for (; j < n; ++j) {
+          value_type sum = in[j] >= limit ? inf : distance + in[j];
+          out[j] = sum < out[j] ? sum : out[j];
+        }
+      }
+    }
+
+
+    MinPlusMatrix::MinPlusMatrix(size_t rows, size_t cols)
+      : m_rows(rows)
+      , m_cols(cols)
+      , m_values(rows * cols, infinity())
+    {}
+
+
+    MinPlusMatrix::MinPlusMatrix(MinPlusIntMatrix::BackingMatrix const & mat)
+      : m_rows(mat.size1())
+      , m_cols(mat.size2())
+      , m_values(mat.size1() * mat.size2())
+    {
+      for (size_t row=0; row<m_rows; ++row) {
+        for (size_t col=0; col<m_cols; ++col) {
+          set(row, col, mat(row, col).get_value());
+        }
+      }
+    }
+
+
+    MinPlusIntMatrix::BackingMatrix
+    MinPlusMatrix::matrix() const
+    {
+      typedef MinPlusIntMatrix::value_type MinPlusInt;
+      MinPlusIntMatrix::BackingMatrix mat(m_rows, m_cols);
+      for (size_t row=0; row<m_rows; ++row) {
+        for (size_t col=0; col<m_cols; ++col) {
+          mat(row, col) = MinPlusInt::make(get(row, col));
+        }
+      }
+      return mat;
+    }
+
+
+    MinPlusMatrix*
+    MinPlusMatrix::zero_raw() const
+    {
+      return new MinPlusMatrix(m_rows, m_cols);
+    }
+
+
+    MinPlusMatrix*
+    MinPlusMatrix::one_raw() const
+    {
+      MinPlusMatrix * id = new MinPlusMatrix(m_rows, m_cols);
+      for (size_t i=0; i<std::min(m_rows, m_cols); ++i) {
+        id->set(i, i, 0);
+      }
+      return id;
+    }
+
+
+    MinPlusMatrix*
+    MinPlusMatrix::extend_raw(MinPlusMatrix * that) const
+    {
+      fast_assert(this->cols() == that->rows());
+
+      MinPlusMatrix * result = new MinPlusMatrix(this->rows(), that->cols());
+      size_t const inner = m_cols;
+      size_t const width = that->cols();
+
+      for (size_t firstCol=0; firstCol<width; firstCol+=columnBlock) {
+        size_t cols = std::min(columnBlock, width - firstCol);
+        for (size_t firstK=0; firstK<inner; firstK+=rowBlock) {
+          size_t lastK = std::min(firstK + rowBlock, inner);
+          for (size_t row=0; row<m_rows; ++row) {
+            value_type const * lhs = rowBegin(row);
+            value_type * out = result->rowBegin(row) + firstCol;
+            for (size_t k=firstK; k<lastK; ++k) {
+              if (lhs[k] != infinity()) {
+                relaxRow(out, lhs[k], that->rowBegin(k) + firstCol, cols);
+              }
+            }
+          }
+        }
+      }
+      return result;
+    }
+
+
+    MinPlusMatrix*
+    MinPlusMatrix::combine_raw(MinPlusMatrix * that) const
+    {
+      fast_assert(this->rows() == that->rows());
+      fast_assert(this->cols() == that->cols());
+
+      MinPlusMatrix * result = new MinPlusMatrix(*this);
+      for (size_t i=0; i<m_values.size(); ++i) {
+        result->m_values[i] = std::min(result->m_values[i], that->m_values[i]);
+      }
+      return result;
+    }
+
+
+    MinPlusMatrix*
+    MinPlusMatrix::star_raw() const
+    {
+      fast_assert(m_rows == m_cols);
+
+      // Floyd-Warshall: after step k, (i, j) is the shortest path from
+      // i to j through intermediate nodes below k. Row k itself does
+      // not change in step k as long as (k, k) is not negative.
+      MinPlusMatrix * result = new MinPlusMatrix(*this);
+      for (size_t i=0; i<m_rows; ++i) {
+        result->set(i, i, std::min(result->get(i, i), 0));
+      }
+      for (size_t k=0; k<m_rows; ++k) {
+        value_type const * through = result->rowBegin(k);
+        for (size_t i=0; i<m_rows; ++i) {
+          value_type toK = result->get(i, k);
+          if (i != k && toK != infinity()) {
+            relaxRow(result->rowBegin(i), toK, through, m_cols);
+          }
+        }
+      }
+      return result;
+    }
+
+
+    bool
+    MinPlusMatrix::equal(MinPlusMatrix * that) const
+    {
+      fast_assert(this->rows() == that->rows());
+      fast_assert(this->cols() == that->cols());
+
+      if (this->rows() != that->rows() || this->cols() != that->cols()) {
+        return false;
+      }
+
+      return m_values.empty()
+        || std::memcmp(&m_values[0], &that->m_values[0],
+                       m_values.size() * sizeof(value_type)) == 0;
+    }
+
+
+    std::ostream &
+    MinPlusMatrix::print(std::ostream & stream) const
+    {
+      stream << "MinPlusMatrix: [" << m_rows << "," << m_cols << "](";
+      for (size_t row=0; row<m_rows; ++row) {
+        stream << (row == 0 ? "(" : ",(");
+        for (size_t col=0; col<m_cols; ++col) {
+          stream << (col == 0 ? "" : ",");
+          if (get(row, col) == infinity()) {
+            stream << "[infinity]";
+          }
+          else {
+            stream << "[" << get(row, col) << "]";
+          }
+        }
+        stream << ")";
+      }
+      stream << ")";
+      return stream;
+    }
+
+
+    sem_elem_t
+    MinPlusMatrix::one() const
+    {
+      return one_raw();
+    }
+
+
+    sem_elem_t
+    MinPlusMatrix::zero() const
+    {
+      return zero_raw();
+    }
+
+
+    sem_elem_t
+    MinPlusMatrix::extend(SemElem * se)
+    {
+      return extend_raw(down(se));
+    }
+
+
+    sem_elem_t
+    MinPlusMatrix::combine(SemElem * se)
+    {
+      return combine_raw(down(se));
+    }
+
+
+    sem_elem_t
+    MinPlusMatrix::star()
+    {
+      return star_raw();
+    }
+
+
+    bool
+    MinPlusMatrix::equal(SemElem * se) const
+    {
+      return equal(down(se));
+    }
+
+
+    MinPlusMatrix*
+    MinPlusMatrix::down(SemElem* se) const
+    {
+      MinPlusMatrix* mm = dynamic_cast<MinPlusMatrix*>(se);
+      fast_assert(mm != NULL);
+      return mm;
+    }
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
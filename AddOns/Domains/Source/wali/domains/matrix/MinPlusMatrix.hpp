@@ -0,0 +1,114 @@
+#ifndef WALI_DOMAINS_MATRIX_MIN_PLUS_MATRIX_HPP
+#define WALI_DOMAINS_MATRIX_MIN_PLUS_MATRIX_HPP
+
+#include <vector>
+#include <iosfwd>
+#include <limits>
+
+#include "wali/SemElem.hpp"
+#include "wali/domains/matrix/Matrix.hpp"
+
+namespace wali {
+  namespace domains {
+
+    /**
+     * A min-plus (tropical) matrix weight over int, like
+     * MinPlusIntMatrix, stored as a flat row-major array of distances
+     * with infinity() (INT_MAX) for "no path".
+     *
+     * Extend is the min-plus product, computed a row of the right
+     * matrix at a time over blocks that stay in cache, with plain loops
+     * that the compiler can vectorize. Sums saturate: anything that
+     * would reach infinity() is infinity(). Combine is the entry-wise
+     * minimum. Star is the all-pairs shortest paths closure (Floyd-
+     * Warshall), which assumes there is no negative cycle.
+     */
+    class MinPlusMatrix
+      : public SemElem
+    {
+    public:
+      typedef int value_type;
+
+      static value_type
+      infinity()
+      {
+#define INHIBIT_MACRO_EXPANSION
+        return std::numeric_limits<value_type>::max INHIBIT_MACRO_EXPANSION ();
+#undef INHIBIT_MACRO_EXPANSION
+      }
+
+      /// A rows x cols matrix with every entry infinite (the semiring zero)
+      MinPlusMatrix(size_t rows, size_t cols);
+
+      explicit MinPlusMatrix(MinPlusIntMatrix::BackingMatrix const & mat);
+
+      size_t rows() const { return m_rows; }
+      size_t cols() const { return m_cols; }
+
+      value_type
+      get(size_t row, size_t col) const
+      {
+        return m_values[row * m_cols + col];
+      }
+
+      void
+      set(size_t row, size_t col, value_type distance)
+      {
+        m_values[row * m_cols + col] = distance;
+      }
+
+      /// The same matrix, as a MinPlusIntMatrix::BackingMatrix
+      MinPlusIntMatrix::BackingMatrix
+      matrix() const;
+
+      MinPlusMatrix *
+      zero_raw() const;
+
+      MinPlusMatrix *
+      one_raw() const;
+
+      MinPlusMatrix *
+      extend_raw(MinPlusMatrix * rhs) const;
+
+      MinPlusMatrix *
+      combine_raw(MinPlusMatrix * rhs) const;
+
+      MinPlusMatrix *
+      star_raw() const;
+
+      bool
+      equal(MinPlusMatrix * rhs) const;
+
+      std::ostream &
+      print(std::ostream & stream) const;
+
+
+      // Here are the "normal" SemElem functions that wrap those above
+      virtual sem_elem_t one() const;
+      virtual sem_elem_t zero() const;
+      virtual sem_elem_t extend(SemElem * se);
+      virtual sem_elem_t combine(SemElem * se);
+      virtual sem_elem_t star();
+      virtual bool equal(SemElem * se) const;
+
+    private:
+      MinPlusMatrix* down(SemElem* se) const;
+
+      value_type * rowBegin(size_t row) { return &m_values[row * m_cols]; }
+      value_type const * rowBegin(size_t row) const { return &m_values[row * m_cols]; }
+
+      size_t m_rows;
+      size_t m_cols;
+      std::vector<value_type> m_values;   // row-major
+    };
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif
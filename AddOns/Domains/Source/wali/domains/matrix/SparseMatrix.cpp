@@ -0,0 +1,21 @@
+#include "wali/domains/matrix/SparseMatrix_template.hpp"
+#include "wali/domains/matrix/SparseMatrix_template.hxx"
+
+#include "wali/domains/matrix/MinPlus.hpp"
+#include "wali/domains/matrix/SemElemWrapper.hpp"
+
+namespace wali {
+  namespace domains {
+
+    template class SparseMatrix<bool>;
+    template class SparseMatrix<details::MinPlus<int> >;
+    template class SparseMatrix<details::SemElemWrapper>;
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
@@ -0,0 +1,23 @@
+#ifndef WALI_DOMAINS_MATRIX_SPARSE_MATRIX_HPP
+#define WALI_DOMAINS_MATRIX_SPARSE_MATRIX_HPP
+
+#include "wali/domains/matrix/Matrix.hpp"
+#include "wali/domains/matrix/SparseMatrix_template.hpp"
+
+namespace wali {
+  namespace domains {
+
+    typedef SparseMatrix<bool> SparseBoolMatrix;
+    typedef SparseMatrix<details::MinPlus<int> > SparseMinPlusIntMatrix;
+    typedef SparseMatrix<details::SemElemWrapper> SparseSemElemMatrix;
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif /* WALI_DOMAINS_MATRIX_SPARSE_MATRIX_HPP */
@@ -0,0 +1,136 @@
+#ifndef WALI_DOMAINS_MATRIX_SPARSE_MATRIX_TEMPLATE_HPP
+#define WALI_DOMAINS_MATRIX_SPARSE_MATRIX_TEMPLATE_HPP
+
+#include <vector>
+#include <iosfwd>
+
+#include <boost/container/vector.hpp>
+
+#include <wali/SemElem.hpp>
+#include <wali/domains/matrix/Matrix_template.hpp>
+
+namespace wali {
+  namespace domains {
+
+    /**
+     * A matrix weight like Matrix<ElementType>, over the same element
+     * types (value_type() is the semiring zero, value_type(1) the one,
+     * + and * combine and extend), for matrices that are mostly zero.
+     *
+     * A matrix is kept in compressed sparse row (CSR) form, or as a
+     * dense BackingMatrix once more than denseThreshold of its entries
+     * are nonzero; every result picks its form by its own density.
+     * Extend of two dense matrices is ublas's prod; anything else is a
+     * sparse product, row by row, that only touches nonzero entries.
+     * Combine merges rows. Star squares (1 + this) until it stops
+     * changing, which terminates where the element semiring has no
+     * infinite ascending chains.
+     */
+    template<typename ElementType>
+    class SparseMatrix
+      : public SemElem
+    {
+    public:
+      typedef ElementType value_type;
+      typedef typename Matrix<ElementType>::BackingMatrix BackingMatrix;
+
+      /// Results with a larger fraction of nonzero entries than this are
+      /// stored densely. Default 0.1.
+      static double denseThreshold;
+
+      /// A rows x cols matrix of zeros
+      SparseMatrix(size_t rows, size_t cols);
+
+      SparseMatrix(BackingMatrix const & mat);
+
+      size_t rows() const { return m_rows; }
+      size_t cols() const { return m_cols; }
+
+      /// The number of entries that are not zero
+      size_t nonZeros() const { return m_nonZeros; }
+
+      bool isDense() const { return m_isDense; }
+
+      /// Bytes held by this matrix (not counting what the elements
+      /// themselves point to)
+      size_t memoryUsage() const;
+
+      value_type
+      get(size_t row, size_t col) const;
+
+      /// The same matrix, dense
+      BackingMatrix
+      matrix() const;
+
+      SparseMatrix *
+      zero_raw() const;
+
+      SparseMatrix *
+      one_raw() const;
+
+      SparseMatrix *
+      extend_raw(SparseMatrix * rhs) const;
+
+      SparseMatrix *
+      combine_raw(SparseMatrix * rhs) const;
+
+      SparseMatrix *
+      star_raw() const;
+
+      bool
+      equal(SparseMatrix * rhs) const;
+
+      std::ostream &
+      print(std::ostream & stream) const;
+
+
+      // Here are the "normal" SemElem functions that wrap those above
+      virtual sem_elem_t one() const;
+      virtual sem_elem_t zero() const;
+      virtual sem_elem_t extend(SemElem * se);
+      virtual sem_elem_t combine(SemElem * se);
+      virtual sem_elem_t star();
+      virtual bool equal(SemElem * se) const;
+
+    private:
+      typedef unsigned Index;
+
+      /// Row i's entries are columns[rowStart[i]] .. columns[rowStart[i+1]-1],
+      /// in increasing order, with their values alongside
+      struct Csr
+      {
+        std::vector<size_t> rowStart;
+        std::vector<Index> columns;
+        boost::container::vector<value_type> values;
+      };
+
+      SparseMatrix* down(SemElem* se) const;
+
+      /// Switches to whichever form suits this matrix's density
+      void settle();
+
+      static void toCsr(BackingMatrix const & dense, Csr & csr);
+      static void toDense(Csr const & csr, size_t cols, BackingMatrix & dense);
+      static bool denseEqual(BackingMatrix const & left, BackingMatrix const & right);
+
+      /// This matrix in CSR form: m_csr, or 'scratch' filled from m_dense
+      Csr const & csr(Csr & scratch) const;
+
+      size_t m_rows;
+      size_t m_cols;
+      size_t m_nonZeros;
+      bool m_isDense;
+      Csr m_csr;                // when !m_isDense
+      BackingMatrix m_dense;    // when m_isDense
+    };
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif
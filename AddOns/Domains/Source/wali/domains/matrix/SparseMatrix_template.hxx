@@ -0,0 +1,466 @@
+#ifndef SPARSE_MATRIX_TEMPLATE_HXX
+#define SPARSE_MATRIX_TEMPLATE_HXX
+
+#include <wali/Common.hpp>
+#include <boost/numeric/ublas/io.hpp>
+#include <algorithm>
+#include <ostream>
+
+namespace wali {
+  namespace domains {
+
+    namespace details {
+      template<typename ElementType>
+      ElementType
+      times(ElementType const & left, ElementType const & right)
+      {
+        return left * right;
+      }
+
+      // bool's * is an int, and GCC warns about it
+      inline bool
+      times(bool left, bool right)
+      {
+        return left && right;
+      }
+    }
+
+
+    template<typename ElementType>
+    double SparseMatrix<ElementType>::denseThreshold = 0.1;
+
+
+    template<typename ElementType>
+    SparseMatrix<ElementType>::SparseMatrix(size_t rows, size_t cols)
+      : m_rows(rows)
+      , m_cols(cols)
+      , m_nonZeros(0)
+      , m_isDense(false)
+    {
+      m_csr.rowStart.assign(rows + 1, 0);
+    }
+
+
+    template<typename ElementType>
+    SparseMatrix<ElementType>::SparseMatrix(BackingMatrix const & m)
+      : m_rows(m.size1())
+      , m_cols(m.size2())
+      , m_nonZeros(0)
+      , m_isDense(true)
+      , m_dense(m)
+    {
+      settle();
+    }
+
+
+    template<typename ElementType>
+    void
+    SparseMatrix<ElementType>::settle()
+    {
+      if (m_isDense) {
+        value_type const zero = value_type();
+        m_nonZeros = 0;
+        for (size_t row=0; row<m_rows; ++row) {
+          for (size_t col=0; col<m_cols; ++col) {
+            if (!(m_dense(row, col) == zero)) {
+              ++m_nonZeros;
+            }
+          }
+        }
+      }
+      else {
+        m_nonZeros = m_csr.columns.size();
+      }
+
+      bool dense = double(m_nonZeros) > denseThreshold * double(m_rows) * double(m_cols);
+      if (dense && !m_isDense) {
+        toDense(m_csr, m_cols, m_dense);
+        Csr none;
+        m_csr = none;
+        m_isDense = true;
+      }
+      else if (!dense && m_isDense) {
+        toCsr(m_dense, m_csr);
+        m_dense = BackingMatrix();
+        m_isDense = false;
+      }
+    }
+
+
+    template<typename ElementType>
+    void
+    SparseMatrix<ElementType>::toCsr(BackingMatrix const & dense, Csr & csr)
+    {
+      value_type const zero = value_type();
+      csr.rowStart.clear();
+      csr.columns.clear();
+      csr.values.clear();
+      csr.rowStart.push_back(0);
+      for (size_t row=0; row<dense.size1(); ++row) {
+        for (size_t col=0; col<dense.size2(); ++col) {
+          if (!(dense(row, col) == zero)) {
+            csr.columns.push_back(Index(col));
+            csr.values.push_back(dense(row, col));
+          }
+        }
+        csr.rowStart.push_back(csr.columns.size());
+      }
+    }
+
+
+    template<typename ElementType>
+    void
+    SparseMatrix<ElementType>::toDense(Csr const & csr, size_t cols, BackingMatrix & dense)
+    {
+      size_t rows = csr.rowStart.size() - 1;
+      dense = boost::numeric::ublas::zero_matrix<value_type>(rows, cols);
+      for (size_t row=0; row<rows; ++row) {
+        for (size_t p=csr.rowStart[row]; p<csr.rowStart[row+1]; ++p) {
+          dense(row, csr.columns[p]) = csr.values[p];
+        }
+      }
+    }
+
+
+    template<typename ElementType>
+    typename SparseMatrix<ElementType>::Csr const &
+    SparseMatrix<ElementType>::csr(Csr & scratch) const
+    {
+      if (!m_isDense) {
+        return m_csr;
+      }
+      toCsr(m_dense, scratch);
+      return scratch;
+    }
+
+
+    template<typename ElementType>
+    size_t
+    SparseMatrix<ElementType>::memoryUsage() const
+    {
+      size_t bytes = sizeof(*this);
+      if (m_isDense) {
+        bytes += m_dense.data().capacity() * sizeof(value_type);
+      }
+      else {
+        bytes += m_csr.rowStart.capacity() * sizeof(size_t)
+          + m_csr.columns.capacity() * sizeof(Index)
+          + m_csr.values.capacity() * sizeof(value_type);
+      }
+      return bytes;
+    }
+
+
+    template<typename ElementType>
+    typename SparseMatrix<ElementType>::value_type
+    SparseMatrix<ElementType>::get(size_t row, size_t col) const
+    {
+      if (m_isDense) {
+        return m_dense(row, col);
+      }
+      std::vector<Index>::const_iterator
+        first = m_csr.columns.begin() + m_csr.rowStart[row],
+        last = m_csr.columns.begin() + m_csr.rowStart[row+1],
+        found = std::lower_bound(first, last, Index(col));
+      if (found == last || *found != col) {
+        return value_type();
+      }
+      return m_csr.values[found - m_csr.columns.begin()];
+    }
+
+
+    template<typename ElementType>
+    typename SparseMatrix<ElementType>::BackingMatrix
+    SparseMatrix<ElementType>::matrix() const
+    {
+      if (m_isDense) {
+        return m_dense;
+      }
+      BackingMatrix dense;
+      toDense(m_csr, m_cols, dense);
+      return dense;
+    }
+
+
+    template<typename ElementType>
+    SparseMatrix<ElementType>*
+    SparseMatrix<ElementType>::zero_raw() const
+    {
+      return new SparseMatrix(m_rows, m_cols);
+    }
+
+
+    template<typename ElementType>
+    SparseMatrix<ElementType>*
+    SparseMatrix<ElementType>::one_raw() const
+    {
+      SparseMatrix * id = new SparseMatrix(m_rows, m_cols);
+      Csr & c = id->m_csr;
+      for (size_t row=0; row<m_rows; ++row) {
+        if (row < m_cols) {
+          c.columns.push_back(Index(row));
+          c.values.push_back(value_type(1));
+        }
+        c.rowStart[row+1] = c.columns.size();
+      }
+      id->settle();
+      return id;
+    }
+
+
+    template<typename ElementType>
+    SparseMatrix<ElementType>*
+    SparseMatrix<ElementType>::extend_raw(SparseMatrix * that) const
+    {
+      fast_assert(this->cols() == that->rows());
+
+      if (this->m_isDense && that->m_isDense) {
+        return new SparseMatrix(BackingMatrix(boost::numeric::ublas::prod(m_dense, that->m_dense)));
+      }
+
+      // Row by row: row i of the result is the sum over the nonzero
+      // (i, k) here of (i, k) times row k of 'that', gathered in a dense
+      // accumulator and then written out in column order
+      Csr scratchLeft, scratchRight;
+      Csr const & a = this->csr(scratchLeft);
+      Csr const & b = that->csr(scratchRight);
+
+      SparseMatrix * result = new SparseMatrix(m_rows, that->m_cols);
+      Csr & c = result->m_csr;
+
+      value_type const zero = value_type();
+      boost::container::vector<value_type> sums(that->m_cols, zero);
+      std::vector<char> seen(that->m_cols, 0);
+      std::vector<Index> touched;
+
+      for (size_t row=0; row<m_rows; ++row) {
+        for (size_t p=a.rowStart[row]; p<a.rowStart[row+1]; ++p) {
+          Index k = a.columns[p];
+          value_type left = a.values[p];
+          for (size_t q=b.rowStart[k]; q<b.rowStart[k+1]; ++q) {
+            Index col = b.columns[q];
+            value_type product = details::times(left, b.values[q]);
+            if (!seen[col]) {
+              seen[col] = 1;
+              touched.push_back(col);
+              sums[col] = product;
+            }
+            else {
+              sums[col] = sums[col] + product;
+            }
+          }
+        }
+
+        std::sort(touched.begin(), touched.end());
+        for (size_t t=0; t<touched.size(); ++t) {
+          Index col = touched[t];
+          if (!(sums[col] == zero)) {
+            c.columns.push_back(col);
+            c.values.push_back(sums[col]);
+          }
+          seen[col] = 0;
+          sums[col] = zero;
+        }
+        touched.clear();
+        c.rowStart[row+1] = c.columns.size();
+      }
+
+      result->settle();
+      return result;
+    }
+
+
+    template<typename ElementType>
+    SparseMatrix<ElementType>*
+    SparseMatrix<ElementType>::combine_raw(SparseMatrix * that) const
+    {
+      fast_assert(this->rows() == that->rows());
+      fast_assert(this->cols() == that->cols());
+
+      if (this->m_isDense || that->m_isDense) {
+        return new SparseMatrix(BackingMatrix(this->matrix() + that->matrix()));
+      }
+
+      Csr const & a = this->m_csr;
+      Csr const & b = that->m_csr;
+
+      SparseMatrix * result = new SparseMatrix(m_rows, m_cols);
+      Csr & c = result->m_csr;
+      value_type const zero = value_type();
+
+      for (size_t row=0; row<m_rows; ++row) {
+        size_t p = a.rowStart[row], pEnd = a.rowStart[row+1];
+        size_t q = b.rowStart[row], qEnd = b.rowStart[row+1];
+        while (p < pEnd || q < qEnd) {
+          if (q == qEnd || (p < pEnd && a.columns[p] < b.columns[q])) {
+            c.columns.push_back(a.columns[p]);
+            c.values.push_back(a.values[p]);
+            ++p;
+          }
+          else if (p == pEnd || b.columns[q] < a.columns[p]) {
+            c.columns.push_back(b.columns[q]);
+            c.values.push_back(b.values[q]);
+            ++q;
+          }
+          else {
+            value_type sum = a.values[p] + b.values[q];
+            if (!(sum == zero)) {
+              c.columns.push_back(a.columns[p]);
+              c.values.push_back(sum);
+            }
+            ++p;
+            ++q;
+          }
+        }
+        c.rowStart[row+1] = c.columns.size();
+      }
+
+      result->settle();
+      return result;
+    }
+
+
+    template<typename ElementType>
+    SparseMatrix<ElementType>*
+    SparseMatrix<ElementType>::star_raw() const
+    {
+      fast_assert(m_rows == m_cols);
+
+      // (1 + A)^(2^n) = 1 + A + ... + A^(2^n), so this needs about
+      // log(longest path) squarings
+      ref_ptr<SparseMatrix> id(one_raw());
+      ref_ptr<SparseMatrix> closure(combine_raw(id.get_ptr()));
+      while (true) {
+        ref_ptr<SparseMatrix> square(closure->extend_raw(closure.get_ptr()));
+        if (square->equal(closure.get_ptr())) {
+          break;
+        }
+        closure = square;
+      }
+      return new SparseMatrix(*closure);
+    }
+
+
+    template<typename ElementType>
+    bool
+    SparseMatrix<ElementType>::denseEqual(BackingMatrix const & left, BackingMatrix const & right)
+    {
+      for (size_t row=0; row<left.size1(); ++row) {
+        for (size_t col=0; col<left.size2(); ++col) {
+          if (!(left(row, col) == right(row, col))) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+
+    template<typename ElementType>
+    bool
+    SparseMatrix<ElementType>::equal(SparseMatrix * that) const
+    {
+      fast_assert(this->rows() == that->rows());
+      fast_assert(this->cols() == that->cols());
+
+      if (this->rows() != that->rows()
+          || this->cols() != that->cols()
+          || this->nonZeros() != that->nonZeros())
+      {
+        return false;
+      }
+
+      if (this->m_isDense || that->m_isDense) {
+        // The two can differ in form if denseThreshold was changed
+        return denseEqual(this->matrix(), that->matrix());
+      }
+
+      Csr const & a = this->m_csr;
+      Csr const & b = that->m_csr;
+      if (a.rowStart != b.rowStart || a.columns != b.columns) {
+        return false;
+      }
+      for (size_t p=0; p<a.values.size(); ++p) {
+        if (!(a.values[p] == b.values[p])) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+
+    template<typename ElementType>
+    std::ostream &
+    SparseMatrix<ElementType>::print(std::ostream & stream) const
+    {
+      stream << "SparseMatrix: " << matrix();
+      return stream;
+    }
+
+
+    template<typename ElementType>
+    sem_elem_t
+    SparseMatrix<ElementType>::one() const
+    {
+      return one_raw();
+    }
+
+
+    template<typename ElementType>
+    sem_elem_t
+    SparseMatrix<ElementType>::zero() const
+    {
+      return zero_raw();
+    }
+
+
+    template<typename ElementType>
+    sem_elem_t
+    SparseMatrix<ElementType>::extend(SemElem * se)
+    {
+      return extend_raw(down(se));
+    }
+
+
+    template<typename ElementType>
+    sem_elem_t
+    SparseMatrix<ElementType>::combine(SemElem * se)
+    {
+      return combine_raw(down(se));
+    }
+
+
+    template<typename ElementType>
+    sem_elem_t
+    SparseMatrix<ElementType>::star()
+    {
+      return star_raw();
+    }
+
+
+    template<typename ElementType>
+    bool
+    SparseMatrix<ElementType>::equal(SemElem * se) const
+    {
+      return equal(down(se));
+    }
+
+    template<typename ElementType>
+    SparseMatrix<ElementType>*
+    SparseMatrix<ElementType>::down(SemElem* se) const
+    {
+      SparseMatrix* sm = dynamic_cast<SparseMatrix*>(se);
+      fast_assert(sm != NULL);
+      return sm;
+    }
+
+  }
+}
+
+#endif /* SPARSE_MATRIX_TEMPLATE_HXX */
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
@@ -45,6 +45,20 @@
 
 #include <stdio.h>
 
+   /* NAK - With BDD_THREAD_LOCAL defined (everywhere bdd.h is included),
+      all of the package's state is thread-local: each thread has its own
+      node table, caches, variables and pairs, and must call bdd_init
+      itself. BDD handles must not be passed between threads. */
+#if defined(BDD_THREAD_LOCAL)
+#if defined(_MSC_VER)
+#define BDD_TLS __declspec(thread)
+#else
+#define BDD_TLS __thread
+#endif
+#else
+#define BDD_TLS
+#endif
+
 /*=== Defined operators for apply calls ================================*/
 
 #define bddop_and       0
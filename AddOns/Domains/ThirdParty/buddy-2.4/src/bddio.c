@@ -48,7 +48,7 @@ static int  bdd_loaddata(FILE *);
 static int  loadhash_get(int);
 static void loadhash_add(int, int);
 
-static bddfilehandler filehandler;
+static BDD_TLS bddfilehandler filehandler;
 
 typedef struct s_LoadHash
 {
@@ -58,10 +58,10 @@ typedef struct s_LoadHash
    int next;
 } LoadHash;
 
-static LoadHash *lh_table;
-static int       lh_freepos;
-static int       lh_nodenum;
-static int      *loadvar2level;
+static BDD_TLS LoadHash *lh_table;
+static BDD_TLS int       lh_freepos;
+static BDD_TLS int       lh_nodenum;
+static BDD_TLS int      *loadvar2level;
 
 /*=== PRINTING ========================================================*/
 
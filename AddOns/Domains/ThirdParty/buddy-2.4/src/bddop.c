@@ -84,39 +84,39 @@ static int oprres[OPERATOR_NUM][4] =
 
 
    /* Variables needed for the operators */
-static int applyop;                 /* Current operator for apply */
-static int appexop;                 /* Current operator for appex */
-static int appexid;                 /* Current cache id for appex */
-static int quantid;                 /* Current cache id for quantifications */
-static int *quantvarset;            /* Current variable set for quant. */
-static int quantvarsetID;           /* Current id used in quantvarset */
-static int quantlast;               /* Current last variable to be quant. */
-static int replaceid;               /* Current cache id for replace */
-static int *replacepair;            /* Current replace pair */
-static int replacelast;             /* Current last var. level to replace */
-static int composelevel;            /* Current variable used for compose */
-static int miscid;                  /* Current cache id for other results */
-static int *varprofile;             /* Current variable profile */
-static int supportID;               /* Current ID (true value) for support */
-static int supportMin;              /* Min. used level in support calc. */
-static int supportMax;              /* Max. used level in support calc. */
-static int* supportSet;             /* The found support set */
-static BddCache applycache;         /* Cache for apply results */
-static BddCache itecache;           /* Cache for ITE results */
-static BddCache quantcache;         /* Cache for exist/forall results */
-static BddCache appexcache;         /* Cache for appex/appall results */
-static BddCache replacecache;       /* Cache for replace results */
-static BddCache misccache;          /* Cache for other results */
-static int cacheratio;
-static BDD satPolarity;
-static int firstReorder;            /* Used instead of local variable in order
+static BDD_TLS int applyop;                 /* Current operator for apply */
+static BDD_TLS int appexop;                 /* Current operator for appex */
+static BDD_TLS int appexid;                 /* Current cache id for appex */
+static BDD_TLS int quantid;                 /* Current cache id for quantifications */
+static BDD_TLS int *quantvarset;            /* Current variable set for quant. */
+static BDD_TLS int quantvarsetID;           /* Current id used in quantvarset */
+static BDD_TLS int quantlast;               /* Current last variable to be quant. */
+static BDD_TLS int replaceid;               /* Current cache id for replace */
+static BDD_TLS int *replacepair;            /* Current replace pair */
+static BDD_TLS int replacelast;             /* Current last var. level to replace */
+static BDD_TLS int composelevel;            /* Current variable used for compose */
+static BDD_TLS int miscid;                  /* Current cache id for other results */
+static BDD_TLS int *varprofile;             /* Current variable profile */
+static BDD_TLS int supportID;               /* Current ID (true value) for support */
+static BDD_TLS int supportMin;              /* Min. used level in support calc. */
+static BDD_TLS int supportMax;              /* Max. used level in support calc. */
+static BDD_TLS int* supportSet;             /* The found support set */
+static BDD_TLS BddCache applycache;         /* Cache for apply results */
+static BDD_TLS BddCache itecache;           /* Cache for ITE results */
+static BDD_TLS BddCache quantcache;         /* Cache for exist/forall results */
+static BDD_TLS BddCache appexcache;         /* Cache for appex/appall results */
+static BDD_TLS BddCache replacecache;       /* Cache for replace results */
+static BDD_TLS BddCache misccache;          /* Cache for other results */
+static BDD_TLS int cacheratio;
+static BDD_TLS BDD satPolarity;
+static BDD_TLS int firstReorder;            /* Used instead of local variable in order
 				       to avoid compiler warning about 'first'
 				       being clobbered by setjmp */
 
-static char*            allsatProfile; /* Variable profile for bdd_allsat() */
-static bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
+static BDD_TLS char*            allsatProfile; /* Variable profile for bdd_allsat() */
+static BDD_TLS bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
 
-extern bddCacheStat bddcachestats;
+extern BDD_TLS bddCacheStat bddcachestats;
 
    /* Internal prototypes */
 static BDD    not_rec(BDD);
@@ -2056,7 +2056,7 @@ RETURN  {* A BDD variable set. *}
 */
 BDD bdd_support(BDD r)
 {
-   static int  supportSize = 0;
+   static BDD_TLS int  supportSize = 0;
    int n;
    int res=1;
 
@@ -81,41 +81,41 @@ const BDD bddfalse=0;                    /* The constant false bdd */
 
 /* Min. number of nodes (%) that has to be left after a garbage collect
    unless a resize should be done. */
-static int minfreenodes=20;
+static BDD_TLS int minfreenodes=20;
 
 
 /*=== GLOBAL KERNEL VARIABLES ==========================================*/
 
-int          bddrunning;            /* Flag - package initialized */
-int          bdderrorcond;          /* Some error condition */
-int          bddnodesize;           /* Number of allocated nodes */
-int          bddmaxnodesize;        /* Maximum allowed number of nodes */
-int          bddmaxnodeincrease;    /* Max. # of nodes used to inc. table */
-BddNode*     bddnodes;          /* All of the bdd nodes */
-int          bddfreepos;        /* First free node */
-int          bddfreenum;        /* Number of free nodes */
-long int     bddproduced;       /* Number of new nodes ever produced */
-int          bddvarnum;         /* Number of defined BDD variables */
-int*         bddrefstack;       /* Internal node reference stack */
-int*         bddrefstacktop;    /* Internal node reference stack top */
-int*         bddvar2level;      /* Variable -> level table */
-int*         bddlevel2var;      /* Level -> variable table */
-jmp_buf      bddexception;      /* Long-jump point for interrupting calc. */
-int          bddresized;        /* Flag indicating a resize of the nodetable */
-
-bddCacheStat bddcachestats;
+BDD_TLS int          bddrunning;            /* Flag - package initialized */
+BDD_TLS int          bdderrorcond;          /* Some error condition */
+BDD_TLS int          bddnodesize;           /* Number of allocated nodes */
+BDD_TLS int          bddmaxnodesize;        /* Maximum allowed number of nodes */
+BDD_TLS int          bddmaxnodeincrease;    /* Max. # of nodes used to inc. table */
+BDD_TLS BddNode*     bddnodes;          /* All of the bdd nodes */
+BDD_TLS int          bddfreepos;        /* First free node */
+BDD_TLS int          bddfreenum;        /* Number of free nodes */
+BDD_TLS long int     bddproduced;       /* Number of new nodes ever produced */
+BDD_TLS int          bddvarnum;         /* Number of defined BDD variables */
+BDD_TLS int*         bddrefstack;       /* Internal node reference stack */
+BDD_TLS int*         bddrefstacktop;    /* Internal node reference stack top */
+BDD_TLS int*         bddvar2level;      /* Variable -> level table */
+BDD_TLS int*         bddlevel2var;      /* Level -> variable table */
+BDD_TLS jmp_buf      bddexception;      /* Long-jump point for interrupting calc. */
+BDD_TLS int          bddresized;        /* Flag indicating a resize of the nodetable */
+
+BDD_TLS bddCacheStat bddcachestats;
 
 
 /*=== PRIVATE KERNEL VARIABLES =========================================*/
 
-static BDD*     bddvarset;             /* Set of defined BDD variables */
-static int      gbcollectnum;          /* Number of garbage collections */
-static int      cachesize;             /* Size of the operator caches */
-static long int gbcclock;              /* Clock ticks used in GBC */
-static int      usednodes_nextreorder; /* When to do reorder next time */
-static bddinthandler  err_handler;     /* Error handler */
-static bddgbchandler  gbc_handler;     /* Garbage collection handler */
-static bdd2inthandler resize_handler;  /* Node-table-resize handler */
+static BDD_TLS BDD*     bddvarset;             /* Set of defined BDD variables */
+static BDD_TLS int      gbcollectnum;          /* Number of garbage collections */
+static BDD_TLS int      cachesize;             /* Size of the operator caches */
+static BDD_TLS long int gbcclock;              /* Clock ticks used in GBC */
+static BDD_TLS int      usednodes_nextreorder; /* When to do reorder next time */
+static BDD_TLS bddinthandler  err_handler;     /* Error handler */
+static BDD_TLS bddgbchandler  gbc_handler;     /* Garbage collection handler */
+static BDD_TLS bdd2inthandler resize_handler;  /* Node-table-resize handler */
 
 
    /* Strings for all error mesages */
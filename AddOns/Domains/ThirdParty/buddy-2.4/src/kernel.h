@@ -93,21 +93,21 @@ typedef struct s_BddNode /* Node table entry */
 extern "C" {
 #endif
 
-extern int       bddrunning;         /* Flag - package initialized */
-extern int       bdderrorcond;       /* Some error condition was met */
-extern int       bddnodesize;        /* Number of allocated nodes */
-extern int       bddmaxnodesize;     /* Maximum allowed number of nodes */
-extern int       bddmaxnodeincrease; /* Max. # of nodes used to inc. table */
-extern BddNode*  bddnodes;           /* All of the bdd nodes */
-extern int       bddvarnum;          /* Number of defined BDD variables */
-extern int*      bddrefstack;        /* Internal node reference stack */
-extern int*      bddrefstacktop;     /* Internal node reference stack top */
-extern int*      bddvar2level;
-extern int*      bddlevel2var;
-extern jmp_buf   bddexception;
-extern int       bddreorderdisabled;
-extern int       bddresized;
-extern bddCacheStat bddcachestats;
+extern BDD_TLS int       bddrunning;         /* Flag - package initialized */
+extern BDD_TLS int       bdderrorcond;       /* Some error condition was met */
+extern BDD_TLS int       bddnodesize;        /* Number of allocated nodes */
+extern BDD_TLS int       bddmaxnodesize;     /* Maximum allowed number of nodes */
+extern BDD_TLS int       bddmaxnodeincrease; /* Max. # of nodes used to inc. table */
+extern BDD_TLS BddNode*  bddnodes;           /* All of the bdd nodes */
+extern BDD_TLS int       bddvarnum;          /* Number of defined BDD variables */
+extern BDD_TLS int*      bddrefstack;        /* Internal node reference stack */
+extern BDD_TLS int*      bddrefstacktop;     /* Internal node reference stack top */
+extern BDD_TLS int*      bddvar2level;
+extern BDD_TLS int*      bddlevel2var;
+extern BDD_TLS jmp_buf   bddexception;
+extern BDD_TLS int       bddreorderdisabled;
+extern BDD_TLS int       bddresized;
+extern BDD_TLS bddCacheStat bddcachestats;
 
 #ifdef CPLUSPLUS
 }
@@ -7,6 +7,7 @@
 #include "opennwa/query/transitions.hpp"
 #include "opennwa/query/calls.hpp"
 #include "opennwa/query/internals.hpp"
+#include "opennwa/query/language.hpp"
 #include "opennwa/nwa_pds/conversions.hpp"
 #include "wali/wpds/fwpds/FWPDS.hpp"
 #include "wali/wfa/State.hpp"
@@ -67,6 +68,21 @@ namespace opennwa
     //clearTrans() called from clearStates()
   }
 
+  void Nwa::freeze( )
+  {
+    trans.freeze();
+  }
+
+  void Nwa::thaw( )
+  {
+    trans.thaw();
+  }
+
+  bool Nwa::isFrozen( ) const
+  {
+    return trans.isFrozen();
+  }
+
   //State Accessors
 
   /**
@@ -1706,122 +1722,7 @@ namespace opennwa
     
   bool Nwa::_private_isEmpty_( ) const
   {
-    //An automaton with no initial states must accept only the empty language.
-    if( sizeInitialStates() == 0 )
-      return true;
-
-    //An automaton with no final states must accept only the empty language.
-    if( sizeFinalStates() == 0 )
-      return true;
-
-    //An automaton with an initial state that is a final state is definitely not empty.
-    for( StateIterator it = beginInitialStates(); it != endInitialStates(); it++ )
-    {
-      if( isFinalState(*it) )
-        return false;
-    }
-
-    //Any final state reachable from an initial state shows this NWA is not empty.
-
-    Reach wgts = Reach(true);
-
-    //Make a WFA with transitions from initial state to final state for each 
-    //initial state of the NWA.
-    wali::wfa::WFA initials;
-    //Set up initial state.
-    wali::Key init = nwa_pds::getProgramControlLocation();
-    initials.addState(init,wgts.zero());
-    initials.setInitialState(init);
-    //Set up final state.
-    wali::Key fin = getKey("fin");
-    initials.addState(fin,wgts.zero());
-    initials.addFinalState(fin);
-    //Add transitions.
-    for( StateIterator it = beginInitialStates(); it != endInitialStates(); it++ )
-    {
-      initials.addTrans(init,*it,fin,wgts.one());
-    }
-
-#if 1 // Allow pending returns
-    for( StateIterator it = beginInitialStates(); it != endInitialStates(); it++ )
-    {
-      initials.addTrans(fin,*it,fin,wgts.one());
-    }
-#endif
-
-    //std::cout << "Initials:\n";
-    //initials.print_dot(std::cout);
-    //std::cout << "\n";
-
-    //Make a WFA with transitions from initial state to final state for each
-    //final state of the NWA.
-    wali::wfa::WFA finals;
-    //Set up initial state.
-    finals.addState(init,wgts.zero());
-    finals.setInitialState(init);
-    //Set up final state.
-    finals.addState(fin,wgts.zero());
-    finals.addFinalState(fin);
-    //Add transitions.
-    for( StateIterator it = beginFinalStates(); it != endFinalStates(); it++ )
-    {
-      finals.addTrans(init,*it,fin,wgts.one());
-    }
-
-#if 1 // Allow pending calls
-    for( StateIterator it = beginStates(); it != endStates(); it++ )
-    {
-      finals.addTrans(fin,*it,fin,wgts.one());
-    }
-#endif
-
-    //std::cout << "Finals:\n";
-    //finals.print_dot(std::cout);
-    //std::cout << "\n";
-
-#if 1
-    ReachGen reach;
-    //Perform poststar to determine reachability.
-    //std::cerr << "Before poststar\n";
-    wali::wfa::WFA postInitials = query::poststar(*this,reach, initials);
-    //std::cerr << "After poststar!\n";
-
-    //std::cout << "poststar(initials):\n";
-    //postInitials.print_dot(std::cout);
-    //std::cout << "\n";
-
-    //intersect poststar(initials) and finals
-    //std::cerr << "Before intersect\n";
-    wali::wfa::WFA reachable = postInitials.intersect(finals);
-    //std::cerr << "After intersect!\n";
-
-    //std::cout << "intersection:\n";
-    //reachable.print_dot(std::cout);
-    //std::cout << "\n";
-#else
-    //Perform poststar to determine reachability.
-    ReachGen<Client> reach;
-    //std::cerr << "Before prestar\n";
-    wali::wfa::WFA preFinals = prestar(finals,reach);
-    //std::cerr << "After prestar!\n";
-
-    //intersect poststar(initials) and finals
-    //std::cerr << "Before WFA intersect\n";
-    wali::wfa::WFA reachable = preFinals.intersect(initials);
-    //std::cerr << "After WFA intersect!\n";
-#endif
-
-    reachable.prune();
-    //reachable.print_dot(std::cout << "Reachable after prune: \n") << "\n";
-
-    //If there are no transitions in this intersection, then the NWA is empty.
-    wali::wfa::TransCounter tc = wali::wfa::TransCounter();
-    reachable.for_each( tc );
-      
-    if( tc.getNumTrans() == 0 )
-      return true;  //There was no path from an initial state to a final state in the NWA.
-    else
-      return false; //There was a path from an initial state to a final state in the NWA.
+    return query::languageIsEmpty(*this);
   }
 
     
@@ -153,6 +153,25 @@ namespace opennwa
      */
     void clear( );
 
+    /**
+     * @brief Packs the transitions into a compact, read-only form
+     *
+     * Lookups are then answered from sorted arrays over densely renumbered
+     * states, and the per-state transition maps are dropped. Any change to
+     * the transitions undoes this. See details::TransitionStorage::freeze().
+     */
+    void freeze( );
+
+    /**
+     * @brief Undoes freeze()
+     */
+    void thaw( );
+
+    /**
+     * @brief Returns whether freeze() is in effect
+     */
+    bool isFrozen( ) const;
+
       
     /**
      * Marshalls the NWA as XML to the output stream os
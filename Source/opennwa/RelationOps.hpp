@@ -8,6 +8,8 @@
 #include <map>
 #include <set>
 
+#include <boost/functional/hash.hpp>
+
 //#include "wali/util/unordered_set.hpp"
 
 #include "wali/ref_ptr.hpp"
@@ -232,6 +234,41 @@ namespace wali {
     };
 
 
+    /// Hashes binary relations, for hash tables keyed by them. The hash of
+    /// a relation is the XOR of a hash of each of its pairs (Zobrist
+    /// hashing): it does not depend on the order the pairs are stored in,
+    /// and a running hash can be kept up to date by XORing in pairHash()
+    /// of each pair as it is added or removed.
+    template<typename State>
+    struct RelationHash
+    {
+      typedef typename RelationTypedefs<State>::BinaryRelation BinaryRelation;
+
+      static size_t pairHash(pair<State, State> const & p)
+      {
+        // hash_combine is order-dependent, so (a,b) and (b,a) differ
+        size_t h = 0;
+        boost::hash_combine(h, p.first);
+        boost::hash_combine(h, p.second);
+        // hash_combine of small keys leaves the high bits nearly constant,
+        // and XOR would let those cancel; mix them in.
+        h ^= h >> 16;
+        h *= 0x45d9f3bu;
+        h ^= h >> 16;
+        return h;
+      }
+
+      size_t operator()(BinaryRelation const & r) const
+      {
+        size_t h = 0;
+        for (typename BinaryRelation::const_iterator p = r.begin(); p != r.end(); ++p) {
+          h ^= pairHash(*p);
+        }
+        return h;
+      }
+    };
+
+
     /// Composes two binary relations
     ///
     /// { (x,z) | (x,y) \in r1,  (y,z) \in r2}
@@ -18,6 +18,7 @@
 
 #include "wali/ref_ptr.hpp"
 #include "wali/KeyContainer.hpp"
+#include "wali/util/BddResources.hpp"
 
 namespace wali {
   namespace relations {
@@ -303,19 +304,34 @@ namespace wali {
     };
 
 
+    /// Hashes binary relations, for hash tables keyed by them. BuDDy shares
+    /// nodes, so equal relations (over the same domain) have the same root
+    /// node, and its id serves as the hash.
+    template<typename State>
+    struct RelationHash
+    {
+      size_t operator()(BinaryRelation const & r) const
+      {
+        return static_cast<size_t>(r.getBdd().id());
+      }
+    };
+
+
     inline
     void buddyInit()
     {
       if (!bdd_isrunning()) {
-        const int million = 1000000;
-        int rc = bdd_init( 50*million, 100000 );
+        // 50M nodes to start, as before bddInit; the environment can
+        // still override these
+        wali::util::BddResources defaults(50000000);
+        defaults.cacheRatio = 500;
+        defaults.maxIncrease = 100000;
+        int rc = wali::util::bddInit(defaults.fromEnvironment());
         if( rc < 0 ) {
           std::cerr << "[ERROR] " << bdd_errstring(rc) << std::endl;
           assert( 0 );
           exit(10);
         }
-        // Default is 50,000 (1 Mb),memory is cheap, so use 100,000
-        bdd_setmaxincrease(100000);
       }
     }
 
@@ -149,6 +149,17 @@ namespace wali {
       typedef wali::relations::TernaryRelation TernaryRelation;
     };
 
+
+    /// Hashes binary relations by their BDD half (see the BuDDy version)
+    template<typename State>
+    struct RelationHash
+    {
+      size_t operator()(BinaryRelation const & r) const
+      {
+        return static_cast<size_t>(r.getBdd().id());
+      }
+    };
+
         
     using wbr::buddyInit;
         
@@ -6,3 +6,4 @@
 #include "opennwa/construct/star.hpp"
 #include "opennwa/construct/union.hpp"
 #include "opennwa/construct/quotient.hpp"
+#include "opennwa/construct/reduce.hpp"
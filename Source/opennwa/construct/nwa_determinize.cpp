@@ -1,5 +1,23 @@
 #include "opennwa/Nwa.hpp"
 #include "opennwa/construct/determinize.hpp"
+#include "opennwa/details/RelationTable.hpp"
+#include "wali/util/unordered_map.hpp"
+
+#include <map>
+#include <vector>
+
+// Which container numbers the macro-states during determinization. The
+// others are kept to compare against (see the run-tests script in
+// Tests/unit-tests/Performance/pcca-determinize); define
+// DETERMINIZE_RELATION_SET to one of them to use it.
+#define DETERMINIZE_RELATION_TABLE  0   // details::RelationTable
+#define DETERMINIZE_STD_SET         1   // a std::map (needs operator<)
+#define DETERMINIZE_UNORDERED_SET   2   // a boost unordered_map
+#define DETERMINIZE_VECTOR_SET      3   // relations::VectorSet (USE_BUDDY only)
+
+#ifndef DETERMINIZE_RELATION_SET
+#  define DETERMINIZE_RELATION_SET DETERMINIZE_RELATION_TABLE
+#endif
 
 namespace opennwa
 {
@@ -21,32 +39,81 @@ namespace opennwa
 
       
   } // end 'namespace construct' !!!
-    
 
-#if 0
-  template< T>
-  struct terrible_set_hasher
-  {
-    size_t operator() (T const & set) const {
-      return set.size();
-    }
-  };
 
-  template< T>
-  struct terrible_set_comparer
+  namespace
   {
-    bool operator() (T const & lhs, T const & rhs) const {
-      if (lhs.size() != rhs.size()) return false;
-          
-      for ( T::const_iterator li = lhs.begin() ; li != lhs.end() ; ++li) {
-        if (rhs.find(*li) == rhs.end()) return false;
+    /**
+     *
+     * Numbers relations like details::RelationTable, but finds them with a
+     * std::map or unordered_map from relation to id. The ids index
+     * pointers to the map's keys, which do not move as the map grows.
+     *
+     */
+    template<typename Relation, typename Map>
+    class MappedRelationTable
+    {
+    public:
+      typedef size_t Id;
+
+      std::pair<Id, bool> insert( Relation const & relation )
+      {
+        std::pair<typename Map::iterator, bool> found =
+          ids_.insert(std::make_pair(relation, relations_.size()));
+        if( found.second )
+          relations_.push_back(&found.first->first);
+        return std::make_pair(found.first->second, found.second);
       }
 
-      return true;
-    }
-  };
+      Relation const & operator[]( Id id ) const { return *relations_[id]; }
+      size_t size( ) const { return relations_.size(); }
+
+    private:
+      Map ids_;
+      std::vector<Relation const *> relations_;
+    };
+
+#ifdef USE_BUDDY
+    /**
+     *
+     * Numbers relations by their position in a VectorSet, which keeps
+     * them in the order they were added and finds them by linear search.
+     *
+     */
+    template<typename Relation>
+    class VectorSetTable
+    {
+    public:
+      typedef size_t Id;
+      typedef wali::relations::VectorSet<Relation> Set;
+
+      VectorSetTable( ) : size_(0) {}
+
+      std::pair<Id, bool> insert( Relation const & relation )
+      {
+        Set const & set = set_;
+        typename Set::const_iterator it = set.find(relation);
+        if( it != set.end() )
+          return std::make_pair(static_cast<Id>(it - set.begin()), false);
+        set_.insert(relation);
+        return std::make_pair(size_++, true);
+      }
+
+      Relation const & operator[]( Id id ) const
+      {
+        Set const & set = set_;
+        return *(set.begin() + id);
+      }
+
+      size_t size( ) const { return size_; }
+
+    private:
+      Set set_;
+      size_t size_;
+    };
 #endif
-      
+  }
+
 
   /**
    *
@@ -83,18 +150,21 @@ namespace opennwa
     typedef std::set<std::pair<State, State> > SetBinaryRelation;
     typedef  RelationTypedefs<State>::TernaryRelation TernaryRelation;
 
-#if 0
-    typedef  wali::util::unordered_set<BinaryRelation
-      , terrible_set_hasher<BinaryRelation>
-      //, terrible_set_comparer<BinaryRelation>
-      >
-      RelationSet;
-#endif
-
-#ifdef USE_BUDDY
-    typedef VectorSet<BinaryRelation> RelationSet;
+    //The macro-states found so far, numbered in the order they were found.
+#if DETERMINIZE_RELATION_SET == DETERMINIZE_STD_SET
+    typedef MappedRelationTable<BinaryRelation,
+                                std::map<BinaryRelation, size_t> > MacroStates;
+#elif DETERMINIZE_RELATION_SET == DETERMINIZE_UNORDERED_SET
+    typedef MappedRelationTable<BinaryRelation,
+                                wali::util::unordered_map<BinaryRelation, size_t, RelationHash<State> > >
+      MacroStates;
+#elif DETERMINIZE_RELATION_SET == DETERMINIZE_VECTOR_SET
+#  ifndef USE_BUDDY
+#    error "DETERMINIZE_VECTOR_SET needs USE_BUDDY"
+#  endif
+    typedef VectorSetTable<BinaryRelation> MacroStates;
 #else
-    typedef std::set<BinaryRelation> RelationSet;
+    typedef details::RelationTable<BinaryRelation, RelationHash<State> > MacroStates;
 #endif
 
     // Construct Id
@@ -154,22 +224,31 @@ namespace opennwa
     mergeClientInfo(nondet,R0,r0,CI);
     states.setClientInfo(r0,CI);
 
-    //Put the initial state on the worklist.
-    RelationSet wl;
-    wl.insert(R0); // or close
-
-    //Keep track of all visited states.
-    RelationSet visited;
+    //The macro-states are processed in the order they are found, so the
+    //table doubles as the worklist: the states before 'current' have been
+    //visited, and the rest are waiting. The key of each macro-state is
+    //made once, when it is found.
+    MacroStates macroStates;
+    std::vector<State> keys;
+    macroStates.insert(R0); // or close
+    keys.push_back(r0);
 
     // Pre-compute some projections and stuff
+    std::vector<Symbol> alphabet;
     std::map<wali::Key, BinaryRelation> callTransPerSymbol;
     std::map<wali::Key, BinaryRelation> internalTransPerSymbol;
     std::map<wali::Key, TernaryRelation> returnTransPerSymbol;
 
+    //The target of a call transition does not depend on its source, so
+    //each symbol's entry state is found once, up front.
+    std::map<wali::Key, MacroStates::Id> entryPerSymbol;
+
     for( SymbolIterator it = nondet.beginSymbols(); it != nondet.endSymbols(); it++ ) {
       if (*it == EPSILON) continue;    //Epsilon is handled with closure.
       if (*it == WILD) continue;
 
+      alphabet.push_back(*it);
+
 #ifdef USE_BUDDY
       internalTransPerSymbol[*it] = BinaryRelation(nondet.largestState());
       callTransPerSymbol[*it] = BinaryRelation(nondet.largestState());
@@ -184,50 +263,36 @@ namespace opennwa
 
       project_symbol_4(returnTransPerSymbol[*it], nondet.trans.getReturns(), *it);
       project_symbol_4(returnTransPerSymbol[*it], nondet.trans.getReturns(),WILD);   //Every symbol also matches wild.
+
+      DECLARE(BinaryRelation, Rc);
+#ifdef USE_BUDDY
+      compose/*<St>*/(Rc,callTransPerSymbol[*it],close);
+#else
+      compose<State>(Rc,callTransPerSymbol[*it],close);
+#endif
+      std::pair<MacroStates::Id, bool> found = macroStates.insert(Rc);
+      if( found.second )
+        keys.push_back(makeKey(Rc));
+      entryPerSymbol[*it] = found.first;
     }
 
       
     //Process the states on the worklist.
-    while(! wl.empty() )
+    for( MacroStates::Id current = 0; current < macroStates.size(); current++ )
     {
-      //Take a state off of the worklist.
-      BinaryRelation R = *wl.begin();
-      wl.erase(wl.begin());
-  
-      //Mark this state as visited.
-      visited.insert(R);
-
-      //Make a key for this state.
-      State r = makeKey(R);
-
+      //Take a state off of the worklist. (It is now visited.)
+      BinaryRelation const & R = macroStates[current];
+      State r = keys[current];
 
       //Check each symbol individually.
-      for( SymbolIterator it = nondet.beginSymbols(); it != nondet.endSymbols(); it++ )
+      for( std::vector<Symbol>::const_iterator it = alphabet.begin(); it != alphabet.end(); it++ )
       {
-        if (*it == EPSILON) continue;    //Epsilon is handled with closure.
-        if (*it == WILD) continue;       //Wild is matched to every symbol as we go.
-
         //Process internal transitions.
         //Compute the relation.
         DECLARE(BinaryRelation, Ri);
         DECLARE(BinaryRelation, Rtmpi);
         BinaryRelation const & Ii = internalTransPerSymbol[*it];
 
-#if 0
-        DECLARE(BinaryRelation, IiOrig);
-        project_symbol_3(IiOrig,nondet.trans.getInternals(),*it);   
-        project_symbol_3(IiOrig,nondet.trans.getInternals(),WILD);   //Every symbol also matches wild.
-          
-        if (Ii == IiOrig) {
-          std::cout << "Ii == IiOrig holds!\n";
-        }
-        else {
-          std::cout << "***** Ii == IiOrig VIOLATED\n";
-          std::cout << "      Ii's size is " << Ii.size() << "\n";
-          std::cout << "      Orig's size is " << IiOrig.size() << "\n";
-        }
-#endif
-
 #ifdef USE_BUDDY
         compose/*<St>*/(Rtmpi,R,Ii);
         compose/*<St>*/(Ri,Rtmpi,close);
@@ -235,8 +300,11 @@ namespace opennwa
         compose<State>(Rtmpi,R,Ii);
         compose<State>(Ri,Rtmpi,close);
 #endif
-        //Make a key for this state.
-        State ri = makeKey(Ri);
+        //Find this state, putting it on the worklist if it is new.
+        std::pair<MacroStates::Id, bool> found = macroStates.insert(Ri);
+        if( found.second )
+          keys.push_back(makeKey(Ri));
+        State ri = keys[found.first];
 
         //Add the state to the deterministic NWA.
         addState(ri);
@@ -248,41 +316,11 @@ namespace opennwa
         mergeClientInfoInternal(nondet,R,Ri,r,*it,ri,riCI);
         states.setClientInfo(ri,riCI);
 
-        //Determine whether to add this state to the worklist.
-        if( visited.find(Ri) == visited.end() )
-        {
-          wl.insert(Ri);
-        }
-
-        //Process call transitions.
-        //Compute the relation.
-        //BinaryRelation IdClose_Delta2;
-        DECLARE(BinaryRelation, Rc);
-        BinaryRelation const & Ic = callTransPerSymbol[*it];
-
-#if 0
-        DECLARE(BinaryRelation, IcOrig);
-        project_symbol_3(IcOrig,nondet.trans.getCalls(),*it);  
-        project_symbol_3(IcOrig,nondet.trans.getCalls(),WILD);   //Every symbol also matches wild.
-          
-        if (Ic == IcOrig) {
-          std::cout << "Ic == IcOrig holds!\n";
-        }
-        else {
-          std::cout << "***** Ic == IcOrig VIOLATED\n";
-        }
-#endif
-
-        //compose/*<St>*/(IdClose_Delta2, R0, Ic);
-        //compose/*<St>*/(Rc,IdClose_Delta2,close);
-#ifdef USE_BUDDY
-        compose/*<St>*/(Rc,Ic,close);
-#else
-        compose<State>(Rc,Ic,close);
-#endif
-          
-        //Make a key for this state.
-        State rc = makeKey(Rc);
+        //Process call transitions. The target was found (and put on the
+        //worklist) up front.
+        MacroStates::Id entry = entryPerSymbol[*it];
+        BinaryRelation const & Rc = macroStates[entry];
+        State rc = keys[entry];
         //Add the state to the deterministic NWA.
         addState(rc);
         //Add the transition to the deterministic NWA.
@@ -293,45 +331,28 @@ namespace opennwa
         mergeClientInfoCall(nondet,R,Rc,r,*it,rc,rcCI);
         states.setClientInfo(rc,rcCI);
 
-        //Determine whether to add this state to the worklist.
-        if( visited.find(Rc) == visited.end() )
-        {
-          wl.insert(Rc);
-        }
-
         //Process return transitions.
         TernaryRelation const & Ir = returnTransPerSymbol[*it];
 
-#if 0
-        TernaryRelation IrOrig;
-        project_symbol_4(IrOrig,nondet.trans.getReturns(),*it);    
-        project_symbol_4(IrOrig,nondet.trans.getReturns(),WILD);   //Every symbol also matches wild.
-
-        if (Ir == IrOrig) {
-          std::cout << "Ir == IrOrig holds!\n";
-        }
-        else {
-          std::cout << "***** Ir == IrOrig VIOLATED\n";
-        }
-#endif
-
         //For each possible call predecessor:
-        for(  RelationSet::iterator rit = visited.begin();
-              rit != visited.end(); rit++ )
+        for( MacroStates::Id v = 0; v <= current; v++ )
         {
           //Compute the relation.
           DECLARE(BinaryRelation, Rr);
           DECLARE(BinaryRelation, Rtmpr);
 #ifdef USE_BUDDY
-          merge/*<St>*/(Rtmpr,R,*rit,Ir);
+          merge/*<St>*/(Rtmpr,R,macroStates[v],Ir);
           compose/*<St>*/(Rr,Rtmpr,close);
 #else
-          merge<State>(Rtmpr,R,*rit,Ir);
+          merge<State>(Rtmpr,R,macroStates[v],Ir);
           compose<State>(Rr,Rtmpr,close);
 #endif
-          //Make a key for this state and the call predecessor state.
-          State rr = makeKey(Rr);
-          State rc2 = makeKey(*rit);
+          //Find this state, putting it on the worklist if it is new.
+          std::pair<MacroStates::Id, bool> found = macroStates.insert(Rr);
+          if( found.second )
+            keys.push_back(makeKey(Rr));
+          State rr = keys[found.first];
+          State rc2 = keys[v];
           //Add the state to the deterministic NWA.
           addState(rr);
           //Add the transition to the deterministic NWA.
@@ -339,35 +360,28 @@ namespace opennwa
 
           //Adjust the client info for this state.
           ClientInfoRefPtr rrCI;
-          mergeClientInfoReturn(nondet,R,*rit,Rr,r,rc2,*it,rr,rrCI);
+          mergeClientInfoReturn(nondet,R,macroStates[v],Rr,r,rc2,*it,rr,rrCI);
           states.setClientInfo(rr,rrCI);
-
-          //Determine whether to add this state to the worklist.
-          if( visited.find(Rr) == visited.end() )
-          {
-            wl.insert(Rr);
-          }
         }
         //For each possible exit point:
-        for(  RelationSet::iterator rit = visited.begin();
-              rit != visited.end(); rit++ )
+        for( MacroStates::Id v = 0; v <= current; v++ )
         {
           //Compute the relation.
           DECLARE(BinaryRelation, Rr);
           DECLARE(BinaryRelation, Rtmpr);
 #ifdef USE_BUDDY
-          merge/*<St>*/(Rtmpr,*rit,R,Ir);
-#else
-          merge<State>(Rtmpr,*rit,R,Ir);
-#endif
-#ifdef USE_BUDDY
+          merge/*<St>*/(Rtmpr,macroStates[v],R,Ir);
           compose/*<St>*/(Rr,Rtmpr,close);
 #else
+          merge<State>(Rtmpr,macroStates[v],R,Ir);
           compose<State>(Rr,Rtmpr,close);
 #endif
-          //Make a key for this state and the exit point state.
-          State rr = makeKey(Rr);
-          State re = makeKey(*rit);
+          //Find this state, putting it on the worklist if it is new.
+          std::pair<MacroStates::Id, bool> found = macroStates.insert(Rr);
+          if( found.second )
+            keys.push_back(makeKey(Rr));
+          State rr = keys[found.first];
+          State re = keys[v];
           //Add the state to the deterministic NWA.
           addState(rr);
           //Add the transition to the deterministic NWA.
@@ -377,40 +391,32 @@ namespace opennwa
           ClientInfoRefPtr rrCI;
           mergeClientInfo(nondet,Rr,rr,rrCI);
           states.setClientInfo(rr,rrCI);
-
-          //Determine whether to add this state to the worklist.
-          if( visited.find(Rr) == visited.end() )
-          {
-            wl.insert(Rr);
-          }
         }
       }
+    }
 
-      //Deterministic final states.
-      //Necessary components for a final state, i.e., 
-      //any final state must contain one of the pairs in 
-      //{(q,fin) | q is any state and fin is a final state}
-      DECLARE(BinaryRelation, Rf);
-      for( StateIterator iit = nondet.beginStates();
-           iit != nondet.endStates(); iit++ )
+    //Deterministic final states.
+    //Necessary components for a final state, i.e., 
+    //any final state must contain one of the pairs in 
+    //{(q,fin) | q is any state and fin is a final state}
+    DECLARE(BinaryRelation, Rf);
+    for( StateIterator iit = nondet.beginStates();
+         iit != nondet.endStates(); iit++ )
+    {
+      for( StateIterator fit = nondet.beginFinalStates();
+           fit != nondet.endFinalStates(); fit++ )
       {
-        for( StateIterator fit = nondet.beginFinalStates();
-             fit != nondet.endFinalStates(); fit++ )
-        {
-          Rf.insert(std::pair<State,State>(*iit,*fit));
-        }
+        Rf.insert(std::pair<State,State>(*iit,*fit));
       }
-      //For each state in the deterministic maching, check whether it is a final state.
-      for(  RelationSet::iterator sit = visited.begin();
-            sit != visited.end(); sit++ )
+    }
+    //For each state in the deterministic maching, check whether it is a final state.
+    for( MacroStates::Id v = 0; v < macroStates.size(); v++ )
+    {
+      DECLARE(BinaryRelation, Rtmpf);
+      wali::relations::intersect(Rtmpf,Rf,macroStates[v]);
+      if(! Rtmpf.empty() )
       {
-        DECLARE(BinaryRelation, Rtmpf);
-        wali::relations::intersect(Rtmpf,Rf,*sit);
-        if(! Rtmpf.empty() )
-        {
-          State f = makeKey(*sit);
-          addFinalState(f);
-        }
+        addFinalState(keys[v]);
       }
     }
 #undef DECLARE
@@ -418,7 +424,7 @@ namespace opennwa
 
 #ifdef USE_BUDDY
     
-  State NWA::makeKey(
+  State Nwa::makeKey(
     wali::relations::RelationTypedefs<State>::BinaryRelation const & R ) const
   {
     std::stringstream ss;
@@ -0,0 +1,191 @@
+#include "opennwa/Nwa.hpp"
+#include "opennwa/construct/quotient.hpp"
+#include "opennwa/construct/reduce.hpp"
+
+#include "wali/util/Timer.hpp"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace opennwa
+{
+  namespace construct
+  {
+
+    namespace
+    {
+      typedef std::vector<size_t> Signature;
+
+      /// A transition from a state, with the states it mentions numbered
+      /// densely. 'other' is the return partner (the call predecessor of
+      /// an exit, or the exit of a call predecessor); it is 0 for
+      /// internals and calls.
+      struct Edge
+      {
+        Symbol symbol;
+        size_t other;
+        size_t target;
+
+        Edge( Symbol s, size_t o, size_t t ) : symbol(s), other(o), target(t) {}
+      };
+
+      typedef std::vector<std::vector<Edge> > Edges;
+
+      /// Appends the set of (symbol, other, block(target)) of the given
+      /// edges to 'sig', as a count followed by the sorted entries.
+      ///
+      /// The return partner goes in as the state itself, not its block.
+      /// The quotient has a return for every pair of blocks some return
+      /// joins, so two exits may only be merged if each has a return
+      /// with every call predecessor that the other has one with (to the
+      /// same blocks), not merely with some predecessor in the same block;
+      /// and likewise for call predecessors.
+      void addEdges( Signature & sig, std::vector<Edge> const & edges,
+                     std::vector<size_t> const & block )
+      {
+        std::vector<Signature> entries;
+        entries.reserve(edges.size());
+        for( std::vector<Edge>::const_iterator e = edges.begin(); e != edges.end(); e++ )
+        {
+          Signature entry(3);
+          entry[0] = e->symbol;
+          entry[1] = e->other;
+          entry[2] = block[e->target];
+          entries.push_back(entry);
+        }
+        std::sort(entries.begin(), entries.end());
+        entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+        sig.push_back(entries.size());
+        for( std::vector<Signature>::const_iterator e = entries.begin(); e != entries.end(); e++ )
+          sig.insert(sig.end(), e->begin(), e->end());
+      }
+    }
+
+
+    wali::util::DisjointSets<State> bisimulationClasses( Nwa const & nwa, unsigned * rounds )
+    {
+      std::vector<State> states(nwa.beginStates(), nwa.endStates());
+      std::map<State, size_t> index;
+      for( size_t i = 0; i < states.size(); i++ )
+        index[states[i]] = i;
+
+      // The transitions out of each state, in each role it can play.
+      Edges internals(states.size()), calls(states.size());
+      Edges asExit(states.size()), asPred(states.size());
+      for( Nwa::InternalIterator it = nwa.beginInternalTrans(); it != nwa.endInternalTrans(); it++ )
+      {
+        size_t from = index[it->first];
+        internals[from].push_back(Edge(it->second, 0, index[it->third]));
+      }
+      for( Nwa::CallIterator it = nwa.beginCallTrans(); it != nwa.endCallTrans(); it++ )
+      {
+        size_t from = index[it->first];
+        calls[from].push_back(Edge(it->second, 0, index[it->third]));
+      }
+      for( Nwa::ReturnIterator it = nwa.beginReturnTrans(); it != nwa.endReturnTrans(); it++ )
+      {
+        size_t exit = index[it->first], pred = index[it->second], ret = index[it->fourth];
+        asExit[exit].push_back(Edge(it->third, pred, ret));
+        asPred[pred].push_back(Edge(it->third, exit, ret));
+      }
+
+      // Initial partition: by being initial and final. Initial states are
+      // kept apart from the others because a pending return may pop any
+      // initial state, so merging one with a non-initial state could let
+      // the latter's returns fire as pending.
+      std::vector<size_t> block(states.size());
+      size_t numBlocks = 0;
+      {
+        std::map<std::pair<bool, bool>, size_t> kinds;
+        for( size_t i = 0; i < states.size(); i++ )
+        {
+          std::pair<bool, bool> kind(nwa.isInitialState(states[i]), nwa.isFinalState(states[i]));
+          std::map<std::pair<bool, bool>, size_t>::iterator place =
+            kinds.insert(std::make_pair(kind, kinds.size())).first;
+          block[i] = place->second;
+        }
+        numBlocks = kinds.size();
+      }
+
+      // Refine: split each block by the blocks its transitions reach,
+      // until no block splits. The old block leads each signature, so
+      // blocks only ever split.
+      unsigned round = 0;
+      while( true )
+      {
+        round++;
+        std::map<Signature, size_t> blocks;
+        std::vector<size_t> next(states.size());
+        for( size_t i = 0; i < states.size(); i++ )
+        {
+          Signature sig(1, block[i]);
+          addEdges(sig, internals[i], block);
+          addEdges(sig, calls[i], block);
+          addEdges(sig, asExit[i], block);
+          addEdges(sig, asPred[i], block);
+          next[i] = blocks.insert(std::make_pair(sig, blocks.size())).first->second;
+        }
+        block.swap(next);
+        if( blocks.size() == numBlocks )
+          break;
+        numBlocks = blocks.size();
+      }
+      if( rounds )
+        *rounds = round;
+
+      wali::util::DisjointSets<State> partition;
+      std::vector<State> representative(numBlocks, 0);
+      std::vector<bool> seen(numBlocks, false);
+      for( size_t i = 0; i < states.size(); i++ )
+      {
+        partition.insert(states[i]);
+        if( !seen[block[i]] )
+        {
+          seen[block[i]] = true;
+          representative[block[i]] = states[i];
+        }
+        else
+          partition.merge_sets(representative[block[i]], states[i]);
+      }
+      return partition;
+    }
+
+
+    void reduce( Nwa & out, Nwa const & nwa, ReductionStatistics * stats )
+    {
+      long long start = wali::util::details::now();
+      unsigned rounds = 0;
+
+      quotient(out, nwa, bisimulationClasses(nwa, &rounds));
+
+      if( stats )
+      {
+        stats->statesBefore = nwa.sizeStates();
+        stats->statesAfter = out.sizeStates();
+        stats->transitionsBefore = nwa.sizeTrans();
+        stats->transitionsAfter = out.sizeTrans();
+        stats->refinementRounds = rounds;
+        stats->seconds = wali::util::details::to_sec(wali::util::details::now() - start);
+      }
+    }
+
+
+    NwaRefPtr reduce( Nwa const & nwa, ReductionStatistics * stats )
+    {
+      NwaRefPtr out(new Nwa());
+      reduce(*out, nwa, stats);
+      return out;
+    }
+
+  } // end 'namespace construct'
+
+} // end 'namespace opennwa'
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
@@ -0,0 +1,102 @@
+#ifndef WALI_NWA_CONSTRUCT_REDUCE_HPP
+#define WALI_NWA_CONSTRUCT_REDUCE_HPP
+
+#include "opennwa/NwaFwd.hpp"
+#include <wali/util/DisjointSets.hpp>
+
+namespace opennwa
+{
+  namespace construct
+  {
+
+    /**
+     *
+     * @brief what a call to 'reduce' did
+     *
+     */
+    struct ReductionStatistics
+    {
+      size_t statesBefore;
+      size_t statesAfter;
+      size_t transitionsBefore;
+      size_t transitionsAfter;
+      unsigned refinementRounds;  ///< rounds until the partition was stable
+      double seconds;             ///< wall-clock time, quotient included
+
+      ReductionStatistics()
+        : statesBefore(0), statesAfter(0)
+        , transitionsBefore(0), transitionsAfter(0)
+        , refinementRounds(0), seconds(0.0)
+      {}
+    };
+
+
+    /**
+     *
+     * @brief computes a forward bisimulation on the states of the given NWA
+     *
+     * Two states are bisimilar if they agree on being initial and on being
+     * final and, for every symbol, reach the same classes along internal
+     * and call transitions, and along return transitions in both of the
+     * roles a state plays in one: as the exit (for each call predecessor)
+     * and as the call predecessor (for each exit). Return partners are
+     * compared as states, not classes: two exits whose returns go through
+     * different call predecessors of the same class are kept apart, since
+     * merging them would let each take the other's returns.
+     * The classes are found by partition refinement, starting from the
+     * initial/final split.
+     *
+     * The result is sound (quotienting by it preserves the language) but
+     * is not guaranteed to be the coarsest such bisimulation: keying
+     * return partners by state keeps apart some states that could safely
+     * be merged, so the reduced NWA need not be minimal.
+     *
+     * Transitions are compared by their labels as written, so EPSILON and
+     * WILD are treated as ordinary symbols.
+     *
+     * @param - nwa: the NWA whose states to partition
+     * @param - rounds: if given, set to the number of refinement rounds
+     * @return the partition of the states of 'nwa' into bisimulation classes
+     *
+     */
+    extern wali::util::DisjointSets<State>
+    bisimulationClasses( Nwa const & nwa, unsigned * rounds = NULL );
+
+
+    /**
+     *
+     * @brief constructs the quotient of the given NWA by bisimulation
+     *
+     * The result accepts the same language as 'nwa' and has one state per
+     * class of bisimulationClasses(nwa); see construct::quotient.
+     *
+     * @param - out: the reduced NWA
+     * @param - nwa: the NWA to reduce
+     * @param - stats: if given, filled in with sizes and timing
+     *
+     */
+    extern void reduce( Nwa & out, Nwa const & nwa, ReductionStatistics * stats = NULL );
+
+
+    /**
+     *
+     * @brief constructs the quotient of the given NWA by bisimulation
+     *
+     * @param - nwa: the NWA to reduce
+     * @param - stats: if given, filled in with sizes and timing
+     * @return the reduced NWA
+     *
+     */
+    extern NwaRefPtr reduce( Nwa const & nwa, ReductionStatistics * stats = NULL );
+
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif
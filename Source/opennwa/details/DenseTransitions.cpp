@@ -0,0 +1,452 @@
+#include "DenseTransitions.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace opennwa
+{
+  namespace details
+  {
+
+    namespace
+    {
+      template<typename Key>
+      void
+      sortUnique( std::vector<Key> & keys )
+      {
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+      }
+
+      template<typename Key>
+      DenseTransitions::Id
+      denseId( std::vector<Key> const & keys, Key key )
+      {
+        typename std::vector<Key>::const_iterator place =
+          std::lower_bound(keys.begin(), keys.end(), key);
+        assert(place != keys.end() && *place == key);
+        return static_cast<DenseTransitions::Id>(place - keys.begin());
+      }
+
+      template<typename T>
+      size_t
+      bytes( std::vector<T> const & v )
+      {
+        return v.capacity() * sizeof(T);
+      }
+
+      /// Releases the memory of 'v', which clear() need not do
+      template<typename T>
+      void
+      release( std::vector<T> & v )
+      {
+        std::vector<T>().swap(v);
+      }
+    }
+
+
+    void DenseTransitions::Csr::build( size_t num_keys, std::vector<Id> const & keys, bool sorted,
+                                       std::vector<Id> const * within, size_t num_within )
+    {
+      offsets.assign(num_keys + 1, 0);
+      for( size_t i = 0; i < keys.size(); i++ )
+        offsets[keys[i] + 1]++;
+      for( size_t q = 0; q < num_keys; q++ )
+        offsets[q + 1] += offsets[q];
+
+      release(order);
+      if( sorted )
+        return;
+
+      // Visit the transitions by 'within' (a counting sort, so ties stay
+      // in index order), or just by index
+      std::vector<Id> visit;
+      if( within )
+      {
+        std::vector<Id> next(num_within + 1, 0);
+        for( size_t i = 0; i < within->size(); i++ )
+          next[(*within)[i] + 1]++;
+        for( size_t w = 0; w < num_within; w++ )
+          next[w + 1] += next[w];
+        visit.resize(within->size());
+        for( size_t i = 0; i < within->size(); i++ )
+          visit[next[(*within)[i]]++] = static_cast<Id>(i);
+      }
+
+      // A counting sort by key; it is stable, so each key's transitions
+      // stay in the order they were visited in.
+      order.resize(keys.size());
+      std::vector<Id> next(offsets.begin(), offsets.end() - 1);
+      for( size_t k = 0; k < keys.size(); k++ )
+      {
+        Id i = within ? visit[k] : static_cast<Id>(k);
+        order[next[keys[i]]++] = i;
+      }
+    }
+
+    DenseTransitions::Slice DenseTransitions::Csr::slice( Id key ) const
+    {
+      return Slice(order.empty() ? 0 : &order[0], offsets[key], offsets[key + 1]);
+    }
+
+
+    void DenseTransitions::build( Calls const & calls, Internals const & internals, Returns const & returns )
+    {
+      clear();
+
+      for( Calls::const_iterator it = calls.begin(); it != calls.end(); it++ )
+      {
+        states_.push_back(it->first);
+        symbols_.push_back(it->second);
+        states_.push_back(it->third);
+      }
+      for( Internals::const_iterator it = internals.begin(); it != internals.end(); it++ )
+      {
+        states_.push_back(it->first);
+        symbols_.push_back(it->second);
+        states_.push_back(it->third);
+      }
+      for( Returns::const_iterator it = returns.begin(); it != returns.end(); it++ )
+      {
+        states_.push_back(it->first);
+        states_.push_back(it->second);
+        symbols_.push_back(it->third);
+        states_.push_back(it->fourth);
+      }
+      sortUnique(states_);
+      sortUnique(symbols_);
+      std::vector<State>(states_).swap(states_);
+      std::vector<Symbol>(symbols_).swap(symbols_);
+
+      size_t const num_states = states_.size();
+      size_t const num_symbols = symbols_.size();
+      std::vector<Id> keys, syms;
+
+      // The sets are ordered lexicographically and the renumbering is
+      // monotone, so the arrays come out sorted.
+      internals_.reserve(internals.size());
+      for( Internals::const_iterator it = internals.begin(); it != internals.end(); it++ )
+      {
+        Triple t = { denseId(states_, it->first), denseId(symbols_, it->second), denseId(states_, it->third) };
+        internals_.push_back(t);
+      }
+      keys.resize(internals_.size());
+      syms.resize(internals_.size());
+      for( size_t i = 0; i < internals_.size(); i++ )
+      {
+        keys[i] = internals_[i].first;
+        syms[i] = internals_[i].second;
+      }
+      internal_from_.build(num_states, keys, true);
+      internal_symbol_.build(num_symbols, syms, false);
+      for( size_t i = 0; i < internals_.size(); i++ )
+        keys[i] = internals_[i].third;
+      internal_to_.build(num_states, keys, false, &syms, num_symbols);
+
+      calls_.reserve(calls.size());
+      for( Calls::const_iterator it = calls.begin(); it != calls.end(); it++ )
+      {
+        Triple t = { denseId(states_, it->first), denseId(symbols_, it->second), denseId(states_, it->third) };
+        calls_.push_back(t);
+      }
+      keys.resize(calls_.size());
+      syms.resize(calls_.size());
+      for( size_t i = 0; i < calls_.size(); i++ )
+      {
+        keys[i] = calls_[i].first;
+        syms[i] = calls_[i].second;
+      }
+      call_from_.build(num_states, keys, true);
+      call_symbol_.build(num_symbols, syms, false);
+      for( size_t i = 0; i < calls_.size(); i++ )
+        keys[i] = calls_[i].third;
+      call_to_.build(num_states, keys, false, &syms, num_symbols);
+
+      returns_.reserve(returns.size());
+      for( Returns::const_iterator it = returns.begin(); it != returns.end(); it++ )
+      {
+        Quad q = { denseId(states_, it->first), denseId(states_, it->second),
+                   denseId(symbols_, it->third), denseId(states_, it->fourth) };
+        returns_.push_back(q);
+      }
+      keys.resize(returns_.size());
+      syms.resize(returns_.size());
+      for( size_t i = 0; i < returns_.size(); i++ )
+      {
+        keys[i] = returns_[i].first;
+        syms[i] = returns_[i].third;
+      }
+      return_exit_.build(num_states, keys, true);
+      return_exit_symbol_.build(num_states, keys, false, &syms, num_symbols);
+      return_symbol_.build(num_symbols, syms, false);
+      for( size_t i = 0; i < returns_.size(); i++ )
+        keys[i] = returns_[i].second;
+      return_pred_.build(num_states, keys, false, &syms, num_symbols);
+      for( size_t i = 0; i < returns_.size(); i++ )
+        keys[i] = returns_[i].fourth;
+      return_to_.build(num_states, keys, false, &syms, num_symbols);
+    }
+
+    void DenseTransitions::clear( )
+    {
+      release(states_);
+      release(symbols_);
+      release(internals_);
+      release(calls_);
+      release(returns_);
+
+      Csr * indices[] = { &internal_from_, &internal_to_, &call_from_, &call_to_,
+                          &return_exit_, &return_exit_symbol_, &return_pred_, &return_to_,
+                          &internal_symbol_, &call_symbol_, &return_symbol_ };
+      for( size_t i = 0; i < sizeof(indices) / sizeof(indices[0]); i++ )
+      {
+        release(indices[i]->offsets);
+        release(indices[i]->order);
+      }
+    }
+
+    size_t DenseTransitions::memoryUsage( ) const
+    {
+      size_t total = bytes(states_) + bytes(symbols_)
+        + bytes(internals_) + bytes(calls_) + bytes(returns_);
+      Csr const * indices[] = { &internal_from_, &internal_to_, &call_from_, &call_to_,
+                                &return_exit_, &return_exit_symbol_, &return_pred_, &return_to_,
+                                &internal_symbol_, &call_symbol_, &return_symbol_ };
+      for( size_t i = 0; i < sizeof(indices) / sizeof(indices[0]); i++ )
+        total += bytes(indices[i]->offsets) + bytes(indices[i]->order);
+      return total;
+    }
+
+
+    DenseTransitions::Internal DenseTransitions::internal( Id index ) const
+    {
+      Triple const & t = internals_[index];
+      return Internal(states_[t.first], symbols_[t.second], states_[t.third]);
+    }
+
+    DenseTransitions::Call DenseTransitions::call( Id index ) const
+    {
+      Triple const & t = calls_[index];
+      return Call(states_[t.first], symbols_[t.second], states_[t.third]);
+    }
+
+    DenseTransitions::Return DenseTransitions::ret( Id index ) const
+    {
+      Quad const & q = returns_[index];
+      return Return(states_[q.first], states_[q.second], symbols_[q.third], states_[q.fourth]);
+    }
+
+
+    bool DenseTransitions::stateId( State state, Id & id ) const
+    {
+      std::vector<State>::const_iterator place =
+        std::lower_bound(states_.begin(), states_.end(), state);
+      if( place == states_.end() || *place != state )
+        return false;
+      id = static_cast<Id>(place - states_.begin());
+      return true;
+    }
+
+    bool DenseTransitions::symbolId( Symbol sym, Id & id ) const
+    {
+      std::vector<Symbol>::const_iterator place =
+        std::lower_bound(symbols_.begin(), symbols_.end(), sym);
+      if( place == symbols_.end() || *place != sym )
+        return false;
+      id = static_cast<Id>(place - symbols_.begin());
+      return true;
+    }
+
+    /// Narrows 'range', whose transitions are in order of 'field', to
+    /// those whose 'field' is 'id'
+    template<typename T>
+    DenseTransitions::Slice DenseTransitions::narrow( std::vector<T> const & trans, Id T::* field, Slice range, Id id )
+    {
+      // Binary searches for the first position not less than 'id', and
+      // then for the first one greater
+      Id low = range.first;
+      Id high = range.last;
+      while( low < high )
+      {
+        Id mid = low + (high - low) / 2;
+        if( trans[range.at(mid)].*field < id )
+          low = mid + 1;
+        else
+          high = mid;
+      }
+      Id const first = low;
+      high = range.last;
+      while( low < high )
+      {
+        Id mid = low + (high - low) / 2;
+        if( trans[range.at(mid)].*field <= id )
+          low = mid + 1;
+        else
+          high = mid;
+      }
+      return Slice(range.order, first, low);
+    }
+
+    /// Narrows 'range', whose transitions are in order of symbol (kept
+    /// in 'field'), to the transitions labeled 'sym'
+    template<typename T>
+    DenseTransitions::Slice DenseTransitions::bySymbol( std::vector<T> const & trans, Id T::* field, Slice range, Symbol sym ) const
+    {
+      Id id;
+      if( range.empty() || !symbolId(sym, id) )
+        return Slice();
+      return narrow(trans, field, range, id);
+    }
+
+
+    DenseTransitions::Slice DenseTransitions::internalsFrom( State source ) const
+    {
+      Id id;
+      return stateId(source, id) ? internal_from_.slice(id) : Slice();
+    }
+
+    DenseTransitions::Slice DenseTransitions::internalsFrom( State source, Symbol sym ) const
+    {
+      return bySymbol(internals_, &Triple::second, internalsFrom(source), sym);
+    }
+
+    DenseTransitions::Slice DenseTransitions::internalsTo( State target ) const
+    {
+      Id id;
+      return stateId(target, id) ? internal_to_.slice(id) : Slice();
+    }
+
+    DenseTransitions::Slice DenseTransitions::internalsTo( State target, Symbol sym ) const
+    {
+      return bySymbol(internals_, &Triple::second, internalsTo(target), sym);
+    }
+
+    DenseTransitions::Slice DenseTransitions::callsFrom( State callSite ) const
+    {
+      Id id;
+      return stateId(callSite, id) ? call_from_.slice(id) : Slice();
+    }
+
+    DenseTransitions::Slice DenseTransitions::callsFrom( State callSite, Symbol sym ) const
+    {
+      return bySymbol(calls_, &Triple::second, callsFrom(callSite), sym);
+    }
+
+    DenseTransitions::Slice DenseTransitions::callsTo( State entry ) const
+    {
+      Id id;
+      return stateId(entry, id) ? call_to_.slice(id) : Slice();
+    }
+
+    DenseTransitions::Slice DenseTransitions::callsTo( State entry, Symbol sym ) const
+    {
+      return bySymbol(calls_, &Triple::second, callsTo(entry), sym);
+    }
+
+    DenseTransitions::Slice DenseTransitions::returnsFromExit( State exit ) const
+    {
+      Id id;
+      return stateId(exit, id) ? return_exit_.slice(id) : Slice();
+    }
+
+    DenseTransitions::Slice DenseTransitions::returnsFromExit( State exit, Symbol sym ) const
+    {
+      Id id;
+      if( !stateId(exit, id) )
+        return Slice();
+      return bySymbol(returns_, &Quad::third, return_exit_symbol_.slice(id), sym);
+    }
+
+    DenseTransitions::Slice DenseTransitions::returnsFromExit( State exit, State callSite, Symbol sym ) const
+    {
+      // The returns are sorted by exit, then call site, then symbol
+      Id pred;
+      Slice range = returnsFromExit(exit);
+      if( range.empty() || !stateId(callSite, pred) )
+        return Slice();
+      return bySymbol(returns_, &Quad::third, narrow(returns_, &Quad::second, range, pred), sym);
+    }
+
+    DenseTransitions::Slice DenseTransitions::returnsFromPred( State callSite ) const
+    {
+      Id id;
+      return stateId(callSite, id) ? return_pred_.slice(id) : Slice();
+    }
+
+    DenseTransitions::Slice DenseTransitions::returnsFromPred( State callSite, Symbol sym ) const
+    {
+      return bySymbol(returns_, &Quad::third, returnsFromPred(callSite), sym);
+    }
+
+    DenseTransitions::Slice DenseTransitions::returnsTo( State returnSite ) const
+    {
+      Id id;
+      return stateId(returnSite, id) ? return_to_.slice(id) : Slice();
+    }
+
+    DenseTransitions::Slice DenseTransitions::returnsTo( State returnSite, Symbol sym ) const
+    {
+      return bySymbol(returns_, &Quad::third, returnsTo(returnSite), sym);
+    }
+
+
+    DenseTransitions::Slice DenseTransitions::internalsOn( Symbol sym ) const
+    {
+      Id id;
+      return symbolId(sym, id) ? internal_symbol_.slice(id) : Slice();
+    }
+
+    DenseTransitions::Slice DenseTransitions::callsOn( Symbol sym ) const
+    {
+      Id id;
+      return symbolId(sym, id) ? call_symbol_.slice(id) : Slice();
+    }
+
+    DenseTransitions::Slice DenseTransitions::returnsOn( Symbol sym ) const
+    {
+      Id id;
+      return symbolId(sym, id) ? return_symbol_.slice(id) : Slice();
+    }
+
+
+    bool DenseTransitions::containsInternal( Internal const & trans ) const
+    {
+      Slice s = internalsFrom(trans.first, trans.second);
+      for( Id k = s.first; k != s.last; k++ )
+      {
+        if( states_[internals_[k].third] == trans.third )
+          return true;
+      }
+      return false;
+    }
+
+    bool DenseTransitions::containsCall( Call const & trans ) const
+    {
+      Slice s = callsFrom(trans.first, trans.second);
+      for( Id k = s.first; k != s.last; k++ )
+      {
+        if( states_[calls_[k].third] == trans.third )
+          return true;
+      }
+      return false;
+    }
+
+    bool DenseTransitions::containsReturn( Return const & trans ) const
+    {
+      Slice s = returnsFromExit(trans.first);
+      for( Id k = s.first; k != s.last; k++ )
+      {
+        if( ret(k) == trans )
+          return true;
+      }
+      return false;
+    }
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
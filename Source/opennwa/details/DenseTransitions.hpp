@@ -0,0 +1,180 @@
+#ifndef wali_nwa_DenseTransitions_GUARD
+#define wali_nwa_DenseTransitions_GUARD 1
+
+#include "opennwa/NwaFwd.hpp"
+#include "opennwa/details/TransitionInfo.hpp"
+
+// std::c++
+#include <vector>
+
+namespace opennwa
+{
+  namespace details
+  {
+
+    /**
+     *
+     * A read-only, compact copy of the per-state transition maps kept by
+     * TransitionInfo, built by TransitionStorage::freeze().
+     *
+     * States and symbols are renumbered densely (in increasing order, so
+     * the dense order agrees with the order of the std::sets). Each kind
+     * of transition is stored once, sorted, as small integers; each
+     * lookup direction is a CSR index: an offsets array over the state
+     * ids and, for every direction but the one the array is sorted by,
+     * a permutation of transition indices. Within a state, the
+     * permutations are in order of symbol, so a (state, symbol) lookup
+     * is a binary search. There is also one index by symbol alone for
+     * each kind.
+     *
+     */
+    class DenseTransitions
+    {
+    public:
+      typedef TransitionInfo::Internal Internal;
+      typedef TransitionInfo::Call Call;
+      typedef TransitionInfo::Return Return;
+
+      typedef TransitionInfo::Internals Internals;
+      typedef TransitionInfo::Calls Calls;
+      typedef TransitionInfo::Returns Returns;
+
+      typedef unsigned Id;
+
+      /**
+       * A run of transitions of one kind: positions [first, last) of a
+       * CSR index. at() maps a position to the transition's index in its
+       * array.
+       */
+      struct Slice
+      {
+        Id const * order;
+        Id first;
+        Id last;
+
+        Slice() : order(0), first(0), last(0) {}
+        Slice(Id const * o, Id f, Id l) : order(o), first(f), last(l) {}
+
+        bool empty() const { return first == last; }
+        Id size() const { return last - first; }
+        Id at(Id position) const { return order ? order[position] : position; }
+      };
+
+      /**
+       * @brief replaces the contents with the given transitions
+       */
+      void build( Calls const & calls, Internals const & internals, Returns const & returns );
+
+      /**
+       * @brief releases all storage
+       */
+      void clear( );
+
+      /**
+       * @brief the number of bytes held by the arrays
+       */
+      size_t memoryUsage( ) const;
+
+      // Reconstruct the transition at an index
+
+      Internal internal( Id index ) const;
+      Call call( Id index ) const;
+      Return ret( Id index ) const;
+
+      // Lookups by state. States that do not appear give an empty slice.
+
+      Slice internalsFrom( State source ) const;
+      Slice internalsFrom( State source, Symbol sym ) const;
+      Slice internalsTo( State target ) const;
+      Slice internalsTo( State target, Symbol sym ) const;
+      Slice callsFrom( State callSite ) const;
+      Slice callsFrom( State callSite, Symbol sym ) const;
+      Slice callsTo( State entry ) const;
+      Slice callsTo( State entry, Symbol sym ) const;
+      Slice returnsFromExit( State exit ) const;
+      Slice returnsFromExit( State exit, Symbol sym ) const;
+      Slice returnsFromExit( State exit, State callSite, Symbol sym ) const;
+      Slice returnsFromPred( State callSite ) const;
+      Slice returnsFromPred( State callSite, Symbol sym ) const;
+      Slice returnsTo( State returnSite ) const;
+      Slice returnsTo( State returnSite, Symbol sym ) const;
+
+      // Lookups by symbol alone
+
+      Slice internalsOn( Symbol sym ) const;
+      Slice callsOn( Symbol sym ) const;
+      Slice returnsOn( Symbol sym ) const;
+
+      // Membership
+
+      bool containsInternal( Internal const & trans ) const;
+      bool containsCall( Call const & trans ) const;
+      bool containsReturn( Return const & trans ) const;
+
+    private:
+      struct Triple
+      {
+        Id first, second, third;
+      };
+
+      struct Quad
+      {
+        Id first, second, third, fourth;
+      };
+
+      /**
+       * One lookup direction. 'order' is left empty when the transitions
+       * are already sorted by the key.
+       */
+      struct Csr
+      {
+        std::vector<Id> offsets;
+        std::vector<Id> order;
+
+        /// Each key's transitions are ordered by 'within' if it is
+        /// given, and by index otherwise
+        void build( size_t num_keys, std::vector<Id> const & keys, bool sorted,
+                    std::vector<Id> const * within = 0, size_t num_within = 0 );
+        Slice slice( Id key ) const;
+      };
+
+      bool stateId( State state, Id & id ) const;
+      bool symbolId( Symbol sym, Id & id ) const;
+
+      template<typename T>
+      static Slice narrow( std::vector<T> const & trans, Id T::* field, Slice range, Id id );
+      template<typename T>
+      Slice bySymbol( std::vector<T> const & trans, Id T::* field, Slice range, Symbol sym ) const;
+
+      std::vector<State> states_;
+      std::vector<Symbol> symbols_;
+
+      std::vector<Triple> internals_;   // sorted by (source, symbol, target)
+      std::vector<Triple> calls_;       // sorted by (call site, symbol, entry)
+      std::vector<Quad> returns_;       // sorted by (exit, call site, symbol, return site)
+
+      Csr internal_from_;
+      Csr internal_to_;
+      Csr call_from_;
+      Csr call_to_;
+      Csr return_exit_;
+      Csr return_exit_symbol_;   // by exit, then symbol
+      Csr return_pred_;
+      Csr return_to_;
+
+      Csr internal_symbol_;
+      Csr call_symbol_;
+      Csr return_symbol_;
+    };
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+
+#endif
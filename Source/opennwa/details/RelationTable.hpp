@@ -0,0 +1,126 @@
+#ifndef wali_nwa_RelationTable_GUARD
+#define wali_nwa_RelationTable_GUARD 1
+
+// std::c++
+#include <cassert>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace opennwa
+{
+  namespace details
+  {
+
+    /**
+     *
+     * A set of relations that numbers them in the order they are added.
+     *
+     * The relations are kept in a deque (so references to them stay valid
+     * as more are added) and found through an open-addressing hash table
+     * of their ids, with linear probing. Each relation's hash is stored
+     * beside it, so the table grows and probes without rehashing any
+     * relation, and full comparisons are made only when hashes agree.
+     *
+     * 'Hash' is one of the RelationHash functors from the RelationOps
+     * headers.
+     *
+     */
+    template<typename Relation, typename Hash>
+    class RelationTable
+    {
+    public:
+      typedef size_t Id;
+
+      explicit RelationTable( Hash const & hash = Hash() )
+        : hash_(hash)
+        , slots_(16, none())
+      {}
+
+      /// The id meaning "not present"
+      static Id none( ) { return static_cast<Id>(-1); }
+
+      /**
+       * @brief adds 'relation' if it is new
+       *
+       * @return the relation's id, and whether it was added
+       */
+      std::pair<Id, bool> insert( Relation const & relation )
+      {
+        size_t hash = hash_(relation);
+        size_t slot = probe(relation, hash);
+        if( slots_[slot] != none() )
+          return std::make_pair(slots_[slot], false);
+
+        Id id = relations_.size();
+        relations_.push_back(relation);
+        hashes_.push_back(hash);
+        slots_[slot] = id;
+
+        // Keep the load factor at most 1/2
+        if( 2 * relations_.size() > slots_.size() )
+          grow();
+        return std::make_pair(id, true);
+      }
+
+      /// @return the id of 'relation', or none()
+      Id find( Relation const & relation ) const
+      {
+        return slots_[probe(relation, hash_(relation))];
+      }
+
+      Relation const & operator[]( Id id ) const
+      {
+        assert(id < relations_.size());
+        return relations_[id];
+      }
+
+      size_t size( ) const { return relations_.size(); }
+      bool empty( ) const { return relations_.empty(); }
+
+    private:
+      /// The slot that holds 'relation', or the empty slot where it
+      /// would go
+      size_t probe( Relation const & relation, size_t hash ) const
+      {
+        size_t const mask = slots_.size() - 1;
+        size_t slot = hash & mask;
+        while( slots_[slot] != none()
+               && !(hashes_[slots_[slot]] == hash && relations_[slots_[slot]] == relation) )
+        {
+          slot = (slot + 1) & mask;
+        }
+        return slot;
+      }
+
+      void grow( )
+      {
+        std::vector<Id> bigger(2 * slots_.size(), none());
+        size_t const mask = bigger.size() - 1;
+        for( Id id = 0; id < relations_.size(); id++ )
+        {
+          size_t slot = hashes_[id] & mask;
+          while( bigger[slot] != none() )
+            slot = (slot + 1) & mask;
+          bigger[slot] = id;
+        }
+        slots_.swap(bigger);
+      }
+
+      Hash hash_;
+      std::deque<Relation> relations_;
+      std::vector<size_t> hashes_;    // parallel to relations_
+      std::vector<Id> slots_;         // a power of two in size
+    };
+
+  }
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+
+#endif
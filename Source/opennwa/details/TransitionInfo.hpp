@@ -15,8 +15,10 @@
 #include "wali/Key.hpp" 
  
 // std::c++
+#include <limits>
 #include <map> 
 #include <set>
+#include <utility>
  
 namespace opennwa
 { 
@@ -64,6 +66,21 @@ namespace opennwa
       typedef std::map<St,Ret> RetMap;
 #endif
 
+      // Secondary indexes: transitions keyed by (state, symbol), and by
+      // symbol alone
+      typedef std::pair<State,Symbol> StateSymbol;
+      typedef std::map<StateSymbol,Internals> IntraSymMap;
+      typedef std::map<StateSymbol,Calls> CallSymMap;
+      typedef std::map<StateSymbol,Returns> RetSymMap;
+      typedef std::map<Symbol,Internals> SymIntraMap;
+      typedef std::map<Symbol,Calls> SymCallMap;
+      typedef std::map<Symbol,Returns> SymRetMap;
+
+      // The transitions matching a (state, symbol) lookup
+      typedef std::pair<InternalIterator,InternalIterator> InternalRange;
+      typedef std::pair<CallIterator,CallIterator> CallRange;
+      typedef std::pair<ReturnIterator,ReturnIterator> ReturnRange;
+
       static Internals const & emptyInternals() {
         static Internals r;
         return r;
@@ -100,6 +117,16 @@ namespace opennwa
         exit_RTrans = other.exit_RTrans;
         pred_RTrans = other.pred_RTrans;
         ret_RTrans = other.ret_RTrans;
+
+        to_sym_ITrans = other.to_sym_ITrans;
+        entry_sym_CTrans = other.entry_sym_CTrans;
+        exit_sym_RTrans = other.exit_sym_RTrans;
+        pred_sym_RTrans = other.pred_sym_RTrans;
+        ret_sym_RTrans = other.ret_sym_RTrans;
+
+        sym_ITrans = other.sym_ITrans;
+        sym_CTrans = other.sym_CTrans;
+        sym_RTrans = other.sym_RTrans;
         
         return *this;
       }
@@ -120,6 +147,9 @@ namespace opennwa
       {
         from_ITrans[intra.first].insert(intra);
         to_ITrans[intra.third].insert(intra);
+
+        to_sym_ITrans[StateSymbol(intra.third, intra.second)].insert(intra);
+        sym_ITrans[intra.second].insert(intra);
       }
       
       /**
@@ -151,6 +181,9 @@ namespace opennwa
           if( it->second.empty() )
             to_ITrans.erase(it);
         }
+
+        eraseFrom(to_sym_ITrans, StateSymbol(intra.third, intra.second), intra);
+        eraseFrom(sym_ITrans, intra.second, intra);
       }
 
       /**
@@ -167,6 +200,9 @@ namespace opennwa
       {
         call_CTrans[call.first].insert(call);
         entry_CTrans[call.third].insert(call);
+
+        entry_sym_CTrans[StateSymbol(call.third, call.second)].insert(call);
+        sym_CTrans[call.second].insert(call);
       }
       
       /**
@@ -198,6 +234,9 @@ namespace opennwa
           if( it->second.empty() )
             entry_CTrans.erase(it);
         }
+
+        eraseFrom(entry_sym_CTrans, StateSymbol(call.third, call.second), call);
+        eraseFrom(sym_CTrans, call.second, call);
       }
       
       /**
@@ -215,6 +254,11 @@ namespace opennwa
         exit_RTrans[ret.first].insert(ret);
         pred_RTrans[ret.second].insert(ret);
         ret_RTrans[ret.fourth].insert(ret);
+
+        exit_sym_RTrans[StateSymbol(ret.first, ret.third)].insert(ret);
+        pred_sym_RTrans[StateSymbol(ret.second, ret.third)].insert(ret);
+        ret_sym_RTrans[StateSymbol(ret.fourth, ret.third)].insert(ret);
+        sym_RTrans[ret.third].insert(ret);
       }
       
       /**
@@ -255,6 +299,11 @@ namespace opennwa
           if( it->second.empty() )
             ret_RTrans.erase(it);
         }
+
+        eraseFrom(exit_sym_RTrans, StateSymbol(ret.first, ret.third), ret);
+        eraseFrom(pred_sym_RTrans, StateSymbol(ret.second, ret.third), ret);
+        eraseFrom(ret_sym_RTrans, StateSymbol(ret.fourth, ret.third), ret);
+        eraseFrom(sym_RTrans, ret.third, ret);
       }
       
       /**
@@ -402,6 +451,174 @@ namespace opennwa
           return it->second;
       }
       
+      /**
+       *
+       * @brief returns the internal transitions from the given state on the given symbol
+       *
+       * The set of transitions from a state is ordered by symbol, so this is
+       * a range of it and needs no index of its own.
+       *
+       * @param - state: the source of the transitions
+       * @param - sym: the symbol of the transitions
+       * @return the range of matching transitions
+       *
+       */
+      InternalRange fromTrans( State state, Symbol sym ) const
+      {
+        Internals const & outgoing = fromTrans(state);
+        return InternalRange(outgoing.lower_bound(Internal(state, sym, 0)),
+                             outgoing.upper_bound(Internal(state, sym, maxState())));
+      }
+
+      /**
+       *
+       * @brief returns the internal transitions to the given state on the given symbol
+       *
+       * @param - state: the target of the transitions
+       * @param - sym: the symbol of the transitions
+       * @return the range of matching transitions
+       *
+       */
+      InternalRange toTrans( State state, Symbol sym ) const
+      {
+        return range(lookup(to_sym_ITrans, StateSymbol(state, sym), emptyInternals()));
+      }
+
+      /**
+       *
+       * @brief returns the call transitions from the given call site on the given symbol
+       *
+       * Like fromTrans(state, sym), this is a range of callTrans(state).
+       *
+       * @param - state: the call site of the transitions
+       * @param - sym: the symbol of the transitions
+       * @return the range of matching transitions
+       *
+       */
+      CallRange callTrans( State state, Symbol sym ) const
+      {
+        Calls const & outgoing = callTrans(state);
+        return CallRange(outgoing.lower_bound(Call(state, sym, 0)),
+                         outgoing.upper_bound(Call(state, sym, maxState())));
+      }
+
+      /**
+       *
+       * @brief returns the call transitions to the given entry point on the given symbol
+       *
+       * @param - state: the entry point of the transitions
+       * @param - sym: the symbol of the transitions
+       * @return the range of matching transitions
+       *
+       */
+      CallRange entryTrans( State state, Symbol sym ) const
+      {
+        return range(lookup(entry_sym_CTrans, StateSymbol(state, sym), emptyCalls()));
+      }
+
+      /**
+       *
+       * @brief returns the return transitions from the given exit point on the given symbol
+       *
+       * @param - state: the exit point of the transitions
+       * @param - sym: the symbol of the transitions
+       * @return the range of matching transitions
+       *
+       */
+      ReturnRange exitTrans( State state, Symbol sym ) const
+      {
+        return range(lookup(exit_sym_RTrans, StateSymbol(state, sym), emptyReturns()));
+      }
+
+      /**
+       *
+       * @brief returns the return transitions from the given exit point and call
+       *        predecessor on the given symbol
+       *
+       * The set of transitions from an exit is ordered by call predecessor and
+       * then by symbol, so this is a range of exitTrans(exit).
+       *
+       * @param - exit: the exit point of the transitions
+       * @param - pred: the call predecessor of the transitions
+       * @param - sym: the symbol of the transitions
+       * @return the range of matching transitions
+       *
+       */
+      ReturnRange exitTrans( State exit, State pred, Symbol sym ) const
+      {
+        Returns const & outgoing = exitTrans(exit);
+        return ReturnRange(outgoing.lower_bound(Return(exit, pred, sym, 0)),
+                           outgoing.upper_bound(Return(exit, pred, sym, maxState())));
+      }
+
+      /**
+       *
+       * @brief returns the return transitions with the given call predecessor on the
+       *        given symbol
+       *
+       * @param - state: the call predecessor of the transitions
+       * @param - sym: the symbol of the transitions
+       * @return the range of matching transitions
+       *
+       */
+      ReturnRange predTrans( State state, Symbol sym ) const
+      {
+        return range(lookup(pred_sym_RTrans, StateSymbol(state, sym), emptyReturns()));
+      }
+
+      /**
+       *
+       * @brief returns the return transitions to the given return site on the given symbol
+       *
+       * @param - state: the return site of the transitions
+       * @param - sym: the symbol of the transitions
+       * @return the range of matching transitions
+       *
+       */
+      ReturnRange retTrans( State state, Symbol sym ) const
+      {
+        return range(lookup(ret_sym_RTrans, StateSymbol(state, sym), emptyReturns()));
+      }
+
+      /**
+       *
+       * @brief returns all internal transitions on the given symbol
+       *
+       * @param - sym: the symbol of the transitions
+       * @return the set of internal transitions labeled 'sym'
+       *
+       */
+      const Internals & symInternals( Symbol sym ) const
+      {
+        return lookup(sym_ITrans, sym, emptyInternals());
+      }
+
+      /**
+       *
+       * @brief returns all call transitions on the given symbol
+       *
+       * @param - sym: the symbol of the transitions
+       * @return the set of call transitions labeled 'sym'
+       *
+       */
+      const Calls & symCalls( Symbol sym ) const
+      {
+        return lookup(sym_CTrans, sym, emptyCalls());
+      }
+
+      /**
+       *
+       * @brief returns all return transitions on the given symbol
+       *
+       * @param - sym: the symbol of the transitions
+       * @return the set of return transitions labeled 'sym'
+       *
+       */
+      const Returns & symReturns( Symbol sym ) const
+      {
+        return lookup(sym_RTrans, sym, emptyReturns());
+      }
+      
       /**
        *  
        * @brief tests whether the given state is the source of any internal transition
@@ -1107,6 +1324,54 @@ namespace opennwa
         exit_RTrans.clear();
         pred_RTrans.clear();
         ret_RTrans.clear();
+
+        to_sym_ITrans.clear();
+        entry_sym_CTrans.clear();
+        exit_sym_RTrans.clear();
+        pred_sym_RTrans.clear();
+        ret_sym_RTrans.clear();
+
+        sym_ITrans.clear();
+        sym_CTrans.clear();
+        sym_RTrans.clear();
+      }
+
+    private:
+
+      static State maxState()
+      {
+        return std::numeric_limits<State>::max();
+      }
+
+      template<typename Map>
+      static typename Map::mapped_type const &
+      lookup( Map const & map, typename Map::key_type const & key,
+              typename Map::mapped_type const & empty )
+      {
+        typename Map::const_iterator it = map.find(key);
+        if( it == map.end() )
+          return empty;
+        return it->second;
+      }
+
+      template<typename Set>
+      static std::pair<typename Set::const_iterator, typename Set::const_iterator>
+      range( Set const & set )
+      {
+        return std::make_pair(set.begin(), set.end());
+      }
+
+      template<typename Map, typename Trans>
+      static void
+      eraseFrom( Map & map, typename Map::key_type const & key, Trans const & trans )
+      {
+        typename Map::iterator it = map.find(key);
+        if( it != map.end() )
+        {
+          it->second.erase(trans);
+          if( it->second.empty() )
+            map.erase(it);
+        }
       }
     
       //
@@ -1125,6 +1390,19 @@ namespace opennwa
       RetMap exit_RTrans;
       RetMap pred_RTrans;  
       RetMap ret_RTrans;
+
+      // Transitions from a state (or call site, or exit and call
+      // predecessor) are ranges of the maps above; the other directions
+      // need their own (state, symbol) index.
+      IntraSymMap to_sym_ITrans;
+      CallSymMap entry_sym_CTrans;
+      RetSymMap exit_sym_RTrans;
+      RetSymMap pred_sym_RTrans;
+      RetSymMap ret_sym_RTrans;
+
+      SymIntraMap sym_ITrans;
+      SymCallMap sym_CTrans;
+      SymRetMap sym_RTrans;
     };
 
 
@@ -11,6 +11,12 @@ namespace opennwa
     // Methods
     //
 
+    TransitionStorage::TransitionStorage( )
+      : info_current(true)
+      , frozen(false)
+    {
+    }
+
     TransitionStorage & TransitionStorage::operator=( const TransitionStorage & other )
     {
       if (this == &other)     
@@ -24,8 +30,65 @@ namespace opennwa
       returnTrans = other.returnTrans;
       
       T_info = other.T_info;
+      info_current = other.info_current;
+      frozen = other.frozen;
+      dense = other.dense;
       return *this;
     }
+
+    //Frozen Storage
+
+    /**
+     *
+     * @brief packs the transitions into a compact, read-only form
+     *
+     */
+    void TransitionStorage::freeze( )
+    {
+      dense.build(callTrans, internalTrans, returnTrans);
+      T_info.clearMaps();
+      info_current = false;
+      frozen = true;
+    }
+
+    /**
+     *
+     * @brief goes back to the per-state maps after freeze()
+     *
+     */
+    void TransitionStorage::thaw( )
+    {
+      if( !frozen )
+        return;
+      info();
+      dense.clear();
+      frozen = false;
+    }
+
+    /**
+     *
+     * @brief tests whether lookups are answered by the dense index
+     *
+     */
+    bool TransitionStorage::isFrozen( ) const
+    {
+      return frozen;
+    }
+
+    TransitionStorage::Info const & TransitionStorage::info( ) const
+    {
+      if( !info_current )
+      {
+        for( CallIterator it = callTrans.begin(); it != callTrans.end(); it++ )
+          T_info.addCall(*it);
+        for( InternalIterator it = internalTrans.begin(); it != internalTrans.end(); it++ )
+          T_info.addIntra(*it);
+        for( ReturnIterator it = returnTrans.begin(); it != returnTrans.end(); it++ )
+          T_info.addRet(*it);
+        info_current = true;
+      }
+      return T_info;
+    }
    
     //Transition Accessors
 
@@ -42,6 +105,41 @@ namespace opennwa
      */
     bool TransitionStorage::getSymbol( State fromSt, State toSt, Symbol & sym ) const
     {
+      if( frozen )
+      {
+        DenseTransitions::Slice from = dense.internalsFrom(fromSt);
+        for( DenseTransitions::Id k = from.first; k != from.last; k++ )
+        {
+          Internal trans = dense.internal(from.at(k));
+          if( toSt == getTarget(trans) )
+          {
+            sym = getInternalSym(trans);
+            return true;
+          }
+        }
+        DenseTransitions::Slice call = dense.callsFrom(fromSt);
+        for( DenseTransitions::Id k = call.first; k != call.last; k++ )
+        {
+          Call trans = dense.call(call.at(k));
+          if( toSt == getEntry(trans) )
+          {
+            sym = getCallSym(trans);
+            return true;
+          }
+        }
+        DenseTransitions::Slice exit = dense.returnsFromExit(fromSt);
+        for( DenseTransitions::Id k = exit.first; k != exit.last; k++ )
+        {
+          Return trans = dense.ret(exit.at(k));
+          if( toSt == getReturnSite(trans) )
+          {
+            sym = getReturnSym(trans);
+            return true;
+          }
+        }
+        return false;
+      }
+
       //Check internal transitions.
       const Info::Internals & from = T_info.fromTrans(fromSt);
       for(Info::InternalIterator it = from.begin(); it != from.end(); it++ )
@@ -99,6 +197,32 @@ namespace opennwa
      */
     bool TransitionStorage::findTrans( State fromSt, Symbol sym, State toSt ) const
     {
+      if( frozen )
+      {
+        DenseTransitions::Slice from = dense.internalsFrom(fromSt);
+        for( DenseTransitions::Id k = from.first; k != from.last; k++ )
+        {
+          Internal trans = dense.internal(from.at(k));
+          if( toSt == getTarget(trans) && ( sym == getInternalSym(trans) || sym == WILD ) )
+            return true;
+        }
+        DenseTransitions::Slice call = dense.callsFrom(fromSt);
+        for( DenseTransitions::Id k = call.first; k != call.last; k++ )
+        {
+          Call trans = dense.call(call.at(k));
+          if( toSt == getEntry(trans) && ( sym == getCallSym(trans) || sym == WILD ) )
+            return true;
+        }
+        DenseTransitions::Slice exit = dense.returnsFromExit(fromSt);
+        for( DenseTransitions::Id k = exit.first; k != exit.last; k++ )
+        {
+          Return trans = dense.ret(exit.at(k));
+          if( toSt == getReturnSite(trans) && ( sym == getReturnSym(trans) || sym == WILD ) )
+            return true;
+        }
+        return false;
+      }
+
       //Check internal transitions.
       const Info::Internals & from = T_info.fromTrans(fromSt);
       for( Info::InternalIterator it = from.begin(); it != from.end(); it++ )
@@ -148,6 +272,13 @@ namespace opennwa
     const TransitionStorage::States TransitionStorage::getReturnSites( State callSite ) const
     {
       States returns;
+      if( frozen )
+      {
+        DenseTransitions::Slice pred = dense.returnsFromPred(callSite);
+        for( DenseTransitions::Id k = pred.first; k != pred.last; k++ )
+          returns.insert(getReturnSite(dense.ret(pred.at(k))));
+        return returns;
+      }
       const Info::Returns & pred = T_info.predTrans(callSite);
       for( Info::ReturnIterator it = pred.begin(); it != pred.end(); it++ )
       {
@@ -168,6 +299,17 @@ namespace opennwa
     TransitionStorage::States TransitionStorage::getReturnSites( State exit, State callSite ) const
     {
       States returns;
+      if( frozen )
+      {
+        DenseTransitions::Slice pred = dense.returnsFromPred(callSite);
+        for( DenseTransitions::Id k = pred.first; k != pred.last; k++ )
+        {
+          Return trans = dense.ret(pred.at(k));
+          if( getExit(trans) == exit )
+            returns.insert(getReturnSite(trans));
+        }
+        return returns;
+      }
       const Info::Returns & pred = T_info.predTrans(callSite);
       for( Info::ReturnIterator it = pred.begin(); it != pred.end(); it++ )
       {
@@ -189,6 +331,17 @@ namespace opennwa
     const TransitionStorage::States TransitionStorage::getCallSites( State exitSite, State returnSite ) const
     {
       States calls;
+      if( frozen )
+      {
+        DenseTransitions::Slice exit = dense.returnsFromExit(exitSite);
+        for( DenseTransitions::Id k = exit.first; k != exit.last; k++ )
+        {
+          Return trans = dense.ret(exit.at(k));
+          if( getReturnSite(trans) == returnSite )
+            calls.insert(getCallSite(trans));
+        }
+        return calls;
+      }
       const Info::Returns & exit = T_info.exitTrans(exitSite);
       for( Info::ReturnIterator it = exit.begin(); it != exit.end(); it++ )
       {
@@ -209,6 +362,13 @@ namespace opennwa
     const TransitionStorage::States TransitionStorage::getEntries( State callSite ) const
     {
       States entries;
+      if( frozen )
+      {
+        DenseTransitions::Slice cll = dense.callsFrom(callSite);
+        for( DenseTransitions::Id k = cll.first; k != cll.last; k++ )
+          entries.insert(getEntry(dense.call(cll.at(k))));
+        return entries;
+      }
       const Info::Calls & cll = T_info.callTrans(callSite);
       for( Info::CallIterator it = cll.begin(); it != cll.end(); it++ )
       {
@@ -228,6 +388,13 @@ namespace opennwa
     const TransitionStorage::States TransitionStorage::getTargets( State source ) const
     {
       States targets;
+      if( frozen )
+      {
+        DenseTransitions::Slice src = dense.internalsFrom(source);
+        for( DenseTransitions::Id k = src.first; k != src.last; k++ )
+          targets.insert(getTarget(dense.internal(src.at(k))));
+        return targets;
+      }
       const Info::Internals & src = T_info.fromTrans(source);
       for( Info::InternalIterator it = src.begin(); it != src.end(); it++ )
       {
@@ -246,6 +413,8 @@ namespace opennwa
      */
     void TransitionStorage::dupTransOutgoing( State orig, State dup )
     { 
+      thaw();
+
       // Duplicate outgoing internal transitions.
       const Info::Internals & from = T_info.fromTrans(orig);
       for( Info::InternalIterator it = from.begin(); it != from.end(); it++ )
@@ -293,6 +462,8 @@ namespace opennwa
      */
     void TransitionStorage::dupTrans( State orig, State dup )
     { 
+      thaw();
+
       //Duplicate outgoing internal transitions.
       const Info::Internals & from = T_info.fromTrans(orig);
       for( Info::InternalIterator it = from.begin(); it != from.end(); it++ )
@@ -401,6 +572,9 @@ namespace opennwa
       returnTrans.clear();
       
       T_info.clearMaps();
+      info_current = true;
+      frozen = false;
+      dense.clear();
     }
     
     /**
@@ -464,7 +638,9 @@ namespace opennwa
      *
      */ 
     bool TransitionStorage::addCall( const Call & addTrans )
-    {     
+    {
+      thaw();
+     
       bool added = callTrans.insert(addTrans).second;
 
       if (added) {
@@ -500,6 +676,8 @@ namespace opennwa
      */
     bool TransitionStorage::addInternal( const Internal & addTrans )
     {
+      thaw();
+
       bool added = internalTrans.insert(addTrans).second;
 
       if(added) {
@@ -536,6 +714,8 @@ namespace opennwa
      */
     bool TransitionStorage::addReturn( const Return & addTrans )
     {
+      thaw();
+
       bool added = returnTrans.insert(addTrans).second;
 
       if (added) {
@@ -606,6 +786,8 @@ namespace opennwa
      */
     bool TransitionStorage::removeCall( const Call & removeTrans )
     {
+      thaw();
+
       size_t erased = callTrans.erase(removeTrans);
       if (erased > 0) {
         T_info.removeCall(removeTrans);
@@ -641,7 +823,9 @@ namespace opennwa
      *
      */
     bool TransitionStorage::removeInternal( const Internal & removeTrans )
-    {     
+    {
+      thaw();
+     
       size_t erased = internalTrans.erase(removeTrans);
       if (erased > 0) {
         T_info.removeIntra(removeTrans);
@@ -679,6 +863,8 @@ namespace opennwa
      */
     bool TransitionStorage::removeReturn( const Return & removeTrans )
     {
+      thaw();
+
       size_t erased = returnTrans.erase(removeTrans);
       if (erased > 0) {
         T_info.removeRet(removeTrans);
@@ -717,6 +903,8 @@ namespace opennwa
      */
     bool TransitionStorage::isCall( const Call & trans ) const
     {
+      if( frozen )
+        return dense.containsCall(trans);
       Calls const & outgoing = T_info.callTrans(trans.first);
       return outgoing.count(trans) > 0;
     }
@@ -751,6 +939,8 @@ namespace opennwa
      */
     bool TransitionStorage::isInternal( const Internal & trans ) const
     {
+      if( frozen )
+        return dense.containsInternal(trans);
       Internals const & outgoing = T_info.fromTrans(trans.first);
       return (outgoing.count(trans) > 0);
     }
@@ -786,6 +976,8 @@ namespace opennwa
      */
     bool TransitionStorage::isReturn( const Return & trans ) const
     {
+      if( frozen )
+        return dense.containsReturn(trans);
       Returns const & outgoing = T_info.exitTrans(trans.first);
       return (outgoing.count(trans) > 0);
     } 
@@ -1114,7 +1306,7 @@ namespace opennwa
      */
     const TransitionStorage::Internals & TransitionStorage::getTransFrom( State state ) const
     {
-      return T_info.fromTrans( state );
+      return info().fromTrans( state );
     }
     
     /**
@@ -1127,7 +1319,7 @@ namespace opennwa
      */
     const TransitionStorage::Internals & TransitionStorage::getTransTo( State state ) const
     {
-      return T_info.toTrans( state );
+      return info().toTrans( state );
     }
     
     /**
@@ -1140,7 +1332,7 @@ namespace opennwa
      */
     const TransitionStorage::Calls & TransitionStorage::getTransCall( State state ) const
     {
-      return T_info.callTrans( state );
+      return info().callTrans( state );
     }
     
     /**
@@ -1153,7 +1345,7 @@ namespace opennwa
      */
     const TransitionStorage::Calls & TransitionStorage::getTransEntry( State state ) const
     {
-      return T_info.entryTrans( state );
+      return info().entryTrans( state );
     }
     
     /**
@@ -1166,7 +1358,7 @@ namespace opennwa
      */
     const TransitionStorage::Returns & TransitionStorage::getTransExit( State state ) const
     {
-      return T_info.exitTrans( state );
+      return info().exitTrans( state );
     }
     
     /**
@@ -1179,7 +1371,7 @@ namespace opennwa
      */
     const TransitionStorage::Returns & TransitionStorage::getTransPred( State state ) const
     {
-      return T_info.predTrans( state );
+      return info().predTrans( state );
     }
     
     /**
@@ -1192,7 +1384,84 @@ namespace opennwa
      */
     const TransitionStorage::Returns & TransitionStorage::getTransRet( State state ) const
     {
-      return T_info.retTrans( state );
+      return info().retTrans( state );
+    }
+
+    TransitionStorage::InternalRange TransitionStorage::getTransFrom( State state, Symbol sym ) const
+    {
+      if( frozen )
+        return InternalRangeIterator::range(dense, &DenseTransitions::internal, dense.internalsFrom(state, sym));
+      return InternalRangeIterator::range(info().fromTrans( state, sym ));
+    }
+
+    TransitionStorage::InternalRange TransitionStorage::getTransTo( State state, Symbol sym ) const
+    {
+      if( frozen )
+        return InternalRangeIterator::range(dense, &DenseTransitions::internal, dense.internalsTo(state, sym));
+      return InternalRangeIterator::range(info().toTrans( state, sym ));
+    }
+
+    TransitionStorage::CallRange TransitionStorage::getTransCall( State state, Symbol sym ) const
+    {
+      if( frozen )
+        return CallRangeIterator::range(dense, &DenseTransitions::call, dense.callsFrom(state, sym));
+      return CallRangeIterator::range(info().callTrans( state, sym ));
+    }
+
+    TransitionStorage::CallRange TransitionStorage::getTransEntry( State state, Symbol sym ) const
+    {
+      if( frozen )
+        return CallRangeIterator::range(dense, &DenseTransitions::call, dense.callsTo(state, sym));
+      return CallRangeIterator::range(info().entryTrans( state, sym ));
+    }
+
+    TransitionStorage::ReturnRange TransitionStorage::getTransExit( State state, Symbol sym ) const
+    {
+      if( frozen )
+        return ReturnRangeIterator::range(dense, &DenseTransitions::ret, dense.returnsFromExit(state, sym));
+      return ReturnRangeIterator::range(info().exitTrans( state, sym ));
+    }
+
+    TransitionStorage::ReturnRange TransitionStorage::getTransExit( State exit, State pred, Symbol sym ) const
+    {
+      if( frozen )
+        return ReturnRangeIterator::range(dense, &DenseTransitions::ret, dense.returnsFromExit(exit, pred, sym));
+      return ReturnRangeIterator::range(info().exitTrans( exit, pred, sym ));
+    }
+
+    TransitionStorage::ReturnRange TransitionStorage::getTransPred( State state, Symbol sym ) const
+    {
+      if( frozen )
+        return ReturnRangeIterator::range(dense, &DenseTransitions::ret, dense.returnsFromPred(state, sym));
+      return ReturnRangeIterator::range(info().predTrans( state, sym ));
+    }
+
+    TransitionStorage::ReturnRange TransitionStorage::getTransRet( State state, Symbol sym ) const
+    {
+      if( frozen )
+        return ReturnRangeIterator::range(dense, &DenseTransitions::ret, dense.returnsTo(state, sym));
+      return ReturnRangeIterator::range(info().retTrans( state, sym ));
+    }
+
+    TransitionStorage::InternalRange TransitionStorage::getInternalsOn( Symbol sym ) const
+    {
+      if( frozen )
+        return InternalRangeIterator::range(dense, &DenseTransitions::internal, dense.internalsOn(sym));
+      return InternalRangeIterator::range(info().symInternals( sym ));
+    }
+
+    TransitionStorage::CallRange TransitionStorage::getCallsOn( Symbol sym ) const
+    {
+      if( frozen )
+        return CallRangeIterator::range(dense, &DenseTransitions::call, dense.callsOn(sym));
+      return CallRangeIterator::range(info().symCalls( sym ));
+    }
+
+    TransitionStorage::ReturnRange TransitionStorage::getReturnsOn( Symbol sym ) const
+    {
+      if( frozen )
+        return ReturnRangeIterator::range(dense, &DenseTransitions::ret, dense.returnsOn(sym));
+      return ReturnRangeIterator::range(info().symReturns( sym ));
     }
     
     /**
@@ -1207,6 +1476,8 @@ namespace opennwa
      */
     bool TransitionStorage::isFrom( State state ) const
     {
+      if( frozen )
+        return !dense.internalsFrom( state ).empty();
       return T_info.isFrom( state );
     }
     
@@ -1222,6 +1493,8 @@ namespace opennwa
      */
     bool TransitionStorage::isTo( State state ) const
     { 
+      if( frozen )
+        return !dense.internalsTo( state ).empty();
       return T_info.isTo( state );
     }
     
@@ -1237,6 +1510,8 @@ namespace opennwa
      */
     bool TransitionStorage::isCall( State state ) const
     {
+      if( frozen )
+        return !dense.callsFrom( state ).empty();
       return T_info.isCall( state );
     }
     
@@ -1252,6 +1527,8 @@ namespace opennwa
      */
     bool TransitionStorage::isEntry( State state ) const
     {
+      if( frozen )
+        return !dense.callsTo( state ).empty();
       return T_info.isEntry( state );
     }
     
@@ -1267,6 +1544,8 @@ namespace opennwa
      */
     bool TransitionStorage::isExit( State state ) const
     {
+      if( frozen )
+        return !dense.returnsFromExit( state ).empty();
       return T_info.isExit( state );
     }
     
@@ -1282,6 +1561,8 @@ namespace opennwa
      */
     bool TransitionStorage::isPred( State state ) const
     {
+      if( frozen )
+        return !dense.returnsFromPred( state ).empty();
       return T_info.isPred( state );
     }
     
@@ -1297,6 +1578,8 @@ namespace opennwa
      */
     bool TransitionStorage::isRet( State state ) const
     {
+      if( frozen )
+        return !dense.returnsTo( state ).empty();
       return T_info.isRet( state );
     }
 
@@ -1327,6 +1610,8 @@ namespace opennwa
      */
     bool TransitionStorage::removeCallTransWith( State state )
     {
+      thaw();
+
       Calls outgoing = T_info.callTrans(state);
       Calls incoming = T_info.entryTrans(state);
 
@@ -1355,6 +1640,8 @@ namespace opennwa
      */
     bool TransitionStorage::removeInternalTransWith( State state )
     {
+      thaw();
+
       Internals outgoing = T_info.fromTrans(state);
       Internals incoming = T_info.toTrans(state);
 
@@ -1385,6 +1672,8 @@ namespace opennwa
      */
     bool TransitionStorage::removeReturnTransWith( State state )
     {
+      thaw();
+
       Returns outgoing = T_info.exitTrans(state);
       Returns incoming = T_info.retTrans(state);
       Returns predgoing = T_info.predTrans(state);
@@ -1435,14 +1724,8 @@ namespace opennwa
      */
     bool TransitionStorage::removeCallTransSym( Symbol sym )
     {
-      Calls removeTrans;
-
-      //Find transitions to remove.
-      for( CallIterator cit = callTrans.begin(); cit != callTrans.end(); cit++ )
-      {
-        if( getCallSym(*cit) == sym )
-          removeTrans.insert(*cit);
-      }
+      thaw();
+      Calls removeTrans = T_info.symCalls(sym);
 
       //Remove transitions.
       for( CallIterator rit = removeTrans.begin(); rit != removeTrans.end(); rit++ )
@@ -1463,14 +1746,8 @@ namespace opennwa
      */
     bool TransitionStorage::removeInternalTransSym( Symbol sym )
     {
-      Internals removeTrans;
-
-      //Find transitions to remove.
-      for( InternalIterator iit = internalTrans.begin(); iit != internalTrans.end(); iit++ )
-      {
-        if( getInternalSym(*iit) == sym )
-          removeTrans.insert(*iit);
-      }
+      thaw();
+      Internals removeTrans = T_info.symInternals(sym);
 
       //Remove transitions.
       for( InternalIterator rit = removeTrans.begin(); rit != removeTrans.end(); rit++ )
@@ -1491,14 +1768,8 @@ namespace opennwa
      */
     bool TransitionStorage::removeReturnTransSym( Symbol sym )
     {
-      Returns removeTrans;
-
-      //Find transitions to remove.
-      for( ReturnIterator rit = returnTrans.begin(); rit != returnTrans.end(); rit++ )
-      {
-        if( getReturnSym(*rit) == sym )
-          removeTrans.insert(*rit);
-      }
+      thaw();
+      Returns removeTrans = T_info.symReturns(sym);
 
       //Remove transitions.
       for( ReturnIterator rit = removeTrans.begin(); rit != removeTrans.end(); rit++ )
@@ -1521,18 +1792,14 @@ namespace opennwa
      */
     bool TransitionStorage::callExists( State from, Symbol sym ) const
     {
-      Calls const & outgoing = T_info.callTrans(from);
+      if( frozen )
+        return !dense.callsFrom(from, sym).empty();
 
-      for( CallIterator cit = outgoing.begin(); cit != outgoing.end(); cit++ )
-      {
-        if( getCallSym(*cit) == sym )
-          return true;
-      }  
-      return false;    
+      CallRange outgoing = T_info.callTrans(from, sym);
+      return outgoing.first != outgoing.second;
     }
     
     /**
-     * Q: how can this be optimized?
      * @brief provides access to all call transitions with the given from state
      *        and symbol in this collection of transitions
      *
@@ -1544,18 +1811,19 @@ namespace opennwa
     const TransitionStorage::Calls TransitionStorage::getCalls( State from, Symbol sym ) const 
     {
       Calls result;
-      Calls const & outgoing = T_info.callTrans(from);
-
-      for( CallIterator cit = outgoing.begin(); cit != outgoing.end(); cit++ )
+      if( frozen )
       {
-        if( getCallSym(*cit) == sym )
-          result.insert(*cit);
-      } 
+        DenseTransitions::Slice s = dense.callsFrom(from, sym);
+        for( DenseTransitions::Id k = s.first; k != s.last; k++ )
+          result.insert(result.end(), dense.call(s.at(k)));
+        return result;
+      }
+      CallRange outgoing = T_info.callTrans(from, sym);
+      result.insert(outgoing.first, outgoing.second);
       return result;
     }
     
     /**
-     * Q: how can this be optimized?
      * @brief test if there exists an internal transition with the given from state 
      *        and symbol in this collection of transitions 
      *
@@ -1567,18 +1835,14 @@ namespace opennwa
      */
     bool TransitionStorage::internalExists( State from, Symbol sym ) const
     {
-      Internals const & outgoing = T_info.fromTrans(from);
+      if( frozen )
+        return !dense.internalsFrom(from, sym).empty();
 
-      for( InternalIterator iit = outgoing.begin(); iit != outgoing.end(); iit++ )
-      {
-        if( getInternalSym(*iit) == sym )
-          return true;    
-      }     
-      return false;
+      InternalRange outgoing = T_info.fromTrans(from, sym);
+      return outgoing.first != outgoing.second;
     }
     
     /**
-     * Q: how can this be optimized?
      * @brief provides access to all internal transitions with the given from 
      *        state and symbol in this collection of transitions
      *
@@ -1590,13 +1854,15 @@ namespace opennwa
     const TransitionStorage::Internals TransitionStorage::getInternals( State from, Symbol sym ) const
     {
       Internals result;
-      Internals const & outgoing = T_info.fromTrans(from);
-
-      for( InternalIterator iit = outgoing.begin(); iit != outgoing.end(); iit++ )
+      if( frozen )
       {
-        if( getInternalSym(*iit) == sym )
-          result.insert(*iit);
-      } 
+        DenseTransitions::Slice s = dense.internalsFrom(from, sym);
+        for( DenseTransitions::Id k = s.first; k != s.last; k++ )
+          result.insert(result.end(), dense.internal(s.at(k)));
+        return result;
+      }
+      InternalRange outgoing = T_info.fromTrans(from, sym);
+      result.insert(outgoing.first, outgoing.second);
       return result;
     }
     
@@ -1611,12 +1877,19 @@ namespace opennwa
      */
     const TransitionStorage::Internals TransitionStorage::getInternalsFrom( State from ) const
     {
+      if( frozen )
+      {
+        Internals result;
+        DenseTransitions::Slice s = dense.internalsFrom(from);
+        for( DenseTransitions::Id k = s.first; k != s.last; k++ )
+          result.insert(result.end(), dense.internal(s.at(k)));
+        return result;
+      }
       return T_info.fromTrans(from);
     }
 
 
     /**
-     * Q: how can this be optimized?
      * @brief test if there exists a return transition with the given from state, 
      *        predecessor state, and symbol in this collection of transitions 
      *
@@ -1629,18 +1902,23 @@ namespace opennwa
      */
     bool TransitionStorage::returnExists( State from, State pred, Symbol sym ) const
     {
-      Returns const & outgoing = T_info.exitTrans(from);
-
-      for( ReturnIterator rit = outgoing.begin(); rit != outgoing.end(); rit++ )
+      if( frozen )
       {
-        if( (getCallSite(*rit) == pred) && (getReturnSym(*rit) == sym) )
-          return true;      
-      }     
-      return false;
+        DenseTransitions::Slice s = dense.returnsFromExit(from);
+        for( DenseTransitions::Id k = s.first; k != s.last; k++ )
+        {
+          Return trans = dense.ret(s.at(k));
+          if( (getCallSite(trans) == pred) && (getReturnSym(trans) == sym) )
+            return true;
+        }
+        return false;
+      }
+
+      ReturnRange outgoing = T_info.exitTrans(from, pred, sym);
+      return outgoing.first != outgoing.second;
     }   
     
     /**
-     * Q: how can this be optimized?
      * @brief provides access to all return transitions with the given from
      *        state and symbol in this collection of transitions
      *
@@ -1652,13 +1930,19 @@ namespace opennwa
     const TransitionStorage::Returns TransitionStorage::getReturns( State from, Symbol sym ) const
     {
       Returns result;
-      Returns const & outgoing = T_info.exitTrans(from);
-
-      for( ReturnIterator rit = outgoing.begin(); rit != outgoing.end(); rit++ )
+      if( frozen )
       {
-        if( (getExit(*rit) == from) && (getReturnSym(*rit) == sym) )
-          result.insert(*rit);
-      } 
+        DenseTransitions::Slice s = dense.returnsFromExit(from);
+        for( DenseTransitions::Id k = s.first; k != s.last; k++ )
+        {
+          Return trans = dense.ret(s.at(k));
+          if( getReturnSym(trans) == sym )
+            result.insert(result.end(), trans);
+        }
+        return result;
+      }
+      ReturnRange outgoing = T_info.exitTrans(from, sym);
+      result.insert(outgoing.first, outgoing.second);
       return result;
     }
 
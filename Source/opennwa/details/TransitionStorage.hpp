@@ -13,9 +13,12 @@
 #include "wali/KeyContainer.hpp"
 #include "opennwa/details/StateStorage.hpp"
 #include "opennwa/details/TransitionInfo.hpp"
+#include "opennwa/details/DenseTransitions.hpp"
 
 // std::c++
 #include <iostream>
+#include <iterator>
+#include <cstddef>
 #include <set>
 #include <assert.h>
 
@@ -23,6 +26,115 @@ namespace opennwa
 {
   namespace details
   {
+
+    /**
+     *
+     * An iterator over the transitions that a (state, symbol) or symbol
+     * lookup returns: a run of one of TransitionInfo's sets or, when the
+     * storage is frozen, a slice of the DenseTransitions arrays.
+     *
+     */
+    template<typename Trans>
+    class TransitionRangeIterator
+    {
+    public:
+      typedef typename std::set<Trans>::const_iterator SetIterator;
+      typedef DenseTransitions::Id Id;
+      typedef DenseTransitions::Slice Slice;
+      typedef Trans (DenseTransitions::*Fetch)( Id ) const;
+
+      typedef std::forward_iterator_tag iterator_category;
+      typedef Trans value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef Trans const * pointer;
+      typedef Trans const & reference;
+
+      TransitionRangeIterator( )
+        : dense(0), fetch(0), position(0) {}
+
+      TransitionRangeIterator( SetIterator it )
+        : set_it(it), dense(0), fetch(0), position(0) {}
+
+      TransitionRangeIterator( DenseTransitions const & d, Fetch f, Slice s, Id pos )
+        : dense(&d), fetch(f), slice(s), position(pos)
+      {
+        load();
+      }
+
+      reference operator*( ) const { return dense ? current : *set_it; }
+      pointer operator->( ) const { return &**this; }
+
+      TransitionRangeIterator & operator++( )
+      {
+        if( dense )
+        {
+          position++;
+          load();
+        }
+        else
+          ++set_it;
+        return *this;
+      }
+
+      TransitionRangeIterator operator++( int )
+      {
+        TransitionRangeIterator old = *this;
+        ++*this;
+        return old;
+      }
+
+      bool operator==( TransitionRangeIterator const & other ) const
+      {
+        if( dense )
+          return dense == other.dense && position == other.position;
+        return other.dense == 0 && set_it == other.set_it;
+      }
+
+      bool operator!=( TransitionRangeIterator const & other ) const
+      {
+        return !(*this == other);
+      }
+
+      /// Makes the range [begin, end) of 'slice'
+      static std::pair<TransitionRangeIterator, TransitionRangeIterator>
+      range( DenseTransitions const & d, Fetch f, Slice s )
+      {
+        return std::make_pair(TransitionRangeIterator(d, f, s, s.first),
+                              TransitionRangeIterator(d, f, s, s.last));
+      }
+
+      /// Makes the range [begin, end) of a run of one of the sets
+      static std::pair<TransitionRangeIterator, TransitionRangeIterator>
+      range( std::pair<SetIterator, SetIterator> const & run )
+      {
+        return std::make_pair(TransitionRangeIterator(run.first),
+                              TransitionRangeIterator(run.second));
+      }
+
+      static std::pair<TransitionRangeIterator, TransitionRangeIterator>
+      range( std::set<Trans> const & all )
+      {
+        return std::make_pair(TransitionRangeIterator(all.begin()),
+                              TransitionRangeIterator(all.end()));
+      }
+
+    private:
+      // The transitions are rebuilt from the arrays, so the current one
+      // is cached to hand out a reference
+      void load( )
+      {
+        if( position < slice.last )
+          current = (dense->*fetch)(slice.at(position));
+      }
+
+      SetIterator set_it;
+      DenseTransitions const * dense;
+      Fetch fetch;
+      Slice slice;
+      Id position;
+      Trans current;
+    };
+
     
     /**
      *
@@ -57,6 +169,14 @@ namespace opennwa
       typedef Internals::const_iterator InternalIterator;
       typedef Returns::const_iterator ReturnIterator;
 
+      typedef TransitionRangeIterator<Call> CallRangeIterator;
+      typedef TransitionRangeIterator<Internal> InternalRangeIterator;
+      typedef TransitionRangeIterator<Return> ReturnRangeIterator;
+
+      typedef std::pair<InternalRangeIterator,InternalRangeIterator> InternalRange;
+      typedef std::pair<CallRangeIterator,CallRangeIterator> CallRange;
+      typedef std::pair<ReturnRangeIterator,ReturnRangeIterator> ReturnRange;
+
       // The following macro fakes static data declarations with
       // initializers in a template class to work around C++ being
       // dumb. Static data in a template class is almost useless
@@ -90,8 +210,43 @@ namespace opennwa
     public:
       
       //Constructors and Destructor
+      TransitionStorage( );
       TransitionStorage & operator=( const TransitionStorage & other );
 
+      //Frozen Storage
+
+      /**
+       *
+       * @brief packs the transitions into a compact, read-only form
+       *
+       * This method drops the per-state maps (which hold up to three more
+       * copies of every transition) and answers lookups from a
+       * DenseTransitions instead. The sets of all calls, internals, and
+       * returns are kept, since they are returned by reference.
+       *
+       * Any change to the transitions thaws the storage again. So do the
+       * getTrans*() accessors, which return references into the maps,
+       * except that they leave the dense index in place.
+       *
+       */
+      void freeze( );
+
+      /**
+       *
+       * @brief goes back to the per-state maps after freeze()
+       *
+       */
+      void thaw( );
+
+      /**
+       *
+       * @brief tests whether lookups are answered by the dense index
+       *
+       * @return true if freeze() was called and nothing has changed since
+       *
+       */
+      bool isFrozen( ) const;
+
       
       //Component Accessors
 
@@ -1213,6 +1368,135 @@ namespace opennwa
        *
        */
       const Returns & getTransRet( State state ) const;
+
+      // The following look transitions up by (state, symbol), or by symbol
+      // alone, through indexes that are kept up to date as transitions are
+      // added and removed. Symbols are matched exactly (WILD only matches
+      // WILD). If the storage is frozen, they are answered by binary search
+      // in the dense arrays, without rebuilding the maps.
+
+      /**
+       *
+       * @brief returns the outgoing internal transitions for the given state
+       *        and symbol
+       *
+       * @param - state: the source state
+       * @param - sym: the symbol
+       * @return the range of matching internal transitions
+       *
+       */
+      InternalRange getTransFrom( State state, Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns the incoming internal transitions for the given state
+       *        and symbol
+       *
+       * @param - state: the target state
+       * @param - sym: the symbol
+       * @return the range of matching internal transitions
+       *
+       */
+      InternalRange getTransTo( State state, Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns the call transitions for the given call site and symbol
+       *
+       * @param - state: the call site
+       * @param - sym: the symbol
+       * @return the range of matching call transitions
+       *
+       */
+      CallRange getTransCall( State state, Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns the call transitions for the given entry point and symbol
+       *
+       * @param - state: the entry point
+       * @param - sym: the symbol
+       * @return the range of matching call transitions
+       *
+       */
+      CallRange getTransEntry( State state, Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns the return transitions for the given exit point and symbol
+       *
+       * @param - state: the exit point
+       * @param - sym: the symbol
+       * @return the range of matching return transitions
+       *
+       */
+      ReturnRange getTransExit( State state, Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns the return transitions for the given exit point, call
+       *        predecessor, and symbol
+       *
+       * @param - exit: the exit point
+       * @param - pred: the call predecessor
+       * @param - sym: the symbol
+       * @return the range of matching return transitions
+       *
+       */
+      ReturnRange getTransExit( State exit, State pred, Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns the return transitions for the given call predecessor
+       *        and symbol
+       *
+       * @param - state: the call predecessor
+       * @param - sym: the symbol
+       * @return the range of matching return transitions
+       *
+       */
+      ReturnRange getTransPred( State state, Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns the return transitions for the given return site and symbol
+       *
+       * @param - state: the return site
+       * @param - sym: the symbol
+       * @return the range of matching return transitions
+       *
+       */
+      ReturnRange getTransRet( State state, Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns all internal transitions labeled with the given symbol
+       *
+       * @param - sym: the symbol
+       * @return the range of internal transitions labeled 'sym'
+       *
+       */
+      InternalRange getInternalsOn( Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns all call transitions labeled with the given symbol
+       *
+       * @param - sym: the symbol
+       * @return the range of call transitions labeled 'sym'
+       *
+       */
+      CallRange getCallsOn( Symbol sym ) const;
+
+      /**
+       *
+       * @brief returns all return transitions labeled with the given symbol
+       *
+       * @param - sym: the symbol
+       * @return the range of return transitions labeled 'sym'
+       *
+       */
+      ReturnRange getReturnsOn( Symbol sym ) const;
         
       /**
        * 
@@ -1549,13 +1833,25 @@ namespace opennwa
       // Variables
       //
       
+    private:
+
+      /**
+       * @brief the per-state maps, rebuilding them if freeze() dropped them
+       */
+      Info const & info( ) const;
+
     protected: 
        
       Calls callTrans;
       Internals internalTrans;
       Returns returnTrans;
         
-      Info T_info;
+      // Only current when 'info_current' is set; see freeze()
+      mutable Info T_info;
+      mutable bool info_current;
+
+      bool frozen;
+      DenseTransitions dense;
     };
 
 
@@ -0,0 +1,217 @@
+#include "opennwa/Nwa.hpp"
+#include "opennwa/query/CompiledNwa.hpp"
+#include "opennwa/query/automaton.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+
+namespace opennwa
+{
+  namespace query
+  {
+
+    size_t const CompiledNwa::defaultMaxFlatReturnEntries;
+
+
+    CompiledNwa::CompiledNwa( Nwa const & nwa, size_t maxFlatReturnEntries )
+    {
+      assert(isDeterministic(nwa));
+
+      std::map<State, Id> index;
+      for( Nwa::StateIterator it = nwa.beginStates(); it != nwa.endStates(); it++ )
+      {
+        Id id = static_cast<Id>(index.size());
+        index[*it] = id;
+        final_.push_back(nwa.isFinalState(*it));
+      }
+      dead_ = static_cast<Id>(index.size());
+      final_.push_back(false);
+      numStates_ = index.size() + 1;
+      initial_ = nwa.sizeInitialStates() == 0 ? dead_ : index[*nwa.beginInitialStates()];
+
+      for( Nwa::SymbolIterator it = nwa.beginSymbols(); it != nwa.endSymbols(); it++ )
+      {
+        if( *it != EPSILON && *it != WILD )
+          symbolKeys_.push_back(*it);
+      }
+      other_ = static_cast<Id>(symbolKeys_.size());
+      numSymbols_ = symbolKeys_.size() + 1;
+
+      // Keys are handed out in sequence, so the alphabet's keys are usually
+      // small enough to index a table by.
+      if( !symbolKeys_.empty() && symbolKeys_.back() < 4 * symbolKeys_.size() + 4096 )
+      {
+        symbolTable_.assign(symbolKeys_.back() + 1, other_);
+        for( size_t i = 0; i < symbolKeys_.size(); i++ )
+          symbolTable_[symbolKeys_[i]] = static_cast<Id>(i);
+      }
+
+      internals_.assign(numStates_ * numSymbols_, dead_);
+      for( Nwa::InternalIterator it = nwa.beginInternalTrans(); it != nwa.endInternalTrans(); it++ )
+      {
+        Id * row = &internals_[index[it->first] * numSymbols_];
+        if( it->second == WILD )
+          std::fill(row, row + numSymbols_, index[it->third]);
+        else
+          row[symbolId(it->second)] = index[it->third];
+      }
+
+      calls_.assign(numStates_ * numSymbols_, dead_);
+      for( Nwa::CallIterator it = nwa.beginCallTrans(); it != nwa.endCallTrans(); it++ )
+      {
+        Id * row = &calls_[index[it->first] * numSymbols_];
+        if( it->second == WILD )
+          std::fill(row, row + numSymbols_, index[it->third]);
+        else
+          row[symbolId(it->second)] = index[it->third];
+      }
+
+      if( numStates_ * numStates_ * numSymbols_ <= maxFlatReturnEntries )
+      {
+        returns_.assign(numStates_ * numStates_ * numSymbols_, dead_);
+        for( Nwa::ReturnIterator it = nwa.beginReturnTrans(); it != nwa.endReturnTrans(); it++ )
+        {
+          Id * row = &returns_[(index[it->first] * numStates_ + index[it->second]) * numSymbols_];
+          if( it->third == WILD )
+            std::fill(row, row + numSymbols_, index[it->fourth]);
+          else
+            row[symbolId(it->third)] = index[it->fourth];
+        }
+        return;
+      }
+
+      // Too big for a flat table: bucket the returns by (exit, symbol),
+      // each bucket sorted by call predecessor.
+      std::vector<std::pair<size_t, PredTarget> > entries;
+      for( Nwa::ReturnIterator it = nwa.beginReturnTrans(); it != nwa.endReturnTrans(); it++ )
+      {
+        PredTarget pt;
+        pt.pred = index[it->second];
+        pt.target = index[it->fourth];
+        size_t row = index[it->first] * numSymbols_;
+        if( it->third == WILD )
+        {
+          for( size_t sym = 0; sym < numSymbols_; sym++ )
+            entries.push_back(std::make_pair(row + sym, pt));
+        }
+        else
+          entries.push_back(std::make_pair(row + symbolId(it->third), pt));
+      }
+      std::sort(entries.begin(), entries.end());
+
+      returnOffsets_.assign(numStates_ * numSymbols_ + 1, 0);
+      returnLists_.reserve(entries.size());
+      for( size_t i = 0; i < entries.size(); i++ )
+      {
+        returnOffsets_[entries[i].first + 1]++;
+        returnLists_.push_back(entries[i].second);
+      }
+      for( size_t i = 0; i + 1 < returnOffsets_.size(); i++ )
+        returnOffsets_[i + 1] += returnOffsets_[i];
+    }
+
+
+    CompiledNwa::Id CompiledNwa::symbolId( Symbol sym ) const
+    {
+      if( !symbolTable_.empty() )
+        return sym < symbolTable_.size() ? symbolTable_[sym] : other_;
+
+      std::vector<Symbol>::const_iterator place =
+        std::lower_bound(symbolKeys_.begin(), symbolKeys_.end(), sym);
+      if( place == symbolKeys_.end() || *place != sym )
+        return other_;
+      return static_cast<Id>(place - symbolKeys_.begin());
+    }
+
+
+    CompiledNwa::Id CompiledNwa::ret( Id exit, Id pred, Id sym ) const
+    {
+      if( !returns_.empty() )
+        return returns_[(exit * numStates_ + pred) * numSymbols_ + sym];
+      if( returnLists_.empty() )
+        return dead_;
+
+      size_t bucket = exit * numSymbols_ + sym;
+      PredTarget const * begin = &returnLists_[0] + returnOffsets_[bucket];
+      PredTarget const * end = &returnLists_[0] + returnOffsets_[bucket + 1];
+      PredTarget key;
+      key.pred = pred;
+      PredTarget const * place = std::lower_bound(begin, end, key);
+      return place != end && place->pred == pred ? place->target : dead_;
+    }
+
+
+    bool CompiledNwa::accepts( NestedWord const & word ) const
+    {
+      Run run(*this);
+      run.append(word);
+      return run.accepting();
+    }
+
+
+    CompiledNwa::Run::Run( CompiledNwa const & nwa )
+      : nwa_(&nwa)
+      , state_(nwa.initial())
+    {}
+
+    void CompiledNwa::Run::reset( )
+    {
+      state_ = nwa_->initial();
+      stack_.clear();
+    }
+
+    void CompiledNwa::Run::internal( Symbol sym )
+    {
+      state_ = nwa_->internal(state_, nwa_->symbolId(sym));
+    }
+
+    void CompiledNwa::Run::call( Symbol sym )
+    {
+      stack_.push_back(state_);
+      state_ = nwa_->call(state_, nwa_->symbolId(sym));
+    }
+
+    void CompiledNwa::Run::ret( Symbol sym )
+    {
+      // A pending return pops the initial state
+      Id pred = nwa_->initial();
+      if( !stack_.empty() )
+      {
+        pred = stack_.back();
+        stack_.pop_back();
+      }
+      state_ = nwa_->ret(state_, pred, nwa_->symbolId(sym));
+    }
+
+    void CompiledNwa::Run::append( NestedWord::Position const & position )
+    {
+      switch( position.type )
+      {
+      case NestedWord::Position::CallType:
+        call(position.symbol);
+        break;
+      case NestedWord::Position::InternalType:
+        internal(position.symbol);
+        break;
+      case NestedWord::Position::ReturnType:
+        ret(position.symbol);
+        break;
+      }
+    }
+
+    void CompiledNwa::Run::append( NestedWord const & word )
+    {
+      for( NestedWord::const_iterator it = word.begin(); it != word.end(); it++ )
+        append(*it);
+    }
+
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
@@ -0,0 +1,148 @@
+#ifndef WALI_NWA_QUERY_COMPILED_NWA_HPP
+#define WALI_NWA_QUERY_COMPILED_NWA_HPP
+
+#include "opennwa/NwaFwd.hpp"
+#include "opennwa/NestedWord.hpp"
+
+#include <vector>
+
+namespace opennwa
+{
+  namespace query
+  {
+
+    /**
+     *
+     * An immutable, table-driven copy of a deterministic NWA (see
+     * query::isDeterministic) for running it over many words or long
+     * event streams.
+     *
+     * States and symbols are numbered densely. Internal and call
+     * transitions are flat (state x symbol) tables. Returns are a flat
+     * (exit x call predecessor x symbol) table when that fits in the
+     * given number of entries, and otherwise a sorted list of
+     * (predecessor, target) per (exit, symbol), searched by bisection.
+     * Symbols are translated through a table indexed directly by key, or
+     * through a sorted array when the alphabet's keys are too spread out
+     * for that. WILD transitions cover every symbol, including ones the
+     * NWA never mentions; missing transitions lead to an absorbing dead
+     * state. As in languageContains, a pending return pops the initial
+     * state.
+     *
+     * Stepping through a word does no map lookups and no allocation,
+     * apart from the stack of a Run growing to the deepest nesting it
+     * has seen.
+     *
+     */
+    class CompiledNwa
+    {
+    public:
+      typedef unsigned Id;
+
+      /// The default limit on the size of the flat return table
+      static size_t const defaultMaxFlatReturnEntries = size_t(1) << 22;
+
+      /**
+       * @brief compiles 'nwa', which must be deterministic
+       */
+      explicit CompiledNwa( Nwa const & nwa,
+                            size_t maxFlatReturnEntries = defaultMaxFlatReturnEntries );
+
+      size_t numStates( ) const { return numStates_; }
+      size_t numSymbols( ) const { return numSymbols_; }
+
+      Id initial( ) const { return initial_; }
+      Id dead( ) const { return dead_; }
+      bool isFinal( Id state ) const { return final_[state]; }
+
+      /// The id of 'sym'; symbols the NWA does not mention share one id
+      Id symbolId( Symbol sym ) const;
+
+      Id internal( Id state, Id sym ) const
+      {
+        return internals_[state * numSymbols_ + sym];
+      }
+
+      Id call( Id state, Id sym ) const
+      {
+        return calls_[state * numSymbols_ + sym];
+      }
+
+      Id ret( Id exit, Id pred, Id sym ) const;
+
+      /**
+       * A run of the automaton over a word given one position at a time.
+       * A Run can be reset and reused, keeping its stack's storage.
+       */
+      class Run
+      {
+      public:
+        explicit Run( CompiledNwa const & nwa );
+
+        void reset( );
+
+        void call( Symbol sym );
+        void internal( Symbol sym );
+        void ret( Symbol sym );
+
+        void append( NestedWord::Position const & position );
+        void append( NestedWord const & word );
+
+        Id state( ) const { return state_; }
+        size_t depth( ) const { return stack_.size(); }
+        bool accepting( ) const { return nwa_->isFinal(state_); }
+        bool dead( ) const { return state_ == nwa_->dead(); }
+
+      private:
+        CompiledNwa const * nwa_;
+        Id state_;
+        std::vector<Id> stack_;
+      };
+
+      /**
+       * @brief whether the NWA accepts 'word' (allocates a Run; reuse one
+       *        to avoid that)
+       */
+      bool accepts( NestedWord const & word ) const;
+
+    private:
+      struct PredTarget
+      {
+        Id pred;
+        Id target;
+
+        bool operator<( PredTarget const & other ) const { return pred < other.pred; }
+      };
+
+      size_t numStates_;    // including the dead state
+      size_t numSymbols_;   // including the id for other symbols
+      Id initial_;
+      Id dead_;
+      Id other_;
+
+      std::vector<bool> final_;
+
+      // Symbol translation: one of these is used
+      std::vector<Id> symbolTable_;     // indexed by key
+      std::vector<Symbol> symbolKeys_;  // sorted; the id is the position
+
+      std::vector<Id> internals_;
+      std::vector<Id> calls_;
+
+      // Returns: the flat table, or the sorted lists
+      std::vector<Id> returns_;
+      std::vector<size_t> returnOffsets_;   // by exit * numSymbols_ + sym
+      std::vector<PredTarget> returnLists_;
+    };
+
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif
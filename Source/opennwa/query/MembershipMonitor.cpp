@@ -0,0 +1,273 @@
+#include "opennwa/Nwa.hpp"
+#include "opennwa/query/MembershipMonitor.hpp"
+#include "opennwa/query/details/TransitionIndex.hpp"
+
+#include "wali/util/Timer.hpp"
+
+#include <algorithm>
+
+namespace opennwa
+{
+  namespace query
+  {
+
+    MembershipMonitor::MembershipMonitor( Nwa const & nwa )
+      : events_(0)
+      , ticks_(0)
+      , started_(0)
+    {
+      std::map<State, Id> index;
+      for( Nwa::StateIterator it = nwa.beginStates(); it != nwa.endStates(); it++ )
+      {
+        Id id = static_cast<Id>(index.size());
+        index[*it] = id;
+        initial_.push_back(nwa.isInitialState(*it));
+        final_.push_back(nwa.isFinalState(*it));
+        if( initial_.back() )
+          initials_.push_back(id);
+      }
+
+      size_t const n = index.size();
+      internals_.resize(n);
+      calls_.resize(n);
+      returns_.resize(n);
+
+      std::vector<std::vector<Id> > epsilons(n);
+      for( Nwa::InternalIterator it = nwa.beginInternalTrans(); it != nwa.endInternalTrans(); it++ )
+      {
+        if( it->second == EPSILON )
+          epsilons[index[it->first]].push_back(index[it->third]);
+        else
+          internals_[index[it->first]].push_back(std::make_pair(it->second, index[it->third]));
+      }
+      for( Nwa::CallIterator it = nwa.beginCallTrans(); it != nwa.endCallTrans(); it++ )
+        calls_[index[it->first]].push_back(std::make_pair(it->second, index[it->third]));
+      for( Nwa::ReturnIterator it = nwa.beginReturnTrans(); it != nwa.endReturnTrans(); it++ )
+        returns_[index[it->first]].push_back(ReturnEdge(index[it->second], it->third, index[it->fourth]));
+
+      closure_.resize(n);
+      std::vector<bool> reached(n, false);
+      for( Id q = 0; q < n; q++ )
+      {
+        std::vector<Id> & close = closure_[q];
+        close.push_back(q);
+        reached[q] = true;
+        for( size_t i = 0; i < close.size(); i++ )
+        {
+          std::vector<Id> const & next = epsilons[close[i]];
+          for( std::vector<Id>::const_iterator e = next.begin(); e != next.end(); e++ )
+          {
+            if( !reached[*e] )
+            {
+              reached[*e] = true;
+              close.push_back(*e);
+            }
+          }
+        }
+        for( size_t i = 0; i < close.size(); i++ )
+          reached[close[i]] = false;
+      }
+
+      reset();
+    }
+
+
+    void MembershipMonitor::reset( )
+    {
+      stack_.reset();
+      summary_.clear();
+      for( std::vector<Id>::const_iterator q = initials_.begin(); q != initials_.end(); q++ )
+        addClosed(summary_, *q, *q);
+      normalize(summary_);
+    }
+
+
+    /// Adds (from, c) for every c in the epsilon closure of 'to'
+    void MembershipMonitor::addClosed( Relation & out, Id from, Id to ) const
+    {
+      std::vector<Id> const & close = closure_[to];
+      for( std::vector<Id>::const_iterator c = close.begin(); c != close.end(); c++ )
+        out.push_back(Pair(from, *c));
+    }
+
+    void MembershipMonitor::normalize( Relation & relation )
+    {
+      std::sort(relation.begin(), relation.end());
+      relation.erase(std::unique(relation.begin(), relation.end()), relation.end());
+    }
+
+
+    void MembershipMonitor::startEvent( )
+    {
+      started_ = wali::util::details::now();
+    }
+
+    void MembershipMonitor::finishEvent( )
+    {
+      ticks_ += wali::util::details::now() - started_;
+      events_++;
+    }
+
+
+    void MembershipMonitor::internal( Symbol sym )
+    {
+      startEvent();
+      Relation next;
+      for( Relation::const_iterator p = summary_.begin(); p != summary_.end(); p++ )
+      {
+        Targets const & out = internals_[p->second];
+        for( Targets::const_iterator t = out.begin(); t != out.end(); t++ )
+        {
+          if( details::matches(t->first, sym) )
+            addClosed(next, p->first, t->second);
+        }
+      }
+      normalize(next);
+      summary_.swap(next);
+      finishEvent();
+    }
+
+
+    void MembershipMonitor::call( Symbol sym )
+    {
+      startEvent();
+      boost::shared_ptr<Frame> frame(new Frame());
+      frame->symbol = sym;
+      frame->below = stack_;
+      frame->depth = stack_ ? stack_->depth + 1 : 1;
+
+      // The new level starts at each entry the call can reach
+      Relation next;
+      for( Relation::const_iterator p = summary_.begin(); p != summary_.end(); p++ )
+      {
+        Targets const & out = calls_[p->second];
+        for( Targets::const_iterator t = out.begin(); t != out.end(); t++ )
+        {
+          if( details::matches(t->first, sym) )
+            addClosed(next, t->second, t->second);
+        }
+      }
+      normalize(next);
+
+      frame->summary.swap(summary_);
+      summary_.swap(next);
+      stack_ = frame;
+      finishEvent();
+    }
+
+
+    void MembershipMonitor::ret( Symbol sym )
+    {
+      startEvent();
+      Relation next;
+      if( !stack_ )
+      {
+        // A pending return: the call predecessor is any initial state
+        for( Relation::const_iterator p = summary_.begin(); p != summary_.end(); p++ )
+        {
+          std::vector<ReturnEdge> const & out = returns_[p->second];
+          for( std::vector<ReturnEdge>::const_iterator r = out.begin(); r != out.end(); r++ )
+          {
+            if( initial_[r->pred] && details::matches(r->symbol, sym) )
+              addClosed(next, p->first, r->ret);
+          }
+        }
+      }
+      else
+      {
+        // For each (p, q) before the call, each entry e the call went to
+        // from q, and each exit x reached from e, take the returns from x
+        // that pop q.
+        Frame const & frame = *stack_;
+        for( Relation::const_iterator p = frame.summary.begin(); p != frame.summary.end(); p++ )
+        {
+          Id const q = p->second;
+          Targets const & entries = calls_[q];
+          for( Targets::const_iterator e = entries.begin(); e != entries.end(); e++ )
+          {
+            if( !details::matches(e->first, frame.symbol) )
+              continue;
+            Relation::const_iterator x = std::lower_bound(summary_.begin(), summary_.end(), Pair(e->second, 0));
+            for( ; x != summary_.end() && x->first == e->second; x++ )
+            {
+              std::vector<ReturnEdge> const & out = returns_[x->second];
+              for( std::vector<ReturnEdge>::const_iterator r = out.begin(); r != out.end(); r++ )
+              {
+                if( r->pred == q && details::matches(r->symbol, sym) )
+                  addClosed(next, p->first, r->ret);
+              }
+            }
+          }
+        }
+        stack_ = frame.below;
+      }
+      normalize(next);
+      summary_.swap(next);
+      finishEvent();
+    }
+
+
+    void MembershipMonitor::append( NestedWord::Position const & position )
+    {
+      switch( position.type )
+      {
+      case NestedWord::Position::CallType:
+        call(position.symbol);
+        break;
+      case NestedWord::Position::InternalType:
+        internal(position.symbol);
+        break;
+      case NestedWord::Position::ReturnType:
+        ret(position.symbol);
+        break;
+      }
+    }
+
+    void MembershipMonitor::append( NestedWord const & word )
+    {
+      for( NestedWord::const_iterator it = word.begin(); it != word.end(); it++ )
+        append(*it);
+    }
+
+
+    bool MembershipMonitor::accepting( ) const
+    {
+      for( Relation::const_iterator p = summary_.begin(); p != summary_.end(); p++ )
+      {
+        if( final_[p->second] )
+          return true;
+      }
+      return false;
+    }
+
+    bool MembershipMonitor::dead( ) const
+    {
+      return summary_.empty();
+    }
+
+    size_t MembershipMonitor::depth( ) const
+    {
+      return stack_ ? stack_->depth : 0;
+    }
+
+
+    double MembershipMonitor::seconds( ) const
+    {
+      return wali::util::details::to_sec(ticks_);
+    }
+
+    double MembershipMonitor::eventsPerSecond( ) const
+    {
+      double s = seconds();
+      return s > 0 ? static_cast<double>(events_) / s : 0.0;
+    }
+
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
@@ -0,0 +1,140 @@
+#ifndef WALI_NWA_QUERY_MEMBERSHIP_MONITOR_HPP
+#define WALI_NWA_QUERY_MEMBERSHIP_MONITOR_HPP
+
+#include "opennwa/NwaFwd.hpp"
+#include "opennwa/NestedWord.hpp"
+
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace opennwa
+{
+  namespace query
+  {
+
+    /**
+     *
+     * Checks membership of a nested word in the language of an NWA as the
+     * word arrives, one position at a time, without determinizing the NWA
+     * and without keeping the word.
+     *
+     * Rather than a set of (state, stack) configurations, which can grow
+     * exponentially with the nesting depth, the monitor keeps one summary
+     * relation per open call: the pairs (e, q) such that the NWA can go
+     * from entry e, where the innermost open call entered, to q on the
+     * positions read since. (At the top level, e is the initial state the
+     * run started in.) A return combines the summary of the call that it
+     * closes with the one below. Memory is thus at most (depth + 1) * |Q|^2
+     * pairs, whatever the length of the stream.
+     *
+     * The stack is a linked list of immutable, reference-counted frames, so
+     * a copy of a monitor (say, a checkpoint taken before a speculative
+     * branch) shares every frame with the original.
+     *
+     * WILD transitions match any symbol and epsilon transitions are taken
+     * freely, as in construct::determinize. As in languageContains, a word
+     * may have pending calls, and a pending return pops an initial state.
+     *
+     * The monitor works from a snapshot of the NWA taken at construction.
+     *
+     */
+    class MembershipMonitor
+    {
+    public:
+      explicit MembershipMonitor( Nwa const & nwa );
+
+      /// Starts over with the empty word (the counters are kept)
+      void reset( );
+
+      // Events
+
+      void call( Symbol sym );
+      void internal( Symbol sym );
+      void ret( Symbol sym );
+
+      void append( NestedWord::Position const & position );
+      void append( NestedWord const & word );
+
+      // Queries about the word read so far
+
+      /// Would the NWA accept the word read so far?
+      bool accepting( ) const;
+
+      /// Has every run died? (If so, no continuation is accepted.)
+      bool dead( ) const;
+
+      /// The number of open calls
+      size_t depth( ) const;
+
+      // Throughput counters, over the life of the monitor
+
+      unsigned long long events( ) const { return events_; }
+
+      /// Time spent processing events (not waiting for them)
+      double seconds( ) const;
+
+      double eventsPerSecond( ) const;
+
+    private:
+      typedef unsigned Id;
+      typedef std::pair<Id, Id> Pair;
+      typedef std::vector<Pair> Relation;   // sorted, no duplicates
+
+      typedef std::vector<std::pair<Symbol, Id> > Targets;
+
+      struct ReturnEdge
+      {
+        Id pred;
+        Symbol symbol;
+        Id ret;
+
+        ReturnEdge( Id p, Symbol s, Id r ) : pred(p), symbol(s), ret(r) {}
+      };
+
+      /// An open call: the summary from before it and its symbol
+      struct Frame
+      {
+        Relation summary;
+        Symbol symbol;
+        boost::shared_ptr<Frame const> below;
+        size_t depth;
+      };
+
+      void addClosed( Relation & out, Id from, Id to ) const;
+      static void normalize( Relation & relation );
+
+      void startEvent( );
+      void finishEvent( );
+
+      // The NWA, with states numbered densely
+      std::vector<bool> initial_;
+      std::vector<bool> final_;
+      std::vector<std::vector<Id> > closure_;   // epsilon closure, reflexive
+      std::vector<Targets> internals_;
+      std::vector<Targets> calls_;
+      std::vector<std::vector<ReturnEdge> > returns_;   // by exit
+      std::vector<Id> initials_;
+
+      // The word read so far
+      Relation summary_;
+      boost::shared_ptr<Frame const> stack_;
+
+      unsigned long long events_;
+      long long ticks_;
+      long long started_;
+    };
+
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif
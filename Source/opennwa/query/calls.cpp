@@ -9,6 +9,9 @@ namespace opennwa
     typedef  Trans::CallIterator CallIterator;
     typedef  Trans::InternalIterator InternalIterator;
     typedef  Trans::ReturnIterator ReturnIterator;
+    typedef  Trans::CallRangeIterator CallRangeIterator;
+    typedef  Trans::InternalRangeIterator InternalRangeIterator;
+    typedef  Trans::ReturnRangeIterator ReturnRangeIterator;
     typedef  Trans::Call Call;       
     typedef  Trans::Internal Internal;   
     typedef  Trans::Return Return;          
@@ -35,12 +38,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Calls & call = trans.getCalls();
+      Trans::CallRange call = trans.getCallsOn(symbol);
       StateSet calls;
-      for( CallIterator it = call.begin(); it != call.end(); it++ )
+      for( CallRangeIterator it = call.first; it != call.second; it++ )
       {
-        if( symbol == Trans::getCallSym(*it) )
-          calls.insert( Trans::getCallSite(*it) );
+        calls.insert( Trans::getCallSite(*it) );
       }
       return calls;
     }
@@ -65,12 +67,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Calls & call = trans.getTransEntry(entryPoint);
+      Trans::CallRange call = trans.getTransEntry(entryPoint, symbol);
       StateSet calls;
-      for( CallIterator it = call.begin(); it != call.end(); it++ )
+      for( CallRangeIterator it = call.first; it != call.second; it++ )
       {
-        if( symbol == Trans::getCallSym(*it) )
-          calls.insert( Trans::getCallSite(*it) );
+        calls.insert( Trans::getCallSite(*it) );
       }
       return calls;
     }
@@ -238,12 +239,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Calls & ent = trans.getCalls();
+      Trans::CallRange ent = trans.getCallsOn(symbol);
       StateSet entries;
-      for( CallIterator it = ent.begin(); it != ent.end(); it++ )
+      for( CallRangeIterator it = ent.first; it != ent.second; it++ )
       {
-        if( symbol == Trans::getCallSym(*it) )
-          entries.insert( Trans::getEntry(*it) );
+        entries.insert( Trans::getEntry(*it) );
       }
       return entries;
     }
@@ -267,12 +267,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Calls & ent = trans.getTransCall(callSite);
+      Trans::CallRange ent = trans.getTransCall(callSite, symbol);
       StateSet entries;
-      for( CallIterator it = ent.begin(); it != ent.end(); it++ )
+      for( CallRangeIterator it = ent.first; it != ent.second; it++ )
       {
-        if( symbol == Trans::getCallSym(*it) )
-          entries.insert( Trans::getEntry(*it) );
+        entries.insert( Trans::getEntry(*it) );
       }
       return entries;
     }
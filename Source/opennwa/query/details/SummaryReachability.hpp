@@ -0,0 +1,354 @@
+#ifndef WALI_NWA_QUERY_DETAILS_SUMMARY_REACHABILITY_HPP
+#define WALI_NWA_QUERY_DETAILS_SUMMARY_REACHABILITY_HPP
+
+#include "opennwa/NestedWord.hpp"
+
+#include <cassert>
+#include <deque>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace opennwa
+{
+  namespace query
+  {
+    namespace details
+    {
+      /// Searches for an accepting state of a nested word automaton,
+      /// stopping at the first one it reaches, and can rebuild the word
+      /// that got there.
+      ///
+      /// It is the usual summarization-based reachability. A "fact" says
+      /// that some word which is well-matched within the current nesting
+      /// level leads from the start of that level to some node. Nested
+      /// levels are identified by their entry node; the top level is
+      /// where the word starts and is the only place pending returns can
+      /// happen. When a fact in a nested level can take a return
+      /// transition, we combine it with each of the facts that called
+      /// into the level (a summary edge). Pending calls need nothing
+      /// special: a fact in a nested level is reachable whether or not
+      /// the calls that led there ever return.
+      ///
+      /// The automaton is described by 'Graph', which only has to produce
+      /// successors on demand, so it can be a product that is never
+      /// built. It must provide:
+      ///
+      ///   typedef ... Node;       // copyable and less-than comparable
+      ///   typedef std::vector<std::pair<Symbol, Node> > Edges;
+      ///   void initial(std::vector<Node> & out);
+      ///   bool isFinal(Node n);
+      ///   void epsilons(Node n, std::vector<Node> & out);
+      ///   void internals(Node n, Edges & out);
+      ///   void calls(Node n, Edges & out);
+      ///   void returns(Node exit, Node call, Edges & out);
+      ///   void pendingReturns(Node exit, Edges & out);
+      ///
+      /// The symbols on the edges are the ones that go into the word, so
+      /// they should be concrete (not WILD).
+      template<typename Graph>
+      class SummaryReachability
+      {
+      public:
+        typedef typename Graph::Node Node;
+        typedef typename Graph::Edges Edges;
+
+        explicit SummaryReachability(Graph & graph)
+          : graph_(graph)
+          , accepting_(none())
+        {}
+
+        /// Returns whether some accepting node is reachable
+        bool
+        run()
+        {
+          levels_.push_back(Level());
+
+          std::vector<Node> initial;
+          graph_.initial(initial);
+          for (typename std::vector<Node>::const_iterator q = initial.begin();
+               q != initial.end() && accepting_ == none(); ++q)
+          {
+            addFact(0, *q, Origin(Origin::Start));
+          }
+
+          while (accepting_ == none() && !worklist_.empty()) {
+            size_t f = worklist_.front();
+            worklist_.pop_front();
+            process(f);
+          }
+
+          return accepting_ != none();
+        }
+
+        /// Returns the word that reached an accepting node; only call
+        /// this after run() returns true
+        NestedWordRefPtr
+        witness() const
+        {
+          assert(accepting_ != none());
+          NestedWordRefPtr word = new NestedWord();
+          buildWord(*word, accepting_);
+          return word;
+        }
+
+        /// The number of (level, node) pairs discovered so far
+        size_t
+        numFacts() const
+        {
+          return facts_.size();
+        }
+
+      private:
+        static size_t none() { return static_cast<size_t>(-1); }
+
+        /// How a fact was derived, so that we can rebuild the word
+        struct Origin
+        {
+          enum Kind { Start, Internal, Return, PendingReturn };
+
+          Kind kind;
+          size_t pred;         // the fact before this step (the caller, for Return)
+          size_t exit;         // for Return, the exit fact of the called level
+          Symbol symbol;       // EPSILON for an epsilon step
+          Symbol call_symbol;  // for Return
+
+          explicit Origin(Kind k, size_t p = none(), Symbol s = EPSILON,
+                          size_t x = none(), Symbol c = EPSILON)
+            : kind(k), pred(p), exit(x), symbol(s), call_symbol(c)
+          {}
+        };
+
+        struct Fact
+        {
+          size_t level;
+          Node node;
+          Origin origin;
+
+          Fact(size_t l, Node n, Origin const & o)
+            : level(l), node(n), origin(o)
+          {}
+        };
+
+        struct Caller
+        {
+          size_t fact;
+          Symbol symbol;
+
+          Caller(size_t f, Symbol s) : fact(f), symbol(s) {}
+        };
+
+        /// Level 0 is the top level; every other level is entered by a
+        /// call
+        struct Level
+        {
+          std::vector<Caller> callers;
+          std::vector<size_t> facts;
+        };
+
+        void
+        addFact(size_t level, Node node, Origin const & origin)
+        {
+          if (accepting_ != none()) {
+            return;
+          }
+          if (!seen_.insert(std::make_pair(level, node)).second) {
+            return;
+          }
+
+          size_t id = facts_.size();
+          facts_.push_back(Fact(level, node, origin));
+          levels_[level].facts.push_back(id);
+          worklist_.push_back(id);
+
+          if (graph_.isFinal(node)) {
+            accepting_ = id;
+          }
+        }
+
+        void
+        process(size_t f)
+        {
+          size_t const level = facts_[f].level;
+          Node const node = facts_[f].node;
+
+          std::vector<Node> eps;
+          graph_.epsilons(node, eps);
+          for (typename std::vector<Node>::const_iterator t = eps.begin(); t != eps.end(); ++t) {
+            addFact(level, *t, Origin(Origin::Internal, f));
+          }
+
+          Edges edges;
+          graph_.internals(node, edges);
+          for (typename Edges::const_iterator t = edges.begin(); t != edges.end(); ++t) {
+            addFact(level, t->second, Origin(Origin::Internal, f, t->first));
+          }
+
+          edges.clear();
+          graph_.calls(node, edges);
+          for (typename Edges::const_iterator t = edges.begin(); t != edges.end(); ++t) {
+            enterLevel(f, t->second, t->first);
+          }
+
+          if (level == 0) {
+            edges.clear();
+            graph_.pendingReturns(node, edges);
+            for (typename Edges::const_iterator r = edges.begin(); r != edges.end(); ++r) {
+              addFact(level, r->second, Origin(Origin::PendingReturn, f, r->first));
+            }
+          }
+          else {
+            // Indices, because returning can add callers
+            for (size_t c = 0; c < levels_[level].callers.size(); ++c) {
+              returnTo(levels_[level].callers[c], f);
+            }
+          }
+        }
+
+        void
+        enterLevel(size_t caller, Node entry, Symbol sym)
+        {
+          typename std::map<Node, size_t>::const_iterator place = level_ids_.find(entry);
+          size_t level;
+          if (place == level_ids_.end()) {
+            level = levels_.size();
+            levels_.push_back(Level());
+            level_ids_[entry] = level;
+          }
+          else {
+            level = place->second;
+          }
+
+          // Calling the same entry on another symbol adds nothing new
+          if (!called_.insert(std::make_pair(caller, level)).second) {
+            return;
+          }
+
+          Caller c(caller, sym);
+          levels_[level].callers.push_back(c);
+          if (levels_[level].facts.empty()) {
+            addFact(level, entry, Origin(Origin::Start));
+          }
+          else {
+            // The level has been explored already (from another caller),
+            // so match its exits up with the new caller now
+            for (size_t x = 0; x < levels_[level].facts.size(); ++x) {
+              returnTo(c, levels_[level].facts[x]);
+            }
+          }
+        }
+
+        void
+        returnTo(Caller caller, size_t exit)
+        {
+          Edges rets;
+          graph_.returns(facts_[exit].node, facts_[caller.fact].node, rets);
+          for (typename Edges::const_iterator r = rets.begin(); r != rets.end(); ++r) {
+            addFact(facts_[caller.fact].level, r->second,
+                    Origin(Origin::Return, caller.fact, r->first, exit, caller.symbol));
+          }
+        }
+
+        /// One step of rebuilding a word: expand a fact (the part of the
+        /// word within its own level, or the whole word up to it), or
+        /// append a letter
+        struct WordStep
+        {
+          enum Kind { Local, Whole, Call, Internal, Return };
+
+          Kind kind;
+          size_t fact;
+          Symbol symbol;
+
+          WordStep(Kind k, size_t f, Symbol s = EPSILON)
+            : kind(k), fact(f), symbol(s)
+          {}
+        };
+
+        /// Appends the whole word for fact 'f', including the pending
+        /// calls that led to its level. The steps are kept on an explicit
+        /// stack rather than by recursion, because a fact's origin chain
+        /// is as long as the word.
+        void
+        buildWord(NestedWord & word, size_t f) const
+        {
+          std::vector<WordStep> steps;
+          steps.push_back(WordStep(WordStep::Whole, f));
+
+          // Steps are pushed in the reverse of the order they append in
+          while (!steps.empty()) {
+            WordStep step = steps.back();
+            steps.pop_back();
+
+            switch (step.kind) {
+            case WordStep::Call:
+              word.appendCall(step.symbol);
+              break;
+            case WordStep::Internal:
+              word.appendInternal(step.symbol);
+              break;
+            case WordStep::Return:
+              word.appendReturn(step.symbol);
+              break;
+
+            case WordStep::Whole:
+              steps.push_back(WordStep(WordStep::Local, step.fact));
+              if (facts_[step.fact].level != 0) {
+                Caller const & first = levels_[facts_[step.fact].level].callers.front();
+                steps.push_back(WordStep(WordStep::Call, none(), first.symbol));
+                steps.push_back(WordStep(WordStep::Whole, first.fact));
+              }
+              break;
+
+            case WordStep::Local: {
+              Origin const & origin = facts_[step.fact].origin;
+              switch (origin.kind) {
+              case Origin::Start:
+                break;
+              case Origin::Internal:
+                if (origin.symbol != EPSILON) {
+                  steps.push_back(WordStep(WordStep::Internal, none(), origin.symbol));
+                }
+                steps.push_back(WordStep(WordStep::Local, origin.pred));
+                break;
+              case Origin::PendingReturn:
+                steps.push_back(WordStep(WordStep::Return, none(), origin.symbol));
+                steps.push_back(WordStep(WordStep::Local, origin.pred));
+                break;
+              case Origin::Return:
+                steps.push_back(WordStep(WordStep::Return, none(), origin.symbol));
+                steps.push_back(WordStep(WordStep::Local, origin.exit));
+                steps.push_back(WordStep(WordStep::Call, none(), origin.call_symbol));
+                steps.push_back(WordStep(WordStep::Local, origin.pred));
+                break;
+              }
+              break;
+            }
+            }
+          }
+        }
+
+        Graph & graph_;
+
+        std::vector<Fact> facts_;
+        std::vector<Level> levels_;
+        std::map<Node, size_t> level_ids_;
+        std::set<std::pair<size_t, Node> > seen_;
+        std::set<std::pair<size_t, size_t> > called_;
+        std::deque<size_t> worklist_;
+        size_t accepting_;
+      };
+
+    }
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef WALI_NWA_QUERY_DETAILS_TRANSITION_INDEX_HPP
+#define WALI_NWA_QUERY_DETAILS_TRANSITION_INDEX_HPP
+
+#include "opennwa/Nwa.hpp"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace opennwa
+{
+  namespace query
+  {
+    namespace details
+    {
+      /// The transitions of one automaton, indexed by source state (the
+      /// exit, for returns). Epsilon internal transitions are kept apart
+      /// from the others. This is a snapshot: it does not follow later
+      /// changes to the NWA.
+      class TransitionIndex
+      {
+      public:
+        typedef std::vector<std::pair<Symbol, State> > Targets;
+        typedef std::map<State, Targets> TargetMap;
+
+        struct ReturnEdge
+        {
+          State call;
+          Symbol symbol;
+          State ret;
+
+          ReturnEdge(State c, Symbol s, State r) : call(c), symbol(s), ret(r) {}
+        };
+        typedef std::vector<ReturnEdge> ReturnEdges;
+        typedef std::map<State, ReturnEdges> ReturnMap;
+
+        explicit TransitionIndex(Nwa const & nwa)
+        {
+          for (Nwa::InternalIterator it = nwa.beginInternalTrans();
+               it != nwa.endInternalTrans(); ++it)
+          {
+            if (it->second == EPSILON) {
+              epsilons[it->first].push_back(std::make_pair(it->second, it->third));
+            }
+            else {
+              internals[it->first].push_back(std::make_pair(it->second, it->third));
+            }
+          }
+          for (Nwa::CallIterator it = nwa.beginCallTrans();
+               it != nwa.endCallTrans(); ++it)
+          {
+            calls[it->first].push_back(std::make_pair(it->second, it->third));
+          }
+          for (Nwa::ReturnIterator it = nwa.beginReturnTrans();
+               it != nwa.endReturnTrans(); ++it)
+          {
+            returns[it->first].push_back(ReturnEdge(it->second, it->third, it->fourth));
+          }
+        }
+
+        static Targets const &
+        lookup(TargetMap const & map, State from)
+        {
+          static Targets const none;
+          TargetMap::const_iterator place = map.find(from);
+          return place == map.end() ? none : place->second;
+        }
+
+        ReturnEdges const &
+        returnsFrom(State exit) const
+        {
+          static ReturnEdges const none;
+          ReturnMap::const_iterator place = returns.find(exit);
+          return place == returns.end() ? none : place->second;
+        }
+
+        TargetMap epsilons;
+        TargetMap internals;
+        TargetMap calls;
+        ReturnMap returns;
+      };
+
+
+      /// Does a transition labeled 'label' match the concrete symbol 'sym'?
+      inline
+      bool
+      matches(Symbol label, Symbol sym)
+      {
+        return label == sym || label == WILD;
+      }
+
+    }
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif
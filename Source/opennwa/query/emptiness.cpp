@@ -0,0 +1,156 @@
+#include "opennwa/Nwa.hpp"
+#include "opennwa/NestedWord.hpp"
+#include "opennwa/query/language.hpp"
+#include "opennwa/query/details/TransitionIndex.hpp"
+#include "opennwa/query/details/SummaryReachability.hpp"
+
+#include <utility>
+#include <vector>
+
+// This file implements emptiness directly on the NWA, instead of going
+// through NwaToWpdsCalls and a full poststar. The search itself is in
+// details/SummaryReachability.hpp; this just presents the NWA's
+// transitions to it.
+
+namespace opennwa {
+  namespace query {
+
+    namespace {
+
+      using details::TransitionIndex;
+
+      class NwaGraph
+      {
+      public:
+        typedef State Node;
+        typedef std::vector<std::pair<Symbol, Node> > Edges;
+
+        explicit NwaGraph(Nwa const & nwa)
+          : nwa_(nwa)
+          , index_(nwa)
+          , wild_symbol_(WILD)
+        {
+          for (Nwa::SymbolIterator sym = nwa.beginSymbols(); sym != nwa.endSymbols(); ++sym) {
+            if (*sym != EPSILON && *sym != WILD) {
+              wild_symbol_ = *sym;
+              break;
+            }
+          }
+        }
+
+        void
+        initial(std::vector<Node> & out) const
+        {
+          out.assign(nwa_.beginInitialStates(), nwa_.endInitialStates());
+        }
+
+        bool
+        isFinal(Node q) const
+        {
+          return nwa_.isFinalState(q);
+        }
+
+        void
+        epsilons(Node q, std::vector<Node> & out) const
+        {
+          TransitionIndex::Targets const & eps = TransitionIndex::lookup(index_.epsilons, q);
+          for (TransitionIndex::Targets::const_iterator t = eps.begin(); t != eps.end(); ++t) {
+            out.push_back(t->second);
+          }
+        }
+
+        void
+        internals(Node q, Edges & out) const
+        {
+          concrete(TransitionIndex::lookup(index_.internals, q), out);
+        }
+
+        void
+        calls(Node q, Edges & out) const
+        {
+          concrete(TransitionIndex::lookup(index_.calls, q), out);
+        }
+
+        void
+        returns(Node exit, Node call, Edges & out) const
+        {
+          TransitionIndex::ReturnEdges const & rets = index_.returnsFrom(exit);
+          for (TransitionIndex::ReturnEdges::const_iterator r = rets.begin(); r != rets.end(); ++r) {
+            if (r->call == call) {
+              out.push_back(std::make_pair(concrete(r->symbol), r->ret));
+            }
+          }
+        }
+
+        void
+        pendingReturns(Node exit, Edges & out) const
+        {
+          TransitionIndex::ReturnEdges const & rets = index_.returnsFrom(exit);
+          for (TransitionIndex::ReturnEdges::const_iterator r = rets.begin(); r != rets.end(); ++r) {
+            if (nwa_.isInitialState(r->call)) {
+              out.push_back(std::make_pair(concrete(r->symbol), r->ret));
+            }
+          }
+        }
+
+      private:
+        /// Picks a symbol for a witness that went along a transition
+        /// labeled 'label'
+        Symbol
+        concrete(Symbol label) const
+        {
+          return label == WILD ? wild_symbol_ : label;
+        }
+
+        void
+        concrete(TransitionIndex::Targets const & targets, Edges & out) const
+        {
+          for (TransitionIndex::Targets::const_iterator t = targets.begin(); t != targets.end(); ++t) {
+            out.push_back(std::make_pair(concrete(t->first), t->second));
+          }
+        }
+
+        Nwa const & nwa_;
+        TransitionIndex index_;
+        Symbol wild_symbol_;
+      };
+
+      typedef details::SummaryReachability<NwaGraph> NwaReachability;
+
+    } // end anonymous namespace
+
+
+    bool
+    languageIsEmpty(Nwa const & nwa)
+    {
+      if (nwa.sizeInitialStates() == 0 || nwa.sizeFinalStates() == 0) {
+        return true;
+      }
+      NwaGraph graph(nwa);
+      NwaReachability search(graph);
+      return !search.run();
+    }
+
+
+    bool
+    languageIsEmpty(Nwa const & nwa, NestedWordRefPtr & witness)
+    {
+      NwaGraph graph(nwa);
+      NwaReachability search(graph);
+      if (search.run()) {
+        witness = search.witness();
+        return false;
+      }
+      witness = NestedWordRefPtr();
+      return true;
+    }
+
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
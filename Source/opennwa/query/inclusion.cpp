@@ -0,0 +1,577 @@
+#include "opennwa/Nwa.hpp"
+#include "opennwa/NestedWord.hpp"
+#include "opennwa/query/language.hpp"
+#include "opennwa/query/details/TransitionIndex.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// This file implements language inclusion without complementing the
+// right-hand automaton. The idea is to run the determinization of 'second'
+// (the one in nwa_determinize.cpp) on the fly, in lock step with a
+// nondeterministic run of 'first', and stop as soon as we find a word that
+// 'first' accepts and the determinized 'second' does not.
+//
+// As in the determinization, the state of 'second' is a "summary": a
+// relation between the states of 'second' at the start of the current
+// nesting level (the call sites, in a nested level) and the states it can
+// be in now. At a call we do not know yet where the matching return will
+// be, so (just like a summarization-based reachability analysis) we start
+// a new level, and when some exit of that level meets a return transition
+// we combine it with each of the callers that entered the level.
+//
+// A "fact" says that some word which is well-matched within the current
+// level leads 'first' to 'state' and 'second' to 'summary'. If two facts
+// in the same level have the same 'first' state and one summary is a
+// subset of the other, every continuation that is rejected from the bigger
+// one is also rejected from the smaller one, so only the minimal summaries
+// (an antichain) need to be explored.
+
+namespace opennwa {
+  namespace query {
+
+    namespace {
+
+      using details::TransitionIndex;
+      using details::matches;
+
+      typedef std::pair<State, State> StatePair;
+
+      /// Sorted and without duplicates, so that subset checks can use
+      /// std::includes.
+      typedef std::vector<StatePair> Summary;
+
+
+      /// The determinized view of the right-hand automaton. Nothing here
+      /// is computed until it is asked for, so the parts of the subset
+      /// construction that the left-hand automaton never drives the
+      /// right-hand one into are never built.
+      class SummaryStepper
+      {
+      public:
+        explicit SummaryStepper(Nwa const & nwa)
+          : nwa_(nwa)
+          , index_(nwa)
+        {}
+
+        /// The summary at the start of the word. The domain of a
+        /// top-level summary does not mean anything, so we use a dummy
+        /// key there.
+        Summary
+        initial()
+        {
+          Summary s;
+          for (Nwa::StateIterator q = nwa_.beginInitialStates();
+               q != nwa_.endInitialStates(); ++q)
+          {
+            s.push_back(StatePair(wali::WALI_BAD_KEY, *q));
+          }
+          return close(s);
+        }
+
+        /// The summary at the start of a level entered by a call on 'sym'
+        Summary const &
+        entry(Symbol sym)
+        {
+          std::map<Symbol, Summary>::iterator place = entries_.find(sym);
+          if (place != entries_.end()) {
+            return place->second;
+          }
+
+          Summary s;
+          for (TransitionIndex::TargetMap::const_iterator from = index_.calls.begin();
+               from != index_.calls.end(); ++from)
+          {
+            for (TransitionIndex::Targets::const_iterator t = from->second.begin();
+                 t != from->second.end(); ++t)
+            {
+              if (matches(t->first, sym)) {
+                s.push_back(StatePair(from->first, t->second));
+              }
+            }
+          }
+          return entries_[sym] = close(s);
+        }
+
+        Summary
+        internal(Summary const & s, Symbol sym)
+        {
+          Summary next;
+          for (Summary::const_iterator p = s.begin(); p != s.end(); ++p) {
+            TransitionIndex::Targets const & out =
+              TransitionIndex::lookup(index_.internals, p->second);
+            for (TransitionIndex::Targets::const_iterator t = out.begin();
+                 t != out.end(); ++t)
+            {
+              if (matches(t->first, sym)) {
+                next.push_back(StatePair(p->first, t->second));
+              }
+            }
+          }
+          return close(next);
+        }
+
+        /// Combines the summary before a call with the summary at the
+        /// exit of the called level
+        Summary
+        matchedReturn(Summary const & before_call, Summary const & exit, Symbol sym)
+        {
+          // Call site -> level starts it was reached from
+          std::map<State, std::vector<State> > callers;
+          for (Summary::const_iterator p = before_call.begin(); p != before_call.end(); ++p) {
+            callers[p->second].push_back(p->first);
+          }
+
+          Summary next;
+          for (Summary::const_iterator p = exit.begin(); p != exit.end(); ++p) {
+            std::map<State, std::vector<State> >::const_iterator starts = callers.find(p->first);
+            if (starts == callers.end()) {
+              continue;
+            }
+            TransitionIndex::ReturnEdges const & out = index_.returnsFrom(p->second);
+            for (TransitionIndex::ReturnEdges::const_iterator r = out.begin();
+                 r != out.end(); ++r)
+            {
+              if (r->call == p->first && matches(r->symbol, sym)) {
+                for (std::vector<State>::const_iterator start = starts->second.begin();
+                     start != starts->second.end(); ++start)
+                {
+                  next.push_back(StatePair(*start, r->ret));
+                }
+              }
+            }
+          }
+          return close(next);
+        }
+
+        /// A return with nothing on the stack, whose call predecessor
+        /// must be an initial state
+        Summary
+        pendingReturn(Summary const & s, Symbol sym)
+        {
+          Summary next;
+          for (Summary::const_iterator p = s.begin(); p != s.end(); ++p) {
+            TransitionIndex::ReturnEdges const & out = index_.returnsFrom(p->second);
+            for (TransitionIndex::ReturnEdges::const_iterator r = out.begin();
+                 r != out.end(); ++r)
+            {
+              if (nwa_.isInitialState(r->call) && matches(r->symbol, sym)) {
+                next.push_back(StatePair(p->first, r->ret));
+              }
+            }
+          }
+          return close(next);
+        }
+
+        bool
+        accepts(Summary const & s) const
+        {
+          for (Summary::const_iterator p = s.begin(); p != s.end(); ++p) {
+            if (nwa_.isFinalState(p->second)) {
+              return true;
+            }
+          }
+          return false;
+        }
+
+      private:
+        /// Adds everything reachable by epsilon transitions, then sorts
+        Summary
+        close(Summary s)
+        {
+          std::sort(s.begin(), s.end());
+          s.erase(std::unique(s.begin(), s.end()), s.end());
+          if (index_.epsilons.empty()) {
+            return s;
+          }
+
+          std::vector<StatePair> worklist(s.begin(), s.end());
+          std::set<StatePair> seen(s.begin(), s.end());
+          while (!worklist.empty()) {
+            StatePair p = worklist.back();
+            worklist.pop_back();
+            TransitionIndex::Targets const & out =
+              TransitionIndex::lookup(index_.epsilons, p.second);
+            for (TransitionIndex::Targets::const_iterator t = out.begin();
+                 t != out.end(); ++t)
+            {
+              StatePair q(p.first, t->second);
+              if (seen.insert(q).second) {
+                worklist.push_back(q);
+              }
+            }
+          }
+          return Summary(seen.begin(), seen.end());
+        }
+
+        Nwa const & nwa_;
+        TransitionIndex index_;
+        std::map<Symbol, Summary> entries_;
+      };
+
+
+      /// The search itself; see the comment at the top of the file.
+      class InclusionChecker
+      {
+      public:
+        InclusionChecker(Nwa const & first, Nwa const & second)
+          : first_(first)
+          , index_(first)
+          , second_(second)
+          , counterexample_(none)
+        {
+          SymbolSet symbols;
+          symbols.insert(first.beginSymbols(), first.endSymbols());
+          symbols.insert(second.beginSymbols(), second.endSymbols());
+          for (SymbolSet::const_iterator sym = symbols.begin(); sym != symbols.end(); ++sym) {
+            if (*sym != EPSILON && *sym != WILD) {
+              alphabet_.push_back(*sym);
+            }
+          }
+        }
+
+        NestedWordRefPtr
+        run()
+        {
+          Summary start = second_.initial();
+          for (Nwa::StateIterator q = first_.beginInitialStates();
+               q != first_.endInitialStates() && counterexample_ == none; ++q)
+          {
+            size_t level = getLevel(*q, EPSILON, none);
+            addFact(level, *q, start, Origin(Origin::Start));
+          }
+
+          while (counterexample_ == none && !worklist_.empty()) {
+            size_t f = worklist_.front();
+            worklist_.pop_front();
+            if (!facts_[f].dead) {
+              process(f);
+            }
+          }
+
+          if (counterexample_ == none) {
+            return NestedWordRefPtr();
+          }
+          NestedWordRefPtr word = new NestedWord();
+          buildWord(*word, counterexample_);
+          return word;
+        }
+
+      private:
+        static size_t const none = static_cast<size_t>(-1);
+
+        /// How a fact was derived, so that we can rebuild the word
+        struct Origin
+        {
+          enum Kind { Start, Internal, Return, PendingReturn };
+
+          Kind kind;
+          size_t pred;     // the fact before this step (the caller, for Return)
+          size_t exit;     // for Return, the exit fact of the called level
+          Symbol symbol;   // EPSILON for an epsilon step
+
+          explicit Origin(Kind k, size_t p = none, Symbol s = EPSILON, size_t x = none)
+            : kind(k), pred(p), exit(x), symbol(s)
+          {}
+        };
+
+        struct Fact
+        {
+          size_t level;
+          State state;
+          Summary summary;
+          Origin origin;
+          bool dead;
+
+          Fact(size_t l, State q, Summary const & s, Origin const & o)
+            : level(l), state(q), summary(s), origin(o), dead(false)
+          {}
+        };
+
+        /// A nesting level, identified by the state 'first' entered it in
+        /// and the call symbol (EPSILON for the top level)
+        struct Level
+        {
+          State entry;
+          Symbol symbol;
+          size_t first_caller;
+          std::vector<size_t> callers;
+          std::vector<size_t> facts;
+
+          Level(State e, Symbol s, size_t c)
+            : entry(e), symbol(s), first_caller(c)
+          {}
+
+          bool isTop() const { return symbol == EPSILON; }
+        };
+
+        size_t
+        getLevel(State entry, Symbol sym, size_t caller)
+        {
+          std::pair<State, Symbol> key(entry, sym);
+          std::map<std::pair<State, Symbol>, size_t>::const_iterator place = level_ids_.find(key);
+          if (place != level_ids_.end()) {
+            return place->second;
+          }
+          size_t id = levels_.size();
+          levels_.push_back(Level(entry, sym, caller));
+          level_ids_[key] = id;
+          return id;
+        }
+
+        void
+        addFact(size_t level, State state, Summary const & summary, Origin const & origin)
+        {
+          if (counterexample_ != none) {
+            return;
+          }
+
+          std::vector<size_t> & antichain = antichains_[std::make_pair(level, state)];
+          for (std::vector<size_t>::const_iterator f = antichain.begin(); f != antichain.end(); ++f) {
+            Summary const & other = facts_[*f].summary;
+            if (std::includes(summary.begin(), summary.end(), other.begin(), other.end())) {
+              return;
+            }
+          }
+
+          size_t id = facts_.size();
+          std::vector<size_t> survivors;
+          for (std::vector<size_t>::const_iterator f = antichain.begin(); f != antichain.end(); ++f) {
+            Summary const & other = facts_[*f].summary;
+            if (std::includes(other.begin(), other.end(), summary.begin(), summary.end())) {
+              facts_[*f].dead = true;
+            }
+            else {
+              survivors.push_back(*f);
+            }
+          }
+          survivors.push_back(id);
+          antichain.swap(survivors);
+
+          facts_.push_back(Fact(level, state, summary, origin));
+          levels_[level].facts.push_back(id);
+          worklist_.push_back(id);
+
+          if (first_.isFinalState(state) && !second_.accepts(summary)) {
+            counterexample_ = id;
+          }
+        }
+
+        void
+        process(size_t f)
+        {
+          size_t const level = facts_[f].level;
+          State const state = facts_[f].state;
+          // Copy: adding facts can reallocate 'facts_'
+          Summary const summary = facts_[f].summary;
+
+          TransitionIndex::Targets const & eps = TransitionIndex::lookup(index_.epsilons, state);
+          for (TransitionIndex::Targets::const_iterator t = eps.begin(); t != eps.end(); ++t) {
+            addFact(level, t->second, summary, Origin(Origin::Internal, f));
+          }
+
+          TransitionIndex::Targets const & ints = TransitionIndex::lookup(index_.internals, state);
+          for (TransitionIndex::Targets::const_iterator t = ints.begin(); t != ints.end(); ++t) {
+            for (std::vector<Symbol>::const_iterator sym = alphabet_.begin();
+                 sym != alphabet_.end(); ++sym)
+            {
+              if (matches(t->first, *sym)) {
+                addFact(level, t->second, second_.internal(summary, *sym),
+                        Origin(Origin::Internal, f, *sym));
+              }
+            }
+          }
+
+          TransitionIndex::Targets const & calls = TransitionIndex::lookup(index_.calls, state);
+          for (TransitionIndex::Targets::const_iterator t = calls.begin(); t != calls.end(); ++t) {
+            for (std::vector<Symbol>::const_iterator sym = alphabet_.begin();
+                 sym != alphabet_.end(); ++sym)
+            {
+              if (matches(t->first, *sym)) {
+                enterLevel(f, t->second, *sym);
+              }
+            }
+          }
+
+          if (levels_[level].isTop()) {
+            TransitionIndex::ReturnEdges const & rets = index_.returnsFrom(state);
+            for (TransitionIndex::ReturnEdges::const_iterator r = rets.begin(); r != rets.end(); ++r) {
+              if (!first_.isInitialState(r->call)) {
+                continue;
+              }
+              for (std::vector<Symbol>::const_iterator sym = alphabet_.begin();
+                   sym != alphabet_.end(); ++sym)
+              {
+                if (matches(r->symbol, *sym)) {
+                  addFact(level, r->ret, second_.pendingReturn(summary, *sym),
+                          Origin(Origin::PendingReturn, f, *sym));
+                }
+              }
+            }
+          }
+          else {
+            // Indices, because returning can add callers
+            for (size_t c = 0; c < levels_[level].callers.size(); ++c) {
+              returnTo(levels_[level].callers[c], f);
+            }
+          }
+        }
+
+        void
+        enterLevel(size_t caller, State entry, Symbol sym)
+        {
+          size_t level = getLevel(entry, sym, caller);
+          levels_[level].callers.push_back(caller);
+          if (levels_[level].facts.empty()) {
+            addFact(level, entry, second_.entry(sym), Origin(Origin::Start));
+          }
+          else {
+            // The level has been explored already (from another caller),
+            // so match its exits up with the new caller now
+            for (size_t x = 0; x < levels_[level].facts.size(); ++x) {
+              returnTo(caller, levels_[level].facts[x]);
+            }
+          }
+        }
+
+        void
+        returnTo(size_t caller, size_t exit)
+        {
+          if (facts_[caller].dead || facts_[exit].dead) {
+            return;
+          }
+          TransitionIndex::ReturnEdges const & rets = index_.returnsFrom(facts_[exit].state);
+          for (TransitionIndex::ReturnEdges::const_iterator r = rets.begin(); r != rets.end(); ++r) {
+            if (r->call != facts_[caller].state) {
+              continue;
+            }
+            for (std::vector<Symbol>::const_iterator sym = alphabet_.begin();
+                 sym != alphabet_.end(); ++sym)
+            {
+              if (matches(r->symbol, *sym)) {
+                Summary summary = second_.matchedReturn(facts_[caller].summary,
+                                                        facts_[exit].summary, *sym);
+                addFact(facts_[caller].level, r->ret, summary,
+                        Origin(Origin::Return, caller, *sym, exit));
+              }
+            }
+          }
+        }
+
+        /// One step of rebuilding a word: expand a fact (the part of the
+        /// word within its own level, or the whole word up to it), or
+        /// append a letter
+        struct WordStep
+        {
+          enum Kind { Local, Whole, Call, Internal, Return };
+
+          Kind kind;
+          size_t fact;
+          Symbol symbol;
+
+          WordStep(Kind k, size_t f, Symbol s = EPSILON)
+            : kind(k), fact(f), symbol(s)
+          {}
+        };
+
+        /// Appends the whole word for fact 'f', including the pending
+        /// calls that led to its level. The steps are kept on an explicit
+        /// stack rather than by recursion, because a fact's origin chain
+        /// is as long as the word.
+        void
+        buildWord(NestedWord & word, size_t f) const
+        {
+          std::vector<WordStep> steps;
+          steps.push_back(WordStep(WordStep::Whole, f));
+
+          // Steps are pushed in the reverse of the order they append in
+          while (!steps.empty()) {
+            WordStep step = steps.back();
+            steps.pop_back();
+
+            switch (step.kind) {
+            case WordStep::Call:
+              word.appendCall(step.symbol);
+              break;
+            case WordStep::Internal:
+              word.appendInternal(step.symbol);
+              break;
+            case WordStep::Return:
+              word.appendReturn(step.symbol);
+              break;
+
+            case WordStep::Whole: {
+              Level const & level = levels_[facts_[step.fact].level];
+              steps.push_back(WordStep(WordStep::Local, step.fact));
+              if (!level.isTop()) {
+                steps.push_back(WordStep(WordStep::Call, none, level.symbol));
+                steps.push_back(WordStep(WordStep::Whole, level.first_caller));
+              }
+              break;
+            }
+
+            case WordStep::Local: {
+              Origin const & origin = facts_[step.fact].origin;
+              switch (origin.kind) {
+              case Origin::Start:
+                break;
+              case Origin::Internal:
+                if (origin.symbol != EPSILON) {
+                  steps.push_back(WordStep(WordStep::Internal, none, origin.symbol));
+                }
+                steps.push_back(WordStep(WordStep::Local, origin.pred));
+                break;
+              case Origin::PendingReturn:
+                steps.push_back(WordStep(WordStep::Return, none, origin.symbol));
+                steps.push_back(WordStep(WordStep::Local, origin.pred));
+                break;
+              case Origin::Return:
+                steps.push_back(WordStep(WordStep::Return, none, origin.symbol));
+                steps.push_back(WordStep(WordStep::Local, origin.exit));
+                steps.push_back(WordStep(WordStep::Call, none,
+                                         levels_[facts_[origin.exit].level].symbol));
+                steps.push_back(WordStep(WordStep::Local, origin.pred));
+                break;
+              }
+              break;
+            }
+            }
+          }
+        }
+
+        Nwa const & first_;
+        TransitionIndex index_;
+        SummaryStepper second_;
+        std::vector<Symbol> alphabet_;
+
+        std::vector<Fact> facts_;
+        std::vector<Level> levels_;
+        std::map<std::pair<State, Symbol>, size_t> level_ids_;
+        std::map<std::pair<size_t, State>, std::vector<size_t> > antichains_;
+        std::deque<size_t> worklist_;
+        size_t counterexample_;
+      };
+
+    } // end anonymous namespace
+
+
+    NestedWordRefPtr
+    getSomeWordInDifference(Nwa const & first, Nwa const & second)
+    {
+      InclusionChecker checker(first, second);
+      return checker.run();
+    }
+
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
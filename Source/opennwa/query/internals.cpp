@@ -9,6 +9,9 @@ namespace opennwa
     typedef  Trans::CallIterator CallIterator;
     typedef  Trans::InternalIterator InternalIterator;
     typedef  Trans::ReturnIterator ReturnIterator;
+    typedef  Trans::CallRangeIterator CallRangeIterator;
+    typedef  Trans::InternalRangeIterator InternalRangeIterator;
+    typedef  Trans::ReturnRangeIterator ReturnRangeIterator;
     typedef  Trans::Call Call;       
     typedef  Trans::Internal Internal;   
     typedef  Trans::Return Return;          
@@ -34,12 +37,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Internals & src = trans.getInternals();
+      Trans::InternalRange src = trans.getInternalsOn(symbol);
       StateSet sources;
-      for( InternalIterator it = src.begin(); it != src.end(); it++ )
+      for( InternalRangeIterator it = src.first; it != src.second; it++ )
       {
-        if( symbol == Trans::getInternalSym(*it) )
-          sources.insert( Trans::getSource(*it) );
+        sources.insert( Trans::getSource(*it) );
       }
       return sources;
     }
@@ -63,12 +65,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Internals & src = trans.getTransTo(target);
+      Trans::InternalRange src = trans.getTransTo(target, symbol);
       StateSet sources;
-      for( InternalIterator it = src.begin(); it != src.end(); it++ )
+      for( InternalRangeIterator it = src.first; it != src.second; it++ )
       {
-        if( symbol == Trans::getInternalSym(*it) )
-          sources.insert( Trans::getSource(*it) );
+        sources.insert( Trans::getSource(*it) );
       }
       return sources;
     }
@@ -226,12 +227,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Internals & tgt = trans.getInternals();
+      Trans::InternalRange tgt = trans.getInternalsOn(symbol);
       StateSet targets;
-      for( InternalIterator it = tgt.begin(); it != tgt.end(); it++ )
+      for( InternalRangeIterator it = tgt.first; it != tgt.second; it++ )
       {
-        if( symbol == Trans::getInternalSym(*it) )
-          targets.insert( Trans::getTarget(*it) );
+        targets.insert( Trans::getTarget(*it) );
       }
       return targets;
     }
@@ -256,12 +256,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Internals & tgt = trans.getTransFrom(source);
+      Trans::InternalRange tgt = trans.getTransFrom(source, symbol);
       StateSet targets;
-      for( InternalIterator it = tgt.begin(); it != tgt.end(); it++ )
+      for( InternalRangeIterator it = tgt.first; it != tgt.second; it++ )
       {
-        if( symbol == Trans::getInternalSym(*it) )
-          targets.insert( Trans::getTarget(*it) );
+        targets.insert( Trans::getTarget(*it) );
       }
       return targets;
     }
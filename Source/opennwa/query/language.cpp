@@ -1,7 +1,5 @@
 #include "opennwa/Nwa.hpp"
 #include "opennwa/NestedWord.hpp"
-#include "opennwa/construct/intersect.hpp"
-#include "opennwa/construct/complement.hpp"
 
 #include "opennwa/query/language.hpp"
 
@@ -18,32 +16,12 @@ namespace opennwa {
     bool
     languageSubsetEq(Nwa const & first, Nwa const & second)
     {
-      Nwa second_copy = second;
-        
-      // We have to synchronize alphabets first
-      for (Nwa::SymbolIterator sym = first.beginSymbols();
-           sym != first.endSymbols(); ++sym)
-      {
-        second_copy.addSymbol(*sym);
-      }
-        
-      //Check L(a1) contained in L(a2) by checking 
-      //if L(a1) intersect (complement L(a2)) is empty.
-      NwaRefPtr comp = construct::complement(second_copy);
-      NwaRefPtr inter = construct::intersect(first, *comp);
-      //inter.intersect(first, comp); //L(a1) intersect (complement L(a2))
-
-      return languageIsEmpty(*inter);
+      //Check L(a1) contained in L(a2) by looking for a word in L(a1) that
+      //is not in L(a2); see inclusion.cpp.
+      return getSomeWordInDifference(first, second).is_empty();
     }
 
       
-    bool
-    languageIsEmpty(Nwa const & nwa)
-    {
-      return nwa._private_isEmpty_();
-    }
-
-
     bool
     languageEquals(Nwa const & first, Nwa const & second)
     {
@@ -7,6 +7,8 @@
 #include "wali/witness/Witness.hpp"
 #include "wali/witness/CalculatingVisitor.hpp"
 
+#include <vector>
+
 namespace opennwa {
   namespace query {
 
@@ -34,6 +36,26 @@ namespace opennwa {
     languageSubsetEq(Nwa const & left, Nwa const & right);
 
 
+    /**
+     * @brief Returns some word that is accepted by 'first' but not by
+     *        'second', or NULL if the language of 'first' is included in
+     *        the language of 'second'
+     *
+     * This explores 'first' together with an on-the-fly subset
+     * construction of 'second', keeping only the minimal subsets it
+     * finds, so 'second' is never complemented (or even fully
+     * determinized). Words are built from the symbols of both NWAs.
+     *
+     * @param - first: the proposed subset
+     * @param - second: the proposed superset
+     * @return a word in L(first) - L(second), or NULL if there is none
+     *
+     */
+    extern
+    ref_ptr<NestedWord>
+    getSomeWordInDifference(Nwa const & first, Nwa const & second);
+
+
     /**
      *
      * @brief tests whether the language accepted by this NWA is empty
@@ -47,6 +69,54 @@ namespace opennwa {
     languageIsEmpty(Nwa const & nwa);
 
 
+    /**
+     *
+     * @brief tests whether the language accepted by this NWA is empty, and
+     *        if not, returns an accepted word in 'witness'
+     *
+     * This searches the NWA directly (computing call/return summaries as
+     * it goes) and stops at the first final state it reaches.
+     *
+     * @param - witness: set to a word accepted by 'nwa', or NULL if the
+     *                   language is empty
+     * @return true if the language accepted by this NWA is empty
+     *
+     */
+    bool
+    languageIsEmpty(Nwa const & nwa, NestedWordRefPtr & witness);
+
+
+    /**
+     *
+     * @brief tests whether the intersection of the languages of the given
+     *        NWAs is empty
+     *
+     * This explores the product of all of the NWAs at once, creating
+     * only the tuples of states that are reachable, so it does not build
+     * the product (or the intermediate products of chained calls to
+     * construct::intersect). Client info is ignored.
+     *
+     * @param - nwas: the NWAs to intersect; there must be at least one
+     * @return true if no word is accepted by all of the NWAs
+     *
+     */
+    bool
+    languageIntersectionIsEmpty(std::vector<Nwa const *> const & nwas);
+
+
+    /**
+     *
+     * @brief Returns some word accepted by all of the given NWAs, or NULL
+     *        if there isn't one
+     *
+     * See languageIntersectionIsEmpty.
+     *
+     */
+    extern
+    ref_ptr<NestedWord>
+    getSomeAcceptedWordInIntersection(std::vector<Nwa const *> const & nwas);
+
+
     /**
      *
      * @brief Returns some word accepted by 'nwa', or NULL if there isn't one.
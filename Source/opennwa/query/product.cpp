@@ -0,0 +1,356 @@
+#include "opennwa/Nwa.hpp"
+#include "opennwa/NestedWord.hpp"
+#include "opennwa/query/language.hpp"
+#include "opennwa/query/details/TransitionIndex.hpp"
+#include "opennwa/query/details/SummaryReachability.hpp"
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+// This file implements emptiness (and witnesses) for the intersection of
+// several NWAs without building the product, or any of the intermediate
+// products that chaining construct::intersect would. The product is
+// presented to details::SummaryReachability as a graph whose nodes are
+// tuples of states, created only when the search reaches them.
+//
+// This is the plain product: unlike Nwa::_private_intersect_, it does not
+// consult stateIntersect/transitionIntersect, so client info is ignored.
+
+namespace opennwa {
+  namespace query {
+
+    namespace {
+
+      using details::TransitionIndex;
+      using details::matches;
+
+      /// Interns tuples of states as small integers. All tuples have the
+      /// same length and are stored back to back in one array; the hash
+      /// table holds only their ids.
+      class TupleTable
+      {
+      public:
+        explicit TupleTable(size_t width)
+          : width_(width)
+          , ids_(0, Hash(*this), Equal(*this))
+        {}
+
+        size_t width() const { return width_; }
+
+        /// The id of the tuple [begin, begin + width()), adding it if it
+        /// is new
+        size_t
+        intern(State const * begin)
+        {
+          size_t candidate = size();
+          states_.insert(states_.end(), begin, begin + width_);
+          std::pair<IdSet::iterator, bool> place = ids_.insert(candidate);
+          if (!place.second) {
+            states_.resize(candidate * width_);
+          }
+          return *place.first;
+        }
+
+        State const *
+        tuple(size_t id) const
+        {
+          return &states_[id * width_];
+        }
+
+        size_t size() const { return states_.size() / width_; }
+
+      private:
+        // Hash and Equal point back at the table
+        TupleTable(TupleTable const &);
+        TupleTable & operator=(TupleTable const &);
+
+        struct Hash
+        {
+          TupleTable const * table;
+          explicit Hash(TupleTable const & t) : table(&t) {}
+
+          size_t operator()(size_t id) const {
+            State const * t = table->tuple(id);
+            return boost::hash_range(t, t + table->width_);
+          }
+        };
+
+        struct Equal
+        {
+          TupleTable const * table;
+          explicit Equal(TupleTable const & t) : table(&t) {}
+
+          bool operator()(size_t left, size_t right) const {
+            State const * l = table->tuple(left);
+            return std::equal(l, l + table->width_, table->tuple(right));
+          }
+        };
+
+        typedef boost::unordered_set<size_t, Hash, Equal> IdSet;
+
+        size_t width_;
+        std::vector<State> states_;
+        IdSet ids_;
+      };
+
+
+      class ProductGraph
+      {
+      public:
+        typedef size_t Node;
+        typedef std::vector<std::pair<Symbol, Node> > Edges;
+
+        explicit ProductGraph(std::vector<Nwa const *> const & nwas)
+          : nwas_(nwas)
+          , tuples_(nwas.size())
+        {
+          assert(!nwas.empty());
+          SymbolSet symbols;
+          for (size_t i = 0; i < nwas.size(); ++i) {
+            indices_.push_back(TransitionIndex(*nwas[i]));
+            symbols.insert(nwas[i]->beginSymbols(), nwas[i]->endSymbols());
+          }
+          for (SymbolSet::const_iterator sym = symbols.begin(); sym != symbols.end(); ++sym) {
+            if (*sym != EPSILON && *sym != WILD) {
+              alphabet_.push_back(*sym);
+            }
+          }
+        }
+
+        void
+        initial(std::vector<Node> & out)
+        {
+          Choices choices(nwas_.size());
+          for (size_t i = 0; i < nwas_.size(); ++i) {
+            choices[i].assign(nwas_[i]->beginInitialStates(), nwas_[i]->endInitialStates());
+          }
+          std::vector<Node> nodes;
+          combine(choices, nodes);
+          out.insert(out.end(), nodes.begin(), nodes.end());
+        }
+
+        bool
+        isFinal(Node n) const
+        {
+          State const * t = tuples_.tuple(n);
+          for (size_t i = 0; i < nwas_.size(); ++i) {
+            if (!nwas_[i]->isFinalState(t[i])) {
+              return false;
+            }
+          }
+          return true;
+        }
+
+        /// One component takes an epsilon step, the others stay put
+        void
+        epsilons(Node n, std::vector<Node> & out)
+        {
+          std::vector<State> t(tuples_.tuple(n), tuples_.tuple(n) + nwas_.size());
+          for (size_t i = 0; i < nwas_.size(); ++i) {
+            TransitionIndex::Targets const & eps =
+              TransitionIndex::lookup(indices_[i].epsilons, t[i]);
+            State const here = t[i];
+            for (TransitionIndex::Targets::const_iterator e = eps.begin(); e != eps.end(); ++e) {
+              t[i] = e->second;
+              out.push_back(tuples_.intern(&t[0]));
+            }
+            t[i] = here;
+          }
+        }
+
+        void
+        internals(Node n, Edges & out)
+        {
+          step(n, &TransitionIndex::internals, out);
+        }
+
+        void
+        calls(Node n, Edges & out)
+        {
+          step(n, &TransitionIndex::calls, out);
+        }
+
+        void
+        returns(Node exit, Node call, Edges & out)
+        {
+          // Copy: interning can move the tuple storage
+          std::vector<State> c(tuples_.tuple(call), tuples_.tuple(call) + nwas_.size());
+          returnStep(exit, &c, out);
+        }
+
+        void
+        pendingReturns(Node exit, Edges & out)
+        {
+          returnStep(exit, NULL, out);
+        }
+
+      private:
+        typedef std::vector<std::vector<State> > Choices;
+
+        /// Adds every tuple that picks one state from each entry of
+        /// 'choices'
+        void
+        combine(Choices const & choices, std::vector<Node> & out)
+        {
+          for (size_t i = 0; i < choices.size(); ++i) {
+            if (choices[i].empty()) {
+              return;
+            }
+          }
+          std::vector<size_t> position(choices.size(), 0);
+          std::vector<State> t(choices.size());
+          while (true) {
+            for (size_t i = 0; i < choices.size(); ++i) {
+              t[i] = choices[i][position[i]];
+            }
+            out.push_back(tuples_.intern(&t[0]));
+
+            size_t i = 0;
+            while (i < choices.size() && ++position[i] == choices[i].size()) {
+              position[i] = 0;
+              ++i;
+            }
+            if (i == choices.size()) {
+              return;
+            }
+          }
+        }
+
+        /// The symbols worth trying for a step whose first component
+        /// goes along a transition labeled 'label'
+        void
+        candidateSymbols(Symbol label, std::vector<Symbol> & out) const
+        {
+          if (label == WILD) {
+            out.insert(out.end(), alphabet_.begin(), alphabet_.end());
+          }
+          else {
+            out.push_back(label);
+          }
+        }
+
+        void
+        step(Node n, TransitionIndex::TargetMap TransitionIndex::* which, Edges & out)
+        {
+          std::vector<State> t(tuples_.tuple(n), tuples_.tuple(n) + nwas_.size());
+
+          std::vector<Symbol> symbols;
+          TransitionIndex::Targets const & first = TransitionIndex::lookup(indices_[0].*which, t[0]);
+          for (TransitionIndex::Targets::const_iterator e = first.begin(); e != first.end(); ++e) {
+            candidateSymbols(e->first, symbols);
+          }
+          std::sort(symbols.begin(), symbols.end());
+          symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+          for (std::vector<Symbol>::const_iterator sym = symbols.begin(); sym != symbols.end(); ++sym) {
+            Choices choices(nwas_.size());
+            for (size_t i = 0; i < nwas_.size(); ++i) {
+              TransitionIndex::Targets const & targets =
+                TransitionIndex::lookup(indices_[i].*which, t[i]);
+              for (TransitionIndex::Targets::const_iterator e = targets.begin(); e != targets.end(); ++e) {
+                if (matches(e->first, *sym)) {
+                  choices[i].push_back(e->second);
+                }
+              }
+            }
+            addEdges(*sym, choices, out);
+          }
+        }
+
+        /// A matched return if 'call' is given, or a pending one
+        void
+        returnStep(Node exit, std::vector<State> const * call, Edges & out)
+        {
+          std::vector<State> x(tuples_.tuple(exit), tuples_.tuple(exit) + nwas_.size());
+
+          std::vector<Symbol> symbols;
+          TransitionIndex::ReturnEdges const & first = indices_[0].returnsFrom(x[0]);
+          for (TransitionIndex::ReturnEdges::const_iterator r = first.begin(); r != first.end(); ++r) {
+            if (callMatches(0, *r, call)) {
+              candidateSymbols(r->symbol, symbols);
+            }
+          }
+          std::sort(symbols.begin(), symbols.end());
+          symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+          for (std::vector<Symbol>::const_iterator sym = symbols.begin(); sym != symbols.end(); ++sym) {
+            Choices choices(nwas_.size());
+            for (size_t i = 0; i < nwas_.size(); ++i) {
+              TransitionIndex::ReturnEdges const & rets = indices_[i].returnsFrom(x[i]);
+              for (TransitionIndex::ReturnEdges::const_iterator r = rets.begin(); r != rets.end(); ++r) {
+                if (callMatches(i, *r, call) && matches(r->symbol, *sym)) {
+                  choices[i].push_back(r->ret);
+                }
+              }
+            }
+            addEdges(*sym, choices, out);
+          }
+        }
+
+        bool
+        callMatches(size_t i, TransitionIndex::ReturnEdge const & r,
+                    std::vector<State> const * call) const
+        {
+          return call ? r.call == (*call)[i] : nwas_[i]->isInitialState(r.call);
+        }
+
+        void
+        addEdges(Symbol sym, Choices const & choices, Edges & out)
+        {
+          std::vector<Node> targets;
+          combine(choices, targets);
+          for (std::vector<Node>::const_iterator n = targets.begin(); n != targets.end(); ++n) {
+            out.push_back(std::make_pair(sym, *n));
+          }
+        }
+
+        std::vector<Nwa const *> nwas_;
+        std::vector<TransitionIndex> indices_;
+        std::vector<Symbol> alphabet_;
+        TupleTable tuples_;
+      };
+
+      typedef details::SummaryReachability<ProductGraph> ProductReachability;
+
+    } // end anonymous namespace
+
+
+    bool
+    languageIntersectionIsEmpty(std::vector<Nwa const *> const & nwas)
+    {
+      for (size_t i = 0; i < nwas.size(); ++i) {
+        if (nwas[i]->sizeInitialStates() == 0 || nwas[i]->sizeFinalStates() == 0) {
+          return true;
+        }
+      }
+      ProductGraph graph(nwas);
+      ProductReachability search(graph);
+      return !search.run();
+    }
+
+
+    NestedWordRefPtr
+    getSomeAcceptedWordInIntersection(std::vector<Nwa const *> const & nwas)
+    {
+      ProductGraph graph(nwas);
+      ProductReachability search(graph);
+      if (search.run()) {
+        return search.witness();
+      }
+      return NestedWordRefPtr();
+    }
+
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
@@ -9,6 +9,9 @@ namespace opennwa
     typedef  Trans::CallIterator CallIterator;
     typedef  Trans::InternalIterator InternalIterator;
     typedef  Trans::ReturnIterator ReturnIterator;
+    typedef  Trans::CallRangeIterator CallRangeIterator;
+    typedef  Trans::InternalRangeIterator InternalRangeIterator;
+    typedef  Trans::ReturnRangeIterator ReturnRangeIterator;
     typedef  Trans::Call Call;       
     typedef  Trans::Internal Internal;   
     typedef  Trans::Return Return;          
@@ -35,14 +38,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns & exit = trans.getReturns();
+      Trans::ReturnRange exit = trans.getReturnsOn(symbol);
       StateSet exits;
-      for( ReturnIterator it = exit.begin(); it != exit.end(); it++ )
+      for( ReturnRangeIterator it = exit.first; it != exit.second; it++ )
       {
-        if( symbol == Trans::getReturnSym(*it) )
-        {
-          exits.insert( Trans::getExit(*it) );
-        }
+        exits.insert( Trans::getExit(*it) );
       }
       return exits;
     }
@@ -68,11 +68,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns & exit = trans.getTransPred(callSite);
+      Trans::ReturnRange exit = trans.getTransPred(callSite, symbol);
       StateSet exits;
-      for( ReturnIterator it = exit.begin(); it != exit.end(); it++ )
+      for( ReturnRangeIterator it = exit.first; it != exit.second; it++ )
       {
-        if( (Trans::getReturnSite(*it) == returnSite) && (symbol == Trans::getReturnSym(*it)) )
+        if( Trans::getReturnSite(*it) == returnSite )
         {
           exits.insert( Trans::getExit(*it) );
         }
@@ -150,12 +150,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns & exit = trans.getTransPred(callSite);
+      Trans::ReturnRange exit = trans.getTransPred(callSite, symbol);
       StateSet exits;
-      for( ReturnIterator it = exit.begin(); it != exit.end(); it++ )
+      for( ReturnRangeIterator it = exit.first; it != exit.second; it++ )
       {
-        if( symbol == Trans::getReturnSym(*it) )
-          exits.insert( Trans::getExit(*it) );
+        exits.insert( Trans::getExit(*it) );
       }
       return exits;
     }
@@ -206,12 +205,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns & exit = trans.getTransRet(returnSite);
+      Trans::ReturnRange exit = trans.getTransRet(returnSite, symbol);
       StateSet exits;
-      for( ReturnIterator it = exit.begin(); it != exit.end(); it++ )
+      for( ReturnRangeIterator it = exit.first; it != exit.second; it++ )
       {
-        if( symbol == Trans::getReturnSym(*it) )
-          exits.insert( Trans::getExit(*it) );
+        exits.insert( Trans::getExit(*it) );
       }
       return exits;
     }
@@ -258,14 +256,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns & call = trans.getReturns();
+      Trans::ReturnRange call = trans.getReturnsOn(symbol);
       StateSet calls;
-      for( ReturnIterator it = call.begin(); it != call.end(); it++ )
+      for( ReturnRangeIterator it = call.first; it != call.second; it++ )
       {
-        if( symbol == Trans::getReturnSym(*it) )
-        {
-          calls.insert( Trans::getCallSite(*it) );
-        }
+        calls.insert( Trans::getCallSite(*it) );
       }
       return calls;
     }
@@ -291,11 +286,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns call = trans.getTransExit(exitPoint);
+      Trans::ReturnRange call = trans.getTransExit(exitPoint, symbol);
       StateSet calls;
-      for( ReturnIterator it = call.begin(); it != call.end(); it++ )
+      for( ReturnRangeIterator it = call.first; it != call.second; it++ )
       {
-        if( (Trans::getReturnSite(*it) == returnSite) &&  (symbol == Trans::getReturnSym(*it)) )
+        if( Trans::getReturnSite(*it) == returnSite )
         {
           calls.insert( Trans::getCallSite(*it) );
         }
@@ -373,12 +368,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns call = trans.getTransExit(exitPoint);
+      Trans::ReturnRange call = trans.getTransExit(exitPoint, symbol);
       StateSet calls;
-      for( ReturnIterator it = call.begin(); it != call.end(); it++ )
+      for( ReturnRangeIterator it = call.first; it != call.second; it++ )
       {
-        if( symbol == Trans::getReturnSym(*it) )
-          calls.insert( Trans::getCallSite(*it) );
+        calls.insert( Trans::getCallSite(*it) );
       }
       return calls;
     }
@@ -428,12 +422,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns call = trans.getTransRet(returnSite);
+      Trans::ReturnRange call = trans.getTransRet(returnSite, symbol);
       StateSet calls;
-      for( ReturnIterator it = call.begin(); it != call.end(); it++ )
+      for( ReturnRangeIterator it = call.first; it != call.second; it++ )
       {
-        if( symbol == Trans::getReturnSym(*it) )
-          calls.insert( Trans::getCallSite(*it) );
+        calls.insert( Trans::getCallSite(*it) );
       }
       return calls;
     }
@@ -706,14 +699,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
       
-      const Returns ret = trans.getReturns();
+      Trans::ReturnRange ret = trans.getReturnsOn(symbol);
       StateSet returns;
-      for( ReturnIterator it = ret.begin(); it != ret.end(); it++ )
+      for( ReturnRangeIterator it = ret.first; it != ret.second; it++ )
       {
-        if( symbol == Trans::getReturnSym(*it) )
-        {
-          returns.insert( Trans::getReturnSite(*it) );
-        }
+        returns.insert( Trans::getReturnSite(*it) );
       }
       return returns;
     }
@@ -739,14 +729,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns ret = trans.getTransExit(exitPoint);
+      Trans::ReturnRange ret = trans.getTransExit(exitPoint, callSite, symbol);
       StateSet returns;
-      for( ReturnIterator it = ret.begin(); it != ret.end(); it++ )
+      for( ReturnRangeIterator it = ret.first; it != ret.second; it++ )
       {
-        if( (Trans::getCallSite(*it) == callSite) && (symbol == Trans::getReturnSym(*it)) )
-        {
-          returns.insert( Trans::getReturnSite(*it) );
-        }
+        returns.insert( Trans::getReturnSite(*it) );
       }
       return returns;
     }
@@ -821,12 +808,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns ret = trans.getTransExit(exitPoint);
+      Trans::ReturnRange ret = trans.getTransExit(exitPoint, symbol);
       StateSet returns;
-      for( ReturnIterator it = ret.begin(); it != ret.end(); it++ )
+      for( ReturnRangeIterator it = ret.first; it != ret.second; it++ )
       {
-        if( symbol == Trans::getReturnSym(*it) )
-          returns.insert( Trans::getReturnSite(*it) );
+        returns.insert( Trans::getReturnSite(*it) );
       }
       return returns;
     }
@@ -876,12 +862,11 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      const Returns ret = trans.getTransPred(callSite);
+      Trans::ReturnRange ret = trans.getTransPred(callSite, symbol);
       StateSet returns;
-      for( ReturnIterator it = ret.begin(); it != ret.end(); it++ )
+      for( ReturnRangeIterator it = ret.first; it != ret.second; it++ )
       {
-        if( symbol == Trans::getReturnSym(*it) )
-          returns.insert( Trans::getReturnSite(*it) );
+        returns.insert( Trans::getReturnSite(*it) );
       }
       return returns;
     }
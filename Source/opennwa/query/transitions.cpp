@@ -10,6 +10,9 @@ namespace opennwa
     typedef  Trans::CallIterator CallIterator;
     typedef  Trans::InternalIterator InternalIterator;
     typedef  Trans::ReturnIterator ReturnIterator;
+    typedef  Trans::CallRangeIterator CallRangeIterator;
+    typedef  Trans::InternalRangeIterator InternalRangeIterator;
+    typedef  Trans::ReturnRangeIterator ReturnRangeIterator;
     typedef  Trans::Call Call;       
     typedef  Trans::Internal Internal;   
     typedef  Trans::Return Return;          
@@ -246,20 +249,17 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      std::set<Call> const & calls = trans.getTransEntry(state);
-      for( CallIterator cit = calls.begin(); cit != calls.end(); cit++ )
-        if( symbol == Trans::getCallSym(*cit) )
-          preds.insert(Trans::getCallSite(*cit));
+      Trans::CallRange calls = trans.getTransEntry(state, symbol);
+      for( CallRangeIterator cit = calls.first; cit != calls.second; cit++ )
+        preds.insert(Trans::getCallSite(*cit));
 
-      std::set<Internal> const & internals = trans.getTransTo(state);
-      for( InternalIterator iit = internals.begin(); iit != internals.end(); iit++ )
-        if( symbol == Trans::getInternalSym(*iit) )
-          preds.insert(Trans::getSource(*iit));
+      Trans::InternalRange internals = trans.getTransTo(state, symbol);
+      for( InternalRangeIterator iit = internals.first; iit != internals.second; iit++ )
+        preds.insert(Trans::getSource(*iit));
 
-      std::set<Return> const & returns = trans.getTransRet(state);
-      for( ReturnIterator rit = returns.begin(); rit != returns.end(); rit++ )
-        if( symbol == Trans::getReturnSym(*rit) )
-          preds.insert(Trans::getExit(*rit));
+      Trans::ReturnRange returns = trans.getTransRet(state, symbol);
+      for( ReturnRangeIterator rit = returns.first; rit != returns.second; rit++ )
+        preds.insert(Trans::getExit(*rit));
     }
     /**
      * 
@@ -344,20 +344,17 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      std::set<Call> const & calls = trans.getTransCall(state);
-      for( CallIterator cit = calls.begin(); cit != calls.end(); cit++ )
-        if( symbol == Trans::getCallSym(*cit) )
-          succs.insert(Trans::getEntry(*cit));
+      Trans::CallRange calls = trans.getTransCall(state, symbol);
+      for( CallRangeIterator cit = calls.first; cit != calls.second; cit++ )
+        succs.insert(Trans::getEntry(*cit));
 
-      std::set<Internal> const & internals = trans.getTransFrom(state);
-      for( InternalIterator iit = internals.begin(); iit != internals.end(); iit++ )
-        if( symbol == Trans::getInternalSym(*iit) )
-          succs.insert(Trans::getTarget(*iit));
+      Trans::InternalRange internals = trans.getTransFrom(state, symbol);
+      for( InternalRangeIterator iit = internals.first; iit != internals.second; iit++ )
+        succs.insert(Trans::getTarget(*iit));
 
-      std::set<Return> const & returns = trans.getTransExit(state);
-      for( ReturnIterator rit = returns.begin(); rit != returns.end(); rit++ )
-        if( symbol == Trans::getReturnSym(*rit) )
-          succs.insert(Trans::getReturnSite(*rit));
+      Trans::ReturnRange returns = trans.getTransExit(state, symbol);
+      for( ReturnRangeIterator rit = returns.first; rit != returns.second; rit++ )
+        succs.insert(Trans::getReturnSite(*rit));
     }
     /**
      * 
@@ -523,10 +520,9 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
 
-      std::set<Return> const & returns = trans.getTransRet(state);
-      for( ReturnIterator rit = returns.begin(); rit != returns.end(); rit++ )
-        if( symbol == Trans::getReturnSym(*rit) )
-          c_preds.insert(Trans::getCallSite(*rit));
+      Trans::ReturnRange returns = trans.getTransRet(state, symbol);
+      for( ReturnRangeIterator rit = returns.first; rit != returns.second; rit++ )
+        c_preds.insert(Trans::getCallSite(*rit));
     }
     /**
      * 
@@ -603,10 +599,9 @@ namespace opennwa
 
       details::TransitionStorage const & trans = nwa._private_get_transition_storage_();
       
-      std::set<Return> const & returns = trans.getTransPred(state);
-      for( ReturnIterator rit = returns.begin(); rit != returns.end(); rit++ )
-        if( symbol == Trans::getReturnSym(*rit) )
-          c_succs.insert(Trans::getReturnSite(*rit));
+      Trans::ReturnRange returns = trans.getTransPred(state, symbol);
+      for( ReturnRangeIterator rit = returns.first; rit != returns.second; rit++ )
+        c_succs.insert(Trans::getReturnSite(*rit));
     }
     /**
      * 
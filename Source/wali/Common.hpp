@@ -151,5 +151,19 @@ namespace wali
 #   define HAS_PRAGMA_MESSAGE 1
 #endif // defined(__GNUC__)
 
+/*!
+ * @macro WALI_RESTRICT
+ *
+ * Declares that a pointer does not alias any other pointer parameter,
+ * so that loops over it can be vectorized without overlap checks.
+ */
+#if defined(__GNUC__)
+#   define WALI_RESTRICT __restrict__
+#elif defined(_MSC_VER)
+#   define WALI_RESTRICT __restrict
+#else
+#   define WALI_RESTRICT
+#endif
+
 #endif  // wali_COMMON_GUARD
 
@@ -10,6 +10,7 @@
 #   pragma warning(disable: 4786)
 #endif
 
+#include <algorithm> // std::swap
 #include <climits> // ULONG_MAX
 #include <utility>  // std::pair
 #include <functional>
@@ -274,6 +275,18 @@ namespace wali
             numValues = 0;
           }
 
+          /// Exchanges the contents of the two maps in constant time
+          void swap( HashMap& hm )
+          {
+            std::swap(buckets,hm.buckets);
+            std::swap(numValues,hm.numValues);
+            std::swap(numBuckets,hm.numBuckets);
+            std::swap(growthFactor,hm.growthFactor);
+            std::swap(shrinkFactor,hm.shrinkFactor);
+            std::swap(hashFunc,hm.hashFunc);
+            std::swap(equalFunc,hm.equalFunc);
+          }
+
           inline size_type size() const
           {
             return numValues;
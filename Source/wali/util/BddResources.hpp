@@ -0,0 +1,238 @@
+#ifndef WALI_UTIL_BDD_RESOURCES_HPP
+#define WALI_UTIL_BDD_RESOURCES_HPP
+
+#include "buddy/bdd.h"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace wali
+{
+  namespace util
+  {
+
+    /**
+     * Thrown (in place of BuDDy's abort) when BuDDy runs out of nodes
+     * while the hooks installed by bddInit are in place: BDD_NODENUM (the
+     * node table is at the ceiling set by BddResources::maxNodes and a GC
+     * did not free anything) or BDD_MEMORY (the table could not grow).
+     * Other errors go to the handler that was installed before.
+     *
+     * The operation that failed has no result, but the BDDs built
+     * before it are intact, and BuDDy can go on once some of them are
+     * dropped. (Running out of nodes during dynamic reordering is the
+     * exception; BuDDy cannot recover from that.)
+     */
+    class BddResourceError : public std::runtime_error
+    {
+    public:
+      BddResourceError( int code )
+        : std::runtime_error(std::string("BDD error: ") + bdd_errstring(code))
+        , code_(code)
+      {}
+
+      /// BuDDy's error code (BDD_NODENUM and so on)
+      int code( ) const { return code_; }
+
+    private:
+      int code_;
+    };
+
+
+    /**
+     * How big BuDDy's tables start and how they grow.
+     *
+     * The node table starts at initialNodes. When a GC leaves less than
+     * minFreePercent of it free, BuDDy grows it: it doubles, but by no
+     * more than maxIncrease nodes at a time, and never past maxNodes. The
+     * operator caches keep one entry per cacheRatio nodes as the table
+     * grows. So a small job stays small and a big one works its way up,
+     * rather than every job paying for the largest.
+     *
+     * Each field can be overridden by an environment variable; see
+     * fromEnvironment.
+     */
+    struct BddResources
+    {
+      int initialNodes;     ///< WALI_BDD_NODES
+      int cacheRatio;       ///< WALI_BDD_CACHE_RATIO: nodes per cache entry
+      int maxIncrease;      ///< WALI_BDD_MAX_INCREASE: most nodes added per resize
+      int minFreePercent;   ///< WALI_BDD_MIN_FREE: grow after a GC frees less
+      int maxNodes;         ///< WALI_BDD_MAX_NODES: ceiling, 0 for none
+      bool report;          ///< WALI_BDD_STATS: print statistics at shutdown
+
+      /// The defaults: 25M nodes (about 500 MB) to start, no ceiling
+      BddResources( int nodes = 25000000 )
+        : initialNodes(nodes)
+        , cacheRatio(10)
+        , maxIncrease(2500000)
+        , minFreePercent(20)
+        , maxNodes(0)
+        , report(false)
+      {}
+
+      /// These values, with each one that is set in the environment
+      /// replaced by the environment's
+      BddResources fromEnvironment( ) const
+      {
+        BddResources r = *this;
+        readEnvironment("WALI_BDD_NODES", r.initialNodes);
+        readEnvironment("WALI_BDD_CACHE_RATIO", r.cacheRatio);
+        readEnvironment("WALI_BDD_MAX_INCREASE", r.maxIncrease);
+        readEnvironment("WALI_BDD_MIN_FREE", r.minFreePercent);
+        readEnvironment("WALI_BDD_MAX_NODES", r.maxNodes);
+        int report = r.report;
+        readEnvironment("WALI_BDD_STATS", report);
+        r.report = report != 0;
+        return r;
+      }
+
+    private:
+      static void readEnvironment( char const * name, int & value )
+      {
+        char const * text = std::getenv(name);
+        if( text == NULL )
+          return;
+        char * end;
+        long v = std::strtol(text, &end, 10);
+        if( *text == '\0' || *end != '\0' || v < 0 ) {
+          std::cerr << "Warning: Invalid value for environment variable "
+                    << name << ": " << text << "\n";
+          return;
+        }
+        value = static_cast<int>(v);
+      }
+    };
+
+
+    /// What BuDDy's node table has been through since bddInit
+    struct BddStatistics
+    {
+      int garbageCollections;
+      double gcSeconds;
+      int resizes;
+      int tableSize;          ///< nodes allocated now
+      int largestLiveNodes;   ///< most nodes still in use after a GC
+    };
+
+
+    namespace details
+    {
+      struct BddHookState
+      {
+        BddStatistics stats;
+        bool report;
+        bddinthandler previousError;
+      };
+
+      inline BddHookState & bddHookState( )
+      {
+        static BDD_TLS BddHookState state;
+        return state;
+      }
+
+      inline void bddErrorHook( int code )
+      {
+        if( code == BDD_NODENUM || code == BDD_MEMORY )
+          throw BddResourceError(code);
+        bddinthandler previous = bddHookState().previousError;
+        if( previous != NULL )
+          previous(code);
+      }
+
+      inline void bddGbcHook( int pre, bddGbcStat * s )
+      {
+        if( pre )
+          return;
+        BddStatistics & stats = bddHookState().stats;
+        stats.garbageCollections = s->num;
+        stats.gcSeconds = double(s->sumtime) / CLOCKS_PER_SEC;
+        if( s->nodes - s->freenodes > stats.largestLiveNodes )
+          stats.largestLiveNodes = s->nodes - s->freenodes;
+      }
+
+      inline void bddResizeHook( int, int )
+      {
+        bddHookState().stats.resizes++;
+      }
+    }
+
+
+    /**
+     * Starts BuDDy with the given resources, silences its GC messages,
+     * and makes running out of nodes throw BddResourceError. Returns
+     * bdd_init's result, which is negative if BuDDy could not start.
+     */
+    inline int bddInit( BddResources const & resources = BddResources().fromEnvironment() )
+    {
+      int nodes = resources.initialNodes;
+      if( resources.maxNodes > 0 && nodes >= resources.maxNodes )
+        nodes = resources.maxNodes - 1;
+      int ratio = resources.cacheRatio > 0 ? resources.cacheRatio : 1;
+
+      int rc = bdd_init(nodes, nodes / ratio + 1);
+      if( rc < 0 )
+        return rc;
+
+      details::BddHookState & state = details::bddHookState();
+      state.stats = BddStatistics();
+      state.report = resources.report;
+
+      bdd_setcacheratio(ratio);
+      bdd_setmaxincrease(resources.maxIncrease);
+      bdd_setminfreenodes(resources.minFreePercent);
+      if( resources.maxNodes > 0 ) {
+        // bdd_init rounds the table up to a prime, which may pass the ceiling
+        int ceiling = resources.maxNodes;
+        if( ceiling <= bdd_getallocnum() )
+          ceiling = bdd_getallocnum() + 1;
+        bdd_setmaxnodenum(ceiling);
+      }
+      bdd_gbc_hook(details::bddGbcHook);
+      bdd_resize_hook(details::bddResizeHook);
+      state.previousError = bdd_error_hook(details::bddErrorHook);
+      return rc;
+    }
+
+    /// The statistics so far (BuDDy must be running)
+    inline BddStatistics bddStatistics( )
+    {
+      BddStatistics stats = details::bddHookState().stats;
+      stats.tableSize = bdd_getallocnum();
+      return stats;
+    }
+
+    inline std::ostream & printBddStatistics( std::ostream & o )
+    {
+      BddStatistics stats = bddStatistics();
+      o << "BDD garbage collections: " << stats.garbageCollections
+        << " (" << stats.gcSeconds << " s)\n"
+        << "BDD table resizes: " << stats.resizes << "\n"
+        << "BDD table size: " << stats.tableSize << " nodes\n"
+        << "BDD most live nodes after a GC: " << stats.largestLiveNodes << "\n";
+      return o;
+    }
+
+    /// Shuts BuDDy down, first printing the statistics to std::cerr if
+    /// the resources asked for that
+    inline void bddDone( )
+    {
+      if( details::bddHookState().report )
+        printBddStatistics(std::cerr);
+      bdd_done();
+    }
+
+  }
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
+
+#endif
@@ -0,0 +1,518 @@
+#include "wali/wfa/BinaryWfa.hpp"
+#include "wali/wfa/WFA.hpp"
+#include "wali/wfa/State.hpp"
+#include "wali/wfa/ITrans.hpp"
+#include "wali/wfa/CsrSnapshot.hpp"
+#include "wali/WeightFactory.hpp"
+
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Layout of a binary WFA. Everything is a 64-bit word in the byte order
+// of the machine that wrote it (checked with 'byte_order' on load), and
+// every section starts on a word boundary.
+//
+//   header           magic, version, byte_order, query, num_strings,
+//                    num_weights, num_states, num_transitions,
+//                    initial_state, file_size
+//   string_offsets   num_strings+1 words; string i is the bytes
+//                    [string_offsets[i], string_offsets[i+1]) of...
+//   string_bytes     ...this, padded to a word
+//   weight_offsets   num_weights+1 words, as for strings
+//   weight_bytes     padded to a word
+//   states           num_states records of (name string, weight,
+//                    accept weight, flags)
+//   row_offsets      num_states+1 words; the transitions leaving state s
+//                    are [row_offsets[s], row_offsets[s+1]) of...
+//   transitions      num_transitions records of (symbol string, target
+//                    state, weight)
+//
+// State and weight references are indices into the tables above; NoIndex
+// stands for "no state"/"no weight".
+
+namespace wali
+{
+  namespace wfa
+  {
+    const unsigned BinaryWfaVersion = 1;
+
+    void
+    MarshallingWeightSerializer::serialize(sem_elem_t weight, std::ostream & out) const
+    {
+      weight->marshall(out);
+    }
+
+    sem_elem_t
+    MarshallingWeightSerializer::deserialize(char const * bytes, size_t length) const
+    {
+      return factory_.getWeight(std::string(bytes, length));
+    }
+
+
+    namespace
+    {
+      typedef boost::uint64_t Word;
+
+      const char Magic[sizeof(Word)] = { 'W', 'A', 'L', 'I', 'W', 'F', 'A', '\0' };
+      const Word ByteOrder = 0x0102030405060708ULL;
+      const Word NoIndex = ~Word(0);
+
+      const Word FinalFlag = 1;
+
+      enum HeaderField {
+        H_MAGIC, H_VERSION, H_BYTE_ORDER, H_QUERY,
+        H_NUM_STRINGS, H_NUM_WEIGHTS, H_NUM_STATES, H_NUM_TRANSITIONS,
+        H_INITIAL_STATE, H_FILE_SIZE,
+        NUM_HEADER_FIELDS
+      };
+
+      const size_t WordsPerState = 4;
+      const size_t WordsPerTransition = 3;
+
+
+      void
+      write_word(std::ostream & out, Word w)
+      {
+        out.write(reinterpret_cast<char const *>(&w), sizeof(w));
+      }
+
+      void
+      write_padded(std::ostream & out, std::string const & bytes)
+      {
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        static const char zeros[sizeof(Word)] = { 0 };
+        size_t pad = (sizeof(Word) - bytes.size() % sizeof(Word)) % sizeof(Word);
+        out.write(zeros, static_cast<std::streamsize>(pad));
+      }
+
+      Word
+      padded_words(Word bytes)
+      {
+        return (bytes + sizeof(Word) - 1) / sizeof(Word);
+      }
+
+
+      /// Collects the strings and weights of a WFA as they are
+      /// encountered, giving each distinct one an index
+      class Tables
+      {
+      public:
+        explicit Tables(WeightSerializer const & serializer)
+          : serializer_(serializer)
+        {
+          string_offsets.push_back(0);
+          weight_offsets.push_back(0);
+        }
+
+        Word stringIndex(Key key) {
+          boost::unordered_map<Key, Word>::const_iterator place = strings_.find(key);
+          if (place != strings_.end()) {
+            return place->second;
+          }
+          Word index = string_offsets.size() - 1;
+          strings_[key] = index;
+          string_bytes << key2str(key);
+          string_offsets.push_back(static_cast<Word>(string_bytes.tellp()));
+          return index;
+        }
+
+        Word weightIndex(sem_elem_t weight) {
+          if (weight.get_ptr() == NULL) {
+            return NoIndex;
+          }
+          boost::unordered_map<SemElem *, Word>::const_iterator place
+            = weights_.find(weight.get_ptr());
+          if (place != weights_.end()) {
+            return place->second;
+          }
+          Word index = weight_offsets.size() - 1;
+          weights_[weight.get_ptr()] = index;
+          serializer_.serialize(weight, weight_bytes);
+          weight_offsets.push_back(static_cast<Word>(weight_bytes.tellp()));
+          return index;
+        }
+
+        std::vector<Word> string_offsets;
+        std::ostringstream string_bytes;
+        std::vector<Word> weight_offsets;
+        std::ostringstream weight_bytes;
+
+      private:
+        WeightSerializer const & serializer_;
+        boost::unordered_map<Key, Word> strings_;
+        // Weights are deduplicated by identity; equal but distinct
+        // weights are each written out.
+        boost::unordered_map<SemElem *, Word> weights_;
+      };
+
+
+      /// Reads words out of a buffer, checking that it does not run off
+      /// the end
+      class Reader
+      {
+      public:
+        Reader(char const * data, size_t size)
+          : data_(data), size_(size), pos_(0)
+        {}
+
+        /// Returns a pointer to the next 'words' words and skips them
+        char const * words(size_t words) {
+          if (words > (size_ - pos_) / sizeof(Word)) {
+            truncated();
+          }
+          char const * start = data_ + pos_;
+          pos_ += words * sizeof(Word);
+          return start;
+        }
+
+        static Word at(char const * words, size_t i) {
+          Word w;
+          std::memcpy(&w, words + i * sizeof(Word), sizeof(w));
+          return w;
+        }
+
+      private:
+        static void truncated() {
+          throw BinaryWfaFormatError("binary WFA is truncated");
+        }
+
+        char const * data_;
+        size_t size_;
+        size_t pos_;
+      };
+
+
+      /// Returns a bounds-checked index into a table of 'size' entries
+      size_t
+      checked_index(Word index, size_t size, char const * what)
+      {
+        if (index >= size) {
+          throw BinaryWfaFormatError(std::string("binary WFA has an out-of-range ") + what);
+        }
+        return static_cast<size_t>(index);
+      }
+
+      /// Checks that 'offsets' (num+1 words) is a non-decreasing sequence
+      /// starting at zero and ending within 'limit'
+      void
+      check_offsets(char const * offsets, size_t num, Word limit, char const * what)
+      {
+        Word previous = 0;
+        for (size_t i = 0; i <= num; ++i) {
+          Word offset = Reader::at(offsets, i);
+          if (offset < previous || offset > limit || (i == 0 && offset != 0)) {
+            throw BinaryWfaFormatError(std::string("binary WFA has bad ") + what + " offsets");
+          }
+          previous = offset;
+        }
+      }
+
+
+#ifndef _WIN32
+      /// A read-only mapping of a whole file, unmapped on destruction
+      class MappedFile
+      {
+      public:
+        explicit MappedFile(std::string const & filename)
+          : data_(NULL), size_(0)
+        {
+          int fd = open(filename.c_str(), O_RDONLY);
+          if (fd < 0) {
+            throw std::runtime_error("cannot open " + filename);
+          }
+          struct stat st;
+          if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("cannot stat " + filename);
+          }
+          size_ = static_cast<size_t>(st.st_size);
+          if (size_ > 0) {
+            void * p = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+              close(fd);
+              throw std::runtime_error("cannot map " + filename);
+            }
+            data_ = static_cast<char const *>(p);
+            // The loader makes one pass front to back
+            madvise(p, size_, MADV_SEQUENTIAL);
+          }
+          close(fd);
+        }
+
+        ~MappedFile() {
+          if (data_ != NULL) {
+            munmap(const_cast<char *>(data_), size_);
+          }
+        }
+
+        char const * data() const { return data_; }
+        size_t size() const { return size_; }
+
+      private:
+        MappedFile(MappedFile const &);
+        MappedFile & operator=(MappedFile const &);
+
+        char const * data_;
+        size_t size_;
+      };
+#endif
+    }
+
+
+    void
+    writeBinaryWfa(std::ostream & out,
+                   WFA const & wfa,
+                   WeightSerializer const & serializer)
+    {
+      boost::scoped_ptr<CsrSnapshot> local_csr;
+      CsrSnapshot const * csr = wfa.getCsrSnapshot();
+      if (csr == NULL) {
+        local_csr.reset(new CsrSnapshot(wfa));
+        csr = local_csr.get();
+      }
+
+      Tables tables(serializer);
+
+      std::vector<Word> states;
+      states.reserve(csr->numStates() * WordsPerState);
+      Word initial_state = NoIndex;
+      for (CsrSnapshot::Index q = 0; q < csr->numStates(); ++q) {
+        Key key = csr->stateKey(q);
+        State const * state = wfa.getState(key);
+        bool is_final = wfa.isFinalState(key);
+
+        states.push_back(tables.stringIndex(key));
+        states.push_back(tables.weightIndex(state->weight()));
+        states.push_back(is_final ? tables.weightIndex(state->acceptWeight()) : NoIndex);
+        states.push_back(is_final ? FinalFlag : 0);
+
+        if (wfa.isInitialState(key)) {
+          initial_state = q;
+        }
+      }
+
+      std::vector<Word> row_offsets;
+      row_offsets.reserve(csr->numStates() + 1);
+      std::vector<Word> transitions;
+      transitions.reserve(csr->numTransitions() * WordsPerTransition);
+      row_offsets.push_back(0);
+      for (CsrSnapshot::Index q = 0; q < csr->numStates(); ++q) {
+        CsrSnapshot::edge_range row = csr->outgoing(q);
+        for (CsrSnapshot::edge_iterator edge = row.first; edge != row.second; ++edge) {
+          transitions.push_back(tables.stringIndex(csr->symbolKey(edge->symbol)));
+          transitions.push_back(edge->target);
+          transitions.push_back(tables.weightIndex(edge->trans->weight()));
+        }
+        row_offsets.push_back(transitions.size() / WordsPerTransition);
+      }
+
+      std::string const string_bytes = tables.string_bytes.str();
+      std::string const weight_bytes = tables.weight_bytes.str();
+      size_t const num_strings = tables.string_offsets.size() - 1;
+      size_t const num_weights = tables.weight_offsets.size() - 1;
+
+      Word file_words = NUM_HEADER_FIELDS
+        + (num_strings + 1) + padded_words(string_bytes.size())
+        + (num_weights + 1) + padded_words(weight_bytes.size())
+        + states.size() + row_offsets.size() + transitions.size();
+
+      Word magic;
+      std::memcpy(&magic, Magic, sizeof(magic));
+
+      write_word(out, magic);
+      write_word(out, BinaryWfaVersion);
+      write_word(out, ByteOrder);
+      write_word(out, wfa.getQuery());
+      write_word(out, num_strings);
+      write_word(out, num_weights);
+      write_word(out, csr->numStates());
+      write_word(out, csr->numTransitions());
+      write_word(out, initial_state);
+      write_word(out, file_words * sizeof(Word));
+
+      for (size_t i = 0; i < tables.string_offsets.size(); ++i) {
+        write_word(out, tables.string_offsets[i]);
+      }
+      write_padded(out, string_bytes);
+      for (size_t i = 0; i < tables.weight_offsets.size(); ++i) {
+        write_word(out, tables.weight_offsets[i]);
+      }
+      write_padded(out, weight_bytes);
+      if (!states.empty()) {
+        out.write(reinterpret_cast<char const *>(&states[0]),
+                  static_cast<std::streamsize>(states.size() * sizeof(Word)));
+      }
+      out.write(reinterpret_cast<char const *>(&row_offsets[0]),
+                static_cast<std::streamsize>(row_offsets.size() * sizeof(Word)));
+      if (!transitions.empty()) {
+        out.write(reinterpret_cast<char const *>(&transitions[0]),
+                  static_cast<std::streamsize>(transitions.size() * sizeof(Word)));
+      }
+    }
+
+
+    void
+    readBinaryWfa(char const * data,
+                  size_t size,
+                  WeightSerializer const & serializer,
+                  WFA & result)
+    {
+      Reader in(data, size);
+
+      char const * header = in.words(NUM_HEADER_FIELDS);
+      if (std::memcmp(header, Magic, sizeof(Word)) != 0) {
+        throw BinaryWfaFormatError("not a binary WFA");
+      }
+      if (Reader::at(header, H_VERSION) != BinaryWfaVersion) {
+        throw BinaryWfaFormatError("unsupported binary WFA version");
+      }
+      if (Reader::at(header, H_BYTE_ORDER) != ByteOrder) {
+        throw BinaryWfaFormatError("binary WFA was written with a different byte order");
+      }
+      if (Reader::at(header, H_FILE_SIZE) != size) {
+        throw BinaryWfaFormatError("binary WFA has the wrong size");
+      }
+
+      Word const query = Reader::at(header, H_QUERY);
+      if (query != WFA::INORDER && query != WFA::REVERSE) {
+        throw BinaryWfaFormatError("binary WFA has a bad query direction");
+      }
+
+      // Everything is bounded by the file size, so these can't overflow
+      // once the sections below are checked.
+      size_t const num_strings = checked_index(Reader::at(header, H_NUM_STRINGS), size, "string count");
+      size_t const num_weights = checked_index(Reader::at(header, H_NUM_WEIGHTS), size, "weight count");
+      size_t const num_states = checked_index(Reader::at(header, H_NUM_STATES), size, "state count");
+      size_t const num_trans = checked_index(Reader::at(header, H_NUM_TRANSITIONS), size, "transition count");
+
+      char const * string_offsets = in.words(num_strings + 1);
+      Word const string_size = Reader::at(string_offsets, num_strings);
+      char const * string_bytes = in.words(padded_words(checked_index(string_size, size, "string size")));
+      check_offsets(string_offsets, num_strings, string_size, "string");
+
+      char const * weight_offsets = in.words(num_weights + 1);
+      Word const weight_size = Reader::at(weight_offsets, num_weights);
+      char const * weight_bytes = in.words(padded_words(checked_index(weight_size, size, "weight size")));
+      check_offsets(weight_offsets, num_weights, weight_size, "weight");
+
+      char const * states = in.words(num_states * WordsPerState);
+      char const * row_offsets = in.words(num_states + 1);
+      check_offsets(row_offsets, num_states, num_trans, "transition");
+      if (Reader::at(row_offsets, num_states) != num_trans) {
+        throw BinaryWfaFormatError("binary WFA has bad transition offsets");
+      }
+      char const * transitions = in.words(num_trans * WordsPerTransition);
+
+      // Intern the strings and decode the weights once each
+      std::vector<Key> keys;
+      keys.reserve(num_strings);
+      for (size_t i = 0; i < num_strings; ++i) {
+        size_t start = static_cast<size_t>(Reader::at(string_offsets, i));
+        size_t end = static_cast<size_t>(Reader::at(string_offsets, i + 1));
+        keys.push_back(getKey(std::string(string_bytes + start, end - start)));
+      }
+
+      std::vector<sem_elem_t> weights;
+      weights.reserve(num_weights);
+      for (size_t i = 0; i < num_weights; ++i) {
+        size_t start = static_cast<size_t>(Reader::at(weight_offsets, i));
+        size_t end = static_cast<size_t>(Reader::at(weight_offsets, i + 1));
+        weights.push_back(serializer.deserialize(weight_bytes + start, end - start));
+      }
+
+      // Built on the side, so that a malformed record further on leaves
+      // 'result' as it was
+      WFA wfa(static_cast<WFA::query_t>(query));
+
+      std::vector<Key> state_keys;
+      state_keys.reserve(num_states);
+      for (size_t q = 0; q < num_states; ++q) {
+        char const * record = states + q * WordsPerState * sizeof(Word);
+        Key key = keys[checked_index(Reader::at(record, 0), num_strings, "state name")];
+        Word weight = Reader::at(record, 1);
+        sem_elem_t state_weight;
+        if (weight != NoIndex) {
+          state_weight = weights[checked_index(weight, num_weights, "state weight")];
+        }
+        wfa.addState(key, state_weight);
+        state_keys.push_back(key);
+      }
+
+      Word const initial_state = Reader::at(header, H_INITIAL_STATE);
+      if (initial_state != NoIndex) {
+        wfa.setInitialState(state_keys[checked_index(initial_state, num_states, "initial state")]);
+      }
+
+      for (size_t q = 0; q < num_states; ++q) {
+        char const * record = states + q * WordsPerState * sizeof(Word);
+        if (Reader::at(record, 3) & FinalFlag) {
+          Word accept = Reader::at(record, 2);
+          if (accept == NoIndex) {
+            wfa.add_final_state(state_keys[q]);
+          }
+          else {
+            wfa.addFinalState(state_keys[q],
+                              weights[checked_index(accept, num_weights, "accept weight")]);
+          }
+        }
+      }
+
+      for (size_t q = 0; q < num_states; ++q) {
+        size_t first = static_cast<size_t>(Reader::at(row_offsets, q));
+        size_t last = static_cast<size_t>(Reader::at(row_offsets, q + 1));
+        for (size_t t = first; t < last; ++t) {
+          char const * record = transitions + t * WordsPerTransition * sizeof(Word);
+          Key symbol = keys[checked_index(Reader::at(record, 0), num_strings, "symbol")];
+          Key target = state_keys[checked_index(Reader::at(record, 1), num_states, "target state")];
+          sem_elem_t weight = weights[checked_index(Reader::at(record, 2), num_weights, "transition weight")];
+          wfa.addTrans(state_keys[q], symbol, target, weight);
+        }
+      }
+
+      result.swap(wfa);
+    }
+
+
+    void
+    readBinaryWfa(std::string const & filename,
+                  WeightSerializer const & serializer,
+                  WFA & result)
+    {
+#ifndef _WIN32
+      MappedFile file(filename);
+      readBinaryWfa(file.data(), file.size(), serializer, result);
+#else
+      std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+      if (!in) {
+        throw std::runtime_error("cannot open " + filename);
+      }
+      std::vector<char> contents((std::istreambuf_iterator<char>(in)),
+                                 std::istreambuf_iterator<char>());
+      readBinaryWfa(contents.empty() ? NULL : &contents[0], contents.size(),
+                    serializer, result);
+#endif
+    }
+
+  } // namespace wfa
+} // namespace wali
+
+
+// Yo emacs!
+// Local Variables:
+//     c-basic-offset: 2
+//     indent-tabs-mode: nil
+// End:
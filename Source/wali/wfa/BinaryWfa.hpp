@@ -0,0 +1,112 @@
+#ifndef WALI_WFA_BINARY_WFA_HPP
+#define WALI_WFA_BINARY_WFA_HPP
+
+#include "wali/Common.hpp"
+#include "wali/SemElem.hpp"
+
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+
+namespace wali
+{
+  class WeightFactory;
+
+  namespace wfa
+  {
+    class WFA;
+
+    /// Converts weights to and from the byte strings stored in a binary
+    /// WFA file. Weight domains that want to be saved in the binary
+    /// format supply one of these.
+    class WeightSerializer
+    {
+    public:
+      virtual ~WeightSerializer() {}
+
+      /// Writes the encoding of 'weight' to 'out'
+      virtual void serialize(sem_elem_t weight, std::ostream & out) const = 0;
+
+      /// Decodes a weight from the 'length' bytes starting at 'bytes'.
+      /// 'bytes' is not null-terminated and may not be aligned.
+      virtual sem_elem_t deserialize(char const * bytes, size_t length) const = 0;
+    };
+
+
+    /// A WeightSerializer that stores the same text that WFA::marshall
+    /// puts in the XML form (SemElem::marshall) and reads it back with a
+    /// WeightFactory, which is what the XML parser uses.
+    class MarshallingWeightSerializer : public WeightSerializer
+    {
+    public:
+      explicit MarshallingWeightSerializer(WeightFactory & factory)
+        : factory_(factory)
+      {}
+
+      virtual void serialize(sem_elem_t weight, std::ostream & out) const;
+      virtual sem_elem_t deserialize(char const * bytes, size_t length) const;
+
+    private:
+      WeightFactory & factory_;
+    };
+
+
+    /// Thrown when reading something that is not a binary WFA of a
+    /// version we understand, or that is truncated
+    struct BinaryWfaFormatError : std::runtime_error
+    {
+      explicit BinaryWfaFormatError(std::string const & what)
+        : std::runtime_error(what)
+      {}
+    };
+
+
+    /// The version written by writeBinaryWfa. Bump whenever the layout
+    /// changes.
+    extern const unsigned BinaryWfaVersion;
+
+    /// Writes 'wfa' to 'out' in the binary format. 'out' should be
+    /// opened in binary mode.
+    ///
+    /// The file holds a string table of the states and symbols that
+    /// appear in 'wfa' (as key2str), a table of the distinct weights,
+    /// and the transitions in compressed-sparse-row order by source
+    /// state. If 'wfa' is frozen its CsrSnapshot is reused.
+    ///
+    /// Keys come back as string keys, exactly as they do when the XML
+    /// form is reparsed.
+    void
+    writeBinaryWfa(std::ostream & out,
+                   WFA const & wfa,
+                   WeightSerializer const & weights);
+
+    /// Replaces the contents of 'result' with the WFA stored in the
+    /// 'size' bytes at 'data'. The input is read in place. If the input
+    /// is malformed, throws BinaryWfaFormatError and leaves 'result'
+    /// unchanged.
+    void
+    readBinaryWfa(char const * data,
+                  size_t size,
+                  WeightSerializer const & weights,
+                  WFA & result);
+
+    /// Replaces the contents of 'result' with the WFA stored in the file
+    /// 'filename'. On POSIX systems the file is memory-mapped and read
+    /// in place rather than copied into a buffer first. Malformed input
+    /// is handled as above.
+    void
+    readBinaryWfa(std::string const & filename,
+                  WeightSerializer const & weights,
+                  WFA & result);
+
+  } // namespace wfa
+} // namespace wali
+
+
+// Yo emacs!
+// Local Variables:
+//     c-basic-offset: 2
+//     indent-tabs-mode: nil
+// End:
+
+#endif
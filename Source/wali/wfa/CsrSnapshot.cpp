@@ -0,0 +1,169 @@
+#include "wali/wfa/CsrSnapshot.hpp"
+#include "wali/wfa/WFA.hpp"
+#include "wali/wfa/State.hpp"
+
+#include <algorithm>
+#include <set>
+
+namespace wali
+{
+  namespace wfa
+  {
+    const CsrSnapshot::Index CsrSnapshot::NoIndex = static_cast<CsrSnapshot::Index>(-1);
+
+    namespace
+    {
+      typedef CsrSnapshot::Edge Edge;
+
+      bool
+      forward_less(Edge const & left, Edge const & right)
+      {
+        if (left.source != right.source) return left.source < right.source;
+        if (left.symbol != right.symbol) return left.symbol < right.symbol;
+        return left.target < right.target;
+      }
+
+      bool
+      reverse_less(Edge const & left, Edge const & right)
+      {
+        if (left.target != right.target) return left.target < right.target;
+        if (left.symbol != right.symbol) return left.symbol < right.symbol;
+        return left.source < right.source;
+      }
+
+      bool
+      symbol_less(Edge const & edge, CsrSnapshot::Index symbol)
+      {
+        return edge.symbol < symbol;
+      }
+
+      bool
+      less_symbol(CsrSnapshot::Index symbol, Edge const & edge)
+      {
+        return symbol < edge.symbol;
+      }
+
+      /// Fills 'offsets' so that the edges for row r are
+      /// [offsets[r], offsets[r+1]). 'edges' must be sorted by the row.
+      template<typename RowOf>
+      void
+      build_offsets(std::vector<Edge> const & edges,
+                    size_t num_rows,
+                    RowOf row_of,
+                    std::vector<size_t> & offsets)
+      {
+        offsets.assign(num_rows + 1, 0);
+        for (std::vector<Edge>::const_iterator edge = edges.begin();
+             edge != edges.end(); ++edge)
+        {
+          ++offsets[row_of(*edge) + 1];
+        }
+        for (size_t row = 0; row < num_rows; ++row) {
+          offsets[row + 1] += offsets[row];
+        }
+      }
+
+      CsrSnapshot::Index source_of(Edge const & edge) { return edge.source; }
+      CsrSnapshot::Index target_of(Edge const & edge) { return edge.target; }
+    }
+
+
+    CsrSnapshot::CsrSnapshot(WFA const & wfa)
+      : state_keys_(wfa.Q.begin(), wfa.Q.end())
+    {
+      states_.reserve(state_keys_.size());
+      state_index_.rehash(state_keys_.size());
+      for (Index i = 0; i < state_keys_.size(); ++i) {
+        state_index_[state_keys_[i]] = i;
+        states_.push_back(wfa.state_map.find(state_keys_[i])->second);
+      }
+
+      std::set<Key> symbols;
+      size_t num_trans = 0;
+      for (WFA::kp_map_t::const_iterator kp = wfa.kpmap.begin();
+           kp != wfa.kpmap.end(); ++kp)
+      {
+        if (!kp->second.empty()) {
+          symbols.insert(kp->first.second);
+          num_trans += kp->second.size();
+        }
+      }
+      symbol_keys_.assign(symbols.begin(), symbols.end());
+      symbol_index_.rehash(symbol_keys_.size());
+      for (Index i = 0; i < symbol_keys_.size(); ++i) {
+        symbol_index_[symbol_keys_[i]] = i;
+      }
+
+      out_edges_.reserve(num_trans);
+      for (WFA::kp_map_t::const_iterator kp = wfa.kpmap.begin();
+           kp != wfa.kpmap.end(); ++kp)
+      {
+        for (TransSet::const_iterator trans = kp->second.begin();
+             trans != kp->second.end(); ++trans)
+        {
+          Edge edge;
+          edge.source = stateIndex((*trans)->from());
+          edge.symbol = symbolIndex((*trans)->stack());
+          edge.target = stateIndex((*trans)->to());
+          edge.trans = *trans;
+          out_edges_.push_back(edge);
+        }
+      }
+
+      in_edges_ = out_edges_;
+      std::sort(out_edges_.begin(), out_edges_.end(), forward_less);
+      std::sort(in_edges_.begin(), in_edges_.end(), reverse_less);
+
+      build_offsets(out_edges_, state_keys_.size(), source_of, out_offsets_);
+      build_offsets(in_edges_, state_keys_.size(), target_of, in_offsets_);
+
+      // Each row of out_edges_ is sorted by symbol, so the distinct
+      // symbols of a row are the first edge of each run.
+      out_symbol_offsets_.reserve(state_keys_.size() + 1);
+      out_symbol_offsets_.push_back(0);
+      for (Index state = 0; state < state_keys_.size(); ++state) {
+        edge_range row = outgoing(state);
+        for (edge_iterator edge = row.first; edge != row.second; ++edge) {
+          if (edge == row.first || edge->symbol != (edge - 1)->symbol) {
+            out_symbols_.push_back(edge->symbol);
+          }
+        }
+        out_symbol_offsets_.push_back(out_symbols_.size());
+      }
+    }
+
+
+    CsrSnapshot::Index
+    CsrSnapshot::stateIndex(Key state) const
+    {
+      boost::unordered_map<Key, Index>::const_iterator place = state_index_.find(state);
+      return place == state_index_.end() ? NoIndex : place->second;
+    }
+
+
+    CsrSnapshot::Index
+    CsrSnapshot::symbolIndex(Key symbol) const
+    {
+      boost::unordered_map<Key, Index>::const_iterator place = symbol_index_.find(symbol);
+      return place == symbol_index_.end() ? NoIndex : place->second;
+    }
+
+
+    CsrSnapshot::edge_range
+    CsrSnapshot::outgoing(Index state, Index symbol) const
+    {
+      edge_range row = outgoing(state);
+      edge_iterator first = std::lower_bound(row.first, row.second, symbol, symbol_less);
+      edge_iterator last = std::upper_bound(first, row.second, symbol, less_symbol);
+      return edge_range(first, last);
+    }
+
+  } // namespace wfa
+} // namespace wali
+
+
+// Yo emacs!
+// Local Variables:
+//     c-basic-offset: 2
+//     indent-tabs-mode: nil
+// End:
@@ -0,0 +1,122 @@
+#ifndef WALI_WFA_CSR_SNAPSHOT_HPP
+#define WALI_WFA_CSR_SNAPSHOT_HPP
+
+#include "wali/Common.hpp"
+
+#include <boost/unordered_map.hpp>
+
+#include <vector>
+#include <utility>
+
+namespace wali
+{
+  namespace wfa
+  {
+    class WFA;
+    class ITrans;
+    class State;
+
+    /// A read-only, compressed-sparse-row view of the transitions of a
+    /// WFA. States and symbols are renumbered densely (in Key order), and
+    /// the transitions are stored twice in flat arrays: once grouped by
+    /// source state (then symbol, then target) and once grouped by target
+    /// state (then symbol, then source).
+    ///
+    /// A CsrSnapshot is built by WFA::freeze() and is thrown away by any
+    /// operation that changes the states or transitions of the WFA.
+    /// Weights are read through the ITrans pointers, so changing the weight
+    /// of an existing transition does not invalidate a snapshot.
+    class CsrSnapshot
+    {
+    public:
+      typedef size_t Index;
+
+      /// Returned by stateIndex() and symbolIndex() for keys that are not
+      /// in the snapshot.
+      static const Index NoIndex;
+
+      struct Edge
+      {
+        Index source;
+        Index symbol;
+        Index target;
+        ITrans const * trans;
+      };
+
+      typedef std::vector<Edge>::const_iterator edge_iterator;
+      typedef std::pair<edge_iterator, edge_iterator> edge_range;
+
+      typedef std::vector<Index>::const_iterator symbol_iterator;
+      typedef std::pair<symbol_iterator, symbol_iterator> symbol_range;
+
+      explicit CsrSnapshot(WFA const & wfa);
+
+      size_t numStates() const { return state_keys_.size(); }
+      size_t numSymbols() const { return symbol_keys_.size(); }
+      size_t numTransitions() const { return out_edges_.size(); }
+
+      Key stateKey(Index state) const { return state_keys_[state]; }
+      Key symbolKey(Index symbol) const { return symbol_keys_[symbol]; }
+
+      Index stateIndex(Key state) const;
+      Index symbolIndex(Key symbol) const;
+
+      /// All transitions, in (source, symbol, target) order
+      edge_range transitions() const {
+        return edge_range(out_edges_.begin(), out_edges_.end());
+      }
+
+      /// Transitions leaving 'state', in (symbol, target) order
+      edge_range outgoing(Index state) const {
+        return edge_range(out_edges_.begin() + out_offsets_[state],
+                          out_edges_.begin() + out_offsets_[state + 1]);
+      }
+
+      /// Transitions leaving 'state' on 'symbol', in target order
+      edge_range outgoing(Index state, Index symbol) const;
+
+      /// The distinct symbols on transitions leaving 'state', in
+      /// increasing order (which is also Key order)
+      symbol_range outgoingSymbols(Index state) const {
+        return symbol_range(out_symbols_.begin() + out_symbol_offsets_[state],
+                            out_symbols_.begin() + out_symbol_offsets_[state + 1]);
+      }
+
+      /// Transitions entering 'state', in (symbol, source) order
+      edge_range incoming(Index state) const {
+        return edge_range(in_edges_.begin() + in_offsets_[state],
+                          in_edges_.begin() + in_offsets_[state + 1]);
+      }
+
+    private:
+      friend class WFA;
+
+      /// The WFA's own State object for the given index
+      State * state(Index state) const { return states_[state]; }
+
+      std::vector<Key> state_keys_;
+      std::vector<State*> states_;
+      std::vector<Key> symbol_keys_;
+      boost::unordered_map<Key, Index> state_index_;
+      boost::unordered_map<Key, Index> symbol_index_;
+
+      std::vector<size_t> out_offsets_;
+      std::vector<Edge> out_edges_;
+      std::vector<size_t> in_offsets_;
+      std::vector<Edge> in_edges_;
+
+      std::vector<size_t> out_symbol_offsets_;
+      std::vector<Index> out_symbols_;
+    };
+
+  } // namespace wfa
+} // namespace wali
+
+
+// Yo emacs!
+// Local Variables:
+//     c-basic-offset: 2
+//     indent-tabs-mode: nil
+// End:
+
+#endif
@@ -0,0 +1,382 @@
+#include "wali/wfa/IncrementalReachability.hpp"
+#include "wali/wfa/WFA.hpp"
+#include "wali/wfa/State.hpp"
+#include "wali/wfa/ITrans.hpp"
+
+namespace wali
+{
+  namespace wfa
+  {
+    IncrementalReachability::IncrementalReachability(WFA const & wfa)
+      : wfa_(wfa)
+      , states_visited_(0)
+      , transitions_erased_(0)
+    {
+      std::set<Key> const & states = wfa.getStates();
+      nodes_.rehash(states.size());
+      for (std::set<Key>::const_iterator q = states.begin(); q != states.end(); ++q) {
+        nodes_[*q];
+      }
+      for (std::set<Key>::const_iterator q = states.begin(); q != states.end(); ++q) {
+        TransSet const & out = wfa.getState(*q)->getTransSet();
+        for (TransSet::const_iterator t = out.begin(); t != out.end(); ++t) {
+          nodes_[(*t)->to()].in.insert(*t);
+          weight_candidates_.insert(*t);
+        }
+      }
+
+      recomputeForward();
+
+      std::vector<Key> worklist;
+      std::set<Key> const & finals = wfa.getFinalStates();
+      for (std::set<Key>::const_iterator f = finals.begin(); f != finals.end(); ++f) {
+        node(*f).backward = true;
+        worklist.push_back(*f);
+      }
+      propagateBackward(worklist);
+
+      for (NodeMap::const_iterator n = nodes_.begin(); n != nodes_.end(); ++n) {
+        updateDead(n->first, n->second);
+      }
+    }
+
+
+    IncrementalReachability::Node &
+    IncrementalReachability::node(Key q)
+    {
+      NodeMap::iterator place = nodes_.find(q);
+      assert(place != nodes_.end());
+      return place->second;
+    }
+
+
+    bool
+    IncrementalReachability::isLiveTrans(ITrans const * t) const
+    {
+      // While a transition is being erased the WFA removes it from
+      // the kpmap (which tells us) before removing it from its source
+      // State, so the State's TransSet can briefly contain a transition
+      // that we have already forgotten.
+      NodeMap::const_iterator place = nodes_.find(t->to());
+      return place != nodes_.end()
+        && place->second.in.count(const_cast<ITrans *>(t)) > 0;
+    }
+
+
+    void
+    IncrementalReachability::updateDead(Key q, Node const & n)
+    {
+      if (n.forward && n.backward) {
+        dead_.erase(q);
+      }
+      else {
+        dead_.insert(q);
+      }
+    }
+
+
+    void
+    IncrementalReachability::propagateForward(std::vector<Key> & worklist)
+    {
+      while (!worklist.empty()) {
+        Key q = worklist.back();
+        worklist.pop_back();
+        ++states_visited_;
+
+        TransSet const & out = wfa_.getState(q)->getTransSet();
+        for (TransSet::const_iterator t = out.begin(); t != out.end(); ++t) {
+          if (!isLiveTrans(*t)) {
+            continue;
+          }
+          Node & target = node((*t)->to());
+          if (!target.forward) {
+            target.forward = true;
+            updateDead((*t)->to(), target);
+            worklist.push_back((*t)->to());
+          }
+        }
+      }
+    }
+
+
+    void
+    IncrementalReachability::propagateBackward(std::vector<Key> & worklist)
+    {
+      while (!worklist.empty()) {
+        Key q = worklist.back();
+        worklist.pop_back();
+        ++states_visited_;
+
+        TransPtrSet const & in = node(q).in;
+        for (TransPtrSet::const_iterator t = in.begin(); t != in.end(); ++t) {
+          Node & source = node((*t)->from());
+          if (!source.backward) {
+            source.backward = true;
+            updateDead((*t)->from(), source);
+            worklist.push_back((*t)->from());
+          }
+        }
+      }
+    }
+
+
+    void
+    IncrementalReachability::retractForward(Key from)
+    {
+      Key init = wfa_.getInitialState();
+
+      // Unmark everything that might have been reached through 'from'
+      std::vector<Key> region;
+      std::vector<Key> worklist;
+      node(from).forward = false;
+      region.push_back(from);
+      worklist.push_back(from);
+      while (!worklist.empty()) {
+        Key q = worklist.back();
+        worklist.pop_back();
+        ++states_visited_;
+
+        TransSet const & out = wfa_.getState(q)->getTransSet();
+        for (TransSet::const_iterator t = out.begin(); t != out.end(); ++t) {
+          Key r = (*t)->to();
+          if (!isLiveTrans(*t) || r == init) {
+            continue;
+          }
+          Node & target = node(r);
+          if (target.forward) {
+            target.forward = false;
+            region.push_back(r);
+            worklist.push_back(r);
+          }
+        }
+      }
+
+      // Re-derive the ones that are still reached from outside
+      for (std::vector<Key>::const_iterator q = region.begin(); q != region.end(); ++q) {
+        Node & n = node(*q);
+        for (TransPtrSet::const_iterator t = n.in.begin(); t != n.in.end(); ++t) {
+          if (node((*t)->from()).forward) {
+            n.forward = true;
+            worklist.push_back(*q);
+            break;
+          }
+        }
+      }
+      propagateForward(worklist);
+
+      for (std::vector<Key>::const_iterator q = region.begin(); q != region.end(); ++q) {
+        updateDead(*q, node(*q));
+      }
+    }
+
+
+    void
+    IncrementalReachability::retractBackward(Key from)
+    {
+      std::vector<Key> region;
+      std::vector<Key> worklist;
+      node(from).backward = false;
+      region.push_back(from);
+      worklist.push_back(from);
+      while (!worklist.empty()) {
+        Key q = worklist.back();
+        worklist.pop_back();
+        ++states_visited_;
+
+        TransPtrSet const & in = node(q).in;
+        for (TransPtrSet::const_iterator t = in.begin(); t != in.end(); ++t) {
+          Key p = (*t)->from();
+          if (wfa_.isFinalState(p)) {
+            continue;
+          }
+          Node & source = node(p);
+          if (source.backward) {
+            source.backward = false;
+            region.push_back(p);
+            worklist.push_back(p);
+          }
+        }
+      }
+
+      for (std::vector<Key>::const_iterator q = region.begin(); q != region.end(); ++q) {
+        Node & n = node(*q);
+        TransSet const & out = wfa_.getState(*q)->getTransSet();
+        for (TransSet::const_iterator t = out.begin(); t != out.end(); ++t) {
+          if (isLiveTrans(*t) && node((*t)->to()).backward) {
+            n.backward = true;
+            worklist.push_back(*q);
+            break;
+          }
+        }
+      }
+      propagateBackward(worklist);
+
+      for (std::vector<Key>::const_iterator q = region.begin(); q != region.end(); ++q) {
+        updateDead(*q, node(*q));
+      }
+    }
+
+
+    void
+    IncrementalReachability::recomputeForward()
+    {
+      for (NodeMap::iterator n = nodes_.begin(); n != nodes_.end(); ++n) {
+        n->second.forward = false;
+      }
+
+      std::vector<Key> worklist;
+      NodeMap::iterator init = nodes_.find(wfa_.getInitialState());
+      if (init != nodes_.end()) {
+        init->second.forward = true;
+        worklist.push_back(init->first);
+      }
+      propagateForward(worklist);
+
+      for (NodeMap::const_iterator n = nodes_.begin(); n != nodes_.end(); ++n) {
+        updateDead(n->first, n->second);
+      }
+    }
+
+
+    void
+    IncrementalReachability::onAddState(Key q)
+    {
+      Node & n = nodes_[q];
+      n.forward = (q == wfa_.getInitialState());
+      n.backward = wfa_.isFinalState(q);
+      updateDead(q, n);
+    }
+
+
+    void
+    IncrementalReachability::onEraseState(Key q)
+    {
+      // The WFA has already erased the transitions to and from 'q'
+      assert(node(q).in.empty());
+      nodes_.erase(q);
+      dead_.erase(q);
+    }
+
+
+    void
+    IncrementalReachability::onAddTrans(ITrans * t)
+    {
+      Key p = t->from();
+      Key q = t->to();
+      Node & source = node(p);
+      Node & target = node(q);
+      target.in.insert(t);
+      weight_candidates_.insert(t);
+
+      std::vector<Key> worklist;
+      if (source.forward && !target.forward) {
+        target.forward = true;
+        updateDead(q, target);
+        worklist.push_back(q);
+        propagateForward(worklist);
+      }
+      if (target.backward && !source.backward) {
+        source.backward = true;
+        updateDead(p, source);
+        worklist.push_back(p);
+        propagateBackward(worklist);
+      }
+    }
+
+
+    void
+    IncrementalReachability::onEraseTrans(ITrans * t)
+    {
+      Key p = t->from();
+      Key q = t->to();
+      Node & target = node(q);
+      target.in.erase(t);
+      weight_candidates_.erase(t);
+      ++transitions_erased_;
+
+      Node & source = node(p);
+      if (source.forward && target.forward && q != wfa_.getInitialState()) {
+        retractForward(q);
+      }
+      if (source.backward && target.backward && !wfa_.isFinalState(p)) {
+        retractBackward(p);
+      }
+    }
+
+
+    void
+    IncrementalReachability::onSetInitialState()
+    {
+      recomputeForward();
+    }
+
+
+    void
+    IncrementalReachability::onAddFinalState(Key q)
+    {
+      Node & n = node(q);
+      if (!n.backward) {
+        n.backward = true;
+        updateDead(q, n);
+        std::vector<Key> worklist(1, q);
+        propagateBackward(worklist);
+      }
+    }
+
+
+    void
+    IncrementalReachability::onClear()
+    {
+      nodes_.clear();
+      dead_.clear();
+      weight_candidates_.clear();
+    }
+
+
+    void
+    IncrementalReachability::onTransWeightChanged(ITrans * t)
+    {
+      weight_candidates_.insert(t);
+    }
+
+
+    bool
+    IncrementalReachability::isForwardReachable(Key q) const
+    {
+      NodeMap::const_iterator place = nodes_.find(q);
+      return place != nodes_.end() && place->second.forward;
+    }
+
+
+    bool
+    IncrementalReachability::isBackwardReachable(Key q) const
+    {
+      NodeMap::const_iterator place = nodes_.find(q);
+      return place != nodes_.end() && place->second.backward;
+    }
+
+
+    IncrementalReachability::TransPtrSet const &
+    IncrementalReachability::incoming(Key q) const
+    {
+      NodeMap::const_iterator place = nodes_.find(q);
+      return place == nodes_.end() ? no_transitions_ : place->second.in;
+    }
+
+
+    void
+    IncrementalReachability::takeWeightCandidates(std::vector<ITrans *> & out)
+    {
+      out.assign(weight_candidates_.begin(), weight_candidates_.end());
+      weight_candidates_.clear();
+    }
+
+  } // namespace wfa
+} // namespace wali
+
+
+// Yo emacs!
+// Local Variables:
+//     c-basic-offset: 2
+//     indent-tabs-mode: nil
+// End:
@@ -0,0 +1,116 @@
+#ifndef WALI_WFA_INCREMENTAL_REACHABILITY_HPP
+#define WALI_WFA_INCREMENTAL_REACHABILITY_HPP
+
+#include "wali/Common.hpp"
+
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <vector>
+
+namespace wali
+{
+  namespace wfa
+  {
+    class WFA;
+    class ITrans;
+
+    /// Keeps track of which states of a WFA are reachable from the
+    /// initial state ("forward") and which can reach a final state
+    /// ("backward") as transitions and states come and go, so that
+    /// WFA::prune() does not have to redo both searches from scratch.
+    ///
+    /// Additions propagate from the new transition. Removals find the
+    /// states that might have depended on the removed transition (those
+    /// reachable from it), unmark them, and re-derive the ones that still
+    /// have support from outside that region. Either way the work is
+    /// proportional to the part of the automaton affected by the change.
+    /// Changing the initial state recomputes the forward set.
+    ///
+    /// The WFA calls the on*() hooks from the functions that change its
+    /// structure; clients do not use this class directly.
+    class IncrementalReachability
+    {
+    public:
+      typedef boost::unordered_set<ITrans *> TransPtrSet;
+      typedef boost::unordered_set<Key> KeyHashSet;
+
+      /// Computes the reachability information for 'wfa' from scratch
+      explicit IncrementalReachability(WFA const & wfa);
+
+      void onAddState(Key q);
+      void onEraseState(Key q);
+      void onAddTrans(ITrans * t);
+      void onEraseTrans(ITrans * t);
+      void onSetInitialState();
+      void onAddFinalState(Key q);
+      void onClear();
+
+      /// Records that 't' was inserted or had its weight combined, so
+      /// prune() will check whether it is a zero-weight transition.
+      void onTransWeightChanged(ITrans * t);
+
+      bool isForwardReachable(Key q) const;
+      bool isBackwardReachable(Key q) const;
+
+      /// States that are not both forward and backward reachable
+      KeyHashSet const & deadStates() const { return dead_; }
+
+      /// Transitions that enter 'q'
+      TransPtrSet const & incoming(Key q) const;
+
+      /// Moves the transitions noted by onTransWeightChanged() into
+      /// 'out' and forgets them
+      void takeWeightCandidates(std::vector<ITrans *> & out);
+
+      /// Number of times a state has been examined by the maintenance
+      /// code since construction or the last resetStatesVisited()
+      size_t statesVisited() const { return states_visited_; }
+      void resetStatesVisited() { states_visited_ = 0; }
+
+      /// Number of transitions removed since construction
+      size_t transitionsErased() const { return transitions_erased_; }
+
+    private:
+      struct Node
+      {
+        bool forward;
+        bool backward;
+        TransPtrSet in;
+
+        Node() : forward(false), backward(false) {}
+      };
+
+      typedef boost::unordered_map<Key, Node> NodeMap;
+
+      Node & node(Key q);
+      bool isLiveTrans(ITrans const * t) const;
+      void updateDead(Key q, Node const & n);
+
+      void propagateForward(std::vector<Key> & worklist);
+      void propagateBackward(std::vector<Key> & worklist);
+      void retractForward(Key from);
+      void retractBackward(Key from);
+      void recomputeForward();
+
+      WFA const & wfa_;
+      NodeMap nodes_;
+      KeyHashSet dead_;
+      TransPtrSet weight_candidates_;
+      TransPtrSet const no_transitions_;
+
+      size_t states_visited_;
+      size_t transitions_erased_;
+    };
+
+  } // namespace wfa
+} // namespace wali
+
+
+// Yo emacs!
+// Local Variables:
+//     c-basic-offset: 2
+//     indent-tabs-mode: nil
+// End:
+
+#endif
@@ -0,0 +1,310 @@
+#include "wali/Common.hpp"
+#include "wali/wfa/WFA.hpp"
+#include "wali/wfa/State.hpp"
+#include "wali/wfa/Trans.hpp"
+#include "wali/wfa/DeterminizeWeightGen.hpp"
+#include "wali/util/ConfigurationVar.hpp"
+
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <vector>
+#include <stack>
+
+namespace wali
+{
+  namespace wfa
+  {
+    WFA::DeterminizeImplementation
+      WFA::globalDefaultDeterminizeImplementation
+      = wali::util::ConfigurationVar<WFA::DeterminizeImplementation>(
+          "WALI_WFA_DETERMINIZE_IMPLEMENTATION",
+          WFA::DeterminizeDenseSubsets
+        )
+        ("KeySets",      WFA::DeterminizeKeySets)
+        ("DenseSubsets", WFA::DeterminizeDenseSubsets);
+
+
+    namespace
+    {
+      typedef std::set<Key> KeySet;
+
+      /// A macro-state: sorted indices into DenseStates::keys
+      typedef std::vector<size_t> DenseSubset;
+
+      typedef boost::unordered_map<DenseSubset, size_t,
+                                   boost::hash<DenseSubset> > SubsetTable;
+
+      /// An outgoing non-epsilon transition, stored so that sorting a
+      /// vector of them groups the transitions by symbol, then by source
+      /// state, then by target state.
+      struct OutEdge
+      {
+        Key symbol;
+        size_t source;
+        size_t target;
+        ITrans const * trans;
+
+        OutEdge(Key sym, size_t src, size_t tgt, ITrans const * t)
+          : symbol(sym), source(src), target(tgt), trans(t)
+        {}
+
+        bool operator< (OutEdge const & other) const {
+          if (symbol != other.symbol) return symbol < other.symbol;
+          if (source != other.source) return source < other.source;
+          return target < other.target;
+        }
+      };
+
+      typedef std::vector<std::pair<size_t, sem_elem_t> > DenseClosure;
+
+      /// A snapshot of the states and non-epsilon transitions of a WFA
+      /// with every state renumbered to an index in [0, |Q|). Indices are
+      /// assigned in Key order, so a sorted DenseSubset corresponds to a
+      /// sorted KeySet.
+      class DenseStates
+      {
+      public:
+        std::vector<Key> keys;
+        std::vector<bool> is_final;
+        std::vector<std::vector<OutEdge> > outgoing;
+
+        DenseStates(WFA const & wfa, WFA::kp_map_t const & kpmap)
+          : keys(wfa.getStates().begin(), wfa.getStates().end())
+          , is_final(keys.size(), false)
+          , outgoing(keys.size())
+          , wfa_(wfa)
+          , closures_(keys.size())
+          , closure_computed_(keys.size(), false)
+        {
+          index_.rehash(keys.size());
+          for (size_t i = 0; i < keys.size(); ++i) {
+            index_[keys[i]] = i;
+            is_final[i] = wfa.isFinalState(keys[i]);
+          }
+
+          for (WFA::kp_map_t::const_iterator kp = kpmap.begin();
+               kp != kpmap.end(); ++kp)
+          {
+            Key symbol = kp->first.second;
+            if (symbol == WALI_EPSILON) {
+              continue;
+            }
+            size_t source = indexOf(kp->first.first);
+            for (TransSet::const_iterator trans = kp->second.begin();
+                 trans != kp->second.end(); ++trans)
+            {
+              outgoing[source].push_back(OutEdge(symbol, source,
+                                                 indexOf((*trans)->to()),
+                                                 *trans));
+            }
+          }
+        }
+
+        size_t indexOf(Key key) const {
+          boost::unordered_map<Key, size_t>::const_iterator place = index_.find(key);
+          assert(place != index_.end());
+          return place->second;
+        }
+
+        /// Returns the epsilon closure of state 'i', sorted by index.
+        DenseClosure const & closure(size_t i) {
+          if (!closure_computed_[i]) {
+            WFA::AccessibleStateMap eclose = wfa_.epsilonCloseCached(keys[i], eclose_cache_);
+            DenseClosure & c = closures_[i];
+            c.reserve(eclose.size());
+            for (WFA::AccessibleStateMap::const_iterator q_w = eclose.begin();
+                 q_w != eclose.end(); ++q_w)
+            {
+              c.push_back(std::make_pair(indexOf(q_w->first), q_w->second));
+            }
+            closure_computed_[i] = true;
+          }
+          return closures_[i];
+        }
+
+        KeySet toKeySet(DenseSubset const & subset) const {
+          KeySet ks;
+          for (DenseSubset::const_iterator i = subset.begin();
+               i != subset.end(); ++i)
+          {
+            ks.insert(ks.end(), keys[*i]);
+          }
+          return ks;
+        }
+
+      private:
+        WFA const & wfa_;
+        boost::unordered_map<Key, size_t> index_;
+        std::vector<DenseClosure> closures_;
+        std::vector<bool> closure_computed_;
+        WFA::EpsilonCloseCache eclose_cache_;
+      };
+    }
+
+
+    WFA
+    WFA::semideterminize_dense(DeterminizeWeightGen const & wg) const
+    {
+      DenseStates dense(*this, kpmap);
+
+      // AlwaysReturnOneWeightGen ignores the weight specification, so we
+      // can skip building it (and the KeySets that go with it).
+      bool const needs_weight_spec
+        = (dynamic_cast<AlwaysReturnOneWeightGen const *>(&wg) == NULL);
+
+      SubsetTable visited;
+      std::vector<Key> subset_keys;
+      std::stack<DenseSubset> worklist;
+
+      // Scratch space used to deduplicate the targets of each symbol
+      // without a std::set: stamp[q] == current_stamp iff q is already in
+      // 'targets'.
+      std::vector<size_t> stamp(dense.keys.size(), 0);
+      size_t current_stamp = 0;
+
+      WFA result;
+      sem_elem_t one = wg.getOne(*this);
+      sem_elem_t zero = one->zero();
+
+      {
+        // Set up initial states
+        DenseClosure const & initials = dense.closure(dense.indexOf(getInitialState()));
+        DenseSubset det_initial;
+        det_initial.reserve(initials.size());
+        for (DenseClosure::const_iterator initial = initials.begin();
+             initial != initials.end(); ++initial)
+        {
+          det_initial.push_back(initial->first);
+        }
+
+        Key initial_key = getKey(dense.toKeySet(det_initial));
+
+        result.addState(initial_key, zero);
+        result.setInitialState(initial_key);
+        visited[det_initial] = subset_keys.size();
+        subset_keys.push_back(initial_key);
+        worklist.push(det_initial);
+      }
+
+      std::vector<OutEdge> edges;
+      DenseSubset targets;
+
+      while (!worklist.empty())
+      {
+        DenseSubset sources = worklist.top();
+        worklist.pop();
+
+        Key sources_key = subset_keys[visited.find(sources)->second];
+        KeySet sources_set;
+        if (needs_weight_spec) {
+          sources_set = dense.toKeySet(sources);
+        }
+
+        bool any_final = false;
+        edges.clear();
+        for (DenseSubset::const_iterator s = sources.begin();
+             s != sources.end(); ++s)
+        {
+          any_final = any_final || dense.is_final[*s];
+          edges.insert(edges.end(), dense.outgoing[*s].begin(), dense.outgoing[*s].end());
+        }
+        std::sort(edges.begin(), edges.end());
+
+        if (any_final) {
+          sem_elem_t accept_weight
+            = wg.getAcceptWeight(*this, result,
+                                 needs_weight_spec ? sources_set : dense.toKeySet(sources));
+          result.addFinalState(sources_key, accept_weight);
+        }
+
+        std::vector<OutEdge>::const_iterator group = edges.begin();
+        while (group != edges.end())
+        {
+          Key symbol = group->symbol;
+          std::vector<OutEdge>::const_iterator group_end = group;
+          while (group_end != edges.end() && group_end->symbol == symbol) {
+            ++group_end;
+          }
+
+          ++current_stamp;
+          targets.clear();
+
+          // weight_spec[p][q] will represent the weight of
+          //
+          //            symbol      epsilon
+          //         p -------> i - - - - - -> q
+          //
+          // See semideterminize_keysets().
+          std::map<Key, AccessibleStateMap> weight_spec;
+
+          for (std::vector<OutEdge>::const_iterator edge = group;
+               edge != group_end; ++edge)
+          {
+            DenseClosure const & eclose = dense.closure(edge->target);
+            AccessibleStateMap * source_spec = NULL;
+            if (needs_weight_spec) {
+              source_spec = &weight_spec[dense.keys[edge->source]];
+            }
+
+            for (DenseClosure::const_iterator q_w = eclose.begin();
+                 q_w != eclose.end(); ++q_w)
+            {
+              if (source_spec) {
+                (*source_spec)[dense.keys[q_w->first]]
+                  = edge->trans->weight()->extend(q_w->second);
+              }
+              if (stamp[q_w->first] != current_stamp) {
+                stamp[q_w->first] = current_stamp;
+                targets.push_back(q_w->first);
+              }
+            }
+          }
+
+          // Every edge contributes at least its own target, so 'targets'
+          // is never empty here. (semideterminize_keysets() has to check.)
+          assert(targets.size() > 0);
+          std::sort(targets.begin(), targets.end());
+
+          Key target_key;
+          SubsetTable::const_iterator place = visited.find(targets);
+          if (place == visited.end()) {
+            // It wasn't already there; this is the only time the subset
+            // is interned.
+            target_key = getKey(dense.toKeySet(targets));
+            visited[targets] = subset_keys.size();
+            subset_keys.push_back(target_key);
+            result.addState(target_key, zero);
+            worklist.push(targets);
+          }
+          else {
+            target_key = subset_keys[place->second];
+          }
+
+          sem_elem_t weight;
+          if (needs_weight_spec) {
+            weight = wg.getWeight(*this, result, weight_spec, sources_set, symbol,
+                                  dense.toKeySet(targets));
+          }
+          else {
+            weight = one;
+          }
+          result.addTrans(sources_key, symbol, target_key, weight);
+
+          group = group_end;
+        }
+      }
+
+      return result;
+    }
+
+  } // namespace wfa
+} // namespace wali
+
+
+// Yo emacs!
+// Local Variables:
+//     c-basic-offset: 2
+//     indent-tabs-mode: nil
+// End:
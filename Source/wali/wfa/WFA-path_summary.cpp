@@ -5,6 +5,7 @@
 #include "wali/wfa/TransFunctor.hpp"
 #include "wali/wfa/Trans.hpp"
 #include "wali/wfa/WeightMaker.hpp"
+#include "wali/wfa/CsrSnapshot.hpp"
 #include "wali/regex/AllRegex.hpp"
 #include "wali/wpds/GenKeySource.hpp"
 #include "wali/wfa/DeterminizeWeightGen.hpp"
@@ -80,6 +81,68 @@ namespace wali
       path_summary_iterative_original(wl, nullwt);
     }
 
+    namespace details
+    {
+      //
+      // Propagates the_delta from q backwards over the transition
+      // t = (qprime, _, q) to qprime, and puts qprime on the worklist if
+      // its weight changed.
+      //
+      static void
+      relax_predecessor(State * qprime, ITrans const * t, State const * q,
+                        sem_elem_t the_delta, sem_elem_t ZERO,
+                        WFA::query_t query, Worklist<State> & wl)
+      {
+        (void) q;
+        sem_elem_t newW = qprime->weight()->zero();
+
+        { // BEGIN DEBUGGING
+          //t->print(*waliErr << "\t++ Popped ") << std::endl;
+        } // END DEBUGGING
+
+        assert(t->to() == q->name());
+
+        sem_elem_t extended;
+        if (query == WFA::INORDER) {
+          extended = t->weight()->extend(the_delta);
+        }
+        else {
+          extended = the_delta->extend(t->weight());
+        }
+        newW = newW->combine(extended);
+
+        // delta => (w+se,w-se)
+        // Use extended->delta b/c we want the diff b/w the new
+        // weight (extended) and what was there before
+        std::pair<sem_elem_t,sem_elem_t> p = newW->delta(qprime->weight());
+
+        { // BEGIN DEBUGGING
+          //qprime->weight()->print(*waliErr << "   oldW " << key2str(qprime->name())) << std::endl;
+          //newW->print(*waliErr << "   newW " << key2str(qprime->name())) << std::endl;
+          //p.first->print(*waliErr << "\t++ p.first ") << std::endl;
+          //p.second->print(*waliErr << "\t++ p.second ") << std::endl;
+        } // END DEBUGGING
+
+        // Sets qprime's new weight
+        // p.first == (l(t) X the_delta) + W(qprime)
+        qprime->weight() = p.first;
+
+        // on the worklist?
+        if (qprime->marked()) {
+          qprime->delta() = qprime->delta()->combine(p.second);
+        }
+        else {
+          // not on the worklist means its delta is zero
+          qprime->delta() = p.second;
+
+          // add to worklist if not zero
+          if (!qprime->delta()->equal(ZERO)) {
+            wl.put(qprime);
+          }
+        }
+      }
+    }
+
     //
     // Computes path_summary_iterative_original
     //
@@ -89,8 +152,12 @@ namespace wali
       // BEGIN DEBUGGING
       //int numPops = 0;
       // END DEBUGGING
+
+      // If the WFA is frozen, the predecessors come straight out of the
+      // snapshot; otherwise we have to build the incoming-transition map.
+      CsrSnapshot const * csr = getCsrSnapshot();
       IncomingTransMap_t preds;
-      setupFixpoint(wl, &preds, NULL, wt);
+      setupFixpoint(wl, csr ? NULL : &preds, NULL, wt);
       while (!wl.empty()) {
         State* q = wl.get();
         sem_elem_t the_delta = q->delta();
@@ -104,70 +171,33 @@ namespace wali
         // Get a handle on ZERO b/c we use it alot
         sem_elem_t ZERO = q->weight()->zero();
 
-        // Find predecessor set
-        IncomingTransMap_t::iterator incomingTransIt = preds.find(q->name());
-
-        // Some states may have no predecessors, like
-        // the initial state
-        if (incomingTransIt == preds.end()) {
-          continue;
-        }
-
-        // Tell predecessors we have changed
-        std::vector<ITrans*> & incoming = incomingTransIt->second;
-
-        std::vector<ITrans*>::iterator transit = incoming.begin();
-        for ( ; transit != incoming.end() ; ++transit)
-        {
-          ITrans* t = *transit;
-          
-          // We are looking at a transition (q', _, q)
-          State* qprime = state_map[t->from()];
-
-          sem_elem_t newW = qprime->weight()->zero();
-
-          { // BEGIN DEBUGGING
-            //t->print(*waliErr << "\t++ Popped ") << std::endl;
-          } // END DEBUGGING
-
-          assert(t->to() == q->name());
-
-          sem_elem_t extended;
-          if (query == INORDER) {
-            extended = t->weight()->extend(the_delta);
-          }
-          else {
-            extended = the_delta->extend(t->weight());
-          }
-          newW = newW->combine(extended);
-
-          // delta => (w+se,w-se)
-          // Use extended->delta b/c we want the diff b/w the new
-          // weight (extended) and what was there before
-          std::pair<sem_elem_t,sem_elem_t> p = newW->delta(qprime->weight());
-
-          { // BEGIN DEBUGGING
-            //qprime->weight()->print(*waliErr << "   oldW " << key2str(qprime->name())) << std::endl;
-            //newW->print(*waliErr << "   newW " << key2str(qprime->name())) << std::endl;
-            //p.first->print(*waliErr << "\t++ p.first ") << std::endl;
-            //p.second->print(*waliErr << "\t++ p.second ") << std::endl;
-          } // END DEBUGGING
-
-          // Sets qprime's new weight
-          // p.first == (l(t) X the_delta) + W(qprime)
-          qprime->weight() = p.first;
-
-          // on the worklist?
-          if (qprime->marked()) {
-            qprime->delta() = qprime->delta()->combine(p.second);
+        if (csr) {
+          CsrSnapshot::edge_range incoming = csr->incoming(csr->stateIndex(q->name()));
+          for ( ; incoming.first != incoming.second; ++incoming.first) {
+            // We are looking at a transition (q', _, q)
+            details::relax_predecessor(csr->state(incoming.first->source),
+                                       incoming.first->trans, q,
+                                       the_delta, ZERO, query, wl);
           }
-          else {
-            // not on the worklist means its delta is zero
-            qprime->delta() = p.second;
-
-            // add to worklist if not zero
-            if (!qprime->delta()->equal(ZERO)) {
-              wl.put(qprime);
+        }
+        else {
+          // Find predecessor set
+          IncomingTransMap_t::iterator incomingTransIt = preds.find(q->name());
+
+          // Some states may have no predecessors, like
+          // the initial state
+          if (incomingTransIt != preds.end()) {
+            // Tell predecessors we have changed
+            std::vector<ITrans*> & incoming = incomingTransIt->second;
+
+            std::vector<ITrans*>::iterator transit = incoming.begin();
+            for ( ; transit != incoming.end() ; ++transit)
+            {
+              ITrans* t = *transit;
+
+              // We are looking at a transition (q', _, q)
+              details::relax_predecessor(state_map[t->from()], t, q,
+                                         the_delta, ZERO, query, wl);
             }
           }
         }
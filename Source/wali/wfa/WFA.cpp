@@ -9,6 +9,8 @@
 #include "wali/wfa/TransFunctor.hpp"
 #include "wali/wfa/Trans.hpp"
 #include "wali/wfa/WeightMaker.hpp"
+#include "wali/wfa/CsrSnapshot.hpp"
+#include "wali/wfa/IncrementalReachability.hpp"
 #include "wali/regex/AllRegex.hpp"
 #include "wali/wpds/GenKeySource.hpp"
 #include "wali/wfa/DeterminizeWeightGen.hpp"
@@ -83,6 +85,7 @@ namespace wali
       if( this != &rhs )
       {
         clear();
+        reachability.reset();
 
         // Copy important state information
         init_state = rhs.init_state;
@@ -118,8 +121,34 @@ namespace wali
       clear();
     }
 
+    void WFA::swap( WFA & other )
+    {
+      kpmap.swap(other.kpmap);
+      state_map.swap(other.state_map);
+      eps_map.swap(other.eps_map);
+      std::swap(init_state, other.init_state);
+      F.swap(other.F);
+      Q.swap(other.Q);
+      std::swap(query, other.query);
+      std::swap(generation, other.generation);
+      deleted_states.swap(other.deleted_states);
+      csr_snapshot.swap(other.csr_snapshot);
+      std::swap(last_prune_statistics, other.last_prune_statistics);
+
+      // The reachability information describes the WFA it is attached
+      // to, so each side starts it over on its new contents
+      if (reachability) {
+        reachability.reset(new IncrementalReachability(*this));
+      }
+      if (other.reachability) {
+        other.reachability.reset(new IncrementalReachability(other));
+      }
+    }
+
     void WFA::clear()
     {
+      thaw();
+
       /* Must manually delete all Trans objects. If reference
        * counting is used this code can be removed
        */
@@ -153,6 +182,10 @@ namespace wali
       F.clear();
       Q.clear();
       init_state = WALI_EPSILON;
+
+      if (reachability) {
+        reachability->onClear();
+      }
     }
 
     //!
@@ -173,6 +206,10 @@ namespace wali
       // TODO : Add debug check to verify key exists
       init_state = key;
 
+      if (reachability) {
+        reachability->onSetInitialState();
+      }
+
       return isold;
     }
 
@@ -183,6 +220,9 @@ namespace wali
     {
       assert( getState(key) != NULL );
       F.insert(key);
+      if (reachability) {
+        reachability->onAddFinalState(key);
+      }
     }
 
     //!
@@ -199,6 +239,9 @@ namespace wali
       assert( getState(key) != NULL );
       F.insert(key);
       getState(key)->acceptWeight() = accept_weight;
+      if (reachability) {
+        reachability->onAddFinalState(key);
+      }
     }
 
     //!
@@ -629,6 +672,51 @@ namespace wali
 
         dest.addTrans(source_key, symbol, target_key, final_weight);
       }
+
+      /// Appends the transitions (state, symbol, ?) of 'wfa' to 'out',
+      /// reading them from the CsrSnapshot if 'wfa' is frozen.
+      void
+      append_outgoing(WFA const & wfa,
+                      Key state,
+                      Key symbol,
+                      std::vector<ITrans const *> & out)
+      {
+        CsrSnapshot const * csr = wfa.getCsrSnapshot();
+        if (csr) {
+          CsrSnapshot::Index
+            state_index = csr->stateIndex(state),
+            symbol_index = csr->symbolIndex(symbol);
+          if (state_index == CsrSnapshot::NoIndex
+              || symbol_index == CsrSnapshot::NoIndex)
+          {
+            return;
+          }
+          CsrSnapshot::edge_range edges = csr->outgoing(state_index, symbol_index);
+          for ( ; edges.first != edges.second; ++edges.first) {
+            out.push_back(edges.first->trans);
+          }
+        }
+        else {
+          TransSet const * transitions = wfa.outgoingTransSet(state, symbol);
+          if (transitions) {
+            out.insert(out.end(), transitions->begin(), transitions->end());
+          }
+        }
+      }
+
+      /// True if 'transitions' contains a self loop
+      bool
+      has_self_loop(std::vector<ITrans const *> const & transitions)
+      {
+        for (std::vector<ITrans const *>::const_iterator trans = transitions.begin();
+             trans != transitions.end(); ++trans)
+        {
+          if ((*trans)->from() == (*trans)->to()) {
+            return true;
+          }
+        }
+        return false;
+      }
     }
     
     //
@@ -646,18 +734,22 @@ namespace wali
       sem_elem_t zero = wmaker.make_weight(this->getSomeWeight()->one(),
                                            fa.getSomeWeight()->one())->zero();
       
+      // If this WFA is frozen, the symbols to try from each state come
+      // from its CSR row; otherwise we have to try every symbol.
+      CsrSnapshot const * this_csr = getCsrSnapshot();
+
       // Sigh
-      std::set<Key> alphabet;
-      for(kp_map_t::const_iterator iter = kpmap.begin();
-          iter != kpmap.end(); ++iter)
-      {
-        alphabet.insert(iter->first.second);
+      std::vector<Key> alphabet;
+      if (!this_csr) {
+        std::set<Key> symbols;
+        for(kp_map_t::const_iterator iter = kpmap.begin();
+            iter != kpmap.end(); ++iter)
+        {
+          symbols.insert(iter->first.second);
+        }
+        symbols.insert(WALI_EPSILON);
+        alphabet.assign(symbols.begin(), symbols.end());
       }
-      alphabet.insert(WALI_EPSILON);
-
-      // Siiiiiiiigh. (nc = non-const)
-      WFA * this_nc = const_cast<WFA*>(this);
-      WFA * fa_nc = const_cast<WFA*>(&fa);
 
       // Now start the actual intersection bit.
       std::vector<KeyPair> worklist;
@@ -670,17 +762,35 @@ namespace wali
                                initial_key, initial_pair);
       dest.setInitialState(initial_key);       
 
+      std::vector<ITrans const *> this_outgoing, fa_outgoing;
+
       // Begin the worklist processing
       while (!worklist.empty()) {
         KeyPair source_pair = worklist.back();
         worklist.pop_back();
 
-        for (std::set<Key>::const_iterator sym_iter = alphabet.begin();
+        if (this_csr) {
+          alphabet.clear();
+          alphabet.push_back(WALI_EPSILON);
+          CsrSnapshot::Index source_index = this_csr->stateIndex(source_pair.first);
+          if (source_index != CsrSnapshot::NoIndex) {
+            CsrSnapshot::edge_range edges = this_csr->outgoing(source_index);
+            for ( ; edges.first != edges.second; ++edges.first) {
+              Key symbol = this_csr->symbolKey(edges.first->symbol);
+              if (symbol != alphabet.back() && symbol != WALI_EPSILON) {
+                alphabet.push_back(symbol);
+              }
+            }
+          }
+        }
+
+        for (std::vector<Key>::const_iterator sym_iter = alphabet.begin();
              sym_iter != alphabet.end(); ++sym_iter)
         {
-          TransSet
-            this_outgoing = this_nc->match(source_pair.first, *sym_iter),
-            fa_outgoing = fa_nc->match(source_pair.second, *sym_iter);
+          this_outgoing.clear();
+          fa_outgoing.clear();
+          details::append_outgoing(*this, source_pair.first, *sym_iter, this_outgoing);
+          details::append_outgoing(fa, source_pair.second, *sym_iter, fa_outgoing);
 
           ITrans
             * left_no_motion = NULL,
@@ -695,17 +805,17 @@ namespace wali
 
             // Will fail if there is already an epsilon self
             // loop. (Non-trivial cycles should be OK.)
-            assert(this_outgoing.find(left_no_motion) == this_outgoing.end());
-            assert(fa_outgoing.find(right_no_motion) == fa_outgoing.end());
+            assert(!details::has_self_loop(this_outgoing));
+            assert(!details::has_self_loop(fa_outgoing));
             
-            this_outgoing.insert(left_no_motion);
-            fa_outgoing.insert(right_no_motion);
+            this_outgoing.push_back(left_no_motion);
+            fa_outgoing.push_back(right_no_motion);
           }
 
-          for (TransSet::const_iterator this_trans_iter = this_outgoing.begin();
+          for (std::vector<ITrans const *>::const_iterator this_trans_iter = this_outgoing.begin();
                this_trans_iter != this_outgoing.end(); ++this_trans_iter)
           {
-            for (TransSet::const_iterator fa_trans_iter = fa_outgoing.begin();
+            for (std::vector<ITrans const *>::const_iterator fa_trans_iter = fa_outgoing.begin();
                  fa_trans_iter != fa_outgoing.end(); ++fa_trans_iter)
             {
               if (*sym_iter == WALI_EPSILON
@@ -859,9 +969,17 @@ namespace wali
     //
     void WFA::prune()
     {
+      if (reachability) {
+        prune_incremental();
+        return;
+      }
+
+      size_t const states_before = numStates();
+
       // First, remove all transitions with zero weight
       TransZeroWeight tzw;
       for_each(tzw);
+      size_t transitions_removed = tzw.zeroWeightTrans.size();
       TransSet::iterator transit = tzw.zeroWeightTrans.begin();
       for(; transit != tzw.zeroWeightTrans.end(); transit++) {
         ITrans *t = *transit;
@@ -950,6 +1068,7 @@ namespace wali
             eraseTransFromEpsMap(t);
             tSet.erase(eraseIt);
             delete t;
+            transitions_removed++;
           }
         }
       }
@@ -958,6 +1077,10 @@ namespace wali
       // States that have a tag of 2 are forwards and backwards
       // reachable. Erase all other states.
       //
+      // The loop above erased every transition from a kept state to an
+      // erased one, so each transition that is left goes away with the
+      // state it leaves.
+      //
       std::vector<State*> to_erase;
       FOR_EACH_STATE( eraseMe ) {
         if( eraseMe->tag != 2 ) {
@@ -965,6 +1088,7 @@ namespace wali
             //*waliErr << "Erasing State '" << key2str(eraseMe->name()) << "'\n";
           } // END DEBUGGING
           to_erase.push_back(eraseMe);
+          transitions_removed += eraseMe->getTransSet().size();
         }
       }
       for (std::vector<State*>::const_iterator eraseMe = to_erase.begin();
@@ -972,6 +1096,62 @@ namespace wali
       {
         eraseState(*eraseMe);
       }
+
+      last_prune_statistics = PruneStatistics();
+      last_prune_statistics.states_removed = states_before - numStates();
+      last_prune_statistics.transitions_removed = transitions_removed;
+    }
+
+    void WFA::prune_incremental()
+    {
+      assert(reachability);
+
+      size_t const states_before = numStates();
+      size_t const erased_before = reachability->transitionsErased();
+
+      // First, remove the transitions that have been given a zero
+      // weight since the last prune
+      std::vector<ITrans*> candidates;
+      reachability->takeWeightCandidates(candidates);
+      for (std::vector<ITrans*>::const_iterator t = candidates.begin();
+           t != candidates.end(); ++t)
+      {
+        if ((*t)->weight()->equal((*t)->weight()->zero())) {
+          erase((*t)->from(), (*t)->stack(), (*t)->to());
+        }
+      }
+
+      // Then remove the states outside the (init_state, F) chop, which
+      // takes their transitions with them
+      IncrementalReachability::KeyHashSet const & dead = reachability->deadStates();
+      std::vector<Key> to_erase(dead.begin(), dead.end());
+      for (std::vector<Key>::const_iterator q = to_erase.begin();
+           q != to_erase.end(); ++q)
+      {
+        eraseState(*q);
+      }
+
+      last_prune_statistics.states_removed = states_before - numStates();
+      last_prune_statistics.transitions_removed
+        = reachability->transitionsErased() - erased_before;
+      last_prune_statistics.states_visited = reachability->statesVisited();
+      reachability->resetStatesVisited();
+    }
+
+    void WFA::setIncrementalPrune(bool incremental)
+    {
+      if (incremental && !reachability) {
+        reachability.reset(new IncrementalReachability(*this));
+        reachability->resetStatesVisited();
+      }
+      else if (!incremental) {
+        reachability.reset();
+      }
+    }
+
+    bool WFA::isIncrementalPrune() const
+    {
+      return reachability.get() != NULL;
     }
 
     //
@@ -1074,7 +1254,17 @@ namespace wali
     {
       o << "digraph \"WFA@" << std::hex << (void*)this << std::dec << "\" {\n";
       TransDotty dotter( o, print_weights, attribute_printer );
-      for_each(dotter);
+      if( csr_snapshot ) {
+        // Frozen: visit the transitions in (from,stack,to) order without
+        // walking the hash buckets
+        CsrSnapshot::edge_range edges = csr_snapshot->transitions();
+        for( ; edges.first != edges.second ; ++edges.first ) {
+          dotter( edges.first->trans );
+        }
+      }
+      else {
+        for_each(dotter);
+      }
       state_map_t::const_iterator stit = state_map.begin();
       state_map_t::const_iterator stitEND = state_map.end();
       for( ; stit != stitEND ; stit++ )
@@ -1188,6 +1378,8 @@ namespace wali
       ////
       if( 0 == told )
       {
+        thaw();
+
         sem_elem_t ZERO( tnew->weight()->zero() );
         //*waliErr << "\tAdding 'from' state'" << key2str(t->from()) << "'\n";
         addState( tnew->from(), ZERO );
@@ -1228,6 +1420,10 @@ namespace wali
           }
           epsit->second.insert( tnew );
         }
+
+        if (reachability) {
+          reachability->onAddTrans(tnew);
+        }
       }
       else {
         // Safety check. If told == tnew then the combine
@@ -1239,6 +1435,9 @@ namespace wali
           told->combineTrans( tnew );
           delete tnew;
           inserted = false;
+          if (reachability) {
+            reachability->onTransWeightChanged(told);
+          }
         }
         else {
           *waliErr << "[WARNING - WFA::insert]\n";
@@ -1260,9 +1459,13 @@ namespace wali
     void WFA::addState( Key key , sem_elem_t zero )
     {
       if( state_map.find( key ) == state_map.end() ) {
+        thaw();
         State* state = new State(key,zero);
         state_map.insert( key , state );
         Q.insert(key);
+        if (reachability) {
+          reachability->onAddState(key);
+        }
       }
     }
 
@@ -1415,6 +1618,12 @@ namespace wali
       if( kpit != kpmap.end() ) {
         tret = kpit->second.erase(terase);
       }
+      if( tret != NULL ) {
+        thaw();
+        if (reachability) {
+          reachability->onEraseTrans(tret);
+        }
+      }
       return tret;
     }
 
@@ -1437,15 +1646,41 @@ namespace wali
     bool
     WFA::eraseState(State* state)
     {
+      thaw();
+
       // Remove incoming and outgoing transitions
-      details::TransRemover remover(state->name());
-      this->for_each(remover);
-      remover.removeFrom(this);
+      if (reachability) {
+        // The reachability tracker knows the incoming transitions, so
+        // there is no need to look at every transition.
+        std::vector<ITrans*> to_remove(state->begin(), state->end());
+        IncrementalReachability::TransPtrSet const & incoming
+          = reachability->incoming(state->name());
+        for (IncrementalReachability::TransPtrSet::const_iterator t = incoming.begin();
+             t != incoming.end(); ++t)
+        {
+          if ((*t)->from() != state->name()) {
+            to_remove.push_back(*t);
+          }
+        }
+        for (std::vector<ITrans*>::const_iterator t = to_remove.begin();
+             t != to_remove.end(); ++t)
+        {
+          erase((*t)->from(), (*t)->stack(), (*t)->to());
+        }
+      }
+      else {
+        details::TransRemover remover(state->name());
+        this->for_each(remover);
+        remover.removeFrom(this);
+      }
 
       // Remove the state itself
       Q.erase(state->name());
       F.erase(state->name());
       state_map.erase(state->name());
+      if (reachability) {
+        reachability->onEraseState(state->name());
+      }
 
       // This is because of dumb bookkeeping stuff. I can't actually
       // delete the state at this point because of some reason, but we
@@ -1710,7 +1945,7 @@ namespace wali
         
         // Now after holds the list of starting positions. After this, before
         // will.
-        swap(after, before);
+        std::swap(after, before);
         
       } // For each letter in 'word'
 
@@ -1797,6 +2032,19 @@ namespace wali
 
     WFA
     WFA::semideterminize(DeterminizeWeightGen const & wg) const
+    {
+      switch (globalDefaultDeterminizeImplementation) {
+        case DeterminizeKeySets:
+          return semideterminize_keysets(wg);
+        case DeterminizeDenseSubsets:
+          return semideterminize_dense(wg);
+      }
+      assert(false);
+      return semideterminize_keysets(wg);
+    }
+
+    WFA
+    WFA::semideterminize_keysets(DeterminizeWeightGen const & wg) const
     {
       std::stack<KeySet> worklist;
       std::set<Key> visited;
@@ -2028,6 +2276,29 @@ namespace wali
           return false;
         }
 
+        if (CsrSnapshot const * left_csr = left.getCsrSnapshot()) {
+          // Frozen: the outgoing transitions of left_state are one CSR
+          // row, so we don't have to scan the whole kpmap.
+          Key right_source = left_to_right[left_state];
+          CsrSnapshot::edge_range edges = left_csr->outgoing(left_csr->stateIndex(left_state));
+          for ( ; edges.first != edges.second; ++edges.first) {
+            ITrans const * left_trans = edges.first->trans;
+            ITrans const * right_trans = right.find(right_source,
+                                                    left_trans->stack(),
+                                                    get(left_to_right, left_trans->to()));
+            if (right_trans == NULL) {
+              // There was no such transition
+              return false;
+            }
+            if (check_weights
+                && !left_trans->weight()->equal(right_trans->weight().get_ptr()))
+            {
+              return false;
+            }
+          }
+          continue;
+        }
+
         for (kp_map_t::const_iterator kpmap_iter = left.kpmap.begin();
              kpmap_iter != left.kpmap.end(); ++kpmap_iter)
         {
@@ -2183,46 +2454,87 @@ namespace wali
     {
       sem_elem_t one = getSomeWeight()->one();
 
-      // We only add {} on-demand. If it's not reachable, then we don't want
-      // it there.
-      bool need_sink_state = false;
-
-      // Maps source state to set of outgoing letters. (We don't care where
-      // they go, just whether there is any.)
-      std::map<Key, KeySet> outgoing;
-      
-      for (kp_map_t::const_iterator kpmap_iter = kpmap.begin();
-           kpmap_iter != kpmap.end(); ++kpmap_iter)
+      // Work out every missing (state, symbol) pair first: adding
+      // transitions thaws the snapshot we read them from. If the WFA
+      // wasn't frozen to begin with, don't leave it frozen.
+      bool const was_frozen = isFrozen();
+      freeze();
+      CsrSnapshot const & csr = *csr_snapshot;
+
+      // The requested symbols that appear in the WFA, as sorted snapshot
+      // indices, and those that don't (which every state is missing).
+      std::vector<CsrSnapshot::Index> wanted;
+      std::vector<Key> absent;
+      for (KeySet::const_iterator symbol = symbols.begin();
+           symbol != symbols.end(); ++symbol)
       {
-        if (kpmap_iter->second.size() > 0) {
-          outgoing[kpmap_iter->first.first].insert(kpmap_iter->first.second);
+        CsrSnapshot::Index index = csr.symbolIndex(*symbol);
+        if (index == CsrSnapshot::NoIndex) {
+          absent.push_back(*symbol);
+        }
+        else {
+          wanted.push_back(index);
         }
       }
+      std::sort(wanted.begin(), wanted.end());
 
-      KeySet states = getStates();
-      for (KeySet::const_iterator state = states.begin();
-           state != states.end(); ++state)
-      {
-        for (KeySet::const_iterator symbol = symbols.begin();
-             symbol != symbols.end(); ++symbol)
+      std::vector<std::pair<Key, Key> > missing;
+      std::vector<CsrSnapshot::Index> state_missing;
+      for (CsrSnapshot::Index state = 0; state < csr.numStates(); ++state) {
+        CsrSnapshot::symbol_range present = csr.outgoingSymbols(state);
+        state_missing.clear();
+        std::set_difference(wanted.begin(), wanted.end(),
+                            present.first, present.second,
+                            std::back_inserter(state_missing));
+
+        Key state_key = csr.stateKey(state);
+        for (std::vector<CsrSnapshot::Index>::const_iterator symbol = state_missing.begin();
+             symbol != state_missing.end(); ++symbol)
         {
-          if (outgoing[*state].find(*symbol) == outgoing[*state].end()) {
-            need_sink_state = true;
-            addState(sink_state, one->zero());
-            addTrans(*state, *symbol, sink_state, one);
-          }
+          missing.push_back(std::make_pair(state_key, csr.symbolKey(*symbol)));
         }
+        for (std::vector<Key>::const_iterator symbol = absent.begin();
+             symbol != absent.end(); ++symbol)
+        {
+          missing.push_back(std::make_pair(state_key, *symbol));
+        }
+      }
+
+      // Every symbol on a transition once we're done, for the sink
+      // state's self loops
+      std::vector<Key> all_symbols;
+      all_symbols.reserve(csr.numSymbols() + absent.size());
+      for (CsrSnapshot::Index symbol = 0; symbol < csr.numSymbols(); ++symbol) {
+        all_symbols.push_back(csr.symbolKey(symbol));
       }
+      all_symbols.insert(all_symbols.end(), absent.begin(), absent.end());
+
+      bool const sink_was_state = (Q.count(sink_state) > 0u);
 
-      if (need_sink_state && states.count(sink_state) == 0u)
+      // We only add {} on-demand. If it's not reachable, then we don't want
+      // it there.
+      if (missing.empty()) {
+        if (!was_frozen) {
+          thaw();
+        }
+        return;
+      }
+
+      addState(sink_state, one->zero());
+      for (std::vector<std::pair<Key, Key> >::const_iterator pair = missing.begin();
+           pair != missing.end(); ++pair)
       {
-        // If we don't need it, then we don't need to add transitions to and
-        // from it. :-) If sink_state is in 'states', then this was already
-        // handled by the loop above.
-        for (kp_map_t::const_iterator kp_iter = kpmap.begin();
-             kp_iter != kpmap.end(); ++kp_iter)
+        addTrans(pair->first, pair->second, sink_state, one);
+      }
+
+      if (!sink_was_state)
+      {
+        // If sink_state was already a state, then the loop above already
+        // completed it.
+        for (std::vector<Key>::const_iterator symbol = all_symbols.begin();
+             symbol != all_symbols.end(); ++symbol)
         {
-          addTrans(sink_state, kp_iter->first.second, sink_state, one);
+          addTrans(sink_state, *symbol, sink_state, one);
         }
       }
     }
@@ -2394,9 +2706,38 @@ namespace wali
       return result;
     }
 
+    void
+    WFA::freeze() const
+    {
+      if (!csr_snapshot) {
+        csr_snapshot.reset(new CsrSnapshot(*this));
+      }
+    }
+
+    bool
+    WFA::isFrozen() const
+    {
+      return csr_snapshot.get() != NULL;
+    }
+
+    CsrSnapshot const *
+    WFA::getCsrSnapshot() const
+    {
+      return csr_snapshot.get();
+    }
+
+    void
+    WFA::thaw()
+    {
+      csr_snapshot.reset();
+    }
+
     size_t
     WFA::numTransitions() const
     {
+      if (csr_snapshot) {
+        return csr_snapshot->numTransitions();
+      }
       TransCounter counter;
       for_each(counter);
       return counter.getNumTrans();
@@ -2509,6 +2850,18 @@ namespace wali
     std::set<Key>
     WFA::alphabet() const
     {
+      if (csr_snapshot) {
+        // The snapshot's symbols are already sorted and distinct
+        std::set<Key> result;
+        for (CsrSnapshot::Index symbol = 0; symbol < csr_snapshot->numSymbols(); ++symbol) {
+          Key key = csr_snapshot->symbolKey(symbol);
+          if (key != WALI_EPSILON) {
+            result.insert(result.end(), key);
+          }
+        }
+        return result;
+      }
+
       AlphabetComputer x;
       this->for_each(x);
       return x.alphabet;
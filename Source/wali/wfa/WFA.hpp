@@ -9,6 +9,7 @@
 #include <boost/ref.hpp>
 #include <boost/type_traits.hpp>
 #include <boost/utility/enable_if.hpp>
+#include <boost/shared_ptr.hpp>
 
 // ::wali
 #include "wali/Common.hpp"
@@ -63,6 +64,8 @@ namespace wali
     class TransFunctor;
     class ConstTransFunctor;
     class DeterminizeWeightGen;
+    class CsrSnapshot;
+    class IncrementalReachability;
 
     /**
      * "Callbacks" for outputting attributes in the Dot.
@@ -113,6 +116,13 @@ namespace wali
         static PathSummaryImplementation globalDefaultPathSummaryImplementation;
         static bool globalDefaultPathSummaryFwpdsTopDown;
 
+        enum DeterminizeImplementation {
+            DeterminizeKeySets,
+            DeterminizeDenseSubsets
+        };
+
+        static DeterminizeImplementation globalDefaultDeterminizeImplementation;
+
         typedef wali::HashMap< KeyPair, TransSet > kp_map_t;
         typedef wali::HashMap< Key , State * > state_map_t;
         typedef wali::HashMap< Key , TransSet > eps_map_t;
@@ -125,6 +135,7 @@ namespace wali
         friend class ::wali::wpds::ewpds::EWPDS;
         friend class ::wali::wpds::fwpds::FWPDS;
         friend class ::wali::wpds::fwpds::SWPDS;
+        friend class CsrSnapshot;
 
         static const std::string XMLTag;
         static const std::string XMLQueryTag;
@@ -155,6 +166,13 @@ namespace wali
          */
         virtual void clear();
 
+        /**
+         * Exchange the states, transitions, initial and final states,
+         * and query direction of this WFA with those of 'other'. The
+         * progress object and the path summary defaults stay put.
+         */
+        void swap( WFA & other );
+
         /**
          * @brief set initial state
          *
@@ -467,9 +485,52 @@ namespace wali
         /**
          * Prunes the WFA. This removes any transitions that are
          * not in the (getInitialState(),F) chop.
+         *
+         * In incremental mode (see setIncrementalPrune) the reachable
+         * sets are already known, so this only removes the zero-weight
+         * transitions added since the last prune and the states that
+         * are not in the chop.
          */
         virtual void prune();
 
+        /**
+         * Counts from the most recent call to prune()
+         */
+        struct PruneStatistics
+        {
+          size_t states_removed;
+          size_t transitions_removed;
+          /// States examined to keep the reachable sets up to date since
+          /// the previous prune (incremental mode only)
+          size_t states_visited;
+
+          PruneStatistics()
+            : states_removed(0), transitions_removed(0), states_visited(0)
+          {}
+        };
+
+        /**
+         * Turns incremental pruning on or off. While it is on, the WFA
+         * keeps track of which states are forward reachable from the
+         * initial state and backward reachable from a final state as
+         * states and transitions are added and erased, and prune() (and
+         * eraseState) take time proportional to what changed rather
+         * than to the size of the WFA.
+         *
+         * Weights changed directly through ITrans::setWeight are not
+         * noticed; a transition whose weight is made zero that way is
+         * not removed by an incremental prune(). An incremental prune()
+         * also leaves the state weights alone, where a full prune()
+         * resets them. Copies of a WFA do not inherit incremental mode.
+         */
+        void setIncrementalPrune(bool incremental);
+
+        bool isIncrementalPrune() const;
+
+        PruneStatistics const & getLastPruneStatistics() const {
+          return last_prune_statistics;
+        }
+
         /**
          * Intersects the WFA with <init_state, (stk \Gamma^*)>
          * that essentially removes transitions and calls prune
@@ -582,6 +643,31 @@ namespace wali
 
         size_t numTransitions() const;
 
+        /**
+         * @brief Build a read-only CsrSnapshot of the states and
+         * transitions.
+         *
+         * Until the next operation that adds or removes a state or
+         * transition, read-only algorithms (path_summary_iterative_original,
+         * intersect, print_dot, isIsomorphicTo, ...) use the snapshot
+         * instead of the hash maps. Calling freeze() on a frozen WFA does
+         * nothing.
+         *
+         * @see CsrSnapshot
+         */
+        void freeze() const;
+
+        /**
+         * @return true if the WFA has a valid CsrSnapshot
+         */
+        bool isFrozen() const;
+
+        /**
+         * @return the current CsrSnapshot, or NULL if the WFA has been
+         * modified since it was last frozen.
+         */
+        CsrSnapshot const * getCsrSnapshot() const;
+
 
         /** Return the results of an analysis
          *
@@ -668,6 +754,17 @@ namespace wali
          */
         bool eraseState( State* state );
 
+        /**
+         * Drops the CsrSnapshot (if any). Called by everything that adds
+         * or removes states or transitions.
+         */
+        void thaw();
+
+        /**
+         * prune() when incremental pruning is on
+         */
+        void prune_incremental();
+
         /**
          * Uses Tarjan's algorithm to build a regular expression
          * for this WFA. IIRC, it is the cubic dynamic programming
@@ -697,6 +794,10 @@ namespace wali
 
         std::set<State*> deleted_states;
 
+        mutable boost::shared_ptr<CsrSnapshot const> csr_snapshot; //! < NULL unless frozen
+        boost::shared_ptr<IncrementalReachability> reachability; //! < NULL unless incremental pruning
+        PruneStatistics last_prune_statistics;
+
         PathSummaryImplementation defaultPathSummaryImplementation;
         bool defaultPathSummaryFwpdsTopDown;
 
@@ -788,6 +889,18 @@ namespace wali
         /// non-total transition function.
         WFA semideterminize() const;
         WFA semideterminize(DeterminizeWeightGen const & weight_gen) const;
+
+        /// The original subset construction. Each macro-state is a
+        /// std::set<Key> that is interned in the KeySpace (via getKey) every
+        /// time it is looked up.
+        WFA semideterminize_keysets(DeterminizeWeightGen const & weight_gen) const;
+
+        /// Subset construction over a dense renumbering of the states.
+        /// Macro-states are sorted arrays of state indices looked up in a
+        /// hash table; a macro-state is interned in the KeySpace only once,
+        /// when it is first added to the result. Produces the same automaton
+        /// as semideterminize_keysets().
+        WFA semideterminize_dense(DeterminizeWeightGen const & weight_gen) const;
         
         /// Returns whether this WFA is isomorphic to the given WFA; that is,
         /// the two automata are equal up to a relabeling of the states. (Or,
@@ -37,6 +37,8 @@ int main(int argc, char ** argv)
   vars["h"] = 2;
   voc->setIntVars(vars);
   
+  clock_t start = clock();
+
   sem_elem_tensor_t val = new BinRel(voc, bddfalse);
   val = val->tensor(val.get_ptr());
   sem_elem_tensor_t id = new BinRel(voc, voc->Assign("a", voc->From("a")));    
@@ -122,7 +124,13 @@ int main(int argc, char ** argv)
 
   val = NULL;
 
+  double seconds = double(clock() - start) / CLOCKS_PER_SEC;
+  bddStat stats;
+  bdd_stats(&stats);
+
   delete voc;
 
+  cout << "Time: " << seconds << " s" << endl;
+  cout << "Nodes produced: " << stats.produced << endl;
   cout << "Done!" << endl;
 }
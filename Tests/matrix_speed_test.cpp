@@ -0,0 +1,126 @@
+// Times extend and star of the matrix weight domains against each
+// other: the ublas-backed Matrix templates (BoolMatrix,
+// MinPlusIntMatrix), the flat ones (BitMatrix, MinPlusMatrix), and on
+// 1%-dense matrices, the sparse ones (SparseBoolMatrix,
+// SparseMinPlusIntMatrix).
+//
+//   matrix_speed_test [size [repetitions [seed]]]
+
+#include "wali/domains/matrix/Matrix.hpp"
+#include "wali/domains/matrix/BitMatrix.hpp"
+#include "wali/domains/matrix/MinPlusMatrix.hpp"
+#include "wali/domains/matrix/SparseMatrix.hpp"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace wali;
+using namespace wali::domains;
+
+namespace
+{
+  double
+  secondsSince(clock_t start)
+  {
+    return double(clock() - start) / CLOCKS_PER_SEC;
+  }
+
+  /// Extends lhs by rhs 'reps' times; returns the seconds per extend
+  double
+  timeExtend(sem_elem_t lhs, sem_elem_t rhs, int reps)
+  {
+    clock_t start = clock();
+    for (int i = 0; i < reps; ++i) {
+      sem_elem_t result = lhs->extend(rhs);
+    }
+    return secondsSince(start) / reps;
+  }
+
+  double
+  timeStar(sem_elem_t x, int reps)
+  {
+    clock_t start = clock();
+    for (int i = 0; i < reps; ++i) {
+      sem_elem_t result = x->star();
+    }
+    return secondsSince(start) / reps;
+  }
+
+  void
+  report(char const * what, double before, double after)
+  {
+    cout << what << ": " << before << " s -> " << after << " s ("
+         << before / after << "x)\n";
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  size_t size = 256;
+  int reps = 3;
+  unsigned seed = unsigned(time(NULL));
+  if (argc > 1) istringstream(argv[1]) >> size;
+  if (argc > 2) istringstream(argv[2]) >> reps;
+  if (argc > 3) istringstream(argv[3]) >> seed;
+  srand(seed);
+
+  cout << size << " x " << size << ", " << reps << " repetitions, seed " << seed << "\n";
+
+  BoolMatrix::BackingMatrix b1(size, size), b2(size, size), bsparse(size, size);
+  MinPlusIntMatrix::BackingMatrix m1(size, size), m2(size, size), msparse(size, size);
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      b1(i, j) = rand() % 2 == 0;
+      b2(i, j) = rand() % 2 == 0;
+      bsparse(i, j) = rand() % 100 == 0;
+      m1(i, j) = MinPlusIntMatrix::value_type::make(rand() % 4 == 0 ? MinPlusMatrix::infinity() : rand() % 1000);
+      m2(i, j) = MinPlusIntMatrix::value_type::make(rand() % 4 == 0 ? MinPlusMatrix::infinity() : rand() % 1000);
+      if (rand() % 100 == 0) msparse(i, j) = MinPlusIntMatrix::value_type::make(rand() % 1000);
+    }
+  }
+
+  sem_elem_t
+    bool1 = new BoolMatrix(b1), bool2 = new BoolMatrix(b2),
+    bit1 = new BitMatrix(b1), bit2 = new BitMatrix(b2),
+    bitSparse = new BitMatrix(bsparse),
+    minPlus1 = new MinPlusIntMatrix(m1), minPlus2 = new MinPlusIntMatrix(m2),
+    dense1 = new MinPlusMatrix(m1), dense2 = new MinPlusMatrix(m2),
+    boolSparse = new BoolMatrix(bsparse), sparseBool = new SparseBoolMatrix(bsparse),
+    minPlusSparse = new MinPlusIntMatrix(msparse), sparseMinPlus = new SparseMinPlusIntMatrix(msparse);
+
+  if (!bool1->extend(bool2)->equal(new BoolMatrix(dynamic_cast<BitMatrix*>(bit1->extend(bit2).get_ptr())->matrix()))
+      || !minPlus1->extend(minPlus2)->equal(new MinPlusIntMatrix(dynamic_cast<MinPlusMatrix*>(dense1->extend(dense2).get_ptr())->matrix())))
+  {
+    cerr << "ERROR: the products differ\n";
+    return 1;
+  }
+
+  report("BoolMatrix -> BitMatrix extend",
+         timeExtend(bool1, bool2, reps), timeExtend(bit1, bit2, reps));
+  report("MinPlusIntMatrix -> MinPlusMatrix extend",
+         timeExtend(minPlus1, minPlus2, reps), timeExtend(dense1, dense2, reps));
+
+  report("BoolMatrix -> SparseBoolMatrix extend (1% dense)",
+         timeExtend(boolSparse, boolSparse, reps), timeExtend(sparseBool, sparseBool, reps));
+  report("MinPlusIntMatrix -> SparseMinPlusIntMatrix extend (1% dense)",
+         timeExtend(minPlusSparse, minPlusSparse, reps), timeExtend(sparseMinPlus, sparseMinPlus, reps));
+  cout << "SparseMinPlusIntMatrix memory (1% dense): "
+       << dynamic_cast<SparseMinPlusIntMatrix*>(sparseMinPlus.get_ptr())->memoryUsage()
+       << " bytes, dense " << size * size * sizeof(MinPlusIntMatrix::value_type) << " bytes\n";
+
+  // The templates have no star of their own; SemElem::star iterates
+  // extend and combine, which takes far too long on dense matrices
+  cout << "BitMatrix star (1% dense): " << timeStar(bitSparse, reps) << " s\n";
+  cout << "MinPlusMatrix star: " << timeStar(dense1, reps) << " s\n";
+
+  return 0;
+}
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
@@ -20,6 +20,7 @@
 #include <sstream>
 #include <fstream>
 #include <ctime>
+#include <vector>
 // ::wali
 #include "wali/KeySpace.hpp"
 #include "wali/Key.hpp"
@@ -90,10 +91,13 @@ namespace{
       };
       typedef enum {READ_FIRST, READ_SECOND, COMPARE} Mode;
       typedef std::map< TransKey, wali::sem_elem_t > DataMap;
-      WFACompare(std::string f="FIRST", std::string s="SECOND") :  
+      // 'detensorSecond': whether the second automaton has tensored
+      // weights (as Newton's does) to be compared with untensored ones
+      WFACompare(std::string f="FIRST", std::string s="SECOND", bool detensorSecond=true) :  
         first(f), 
         second(s), 
-        cur(READ_FIRST)  
+        cur(READ_FIRST),
+        detensorSecond(detensorSecond)
       {}
       virtual void operator() (const ITrans* t)
       {
@@ -101,7 +105,10 @@ namespace{
           firstData[TransKey(t->from(),t->stack(),t->to())] = t->weight();
         else if(cur == READ_SECOND){
           wali::SemElemTensor * wt = dynamic_cast<SemElemTensor*>(t->weight().get_ptr());
-          secondData[TransKey(t->from(),t->stack(),t->to())] = wt;//->detensorTranspose();
+          if(detensorSecond)
+            secondData[TransKey(t->from(),t->stack(),t->to())] = wt->detensor();
+          else
+            secondData[TransKey(t->from(),t->stack(),t->to())] = wt;
         }
         else
           assert(false && "Not in any read mode right now");
@@ -215,6 +222,7 @@ namespace{
       string first;
       string second;
       Mode cur;
+      bool detensorSecond;
       DataMap firstData;
       DataMap secondData;
   };
@@ -364,6 +372,84 @@ namespace{
 #endif
   };
 
+  /// Newton poststar on the random program for 'seed', with initial
+  /// weights drawn from 'mwg' as in main. Returns the CPU seconds
+  /// poststar took.
+  double newtonPoststar(mywtgen_t mwg, int pdsSizeFactor, unsigned seed, WFA & outfa)
+  {
+    FWPDS npds;
+    npds.useNewton(true);
+    RandomPdsGen::Names names;
+    random_pdsgen_t rpt = new RandomPdsGen(mwg, pdsSizeFactor, 10 * pdsSizeFactor, pdsSizeFactor, 5 * pdsSizeFactor, 0,0.45,0.45,seed);
+    rpt->get(npds,names);
+    WFA fa;
+    wali::Key acc = wali::getKeySpace()->getKey("accept");
+    for(RandomPdsGen::Names::KeyVector::iterator iter =  names.entries.begin();
+        iter != names.entries.end();
+        ++iter
+       )
+      fa.addTrans(names.pdsState,*iter,acc,(*mwg)());
+    fa.setInitialState(names.pdsState);
+    fa.addFinalState(acc);
+    clock_t start = clock();
+    npds.poststar(fa,outfa);
+    return double(clock() - start) / CLOCKS_PER_SEC;
+  }
+
+  /// Runs Newton poststar on 'programs' random programs (seeds 'seed',
+  /// 'seed'+1, ...) once per detensor method, and reports the time each
+  /// method took in all. The memo is cleared before each run so that
+  /// every method does its own detensors. The results of each method are
+  /// checked against those of the first.
+  void compareDetensorMethods(program_bdd_context_t bmt, mywtgen_t mwg,
+      int pdsSizeFactor, unsigned seed, unsigned programs)
+  {
+    BddContext::DetensorMethod const methods[] = {
+      BddContext::DETENSOR_METHOD_TOGETHER,
+      BddContext::DETENSOR_METHOD_BIT_BY_BIT,
+      BddContext::DETENSOR_METHOD_RELPROD,
+      BddContext::DETENSOR_METHOD_BIT_BY_BIT_RELPROD
+    };
+    char const * const names[] = {"together", "bit-by-bit", "relprod", "bit-by-bit-relprod"};
+    unsigned const numMethods = sizeof(methods) / sizeof(methods[0]);
+    std::vector<double> seconds(numMethods, 0.0);
+    bool diffFound = false;
+
+    BddContext::DetensorMethod saved = bmt->getDetensorMethod();
+    for(unsigned p = 0; p < programs; ++p){
+      // Each run regenerates the keys, so the comparisons read the
+      // results as they come
+      std::vector<WFACompare> compares;
+      for(unsigned m = 1; m < numMethods; ++m)
+        compares.push_back(WFACompare(names[0], names[m], false));
+      for(unsigned m = 0; m < numMethods; ++m){
+        bmt->setDetensorMethod(methods[m]);
+        bmt->clearMemo();
+        WFA outfa;
+        seconds[m] += newtonPoststar(mwg, pdsSizeFactor, seed + p, outfa);
+        if(m == 0){
+          for(unsigned c = 0; c < compares.size(); ++c){
+            outfa.for_each(compares[c]);
+            compares[c].advance_mode();
+          }
+        }else{
+          WFACompare & compare = compares[m - 1];
+          outfa.for_each(compare);
+          compare.advance_mode();
+          if(compare.diff(&cout))
+            diffFound = true;
+        }
+      }
+    }
+    bmt->setDetensorMethod(saved);
+
+    cout << "[Detensor methods] " << programs << " programs" << endl;
+    for(unsigned m = 0; m < numMethods; ++m)
+      cout << "  " << names[m] << ": " << seconds[m] << " s" << endl;
+    if(diffFound)
+      cout << "DETENSOR DIFF FOUND!!!" << endl;
+  }
+
 }
 
 int main(int argc, char ** argv)
@@ -393,6 +479,12 @@ int main(int argc, char ** argv)
     s << argv[4];
     s >> seed;
   }
+  unsigned detensorPrograms = 0;
+  if(argc >= 6){
+    stringstream s;
+    s << argv[5];
+    s >> detensorPrograms;
+  }
 
   if(seed <= 0) 
     seed = (unsigned)time(NULL);
@@ -555,5 +647,8 @@ int main(int argc, char ** argv)
         pdsdiff << "PA DIFF FOUND!!!" << std::endl;
     }
   }
+
+  if(detensorPrograms > 0)
+    compareDetensorMethods(bmt, mwg, pdsSizeFactor, seed, detensorPrograms);
   return 0;
 }
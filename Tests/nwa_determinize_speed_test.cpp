@@ -0,0 +1,46 @@
+// Times construct::determinize on an NWA read from a file, for
+// comparing the macro-state containers that DETERMINIZE_RELATION_SET
+// selects in opennwa/construct/nwa_determinize.cpp. The inputs in
+// Tests/unit-tests/Performance/pcca-determinize are suitable (after
+// bunzip2).
+//
+//   nwa_determinize_speed_test file.nwa [repetitions]
+
+#include "opennwa/Nwa.hpp"
+#include "opennwa/NwaParser.hpp"
+#include "opennwa/construct/determinize.hpp"
+
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace opennwa;
+
+int main(int argc, char ** argv)
+{
+  if (argc < 2) {
+    cerr << "usage: " << argv[0] << " file.nwa [repetitions]\n";
+    return 1;
+  }
+  int reps = 2;
+  if (argc > 2) istringstream(argv[2]) >> reps;
+
+  ifstream in(argv[1]);
+  if (!in) {
+    cerr << "cannot open " << argv[1] << "\n";
+    return 1;
+  }
+  NwaRefPtr nwa = read_nwa(in);
+
+  for (int i = 0; i < reps; ++i) {
+    clock_t start = clock();
+    NwaRefPtr det = construct::determinize(*nwa);
+    double seconds = double(clock() - start) / CLOCKS_PER_SEC;
+
+    cout << nwa->sizeStates() << " -> " << det->sizeStates() << " states, "
+         << det->sizeTrans() << " transitions: " << seconds << " s\n";
+  }
+  return 0;
+}
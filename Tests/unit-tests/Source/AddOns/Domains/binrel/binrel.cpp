@@ -14,6 +14,10 @@
 
 #include <boost/static_assert.hpp>
 
+#if defined(BDD_THREAD_LOCAL) && !defined(_WIN32)
+#include <pthread.h>
+#endif
+
 // ::wali::domains::binrel
 #include "wali/domains/binrel/BinRel.hpp"
 #include "wali/domains/binrel/ProgramBddContext.hpp"
@@ -1392,6 +1396,255 @@ namespace{
     bdd b = p.Assume(p.From("a"), p.Const(0));
     ASSERT_NE(b, bddfalse);
   }
+
+
+  // The number of (pre, post) pairs of base valuations in 'b'. Unlike the
+  // bdd itself, this can be compared across contexts.
+  double countBasePairs(BddContext const & voc, bdd b)
+  {
+    bdd levels = bddtrue;
+    for (BddContext::const_iterator it = voc.begin(); it != voc.end(); ++it) {
+      levels &= fdd_ithset(it->second->baseLhs) & fdd_ithset(it->second->baseRhs);
+    }
+    return bdd_satcountset(b, levels);
+  }
+
+  std::vector<std::map<std::string, int> > twoGroupsOfVars()
+  {
+    std::vector<std::map<std::string, int> > vars(2);
+    vars[0]["a"] = 4;
+    vars[0]["b"] = 2;
+    vars[1]["c"] = 4;
+    vars[1]["d"] = 2;
+    return vars;
+  }
+
+  TEST(wali$domains$binrel$BddContext$$VarOrder, everyOrderGivesTheSameRelations)
+  {
+    BddContext::VarOrder const orders[] = {
+      BddContext::ORDER_TENSOR_MAX_AFFINITY,
+      BddContext::ORDER_TENSOR_MIN_AFFINITY,
+      BddContext::ORDER_BASE_MAX_AFFINITY_TENSOR_MIXED,
+      BddContext::ORDER_TENSOR_MATCHED_PAREN
+    };
+    std::vector<double> counts;
+
+    for (size_t i = 0; i < sizeof(orders) / sizeof(orders[0]); ++i) {
+      std::stringstream ss;
+      ss << "Order " << orders[i];
+      SCOPED_TRACE(ss.str());
+
+      program_bdd_context_t brm = new ProgramBddContext(twoGroupsOfVars(), 100000, 10000, orders[i]);
+      EXPECT_EQ(orders[i], brm->getVarOrder());
+
+      binrel_t r1 = new BinRel(brm.get_ptr(), brm->Assign("a", brm->Plus(brm->From("a"), brm->From("c"))));
+      binrel_t r2 = new BinRel(brm.get_ptr(), brm->Assume(brm->From("b"), brm->From("d")));
+      binrel_t r3 = new BinRel(brm.get_ptr(), brm->Assign("c", brm->From("a")));
+
+      binrel_t composed = r1->Compose(r2)->Compose(r3);
+      EXPECT_TRUE(r1->Kronecker(r2)->Eq23Project()->Equal(r1->Compose(r2)));
+      EXPECT_TRUE(r2->Kronecker(r3)->Eq23Project()->Equal(r2->Compose(r3)));
+
+      counts.push_back(countBasePairs(*brm, composed->getBdd()));
+      EXPECT_NE(0.0, counts.back());
+      EXPECT_EQ(counts[0], counts.back());
+    }
+  }
+
+  TEST(wali$domains$binrel$BddContext$$VarOrder, copiesKeepTheOrder)
+  {
+    ProgramBddContext p(100000, 10000, BddContext::ORDER_TENSOR_MIN_AFFINITY);
+    ProgramBddContext q(p);
+    EXPECT_EQ(BddContext::ORDER_TENSOR_MIN_AFFINITY, q.getVarOrder());
+
+    ProgramBddContext r;
+    r = p;
+    EXPECT_EQ(BddContext::ORDER_TENSOR_MIN_AFFINITY, r.getVarOrder());
+  }
+
+  TEST(wali$domains$binrel$BddContext$$reorder, relationsSurviveReordering)
+  {
+    program_bdd_context_t brm =
+      new ProgramBddContext(twoGroupsOfVars(), 100000, 10000, BddContext::ORDER_DEFAULT, true);
+    EXPECT_TRUE(BddContext::dynamicReorderingEnabled());
+
+    binrel_t r1 = new BinRel(brm.get_ptr(), brm->Assign("a", brm->Plus(brm->From("a"), brm->From("c"))));
+    binrel_t r2 = new BinRel(brm.get_ptr(), brm->Assume(brm->From("b"), brm->From("d")));
+    binrel_t before = r1->Compose(r2);
+    double count = countBasePairs(*brm, before->getBdd());
+
+    unsigned reorderings = BddContext::numReorderings();
+    EXPECT_LT(0, BddContext::reorder());
+    EXPECT_EQ(reorderings + 1, BddContext::numReorderings());
+
+    EXPECT_TRUE(r1->Compose(r2)->Equal(before));
+    EXPECT_TRUE(r1->Kronecker(r2)->Eq23Project()->Equal(before));
+    EXPECT_EQ(count, countBasePairs(*brm, before->getBdd()));
+
+    // With a tiny threshold, the next composition reorders
+    BddContext::enableDynamicReordering(BDD_REORDER_SIFT, 1);
+    binrel_t again = r2->Compose(r1);
+    EXPECT_EQ(reorderings + 2, BddContext::numReorderings());
+    EXPECT_TRUE(again->Equal(r2->Compose(r1)));
+
+    BddContext::disableDynamicReordering();
+    EXPECT_FALSE(BddContext::dynamicReorderingEnabled());
+    r1->Compose(r2);
+    EXPECT_EQ(reorderings + 2, BddContext::numReorderings());
+  }
+
+  TEST(wali$domains$binrel$BddContext$$memo, repeatedOperationsHitTheMemo)
+  {
+    program_bdd_context_t brm = new ProgramBddContext(twoGroupsOfVars(), 100000, 10000);
+    EXPECT_EQ(BddContext::defaultMemoSize, brm->getMemoSize());
+
+    binrel_t r1 = new BinRel(brm.get_ptr(), brm->Assign("a", brm->Plus(brm->From("a"), brm->From("c"))));
+    binrel_t r2 = new BinRel(brm.get_ptr(), brm->Assume(brm->From("b"), brm->From("d")));
+
+    binrel_t composed = r1->Compose(r2);
+    binrel_t unioned = r1->Union(r2);
+    binrel_t projected = r1->Kronecker(r2)->Eq23Project();
+    StatCount hits = brm->numMemoHits();
+    StatCount misses = brm->numMemoMisses();
+
+    EXPECT_TRUE(r1->Compose(r2)->Equal(composed));
+    EXPECT_TRUE(r2->Union(r1)->Equal(unioned));
+    EXPECT_TRUE(r1->Kronecker(r2)->Eq23Project()->Equal(projected));
+    EXPECT_EQ(hits + 4, brm->numMemoHits());
+    EXPECT_EQ(misses, brm->numMemoMisses());
+
+    // Without the memo, the results are the same and nothing is counted
+    brm->setMemoSize(0);
+    EXPECT_EQ(0u, brm->getMemoSize());
+    EXPECT_TRUE(r1->Compose(r2)->Equal(composed));
+    EXPECT_TRUE(r1->Kronecker(r2)->Eq23Project()->Equal(projected));
+    EXPECT_EQ(hits + 4, brm->numMemoHits());
+
+    brm->setMemoSize(100);
+    EXPECT_EQ(128u, brm->getMemoSize());
+  }
+
+  TEST(wali$domains$binrel$BddContext$$memo, memoOutlivesTheOperands)
+  {
+    program_bdd_context_t brm = new ProgramBddContext(twoGroupsOfVars(), 100000, 10000);
+    binrel_t r2 = new BinRel(brm.get_ptr(), brm->Assume(brm->From("b"), brm->From("d")));
+    double count;
+    {
+      binrel_t r1 = new BinRel(brm.get_ptr(), brm->Assign("a", brm->Plus(brm->From("a"), brm->From("c"))));
+      count = countBasePairs(*brm, r1->Compose(r2)->getBdd());
+    }
+    // Nodes that are only in the memo must not be collected (and reused
+    // under the ids the memo knows them by)
+    bdd_gbc();
+    binrel_t r3 = new BinRel(brm.get_ptr(), brm->Assign("c", brm->From("a")));
+    binrel_t r1 = new BinRel(brm.get_ptr(), brm->Assign("a", brm->Plus(brm->From("a"), brm->From("c"))));
+    EXPECT_EQ(count, countBasePairs(*brm, r1->Compose(r2)->getBdd()));
+    binrel_t memoized = r3->Compose(r2);
+    brm->setMemoSize(0);
+    EXPECT_TRUE(r3->Compose(r2)->Equal(memoized));
+  }
+
+  TEST(wali$domains$binrel$BddContext$$DetensorMethod, everyMethodGivesTheSameRelations)
+  {
+    BddContext::VarOrder const orders[] = {
+      BddContext::ORDER_TENSOR_MAX_AFFINITY,
+      BddContext::ORDER_TENSOR_MIN_AFFINITY,
+      BddContext::ORDER_BASE_MAX_AFFINITY_TENSOR_MIXED
+    };
+    BddContext::DetensorMethod const methods[] = {
+      BddContext::DETENSOR_METHOD_TOGETHER,
+      BddContext::DETENSOR_METHOD_BIT_BY_BIT,
+      BddContext::DETENSOR_METHOD_RELPROD,
+      BddContext::DETENSOR_METHOD_BIT_BY_BIT_RELPROD
+    };
+
+    for (size_t i = 0; i < sizeof(orders) / sizeof(orders[0]); ++i) {
+      program_bdd_context_t brm = new ProgramBddContext(twoGroupsOfVars(), 100000, 10000, orders[i]);
+      // Otherwise every method after the first would just hit the memo
+      brm->setMemoSize(0);
+
+      binrel_t r1 = new BinRel(brm.get_ptr(), brm->Assign("a", brm->Plus(brm->From("a"), brm->From("c"))));
+      binrel_t r2 = new BinRel(brm.get_ptr(), brm->Assume(brm->From("b"), brm->From("d")));
+      binrel_t tensored = r1->Kronecker(r2)->Union(r2->Kronecker(r1));
+      binrel_t composed = r1->Compose(r2)->Union(r2->Compose(r1));
+
+      for (size_t j = 0; j < sizeof(methods) / sizeof(methods[0]); ++j) {
+        std::stringstream ss;
+        ss << "Order " << orders[i] << ", method " << methods[j];
+        SCOPED_TRACE(ss.str());
+
+        brm->setDetensorMethod(methods[j]);
+        EXPECT_EQ(methods[j], brm->getDetensorMethod());
+        EXPECT_TRUE(tensored->Eq23Project()->Equal(composed));
+        EXPECT_TRUE(r1->Kronecker(r2)->Eq13Project()->Equal(r1->Transpose()->Compose(r2)));
+      }
+    }
+  }
+
+  TEST(wali$domains$binrel$BddContext$$DetensorMethod, defaultIsTheGlobalDefault)
+  {
+    BddContext::DetensorMethod saved = BddContext::globalDefaultDetensorMethod;
+    BddContext::globalDefaultDetensorMethod = BddContext::DETENSOR_METHOD_RELPROD;
+    program_bdd_context_t brm = new ProgramBddContext(twoGroupsOfVars(), 100000, 10000);
+    EXPECT_EQ(BddContext::DETENSOR_METHOD_RELPROD, brm->getDetensorMethod());
+
+    brm->setDetensorMethod(BddContext::DETENSOR_METHOD_BIT_BY_BIT);
+    ProgramBddContext copy(*brm);
+    EXPECT_EQ(BddContext::DETENSOR_METHOD_BIT_BY_BIT, copy.getDetensorMethod());
+
+    brm->setDetensorMethod(BddContext::DETENSOR_METHOD_DEFAULT);
+    EXPECT_EQ(BddContext::DETENSOR_METHOD_RELPROD, brm->getDetensorMethod());
+    BddContext::globalDefaultDetensorMethod = saved;
+  }
+
+
+#if defined(BDD_THREAD_LOCAL) && !defined(_WIN32)
+  /// Composes two relations over twoGroupsOfVars() many times in a
+  /// BddContext of its own, and counts the pairs in the result
+  double composeRepeatedly(int times)
+  {
+    program_bdd_context_t brm = new ProgramBddContext(twoGroupsOfVars(), 100000, 10000);
+    brm->setMemoSize(0);
+    binrel_t r1 = new BinRel(brm.get_ptr(), brm->Assign("a", brm->Plus(brm->From("a"), brm->From("c"))));
+    binrel_t r2 = new BinRel(brm.get_ptr(), brm->Assume(brm->From("b"), brm->From("d")));
+    binrel_t r = r1;
+    for (int i = 0; i < times; ++i) {
+      r = r->Compose(r2)->Union(r1);
+    }
+    return countBasePairs(*brm, r->getBdd());
+  }
+
+  void * composeInThread(void * result)
+  {
+    *static_cast<double*>(result) = composeRepeatedly(200);
+    return NULL;
+  }
+
+  TEST(wali$domains$binrel$BddContext$$threads, eachThreadHasItsOwnBuddy)
+  {
+    // This thread's BuDDy stays up while the others start and stop theirs
+    program_bdd_context_t mine = new ProgramBddContext(twoGroupsOfVars(), 100000, 10000);
+    binrel_t before = new BinRel(mine.get_ptr(), mine->Assign("b", mine->From("d")));
+    int nodes = bdd_getnodenum();
+
+    pthread_t threads[4];
+    double results[4];
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_EQ(0, pthread_create(&threads[i], NULL, &composeInThread, &results[i]));
+    }
+    for (int i = 0; i < 4; ++i) {
+      pthread_join(threads[i], NULL);
+    }
+    EXPECT_EQ(nodes, bdd_getnodenum());
+    EXPECT_TRUE(before->Equal(new BinRel(mine.get_ptr(), mine->Assign("b", mine->From("d")))));
+
+    double expected = composeRepeatedly(200);
+    EXPECT_NE(0.0, expected);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(expected, results[i]);
+    }
+  }
+#endif
 } //namespace
 
 
@@ -0,0 +1,235 @@
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "wali/Common.hpp"
+#include "wali/domains/genkill/BitVectorSet.hpp"
+#include "wali/domains/genkill/SortedContainerSetAdapter.hpp"
+#include "wali/domains/genkill/GenKillXformerTemplate.hpp"
+
+#include "fixtures/Random.hpp"
+
+using wali::domains::genkill::BitVectorSet;
+using wali::domains::genkill::SortedContainerSetAdapter;
+using testing::Lcg;
+using testing::randomElements;
+
+namespace {
+
+    typedef SortedContainerSetAdapter<std::set<size_t> > SortedSet;
+
+    typedef GenKillTransformer_T<BitVectorSet> BitGenKill;
+    typedef GenKillTransformer_T<SortedSet> SortedGenKill;
+
+    // Every test uses the same universe: the special transformers
+    // (one, bottom) hold on to sets made under the first one. Not a
+    // multiple of 64.
+    size_t const universe = 200;
+
+    void
+    setUniverse()
+    {
+        BitVectorSet::setUniverseSize(universe);
+        if (SortedSet::UniverseSet().empty()) {
+            for (size_t i = 0; i < universe; ++i) {
+                SortedSet::UniverseSet().insert(i);
+            }
+        }
+    }
+
+    std::vector<size_t>
+    elementsOf(BitVectorSet const & set)
+    {
+        std::vector<size_t> elements;
+        for (size_t i = 0; i < universe; ++i) {
+            if (set.contains(i)) {
+                elements.push_back(i);
+            }
+        }
+        return elements;
+    }
+
+    std::vector<size_t>
+    elementsOf(SortedSet const & set)
+    {
+        return std::vector<size_t>(set.begin(), set.end());
+    }
+
+    void
+    expectSame(wali::sem_elem_t bitWeight, wali::sem_elem_t sortedWeight)
+    {
+        BitGenKill * bits = dynamic_cast<BitGenKill*>(bitWeight.get_ptr());
+        SortedGenKill * sorted = dynamic_cast<SortedGenKill*>(sortedWeight.get_ptr());
+        ASSERT_TRUE(bits != NULL);
+        ASSERT_TRUE(sorted != NULL);
+
+        // (IsOne and IsBottom may not be asked of zero)
+        ASSERT_EQ(sorted->IsZero(), bits->IsZero());
+        if (!sorted->IsZero()) {
+            EXPECT_EQ(sorted->IsOne(), bits->IsOne());
+            EXPECT_EQ(sorted->IsBottom(), bits->IsBottom());
+            EXPECT_EQ(elementsOf(sorted->getKill()), elementsOf(bits->getKill()));
+            EXPECT_EQ(elementsOf(sorted->getGen()), elementsOf(bits->getGen()));
+        }
+    }
+
+}
+
+
+TEST(wali$domains$genkill$BitVectorSet, basics)
+{
+    setUniverse();
+    size_t elements[] = { 0, 63, 64, 199 };
+    BitVectorSet s(elements, elements + 4);
+
+    EXPECT_EQ(4u, s.size());
+    EXPECT_TRUE(s.contains(64));
+    EXPECT_FALSE(s.contains(65));
+
+    s.insert(65);
+    s.erase(0);
+    EXPECT_EQ(4u, s.size());
+    EXPECT_TRUE(s.contains(65));
+    EXPECT_FALSE(s.contains(0));
+
+    // Outside the universe, and past the last word
+    EXPECT_FALSE(s.contains(200));
+    EXPECT_FALSE(s.contains(1000));
+
+    std::stringstream ss;
+    s.print(ss);
+    EXPECT_EQ("{63, 64, 65, 199, }", ss.str());
+
+    EXPECT_EQ(universe, BitVectorSet::UniverseSet().size());
+    EXPECT_EQ(0u, BitVectorSet::EmptySet().size());
+    EXPECT_TRUE(BitVectorSet::Eq(BitVectorSet(), BitVectorSet::EmptySet()));
+}
+
+
+TEST(wali$domains$genkill$BitVectorSet, equalSetsShareStorage)
+{
+    setUniverse();
+    Lcg random(1);
+    std::vector<size_t> elements = randomElements(universe, 3, random);
+
+    // The smallest element not in the set (the elements are sorted)
+    size_t missing = 0;
+    while (missing < elements.size() && elements[missing] == missing) {
+        ++missing;
+    }
+
+    // Make the empty and universe sets first, so they don't count below
+    BitVectorSet::EmptySet();
+    BitVectorSet::UniverseSet();
+    size_t before = BitVectorSet::distinctSets();
+    {
+        BitVectorSet a(elements.begin(), elements.end());
+        EXPECT_EQ(before + 1, BitVectorSet::distinctSets());
+
+        BitVectorSet b(elements.begin(), elements.end());
+        BitVectorSet c = BitVectorSet::Union(a, BitVectorSet::EmptySet());
+        BitVectorSet d = BitVectorSet::Intersect(a, BitVectorSet::UniverseSet());
+        EXPECT_EQ(before + 1, BitVectorSet::distinctSets());
+        EXPECT_TRUE(BitVectorSet::Eq(a, b));
+        EXPECT_TRUE(BitVectorSet::Eq(a, c));
+        EXPECT_TRUE(BitVectorSet::Eq(a, d));
+        EXPECT_EQ(a.hash(), d.hash());
+
+        b.insert(missing);
+        EXPECT_FALSE(BitVectorSet::Eq(a, b));
+    }
+    EXPECT_EQ(before, BitVectorSet::distinctSets());
+}
+
+
+TEST(wali$domains$genkill$BitVectorSet, agreesWithSortedContainerSetAdapter)
+{
+    setUniverse();
+    unsigned const sparsities[] = { 1, 2, 10, 100 };
+    Lcg random(7);
+
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            std::vector<size_t>
+                x = randomElements(universe, sparsities[i], random),
+                y = randomElements(universe, sparsities[j], random);
+
+            BitVectorSet bx(x.begin(), x.end()), by(y.begin(), y.end());
+            SortedSet sx(std::set<size_t>(x.begin(), x.end())),
+                sy(std::set<size_t>(y.begin(), y.end()));
+
+            EXPECT_EQ(elementsOf(SortedSet::Union(sx, sy)),
+                      elementsOf(BitVectorSet::Union(bx, by)));
+            EXPECT_EQ(elementsOf(SortedSet::Intersect(sx, sy)),
+                      elementsOf(BitVectorSet::Intersect(bx, by)));
+            EXPECT_EQ(elementsOf(SortedSet::Diff(sx, sy)),
+                      elementsOf(BitVectorSet::Diff(bx, by)));
+            EXPECT_EQ(SortedSet::Eq(sx, sy), BitVectorSet::Eq(bx, by));
+        }
+    }
+}
+
+
+TEST(wali$domains$genkill$BitVectorSet, genKillTransformersAgreeWithSortedSets)
+{
+    setUniverse();
+    unsigned const sparsities[] = { 1, 3, 20 };
+    Lcg random(11);
+
+    std::vector<wali::sem_elem_t> bitWeights, sortedWeights;
+    bitWeights.push_back(BitGenKill::MkZero());
+    sortedWeights.push_back(SortedGenKill::MkZero());
+    bitWeights.push_back(BitGenKill::MkOne());
+    sortedWeights.push_back(SortedGenKill::MkOne());
+    bitWeights.push_back(BitGenKill::MkBottom());
+    sortedWeights.push_back(SortedGenKill::MkBottom());
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            std::vector<size_t>
+                kill = randomElements(universe, sparsities[i], random),
+                gen = randomElements(universe, sparsities[j], random);
+            bitWeights.push_back(BitGenKill::makeGenKillTransformer_T(
+                                     BitVectorSet(kill.begin(), kill.end()),
+                                     BitVectorSet(gen.begin(), gen.end())));
+            sortedWeights.push_back(SortedGenKill::makeGenKillTransformer_T(
+                                        std::set<size_t>(kill.begin(), kill.end()),
+                                        std::set<size_t>(gen.begin(), gen.end())));
+        }
+    }
+
+    for (size_t i = 0; i < bitWeights.size(); ++i) {
+        expectSame(bitWeights[i], sortedWeights[i]);
+        for (size_t j = 0; j < bitWeights.size(); ++j) {
+            expectSame(bitWeights[i]->extend(bitWeights[j]),
+                       sortedWeights[i]->extend(sortedWeights[j]));
+            expectSame(bitWeights[i]->combine(bitWeights[j]),
+                       sortedWeights[i]->combine(sortedWeights[j]));
+            expectSame(bitWeights[i]->diff(bitWeights[j]),
+                       sortedWeights[i]->diff(sortedWeights[j]));
+            EXPECT_EQ(sortedWeights[i]->equal(sortedWeights[j]),
+                      bitWeights[i]->equal(bitWeights[j]));
+        }
+    }
+}
+
+
+TEST(wali$domains$genkill$BitVectorSet, callWaliTestSemElemImpl)
+{
+    setUniverse();
+    size_t kill[] = { 1, 2, 150 };
+    size_t gen[] = { 3, 199 };
+    wali::sem_elem_t w = BitGenKill::makeGenKillTransformer_T(BitVectorSet(kill, kill + 3),
+                                                              BitVectorSet(gen, gen + 2));
+    wali::test_semelem_impl(w);
+}
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
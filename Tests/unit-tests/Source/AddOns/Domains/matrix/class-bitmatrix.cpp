@@ -0,0 +1,177 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <boost/scoped_ptr.hpp>
+
+#include "wali/domains/matrix/Matrix.hpp"
+#include "wali/domains/matrix/BitMatrix.hpp"
+
+#include "fixtures-boolmatrix.hpp"
+#include "fixtures-random-matrix.hpp"
+#include "matrix-equal.hpp"
+
+using namespace testing::boolmatrix;
+using testing::randomBoolMatrix;
+
+namespace wali {
+namespace domains {
+
+TEST(wali$domains$matrix$BitMatrix$$constructorAndMatrix, basicTest3x3)
+{
+    RandomMatrix1_3x3 f;
+    BitMatrix m(f.mat);
+
+    EXPECT_EQ(m.matrix(), f.mat);
+    EXPECT_EQ(5u, m.count());
+    EXPECT_TRUE(m.get(1, 2));
+    EXPECT_FALSE(m.get(2, 0));
+}
+
+
+#define NUM_ELEMENTS(arr) ((sizeof arr)/(sizeof arr[0]))
+
+TEST(wali$domains$matrix$BitMatrix$$equalAndIsZeroAndIsOne, battery)
+{
+    MatrixFixtures_3x3 f;
+    BitMatrix mats[] = {
+        BitMatrix(f.zero.mat),
+        BitMatrix(f.id.mat),
+        BitMatrix(f.r1.mat),
+        BitMatrix(f.r2.mat),
+        BitMatrix(f.ext_r1_r2.mat),
+        BitMatrix(f.ext_r2_r1.mat),
+    };
+
+    for (size_t left=0; left<NUM_ELEMENTS(mats); ++left) {
+        for (size_t right=0; right<NUM_ELEMENTS(mats); ++right) {
+            EXPECT_EQ(left == right,
+                      mats[left].equal(&mats[right]));
+        }
+    }
+
+    boost::scoped_ptr<BitMatrix>
+        zero(mats[2].zero_raw()),
+        one(mats[2].one_raw());
+    EXPECT_TRUE(mats[0].equal(zero.get()));
+    EXPECT_TRUE(mats[1].equal(one.get()));
+}
+
+
+TEST(wali$domains$matrix$BitMatrix$$extend_raw, twoRandomMatrices)
+{
+    RandomMatrix1_3x3 f1;
+    RandomMatrix2_3x3 f2;
+    ExtendR1R2_3x3 fr12;
+    ExtendR2R1_3x3 fr21;
+
+    BitMatrix m1(f1.mat);
+    BitMatrix m2(f2.mat);
+
+    boost::scoped_ptr<BitMatrix> result12(m1.extend_raw(&m2));
+    boost::scoped_ptr<BitMatrix> result21(m2.extend_raw(&m1));
+
+    EXPECT_EQ(fr12.mat, result12->matrix());
+    EXPECT_EQ(fr21.mat, result21->matrix());
+}
+
+
+TEST(wali$domains$matrix$BitMatrix$$extend_raw, agreesWithBoolMatrix)
+{
+    // Sizes that are not multiples of 64 (or of 8), sparse matrices
+    // (which OR rows) and dense ones (which use the Four Russians table)
+    size_t const sizes[][3] = {
+        {1, 1, 1}, {5, 70, 3}, {70, 130, 65}, {200, 200, 200}, {129, 257, 64},
+    };
+    unsigned const sparsities[] = { 1, 2, 3, 50 };
+
+    for (size_t s=0; s<NUM_ELEMENTS(sizes); ++s) {
+        for (size_t d=0; d<NUM_ELEMENTS(sparsities); ++d) {
+            unsigned seed = unsigned(10 * s + d);
+            BoolMatrix::BackingMatrix
+                a = randomBoolMatrix(sizes[s][0], sizes[s][1], sparsities[d], seed),
+                b = randomBoolMatrix(sizes[s][1], sizes[s][2], sparsities[d], seed + 1000);
+
+            BoolMatrix ba(a), bb(b);
+            BitMatrix ma(a), mb(b);
+
+            boost::scoped_ptr<BoolMatrix> expected(ba.extend_raw(&bb));
+            boost::scoped_ptr<BitMatrix> result(ma.extend_raw(&mb));
+
+            EXPECT_EQ(expected->matrix(), result->matrix())
+                << sizes[s][0] << "x" << sizes[s][1] << "x" << sizes[s][2]
+                << ", sparsity " << sparsities[d];
+        }
+    }
+}
+
+
+TEST(wali$domains$matrix$BitMatrix$$combine_raw, randomAndId)
+{
+    RandomMatrix1_3x3 f1;
+    IdBackingMatrix_3x3 f2;
+    CombineR1Id_3x3 fr;
+
+    BitMatrix m1(f1.mat);
+    BitMatrix m2(f2.mat);
+    BitMatrix mr(fr.mat);
+
+    boost::scoped_ptr<BitMatrix> result12(m1.combine_raw(&m2));
+    boost::scoped_ptr<BitMatrix> result21(m2.combine_raw(&m1));
+
+    EXPECT_EQ(fr.mat, result12->matrix());
+    EXPECT_EQ(fr.mat, result21->matrix());
+
+    EXPECT_TRUE(mr.equal(result12.get()));
+    EXPECT_TRUE(mr.equal(result21.get()));
+}
+
+
+TEST(wali$domains$matrix$BitMatrix$$star_raw, isTheReflexiveTransitiveClosure)
+{
+    unsigned const sparsities[] = { 2, 20, 100 };
+
+    for (size_t d=0; d<NUM_ELEMENTS(sparsities); ++d) {
+        BoolMatrix::BackingMatrix a = randomBoolMatrix(90, 90, sparsities[d], unsigned(d));
+
+        // closure = I + closure * a, iterated to a fixpoint
+        BoolMatrix ba(a);
+        sem_elem_t closure = ba.one();
+        while (true) {
+            sem_elem_t next = closure->extend(&ba)->combine(ba.one());
+            if (next->equal(closure)) {
+                break;
+            }
+            closure = next;
+        }
+
+        BitMatrix ma(a);
+        boost::scoped_ptr<BitMatrix> result(ma.star_raw());
+        BoolMatrix * expected = dynamic_cast<BoolMatrix*>(closure.get_ptr());
+        ASSERT_TRUE(expected != NULL);
+        EXPECT_EQ(expected->matrix(), result->matrix())
+            << "sparsity " << sparsities[d];
+    }
+}
+
+
+TEST(wali$domains$matrix$BitMatrix$$print, random)
+{
+    RandomMatrix1_3x3 f;
+    BitMatrix m(f.mat);
+    std::stringstream ss;
+
+    m.print(ss);
+
+    EXPECT_EQ("BitMatrix: [3,3]((1,1,0),(1,0,1),(0,0,1))", ss.str());
+}
+
+
+TEST(wali$domains$matrix$BitMatrix, callWaliTestSemElemImpl)
+{
+    RandomMatrix1_3x3 f;
+    sem_elem_t m = new BitMatrix(f.mat);
+    test_semelem_impl(m);
+}
+
+}
+}
@@ -0,0 +1,195 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <boost/scoped_ptr.hpp>
+
+#include "wali/domains/matrix/Matrix.hpp"
+#include "wali/domains/matrix/MinPlusMatrix.hpp"
+
+#include "fixtures-minplus-matrix.hpp"
+#include "fixtures-random-matrix.hpp"
+#include "matrix-equal.hpp"
+
+using namespace testing::minplus_matrix;
+using testing::randomMinPlusMatrix;
+
+namespace wali {
+namespace domains {
+
+TEST(wali$domains$matrix$MinPlusMatrix$$constructorAndMatrix, basicTest3x3)
+{
+    RandomMatrix1_3x3 f;
+    MinPlusMatrix m(f.mat);
+
+    EXPECT_EQ(m.matrix(), f.mat);
+    EXPECT_EQ(12, m.get(1, 0));
+    EXPECT_EQ(MinPlusMatrix::infinity(), m.get(0, 1));
+}
+
+
+#define NUM_ELEMENTS(arr) ((sizeof arr)/(sizeof arr[0]))
+
+TEST(wali$domains$matrix$MinPlusMatrix$$equalAndIsZeroAndIsOne, battery)
+{
+    MatrixFixtures_3x3 f;
+    MinPlusMatrix mats[] = {
+        MinPlusMatrix(f.zero.mat),
+        MinPlusMatrix(f.id.mat),
+        MinPlusMatrix(f.r1.mat),
+        MinPlusMatrix(f.r2.mat),
+        MinPlusMatrix(f.ext_r1_r2.mat),
+        MinPlusMatrix(f.ext_r2_r1.mat),
+    };
+
+    for (size_t left=0; left<NUM_ELEMENTS(mats); ++left) {
+        for (size_t right=0; right<NUM_ELEMENTS(mats); ++right) {
+            EXPECT_EQ(left == right,
+                      mats[left].equal(&mats[right]));
+        }
+    }
+
+    boost::scoped_ptr<MinPlusMatrix>
+        zero(mats[2].zero_raw()),
+        one(mats[2].one_raw());
+    EXPECT_TRUE(mats[0].equal(zero.get()));
+    EXPECT_TRUE(mats[1].equal(one.get()));
+}
+
+
+TEST(wali$domains$matrix$MinPlusMatrix$$extend_raw, twoRandomMatrices)
+{
+    RandomMatrix1_3x3 f1;
+    RandomMatrix2_3x3 f2;
+    ExtendR1R2_3x3 fr12;
+    ExtendR2R1_3x3 fr21;
+
+    MinPlusMatrix m1(f1.mat);
+    MinPlusMatrix m2(f2.mat);
+
+    boost::scoped_ptr<MinPlusMatrix> result12(m1.extend_raw(&m2));
+    boost::scoped_ptr<MinPlusMatrix> result21(m2.extend_raw(&m1));
+
+    EXPECT_EQ(fr12.mat, result12->matrix());
+    EXPECT_EQ(fr21.mat, result21->matrix());
+}
+
+
+TEST(wali$domains$matrix$MinPlusMatrix$$extend_raw, agreesWithMinPlusIntMatrix)
+{
+    // Includes sizes past extend's 128-row and 512-column blocks, and
+    // negative distances
+    size_t const sizes[][3] = {
+        {1, 1, 1}, {5, 17, 3}, {70, 130, 65}, {20, 300, 600},
+    };
+    unsigned const infinite[] = { 2, 5, 1000 };
+    int const lows[] = { 0, -50 };
+
+    for (size_t s=0; s<NUM_ELEMENTS(sizes); ++s) {
+        for (size_t d=0; d<NUM_ELEMENTS(infinite); ++d) {
+            for (size_t l=0; l<NUM_ELEMENTS(lows); ++l) {
+                unsigned seed = unsigned(100 * s + 10 * d + l);
+                MinPlusIntMatrix::BackingMatrix
+                    a = randomMinPlusMatrix(sizes[s][0], sizes[s][1], infinite[d] - 1, infinite[d], lows[l], seed),
+                    b = randomMinPlusMatrix(sizes[s][1], sizes[s][2], infinite[d] - 1, infinite[d], lows[l], seed + 1000);
+
+                MinPlusIntMatrix ta(a), tb(b);
+                MinPlusMatrix ma(a), mb(b);
+
+                boost::scoped_ptr<MinPlusIntMatrix> expected(ta.extend_raw(&tb));
+                boost::scoped_ptr<MinPlusMatrix> result(ma.extend_raw(&mb));
+
+                EXPECT_EQ(expected->matrix(), result->matrix())
+                    << sizes[s][0] << "x" << sizes[s][1] << "x" << sizes[s][2]
+                    << ", infinite " << infinite[d] << ", low " << lows[l];
+            }
+        }
+    }
+}
+
+
+TEST(wali$domains$matrix$MinPlusMatrix$$extend_raw, sumsSaturateAtInfinity)
+{
+    MinPlusMatrix a(1, 2), b(2, 1);
+    a.set(0, 0, inf - 5);
+    a.set(0, 1, -3);
+    b.set(0, 0, 10);
+
+    boost::scoped_ptr<MinPlusMatrix> result(a.extend_raw(&b));
+    EXPECT_EQ(inf, result->get(0, 0));
+
+    b.set(1, 0, 4);
+    result.reset(a.extend_raw(&b));
+    EXPECT_EQ(1, result->get(0, 0));
+}
+
+
+TEST(wali$domains$matrix$MinPlusMatrix$$combine_raw, isTheMinimum)
+{
+    RandomMatrix1_3x3 f1;
+    RandomMatrix2_3x3 f2;
+
+    MinPlusIntMatrix t1(f1.mat), t2(f2.mat);
+    MinPlusMatrix m1(f1.mat), m2(f2.mat);
+
+    boost::scoped_ptr<MinPlusIntMatrix> expected(t1.combine_raw(&t2));
+    boost::scoped_ptr<MinPlusMatrix> result12(m1.combine_raw(&m2));
+    boost::scoped_ptr<MinPlusMatrix> result21(m2.combine_raw(&m1));
+
+    EXPECT_EQ(expected->matrix(), result12->matrix());
+    EXPECT_TRUE(result12->equal(result21.get()));
+}
+
+
+TEST(wali$domains$matrix$MinPlusMatrix$$star_raw, isAllPairsShortestPaths)
+{
+    unsigned const infinite[] = { 2, 10, 50 };
+
+    for (size_t d=0; d<NUM_ELEMENTS(infinite); ++d) {
+        MinPlusIntMatrix::BackingMatrix a = randomMinPlusMatrix(60, 60, infinite[d] - 1, infinite[d], 1, unsigned(d));
+
+        // closure = 1 + closure * a, iterated to a fixpoint
+        MinPlusIntMatrix ta(a);
+        sem_elem_t closure = ta.one();
+        while (true) {
+            sem_elem_t next = closure->extend(&ta)->combine(ta.one());
+            if (next->equal(closure)) {
+                break;
+            }
+            closure = next;
+        }
+
+        MinPlusMatrix ma(a);
+        boost::scoped_ptr<MinPlusMatrix> result(ma.star_raw());
+        MinPlusIntMatrix * expected = dynamic_cast<MinPlusIntMatrix*>(closure.get_ptr());
+        ASSERT_TRUE(expected != NULL);
+        EXPECT_EQ(expected->matrix(), result->matrix())
+            << "infinite " << infinite[d];
+    }
+}
+
+
+TEST(wali$domains$matrix$MinPlusMatrix$$print, random)
+{
+    RandomMatrix1_3x3 f;
+    MinPlusMatrix m(f.mat);
+    std::stringstream ss;
+
+    m.print(ss);
+
+    EXPECT_EQ("MinPlusMatrix: [3,3]"
+              "(([1],[infinity],[infinity]),"
+              "([12],[0],[1]),"
+              "([infinity],[infinity],[17]))",
+              ss.str());
+}
+
+
+TEST(wali$domains$matrix$MinPlusMatrix, callWaliTestSemElemImpl)
+{
+    RandomMatrix1_3x3 f;
+    sem_elem_t m = new MinPlusMatrix(f.mat);
+    test_semelem_impl(m);
+}
+
+}
+}
@@ -0,0 +1,248 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <boost/scoped_ptr.hpp>
+
+#include "wali/domains/matrix/Matrix.hpp"
+#include "wali/domains/matrix/SparseMatrix.hpp"
+
+#include "fixtures-boolmatrix.hpp"
+#include "fixtures-random-matrix.hpp"
+#include "matrix-equal.hpp"
+
+using namespace testing::boolmatrix;
+using testing::randomBoolMatrix;
+using testing::randomMinPlusMatrix;
+
+namespace {
+
+    using wali::domains::MinPlusIntMatrix;
+
+    /// Sets SparseMatrix<T>::denseThreshold for the life of the object
+    template<typename T>
+    struct ThresholdFixture
+    {
+        double saved;
+
+        ThresholdFixture(double threshold)
+            : saved(T::denseThreshold)
+        {
+            T::denseThreshold = threshold;
+        }
+
+        ~ThresholdFixture()
+        {
+            T::denseThreshold = saved;
+        }
+    };
+
+    /// closure = 1 + closure * m, iterated to a fixpoint
+    wali::sem_elem_t
+    iteratedClosure(wali::sem_elem_t m)
+    {
+        wali::sem_elem_t closure = m->one();
+        while (true) {
+            wali::sem_elem_t next = closure->extend(m)->combine(m->one());
+            if (next->equal(closure)) {
+                return closure;
+            }
+            closure = next;
+        }
+    }
+
+    // Always sparse, the default, and always dense
+    double const thresholds[] = { 1.0, 0.1, 0.0 };
+
+}
+
+namespace wali {
+namespace domains {
+
+#define NUM_ELEMENTS(arr) ((sizeof arr)/(sizeof arr[0]))
+
+TEST(wali$domains$matrix$SparseMatrix$$constructorAndMatrix, basicTest3x3)
+{
+    RandomMatrix1_3x3 f;
+    SparseBoolMatrix m(f.mat);
+
+    EXPECT_EQ(m.matrix(), f.mat);
+    EXPECT_EQ(5u, m.nonZeros());
+    EXPECT_TRUE(m.get(1, 2));
+    EXPECT_FALSE(m.get(2, 0));
+
+    ThresholdFixture<SparseBoolMatrix> alwaysSparse(1.0);
+    SparseBoolMatrix s(f.mat);
+    EXPECT_FALSE(s.isDense());
+    EXPECT_EQ(s.matrix(), f.mat);
+    EXPECT_TRUE(s.get(1, 2));
+    EXPECT_FALSE(s.get(2, 0));
+}
+
+
+TEST(wali$domains$matrix$SparseMatrix$$settle, switchesFormByDensity)
+{
+    BoolMatrix::BackingMatrix
+        sparse = randomBoolMatrix(200, 200, 100, 1),
+        dense = randomBoolMatrix(200, 200, 2, 2);
+
+    SparseBoolMatrix s(sparse), d(dense);
+    EXPECT_FALSE(s.isDense());
+    EXPECT_TRUE(d.isDense());
+    EXPECT_LT(s.memoryUsage() * 5, d.memoryUsage());
+
+    boost::scoped_ptr<SparseBoolMatrix> sum(s.combine_raw(&d));
+    EXPECT_TRUE(sum->isDense());
+
+    boost::scoped_ptr<SparseBoolMatrix> zero(d.zero_raw());
+    EXPECT_FALSE(zero->isDense());
+    EXPECT_EQ(0u, zero->nonZeros());
+}
+
+
+TEST(wali$domains$matrix$SparseMatrix$$equalAndIsZeroAndIsOne, battery)
+{
+    for (size_t t=0; t<NUM_ELEMENTS(thresholds); ++t) {
+        ThresholdFixture<SparseBoolMatrix> threshold(thresholds[t]);
+        MatrixFixtures_3x3 f;
+        SparseBoolMatrix mats[] = {
+            SparseBoolMatrix(f.zero.mat),
+            SparseBoolMatrix(f.id.mat),
+            SparseBoolMatrix(f.r1.mat),
+            SparseBoolMatrix(f.r2.mat),
+            SparseBoolMatrix(f.ext_r1_r2.mat),
+            SparseBoolMatrix(f.ext_r2_r1.mat),
+        };
+
+        for (size_t left=0; left<NUM_ELEMENTS(mats); ++left) {
+            for (size_t right=0; right<NUM_ELEMENTS(mats); ++right) {
+                EXPECT_EQ(left == right,
+                          mats[left].equal(&mats[right]));
+            }
+        }
+
+        boost::scoped_ptr<SparseBoolMatrix>
+            zero(mats[2].zero_raw()),
+            one(mats[2].one_raw());
+        EXPECT_TRUE(mats[0].equal(zero.get()));
+        EXPECT_TRUE(mats[1].equal(one.get()));
+    }
+}
+
+
+TEST(wali$domains$matrix$SparseMatrix$$extend_raw, agreesWithBoolMatrix)
+{
+    size_t const sizes[][3] = { {1, 1, 1}, {5, 17, 3}, {70, 130, 65} };
+    unsigned const sparsities[] = { 2, 20, 200 };
+
+    for (size_t t=0; t<NUM_ELEMENTS(thresholds); ++t) {
+        ThresholdFixture<SparseBoolMatrix> threshold(thresholds[t]);
+        for (size_t s=0; s<NUM_ELEMENTS(sizes); ++s) {
+            for (size_t d=0; d<NUM_ELEMENTS(sparsities); ++d) {
+                unsigned seed = unsigned(10 * s + d);
+                BoolMatrix::BackingMatrix
+                    a = randomBoolMatrix(sizes[s][0], sizes[s][1], sparsities[d], seed),
+                    b = randomBoolMatrix(sizes[s][1], sizes[s][2], sparsities[d], seed + 1000);
+
+                BoolMatrix ba(a), bb(b);
+                SparseBoolMatrix sa(a), sb(b);
+
+                boost::scoped_ptr<BoolMatrix>
+                    expectedExtend(ba.extend_raw(&bb));
+                boost::scoped_ptr<SparseBoolMatrix>
+                    extend(sa.extend_raw(&sb));
+
+                EXPECT_EQ(expectedExtend->matrix(), extend->matrix())
+                    << "threshold " << thresholds[t] << ", "
+                    << sizes[s][0] << "x" << sizes[s][1] << "x" << sizes[s][2]
+                    << ", sparsity " << sparsities[d];
+
+                BoolMatrix::BackingMatrix c = randomBoolMatrix(sizes[s][0], sizes[s][1], sparsities[d], seed + 2000);
+                BoolMatrix bc(c);
+                SparseBoolMatrix sc(c);
+                boost::scoped_ptr<BoolMatrix> expectedCombine(ba.combine_raw(&bc));
+                boost::scoped_ptr<SparseBoolMatrix> combine(sa.combine_raw(&sc));
+
+                EXPECT_EQ(expectedCombine->matrix(), combine->matrix())
+                    << "threshold " << thresholds[t] << ", "
+                    << sizes[s][0] << "x" << sizes[s][1]
+                    << ", sparsity " << sparsities[d];
+            }
+        }
+    }
+}
+
+
+TEST(wali$domains$matrix$SparseMatrix$$extend_raw, agreesWithMinPlusIntMatrix)
+{
+    unsigned const sparsities[] = { 2, 20, 200 };
+
+    for (size_t t=0; t<NUM_ELEMENTS(thresholds); ++t) {
+        ThresholdFixture<SparseMinPlusIntMatrix> threshold(thresholds[t]);
+        for (size_t d=0; d<NUM_ELEMENTS(sparsities); ++d) {
+            MinPlusIntMatrix::BackingMatrix
+                a = randomMinPlusMatrix(40, 70, 1, sparsities[d], 1, unsigned(d)),
+                b = randomMinPlusMatrix(70, 30, 1, sparsities[d], 1, unsigned(d + 100));
+
+            MinPlusIntMatrix ma(a), mb(b);
+            SparseMinPlusIntMatrix sa(a), sb(b);
+
+            boost::scoped_ptr<MinPlusIntMatrix> expected(ma.extend_raw(&mb));
+            boost::scoped_ptr<SparseMinPlusIntMatrix> result(sa.extend_raw(&sb));
+
+            EXPECT_EQ(expected->matrix(), result->matrix())
+                << "threshold " << thresholds[t] << ", sparsity " << sparsities[d];
+        }
+    }
+}
+
+
+TEST(wali$domains$matrix$SparseMatrix$$star_raw, isTheIteratedClosure)
+{
+    unsigned const sparsities[] = { 5, 30, 100 };
+
+    for (size_t d=0; d<NUM_ELEMENTS(sparsities); ++d) {
+        BoolMatrix::BackingMatrix b = randomBoolMatrix(60, 60, sparsities[d], unsigned(d));
+        MinPlusIntMatrix::BackingMatrix m = randomMinPlusMatrix(60, 60, 1, sparsities[d], 1, unsigned(d));
+
+        sem_elem_t expectedBool = iteratedClosure(new BoolMatrix(b));
+        sem_elem_t expectedMinPlus = iteratedClosure(new MinPlusIntMatrix(m));
+
+        SparseBoolMatrix sb(b);
+        SparseMinPlusIntMatrix sm(m);
+        boost::scoped_ptr<SparseBoolMatrix> starBool(sb.star_raw());
+        boost::scoped_ptr<SparseMinPlusIntMatrix> starMinPlus(sm.star_raw());
+
+        EXPECT_EQ(dynamic_cast<BoolMatrix*>(expectedBool.get_ptr())->matrix(),
+                  starBool->matrix())
+            << "sparsity " << sparsities[d];
+        EXPECT_EQ(dynamic_cast<MinPlusIntMatrix*>(expectedMinPlus.get_ptr())->matrix(),
+                  starMinPlus->matrix())
+            << "sparsity " << sparsities[d];
+    }
+}
+
+
+TEST(wali$domains$matrix$SparseMatrix$$print, random)
+{
+    RandomMatrix1_3x3 f;
+    SparseBoolMatrix m(f.mat);
+    std::stringstream ss;
+
+    m.print(ss);
+
+    EXPECT_EQ("SparseMatrix: [3,3]((1,1,0),(1,0,1),(0,0,1))", ss.str());
+}
+
+
+TEST(wali$domains$matrix$SparseMatrix, callWaliTestSemElemImpl)
+{
+    for (size_t t=0; t<NUM_ELEMENTS(thresholds); ++t) {
+        ThresholdFixture<SparseBoolMatrix> threshold(thresholds[t]);
+        RandomMatrix1_3x3 f;
+        sem_elem_t m = new SparseBoolMatrix(f.mat);
+        test_semelem_impl(m);
+    }
+}
+
+}
+}
@@ -0,0 +1,50 @@
+#ifndef ADDONS_DOMAINS_MATRIX_RANDOM_FIXTURES_HPP
+#define ADDONS_DOMAINS_MATRIX_RANDOM_FIXTURES_HPP
+
+#include "wali/domains/matrix/Matrix.hpp"
+
+#include "fixtures/Random.hpp"
+
+namespace testing
+{
+
+/// A rows x cols matrix where each entry is true with probability
+/// about 1/sparsity. Deterministic in 'seed'.
+inline
+wali::domains::BoolMatrix::BackingMatrix
+randomBoolMatrix(size_t rows, size_t cols, unsigned sparsity, unsigned long seed)
+{
+    wali::domains::BoolMatrix::BackingMatrix mat(rows, cols);
+    Lcg random(seed);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            mat(i, j) = random.oneIn(sparsity);
+        }
+    }
+    return mat;
+}
+
+/// A rows x cols matrix where each entry is finite, in [low, low +
+/// 100), with probability about finite/outOf, and infinity otherwise.
+/// Deterministic in 'seed'.
+inline
+wali::domains::MinPlusIntMatrix::BackingMatrix
+randomMinPlusMatrix(size_t rows, size_t cols, unsigned finite, unsigned outOf,
+                    int low, unsigned long seed)
+{
+    wali::domains::MinPlusIntMatrix::BackingMatrix mat(rows, cols);
+    Lcg random(seed);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            int value = low + int(random.next(100));
+            if (random.next(outOf) < finite) {
+                mat(i, j).set_value(value);
+            }
+        }
+    }
+    return mat;
+}
+
+}
+
+#endif /* ADDONS_DOMAINS_MATRIX_RANDOM_FIXTURES_HPP */
@@ -0,0 +1,55 @@
+#ifndef WALI_TESTING_RANDOM_HPP
+#define WALI_TESTING_RANDOM_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace testing
+{
+  /// A small deterministic generator (the usual linear congruential
+  /// one), so that the randomized tests are repeatable
+  class Lcg
+  {
+  public:
+    explicit Lcg(unsigned long seed) : state(seed) {}
+
+    /// A number in [0, bound)
+    unsigned next(unsigned bound) {
+      state = (state * 1103515245ul + 12345ul) & 0x7ffffffful;
+      return static_cast<unsigned>((state >> 8) % bound);
+    }
+
+    /// True about one time in 'n'
+    bool oneIn(unsigned n) {
+      return next(n) == 0;
+    }
+
+  private:
+    unsigned long state;
+  };
+
+
+  /// The numbers in [0, universe) picked with probability about
+  /// 1/sparsity each, in increasing order
+  inline
+  std::vector<size_t>
+  randomElements(size_t universe, unsigned sparsity, Lcg & random)
+  {
+    std::vector<size_t> elements;
+    for (size_t i = 0; i < universe; ++i) {
+      if (random.oneIn(sparsity)) {
+        elements.push_back(i);
+      }
+    }
+    return elements;
+  }
+}
+
+// Yo emacs!
+// Local Variables:
+//     c-file-style: "ellemtel"
+//     c-basic-offset: 2
+//     indent-tabs-mode: nil
+// End:
+
+#endif
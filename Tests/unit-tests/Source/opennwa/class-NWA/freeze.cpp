@@ -0,0 +1,177 @@
+#include "gtest/gtest.h"
+
+#include "opennwa/Nwa.hpp"
+#include "opennwa/query/language.hpp"
+
+#include "Tests/unit-tests/Source/opennwa/fixtures.hpp"
+
+#include <sstream>
+
+namespace opennwa
+{
+        namespace {
+
+            typedef details::TransitionStorage Trans;
+
+            /// Asks both storages every per-state question about every
+            /// state of 'nwa' (and one state it does not have)
+            void
+            expect_same_answers(Nwa const & nwa, Trans const & frozen, Trans const & thawed)
+            {
+                std::vector<State> states(nwa.beginStates(), nwa.endStates());
+                states.push_back(getKey("freeze-not-a-state"));
+
+                std::vector<Symbol> symbols(nwa.beginSymbols(), nwa.endSymbols());
+                symbols.push_back(WILD);
+                symbols.push_back(EPSILON);
+
+                for (size_t i = 0; i < states.size(); ++i) {
+                    State q = states[i];
+
+                    EXPECT_EQ(thawed.isFrom(q), frozen.isFrom(q));
+                    EXPECT_EQ(thawed.isTo(q), frozen.isTo(q));
+                    EXPECT_EQ(thawed.isCall(q), frozen.isCall(q));
+                    EXPECT_EQ(thawed.isEntry(q), frozen.isEntry(q));
+                    EXPECT_EQ(thawed.isExit(q), frozen.isExit(q));
+                    EXPECT_EQ(thawed.isPred(q), frozen.isPred(q));
+                    EXPECT_EQ(thawed.isRet(q), frozen.isRet(q));
+
+                    EXPECT_EQ(thawed.getTargets(q), frozen.getTargets(q));
+                    EXPECT_EQ(thawed.getEntries(q), frozen.getEntries(q));
+                    EXPECT_EQ(thawed.getReturnSites(q), frozen.getReturnSites(q));
+                    EXPECT_EQ(thawed.getInternalsFrom(q), frozen.getInternalsFrom(q));
+
+                    for (size_t j = 0; j < symbols.size(); ++j) {
+                        Symbol a = symbols[j];
+                        EXPECT_EQ(thawed.callExists(q, a), frozen.callExists(q, a));
+                        EXPECT_EQ(thawed.internalExists(q, a), frozen.internalExists(q, a));
+                        EXPECT_EQ(thawed.getCalls(q, a), frozen.getCalls(q, a));
+                        EXPECT_EQ(thawed.getInternals(q, a), frozen.getInternals(q, a));
+                        EXPECT_EQ(thawed.getReturns(q, a), frozen.getReturns(q, a));
+                    }
+
+                    for (size_t k = 0; k < states.size(); ++k) {
+                        State p = states[k];
+                        Symbol thawed_sym = EPSILON, frozen_sym = EPSILON;
+                        EXPECT_EQ(thawed.getSymbol(q, p, thawed_sym), frozen.getSymbol(q, p, frozen_sym));
+                        EXPECT_EQ(thawed_sym, frozen_sym);
+                        EXPECT_EQ(thawed.getReturnSites(q, p), frozen.getReturnSites(q, p));
+                        EXPECT_EQ(thawed.getCallSites(q, p), frozen.getCallSites(q, p));
+                        for (size_t j = 0; j < symbols.size(); ++j) {
+                            Symbol a = symbols[j];
+                            EXPECT_EQ(thawed.findTrans(q, a, p), frozen.findTrans(q, a, p));
+                            EXPECT_EQ(thawed.returnExists(q, p, a), frozen.returnExists(q, p, a));
+                            EXPECT_EQ(thawed.isInternal(q, a, p), frozen.isInternal(q, a, p));
+                            EXPECT_EQ(thawed.isCall(q, a, p), frozen.isCall(q, a, p));
+                        }
+                    }
+                }
+
+                for (Trans::ReturnIterator r = thawed.beginReturn(); r != thawed.endReturn(); ++r) {
+                    EXPECT_TRUE(frozen.isReturn(*r));
+                    Trans::Return other(r->first, r->second, r->third, r->first);
+                    EXPECT_EQ(thawed.isReturn(other), frozen.isReturn(other));
+                }
+            }
+
+        }
+
+
+        TEST(opennwa$Nwa$$freeze, frozenLookupsAgreeWithMaps)
+        {
+            OddNumEvenGroupsNwa fixture;
+            RandomNwas random(2011);
+
+            for (int round = 0; round < 20; ++round) {
+                std::stringstream ss;
+                ss << "Round " << round;
+                SCOPED_TRACE(ss.str());
+
+                Nwa nwa = round == 0 ? fixture.nwa : random.next("freeze");
+                Nwa frozen = nwa;
+                frozen.freeze();
+                ASSERT_TRUE(frozen.isFrozen());
+                ASSERT_FALSE(nwa.isFrozen());
+
+                expect_same_answers(nwa,
+                                    frozen._private_get_transition_storage_(),
+                                    nwa._private_get_transition_storage_());
+                EXPECT_TRUE(frozen.isFrozen());
+                EXPECT_TRUE(nwa == frozen);
+            }
+        }
+
+        TEST(opennwa$Nwa$$freeze, mapAccessorsStillWorkWhenFrozen)
+        {
+            OddNumEvenGroupsNwa fixture;
+            Nwa frozen = fixture.nwa;
+            frozen.freeze();
+
+            Trans const & expected = fixture.nwa._private_get_transition_storage_();
+            Trans const & actual = frozen._private_get_transition_storage_();
+            for (Nwa::StateIterator q = fixture.nwa.beginStates(); q != fixture.nwa.endStates(); ++q) {
+                EXPECT_EQ(expected.getTransFrom(*q), actual.getTransFrom(*q));
+                EXPECT_EQ(expected.getTransTo(*q), actual.getTransTo(*q));
+                EXPECT_EQ(expected.getTransCall(*q), actual.getTransCall(*q));
+                EXPECT_EQ(expected.getTransEntry(*q), actual.getTransEntry(*q));
+                EXPECT_EQ(expected.getTransExit(*q), actual.getTransExit(*q));
+                EXPECT_EQ(expected.getTransPred(*q), actual.getTransPred(*q));
+                EXPECT_EQ(expected.getTransRet(*q), actual.getTransRet(*q));
+            }
+            EXPECT_TRUE(frozen.isFrozen());
+        }
+
+        TEST(opennwa$Nwa$$freeze, changesThaw)
+        {
+            OddNumEvenGroupsNwa fixture;
+            Nwa nwa = fixture.nwa;
+
+            nwa.freeze();
+            EXPECT_TRUE(nwa.addInternalTrans(fixture.q3, fixture.zero, fixture.q0));
+            EXPECT_FALSE(nwa.isFrozen());
+            EXPECT_TRUE(nwa._private_get_transition_storage_().isInternal(fixture.q3, fixture.zero, fixture.q0));
+
+            nwa.freeze();
+            EXPECT_TRUE(nwa._private_get_transition_storage_().isInternal(fixture.q3, fixture.zero, fixture.q0));
+            EXPECT_TRUE(nwa.removeInternalTrans(fixture.q3, fixture.zero, fixture.q0));
+            EXPECT_FALSE(nwa.isFrozen());
+            EXPECT_TRUE(nwa == fixture.nwa);
+
+            nwa.freeze();
+            nwa.removeState(fixture.q3);
+            EXPECT_FALSE(nwa.isFrozen());
+            EXPECT_FALSE(nwa.isState(fixture.q3));
+
+            Nwa copy = nwa;
+            copy.freeze();
+            Nwa assigned;
+            assigned = copy;
+            EXPECT_TRUE(assigned.isFrozen());
+            EXPECT_TRUE(assigned == nwa);
+
+            copy.thaw();
+            EXPECT_FALSE(copy.isFrozen());
+            EXPECT_TRUE(copy == nwa);
+
+            copy.freeze();
+            copy.clear();
+            EXPECT_FALSE(copy.isFrozen());
+            EXPECT_EQ(0u, copy.sizeTrans());
+        }
+
+        TEST(opennwa$Nwa$$freeze, frozenNwaAcceptsTheSameWords)
+        {
+            RandomNwas random(77);
+            for (int round = 0; round < 20; ++round) {
+                Nwa nwa = random.next("freeze-lang");
+                Nwa frozen = nwa;
+                frozen.freeze();
+
+                NestedWordRefPtr witness;
+                EXPECT_EQ(query::languageIsEmpty(nwa), query::languageIsEmpty(frozen));
+                if (!query::languageIsEmpty(nwa, witness)) {
+                    EXPECT_EQ(nwa.isMemberNondet(*witness), frozen.isMemberNondet(*witness));
+                }
+            }
+        }
+}
@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+
+#include "opennwa/Nwa.hpp"
+#include "opennwa/details/RelationTable.hpp"
+
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace opennwa
+{
+        namespace {
+
+            typedef wali::relations::RelationTypedefs<State>::BinaryRelation BinaryRelation;
+            typedef wali::relations::RelationHash<State> RelationHash;
+            typedef details::RelationTable<BinaryRelation, RelationHash> Table;
+
+            /// The relation { (i, i+1), ..., (i, i+width) } -- many of
+            /// these have the same size, which the old size-only hash
+            /// could not tell apart
+            BinaryRelation
+            relation(State i, State width)
+            {
+                BinaryRelation r;
+                for (State j = 1; j <= width; ++j) {
+                    r.insert(std::make_pair(i, i + j));
+                }
+                return r;
+            }
+
+        }
+
+
+        TEST(opennwa$details$RelationTable$$RelationHash, doesNotDependOnInsertionOrder)
+        {
+            BinaryRelation forward, backward;
+            for (State i = 0; i < 20; ++i) {
+                forward.insert(std::make_pair(i, 2 * i));
+                backward.insert(std::make_pair(19 - i, 2 * (19 - i)));
+            }
+            RelationHash hash;
+            EXPECT_EQ(hash(forward), hash(backward));
+        }
+
+        TEST(opennwa$details$RelationTable$$RelationHash, isARunningXorOfPairHashes)
+        {
+            RelationHash hash;
+            BinaryRelation r = relation(3, 5);
+            size_t running = hash(r);
+
+            std::pair<State, State> extra(100, 200);
+            r.insert(extra);
+            running ^= RelationHash::pairHash(extra);
+            EXPECT_EQ(hash(r), running);
+
+            r.erase(std::make_pair(State(3), State(4)));
+            running ^= RelationHash::pairHash(std::make_pair(State(3), State(4)));
+            EXPECT_EQ(hash(r), running);
+        }
+
+        TEST(opennwa$details$RelationTable$$RelationHash, separatesSwappedPairs)
+        {
+            RelationHash hash;
+            BinaryRelation ab, ba;
+            ab.insert(std::make_pair(State(1), State(2)));
+            ba.insert(std::make_pair(State(2), State(1)));
+            EXPECT_NE(hash(ab), hash(ba));
+        }
+
+        TEST(opennwa$details$RelationTable$$RelationHash, separatesRelationsOfEqualSize)
+        {
+            RelationHash hash;
+            std::set<size_t> hashes;
+            for (State i = 0; i < 200; ++i) {
+                hashes.insert(hash(relation(i, 4)));
+            }
+            EXPECT_EQ(200u, hashes.size());
+        }
+
+
+        TEST(opennwa$details$RelationTable, numbersRelationsInOrderAdded)
+        {
+            Table table;
+            EXPECT_TRUE(table.empty());
+
+            // Enough to make the table grow a few times
+            for (State i = 0; i < 100; ++i) {
+                std::pair<Table::Id, bool> added = table.insert(relation(i, 1 + i % 7));
+                EXPECT_TRUE(added.second);
+                EXPECT_EQ(i, added.first);
+            }
+            EXPECT_EQ(100u, table.size());
+
+            for (State i = 0; i < 100; ++i) {
+                std::stringstream ss;
+                ss << "Relation " << i;
+                SCOPED_TRACE(ss.str());
+
+                BinaryRelation r = relation(i, 1 + i % 7);
+                EXPECT_EQ(i, table.find(r));
+                EXPECT_TRUE(table[i] == r);
+
+                std::pair<Table::Id, bool> again = table.insert(r);
+                EXPECT_FALSE(again.second);
+                EXPECT_EQ(i, again.first);
+            }
+            EXPECT_EQ(100u, table.size());
+        }
+
+        TEST(opennwa$details$RelationTable, findsNothingForAbsentRelations)
+        {
+            Table table;
+            EXPECT_EQ(Table::none(), table.find(BinaryRelation()));
+
+            table.insert(BinaryRelation());
+            table.insert(relation(1, 2));
+            EXPECT_EQ(0u, table.find(BinaryRelation()));
+            EXPECT_EQ(Table::none(), table.find(relation(1, 3)));
+            EXPECT_EQ(Table::none(), table.find(relation(2, 2)));
+        }
+
+        TEST(opennwa$details$RelationTable, referencesSurviveGrowth)
+        {
+            Table table;
+            table.insert(relation(0, 3));
+            BinaryRelation const & first = table[0];
+            for (State i = 1; i < 200; ++i) {
+                table.insert(relation(i, 3));
+            }
+            EXPECT_TRUE(first == relation(0, 3));
+        }
+}
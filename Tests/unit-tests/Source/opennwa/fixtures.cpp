@@ -135,5 +135,60 @@ namespace opennwa
             a->addCallTrans(q2, WILD, dummy);
             a->addReturnTrans(q2, q1, WILD, dummy);
         }
-      
+
+
+        unsigned
+        RandomNwas::nextInt(unsigned bound)
+        {
+            return random.next(bound);
+        }
+
+        Nwa
+        RandomNwas::next(std::string const & prefix)
+        {
+            Symbol const symbols[] = { getKey("a"), getKey("b") };
+            unsigned const num_symbols = sizeof(symbols) / sizeof(symbols[0]);
+            unsigned const num_states = 3;
+
+            std::vector<State> states;
+            for (unsigned q = 0; q < num_states; ++q) {
+                std::stringstream ss;
+                ss << prefix << q;
+                states.push_back(getKey(ss.str()));
+            }
+
+            Nwa nwa;
+            nwa.addInitialState(states[0]);
+            if (nextInt(3) == 0) {
+                nwa.addInitialState(states[1]);
+            }
+            for (unsigned q = 0; q < num_states; ++q) {
+                if (nextInt(3) == 0) {
+                    nwa.addFinalState(states[q]);
+                }
+            }
+
+            unsigned const num_trans = 4 + nextInt(6);
+            for (unsigned t = 0; t < num_trans; ++t) {
+                State from = states[nextInt(num_states)];
+                State to = states[nextInt(num_states)];
+                Symbol sym = symbols[nextInt(num_symbols)];
+                switch (nextInt(7)) {
+                case 0: case 1:
+                    nwa.addInternalTrans(from, sym, to);
+                    break;
+                case 2:
+                    nwa.addInternalTrans(from, EPSILON, to);
+                    break;
+                case 3: case 4:
+                    nwa.addCallTrans(from, sym, to);
+                    break;
+                default:
+                    nwa.addReturnTrans(from, states[nextInt(num_states)], sym, to);
+                    break;
+                }
+            }
+            return nwa;
+        }
+
 }
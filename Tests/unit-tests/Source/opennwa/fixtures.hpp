@@ -2,6 +2,8 @@
 
 #include "opennwa/NestedWord.hpp"
 
+#include "fixtures/Random.hpp"
+
 namespace opennwa
 {
         //////////////////////////////////
@@ -521,4 +523,22 @@ namespace opennwa
 
         };
 
+
+
+        /// Generates small random NWAs (three states over symbols 'a'
+        /// and 'b', with some epsilon transitions) from a fixed seed, so
+        /// tests that use them are repeatable. 'prefix' names the states.
+        class RandomNwas
+        {
+        public:
+            explicit RandomNwas(unsigned long seed) : random(seed) {}
+
+            Nwa next(std::string const & prefix);
+
+            unsigned nextInt(unsigned bound);
+
+        private:
+            ::testing::Lcg random;
+        };
+
 }
@@ -11,6 +11,8 @@
 #include "Tests/unit-tests/Source/opennwa/int-client-info.hpp"
 #include "Tests/unit-tests/Source/opennwa/class-NWA/supporting.hpp"
 
+#include <sstream>
+
 namespace opennwa {
         namespace construct {
 
@@ -135,6 +137,28 @@ namespace opennwa {
 
                 EXPECT_TRUE(query::languageIsEmpty(*det));
             }
+
+
+            TEST(opennwa$construct$$determinize, randomNwasGiveEquivalentDeterministicNwas)
+            {
+                RandomNwas random(36);
+
+                for (int round = 0; round < 20; ++round) {
+                    std::stringstream ss;
+                    ss << "Round " << round;
+                    SCOPED_TRACE(ss.str());
+
+                    Nwa nwa = random.next("determinize");
+                    NwaRefPtr det = determinize(nwa);
+
+                    EXPECT_TRUE(query::isDeterministic(*det));
+                    EXPECT_TRUE(query::languageEquals(nwa, *det));
+
+                    // The construction is deterministic too
+                    NwaRefPtr again = determinize(nwa);
+                    EXPECT_TRUE(*det == *again);
+                }
+            }
             
 
         }
@@ -0,0 +1,177 @@
+#include "gtest/gtest.h"
+
+#include "opennwa/Nwa.hpp"
+#include "opennwa/query/language.hpp"
+#include "opennwa/construct/reduce.hpp"
+
+#include "Tests/unit-tests/Source/opennwa/fixtures.hpp"
+#include "Tests/unit-tests/Source/opennwa/class-NWA/supporting.hpp"
+
+#include <sstream>
+
+using namespace opennwa;
+
+#define NUM_ELEMENTS(array)  (sizeof(array)/sizeof((array)[0]))
+
+static Nwa const nwas[] = {
+    Nwa(),
+    AcceptsBalancedOnly().nwa,
+    AcceptsStrictlyUnbalancedLeft().nwa,
+    AcceptsPossiblyUnbalancedLeft().nwa,
+    AcceptsStrictlyUnbalancedRight().nwa,
+    AcceptsPossiblyUnbalancedRight().nwa,
+    AcceptsPositionallyConsistentString().nwa,
+    OddNumEvenGroupsNwa().nwa
+};
+
+static const unsigned num_nwas = NUM_ELEMENTS(nwas);
+
+
+namespace opennwa {
+    namespace construct {
+
+        TEST(opennwa$construct$$reduce, mergesStatesWithTheSameFuture)
+        {
+            SomeElements e;
+            Nwa nwa;
+
+            //           symbol          symbol
+            //  --> state -----> state2 -----> ((state4))
+            //          \                     /
+            //           ------> state3 ------
+            //           symbol          symbol
+            nwa.addInitialState(e.state);
+            nwa.addFinalState(e.state4);
+            nwa.addInternalTrans(e.state, e.symbol, e.state2);
+            nwa.addInternalTrans(e.state, e.symbol, e.state3);
+            nwa.addInternalTrans(e.state2, e.symbol, e.state4);
+            nwa.addInternalTrans(e.state3, e.symbol, e.state4);
+
+            wali::util::DisjointSets<State> classes = bisimulationClasses(nwa);
+            EXPECT_EQ(classes.representative(e.state2), classes.representative(e.state3));
+            EXPECT_NE(classes.representative(e.state), classes.representative(e.state2));
+
+            ReductionStatistics stats;
+            NwaRefPtr reduced = reduce(nwa, &stats);
+            EXPECT_EQ(4u, stats.statesBefore);
+            EXPECT_EQ(3u, stats.statesAfter);
+            EXPECT_EQ(4u, stats.transitionsBefore);
+            EXPECT_EQ(2u, stats.transitionsAfter);
+            EXPECT_EQ(reduced->sizeStates(), stats.statesAfter);
+            EXPECT_LE(1u, stats.refinementRounds);
+            EXPECT_LE(0.0, stats.seconds);
+            EXPECT_TRUE(query::languageEquals(nwa, *reduced));
+        }
+
+
+        TEST(opennwa$construct$$reduce, keepsCallPredecessorsApart)
+        {
+            SomeElements e;
+            Nwa nwa;
+
+            // state and state2 look alike going forward (both call into
+            // state3), but only a return with state on the stack reaches
+            // the final state.
+            State start = getKey("reduce-start");
+            nwa.addInitialState(start);
+            nwa.addFinalState(e.state4);
+            nwa.addInternalTrans(start, e.symbol, e.state);
+            nwa.addInternalTrans(start, e.symbol, e.state2);
+            nwa.addCallTrans(e.state, e.symbol, e.state3);
+            nwa.addCallTrans(e.state2, e.symbol, e.state3);
+            nwa.addReturnTrans(e.state3, e.state, e.symbol, e.state4);
+
+            wali::util::DisjointSets<State> classes = bisimulationClasses(nwa);
+            EXPECT_NE(classes.representative(e.state), classes.representative(e.state2));
+
+            NwaRefPtr reduced = reduce(nwa);
+            EXPECT_EQ(nwa.sizeStates(), reduced->sizeStates());
+            EXPECT_TRUE(query::languageEquals(nwa, *reduced));
+        }
+
+
+        TEST(opennwa$construct$$reduce, keepsExitsWithDifferentCallPredecessorsApart)
+        {
+            // Each exit returns with just one of the call predecessors:
+            //
+            //    --> i -x-> c1 -call-> n -p-> e1    (e1, c1, a) --> r
+            //         \-y-> c2 -call-/  \-q-> e2    (e2, c2, a) --> r
+            //
+            // so the language is { x call p a, y call q a }. Comparing
+            // return partners by class would merge c1 with c2 and e1 with
+            // e2, and the quotient would accept y call p a.
+            State i = getKey("reduce-i"), n = getKey("reduce-n"), r = getKey("reduce-r");
+            State c1 = getKey("reduce-c1"), c2 = getKey("reduce-c2");
+            State e1 = getKey("reduce-e1"), e2 = getKey("reduce-e2");
+            Symbol x = getKey("x"), y = getKey("y"), call = getKey("call");
+            Symbol p = getKey("p"), q = getKey("q"), a = getKey("a");
+
+            Nwa nwa;
+            nwa.addInitialState(i);
+            nwa.addFinalState(r);
+            nwa.addInternalTrans(i, x, c1);
+            nwa.addInternalTrans(i, y, c2);
+            nwa.addCallTrans(c1, call, n);
+            nwa.addCallTrans(c2, call, n);
+            nwa.addInternalTrans(n, p, e1);
+            nwa.addInternalTrans(n, q, e2);
+            nwa.addReturnTrans(e1, c1, a, r);
+            nwa.addReturnTrans(e2, c2, a, r);
+
+            wali::util::DisjointSets<State> classes = bisimulationClasses(nwa);
+            EXPECT_NE(classes.representative(c1), classes.representative(c2));
+            EXPECT_NE(classes.representative(e1), classes.representative(e2));
+
+            NestedWord ycallpa;
+            ycallpa.appendInternal(y);
+            ycallpa.appendCall(call);
+            ycallpa.appendInternal(p);
+            ycallpa.appendReturn(a);
+
+            NwaRefPtr reduced = reduce(nwa);
+            EXPECT_EQ(7u, reduced->sizeStates());
+            EXPECT_FALSE(query::languageContains(*reduced, ycallpa));
+            EXPECT_TRUE(query::languageEquals(nwa, *reduced));
+        }
+
+
+        TEST(opennwa$construct$$reduce, fixturesKeepTheirLanguage)
+        {
+            for (unsigned i = 0; i < num_nwas; ++i) {
+                std::stringstream ss;
+                ss << "NWA " << i;
+                SCOPED_TRACE(ss.str());
+
+                NwaRefPtr reduced = reduce(nwas[i]);
+                EXPECT_LE(reduced->sizeStates(), nwas[i].sizeStates());
+                EXPECT_TRUE(query::languageEquals(nwas[i], *reduced));
+            }
+        }
+
+
+        TEST(opennwa$construct$$reduce, randomNwasKeepTheirLanguage)
+        {
+            RandomNwas random(38);
+
+            for (int round = 0; round < 30; ++round) {
+                std::stringstream ss;
+                ss << "Round " << round;
+                SCOPED_TRACE(ss.str());
+
+                Nwa nwa = random.next("reduce");
+                ReductionStatistics stats;
+                NwaRefPtr reduced = reduce(nwa, &stats);
+
+                EXPECT_EQ(nwa.sizeStates(), stats.statesBefore);
+                EXPECT_LE(stats.statesAfter, stats.statesBefore);
+                EXPECT_LE(stats.transitionsAfter, stats.transitionsBefore);
+                EXPECT_TRUE(query::languageEquals(nwa, *reduced));
+
+                // Reducing again finds nothing more to merge
+                NwaRefPtr twice = reduce(*reduced);
+                EXPECT_EQ(reduced->sizeStates(), twice->sizeStates());
+            }
+        }
+
+    }
+}
@@ -0,0 +1,189 @@
+#include "gtest/gtest.h"
+
+#include "opennwa/Nwa.hpp"
+#include "opennwa/construct/determinize.hpp"
+#include "opennwa/query/automaton.hpp"
+#include "opennwa/query/language.hpp"
+#include "opennwa/query/CompiledNwa.hpp"
+
+#include "Tests/unit-tests/Source/opennwa/fixtures.hpp"
+
+#include <sstream>
+
+using namespace opennwa;
+
+
+namespace {
+
+    /// A random nested word over the symbols RandomNwas uses. Calls and
+    /// returns need not match up.
+    NestedWord
+    random_word(RandomNwas & random)
+    {
+        Symbol const symbols[] = { getKey("a"), getKey("b") };
+        NestedWord word;
+        unsigned const length = random.nextInt(9);
+        for (unsigned i = 0; i < length; ++i) {
+            Symbol sym = symbols[random.nextInt(2)];
+            switch (random.nextInt(3)) {
+            case 0: word.appendCall(sym); break;
+            case 1: word.appendInternal(sym); break;
+            default: word.appendReturn(sym); break;
+            }
+        }
+        return word;
+    }
+
+}
+
+
+namespace opennwa {
+    namespace query {
+
+        TEST(opennwa$query$$CompiledNwa, agreesWithLanguageContainsOnRandomNwas)
+        {
+            RandomNwas random(40);
+
+            for (int round = 0; round < 40; ++round) {
+                Nwa nwa = random.next("compiled");
+                NwaRefPtr det = construct::determinize(nwa);
+                ASSERT_TRUE(isDeterministic(*det));
+
+                // The second copy is forced onto the return lists
+                CompiledNwa flat(*det);
+                CompiledNwa lists(*det, 0);
+                CompiledNwa::Run run(flat);
+
+                for (int w = 0; w < 10; ++w) {
+                    NestedWord word = random_word(random);
+                    std::stringstream ss;
+                    ss << "Round " << round << ", word " << w << ": " << word;
+                    SCOPED_TRACE(ss.str());
+
+                    bool expected = languageContains(*det, word);
+                    EXPECT_EQ(expected, flat.accepts(word));
+                    EXPECT_EQ(expected, lists.accepts(word));
+
+                    run.reset();
+                    run.append(word);
+                    EXPECT_EQ(expected, run.accepting());
+                    if (run.dead()) {
+                        EXPECT_FALSE(run.accepting());
+                    }
+                }
+            }
+        }
+
+        TEST(opennwa$query$$CompiledNwa, agreesWithLanguageContainsOnFixtures)
+        {
+            Nwa const nwas[] = {
+                AcceptsBalancedOnly().nwa,
+                AcceptsStrictlyUnbalancedLeft().nwa,
+                AcceptsPossiblyUnbalancedLeft().nwa,
+                AcceptsStrictlyUnbalancedRight().nwa,
+                AcceptsPossiblyUnbalancedRight().nwa,
+                AcceptsPositionallyConsistentString().nwa
+            };
+            WordCollection words;
+            NestedWord const * const all_words[] = {
+                &words.empty, &words.balanced, &words.balanced0,
+                &words.unbalancedRight, &words.unbalancedRight0,
+                &words.unbalancedLeft, &words.unbalancedLeft0,
+                &words.fullyUnbalanced, &words.fullyUnbalanced0
+            };
+
+            for (size_t i = 0; i < sizeof(nwas) / sizeof(nwas[0]); ++i) {
+                NwaRefPtr det = construct::determinize(nwas[i]);
+                CompiledNwa compiled(*det);
+                for (size_t j = 0; j < sizeof(all_words) / sizeof(all_words[0]); ++j) {
+                    std::stringstream ss;
+                    ss << "NWA " << i << ", word " << j;
+                    SCOPED_TRACE(ss.str());
+
+                    EXPECT_EQ(languageContains(*det, *all_words[j]), compiled.accepts(*all_words[j]));
+                }
+            }
+        }
+
+        TEST(opennwa$query$$CompiledNwa, unknownSymbolsAndMissingTransitionsLeadToTheDeadState)
+        {
+            SomeElements e;
+            Nwa nwa;
+            nwa.addInitialState(e.state);
+            nwa.addFinalState(e.state2);
+            nwa.addInternalTrans(e.state, e.symbol, e.state2);
+
+            CompiledNwa compiled(nwa);
+            EXPECT_EQ(3u, compiled.numStates());
+            EXPECT_EQ(2u, compiled.numSymbols());
+            EXPECT_EQ(compiled.symbolId(e.symbol2), compiled.symbolId(getKey("never seen")));
+            EXPECT_NE(compiled.symbolId(e.symbol), compiled.symbolId(e.symbol2));
+
+            CompiledNwa::Run run(compiled);
+            EXPECT_FALSE(run.accepting());
+            run.internal(e.symbol);
+            EXPECT_TRUE(run.accepting());
+            EXPECT_FALSE(run.dead());
+
+            run.internal(e.symbol);
+            EXPECT_TRUE(run.dead());
+            run.internal(e.symbol);
+            EXPECT_TRUE(run.dead());
+
+            run.reset();
+            run.internal(e.symbol2);
+            EXPECT_TRUE(run.dead());
+        }
+
+        TEST(opennwa$query$$CompiledNwa, wildTransitionsMatchEverySymbol)
+        {
+            SomeElements e;
+            Nwa nwa;
+            nwa.addInitialState(e.state);
+            nwa.addFinalState(e.state2);
+            nwa.addCallTrans(e.state, WILD, e.state2);
+            nwa.addReturnTrans(e.state2, e.state, WILD, e.state);
+            nwa.addInternalTrans(e.state, e.symbol, e.state);
+            nwa.addInternalTrans(e.state2, e.symbol, e.state2);
+
+            CompiledNwa compiled(nwa);
+            CompiledNwa::Run run(compiled);
+
+            for (int i = 0; i < 1000; ++i) {
+                run.call(e.symbol2);
+                run.internal(e.symbol);
+                EXPECT_TRUE(run.accepting());
+                EXPECT_EQ(1u, run.depth());
+                run.ret(getKey("never seen"));
+                EXPECT_FALSE(run.accepting());
+                EXPECT_FALSE(run.dead());
+                run.internal(e.symbol);
+            }
+            EXPECT_EQ(0u, run.depth());
+
+            // Nothing leaves state2 on a call
+            run.call(e.symbol);
+            run.call(e.symbol);
+            EXPECT_TRUE(run.dead());
+        }
+
+        TEST(opennwa$query$$CompiledNwa, sparseReturnsWithNoReturnTransitions)
+        {
+            SomeElements e;
+            Nwa nwa;
+            nwa.addInitialState(e.state);
+            nwa.addFinalState(e.state2);
+            nwa.addCallTrans(e.state, e.symbol, e.state2);
+
+            // Force the bucketed return table, which is then empty
+            CompiledNwa compiled(nwa, 0);
+            CompiledNwa::Run run(compiled);
+
+            run.call(e.symbol);
+            EXPECT_TRUE(run.accepting());
+            run.ret(e.symbol);
+            EXPECT_TRUE(run.dead());
+        }
+
+    }
+}
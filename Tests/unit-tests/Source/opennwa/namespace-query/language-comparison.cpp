@@ -2,6 +2,8 @@
 
 #include "opennwa/Nwa.hpp"
 #include "opennwa/query/language.hpp"
+#include "opennwa/construct/complement.hpp"
+#include "opennwa/construct/intersect.hpp"
 
 #include "Tests/unit-tests/Source/opennwa/fixtures.hpp"
 #include "Tests/unit-tests/Source/opennwa/class-NWA/supporting.hpp"
@@ -42,6 +44,28 @@ static bool expected_answers[][num_nwas] = {
 };
 
 
+namespace {
+
+    /// The way languageSubsetEq used to work: L(first) - L(second) is
+    /// empty iff L(first) intersect complement(L(second)) is. (This
+    /// checks emptiness through the WPDS, as languageIsEmpty used to.)
+    bool
+    subsetEqByComplement(Nwa const & first, Nwa const & second)
+    {
+        Nwa second_copy = second;
+        for (Nwa::SymbolIterator sym = first.beginSymbols();
+             sym != first.endSymbols(); ++sym)
+        {
+            second_copy.addSymbol(*sym);
+        }
+        NwaRefPtr comp = construct::complement(second_copy);
+        NwaRefPtr inter = construct::intersect(first, *comp);
+        return query::getSomeAcceptedWord(*inter) == NULL;
+    }
+
+}
+
+
 namespace opennwa {
         namespace query {
 
@@ -84,6 +108,83 @@ namespace opennwa {
                     }
                 }
             }
-            
+
+
+            TEST(opennwa$query$$getSomeWordInDifference, testBatteryOfVariouslyBalancedNwas)
+            {
+                for (unsigned left = 0 ; left < num_nwas ; ++left) {
+                    for (unsigned right = 0 ; right < num_nwas ; ++right) {
+                        std::stringstream ss;
+                        ss << "Testing Nwa " << left << " - " << right;
+                        SCOPED_TRACE(ss.str());
+
+                        NestedWordRefPtr word = getSomeWordInDifference(nwas[left], nwas[right]);
+                        EXPECT_EQ(expected_answers[left][right], word.is_empty());
+                        if (word.is_valid()) {
+                            EXPECT_TRUE(languageContains(nwas[left], *word));
+                            EXPECT_FALSE(languageContains(nwas[right], *word));
+                        }
+                    }
+                }
+            }
+
+
+            TEST(opennwa$query$$getSomeWordInDifference, emptyWordIsACounterexample)
+            {
+                Nwa accepts_empty;
+                accepts_empty.addInitialState(getKey("diff_q"));
+                accepts_empty.addFinalState(getKey("diff_q"));
+
+                NestedWordRefPtr word = getSomeWordInDifference(accepts_empty, AcceptsStrictlyUnbalancedLeft().nwa);
+                ASSERT_TRUE(word.is_valid());
+                EXPECT_EQ(0u, word->size());
+            }
+
+
+            TEST(opennwa$query$$getSomeWordInDifference, longCounterexample)
+            {
+                // The only word is 'length' internals long, and the
+                // counterexample is rebuilt one letter per step
+                unsigned const length = 50000;
+                Symbol a = getKey("a");
+                Nwa chain;
+                State previous = getKey("diff_chain_0");
+                chain.addInitialState(previous);
+                for (unsigned i = 1; i <= length; ++i) {
+                    std::stringstream ss;
+                    ss << "diff_chain_" << i;
+                    State next = getKey(ss.str());
+                    chain.addInternalTrans(previous, a, next);
+                    previous = next;
+                }
+                chain.addFinalState(previous);
+
+                NestedWordRefPtr word = getSomeWordInDifference(chain, Nwa());
+                ASSERT_TRUE(word.is_valid());
+                EXPECT_EQ(length, word->size());
+            }
+
+
+            TEST(opennwa$query$$languageSubsetEq, randomNwasAgreeWithComplementation)
+            {
+                RandomNwas random(2718);
+
+                for (int round = 0; round < 150; ++round) {
+                    std::stringstream ss;
+                    ss << "Round " << round;
+                    SCOPED_TRACE(ss.str());
+
+                    Nwa first = random.next("diff_left_");
+                    Nwa second = random.next("diff_right_");
+
+                    NestedWordRefPtr word = getSomeWordInDifference(first, second);
+                    EXPECT_EQ(subsetEqByComplement(first, second), word.is_empty());
+                    if (word.is_valid()) {
+                        EXPECT_TRUE(languageContains(first, *word));
+                        EXPECT_FALSE(languageContains(second, *word));
+                    }
+                }
+            }
+
     }
 }
@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+
+#include "opennwa/Nwa.hpp"
+#include "opennwa/query/language.hpp"
+#include "opennwa/construct/intersect.hpp"
+
+#include "Tests/unit-tests/Source/opennwa/fixtures.hpp"
+#include "Tests/unit-tests/Source/opennwa/class-NWA/supporting.hpp"
+
+using namespace opennwa;
+
+#define NUM_ELEMENTS(array)  (sizeof(array)/sizeof((array)[0]))
+
+
+static Nwa const nwas[] = {
+    Nwa(),
+    AcceptsBalancedOnly().nwa,
+    AcceptsStrictlyUnbalancedLeft().nwa,
+    AcceptsPossiblyUnbalancedLeft().nwa,
+    AcceptsStrictlyUnbalancedRight().nwa,
+    AcceptsPossiblyUnbalancedRight().nwa,
+    AcceptsPositionallyConsistentString().nwa,
+    OddNumEvenGroupsNwa().nwa
+};
+
+static const unsigned num_nwas = NUM_ELEMENTS(nwas);
+
+
+namespace {
+
+    std::vector<Nwa const *>
+    list(Nwa const & a, Nwa const & b)
+    {
+        std::vector<Nwa const *> nwas;
+        nwas.push_back(&a);
+        nwas.push_back(&b);
+        return nwas;
+    }
+
+    ::testing::AssertionResult
+    acceptedByAll(std::vector<Nwa const *> const & nwas, NestedWord const & word)
+    {
+        for (size_t i = 0; i < nwas.size(); ++i) {
+            if (!query::languageContains(*nwas[i], word)) {
+                return ::testing::AssertionFailure() << "not accepted by NWA " << i;
+            }
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+}
+
+
+namespace opennwa {
+        namespace query {
+
+            TEST(opennwa$query$$languageIntersectionIsEmpty, pairsAgreeWithConstructIntersect)
+            {
+                for (unsigned left = 0 ; left < num_nwas ; ++left) {
+                    for (unsigned right = 0 ; right < num_nwas ; ++right) {
+                        std::stringstream ss;
+                        ss << "Testing Nwa " << left << " & " << right;
+                        SCOPED_TRACE(ss.str());
+
+                        std::vector<Nwa const *> both = list(nwas[left], nwas[right]);
+                        NwaRefPtr product = construct::intersect(nwas[left], nwas[right]);
+                        bool expected = languageIsEmpty(*product);
+
+                        EXPECT_EQ(expected, languageIntersectionIsEmpty(both));
+
+                        NestedWordRefPtr word = getSomeAcceptedWordInIntersection(both);
+                        EXPECT_EQ(expected, word == NULL);
+                        if (word != NULL) {
+                            EXPECT_TRUE(acceptedByAll(both, *word));
+                        }
+                    }
+                }
+            }
+
+
+            TEST(opennwa$query$$languageIntersectionIsEmpty, singleNwaIsEmptiness)
+            {
+                for (unsigned i = 0 ; i < num_nwas ; ++i) {
+                    std::vector<Nwa const *> one(1, &nwas[i]);
+                    EXPECT_EQ(languageIsEmpty(nwas[i]), languageIntersectionIsEmpty(one));
+                }
+            }
+
+
+            TEST(opennwa$query$$languageIntersectionIsEmpty, randomChainsAgreeWithConstructIntersect)
+            {
+                RandomNwas random(1618);
+
+                for (int round = 0; round < 200; ++round) {
+                    std::stringstream ss;
+                    ss << "Round " << round;
+                    SCOPED_TRACE(ss.str());
+
+                    std::vector<Nwa> chain;
+                    for (int i = 0; i < 3; ++i) {
+                        std::stringstream prefix;
+                        prefix << "product_random_" << i << "_";
+                        chain.push_back(random.next(prefix.str()));
+                    }
+
+                    std::vector<Nwa const *> all;
+                    NwaRefPtr product = new Nwa(chain[0]);
+                    all.push_back(&chain[0]);
+                    for (size_t i = 1; i < chain.size(); ++i) {
+                        product = construct::intersect(*product, chain[i]);
+                        all.push_back(&chain[i]);
+                    }
+
+                    bool expected = getSomeAcceptedWord(*product) == NULL;
+                    EXPECT_EQ(expected, languageIntersectionIsEmpty(all));
+
+                    NestedWordRefPtr word = getSomeAcceptedWordInIntersection(all);
+                    EXPECT_EQ(expected, word == NULL);
+                    if (word != NULL) {
+                        EXPECT_TRUE(acceptedByAll(all, *word));
+                    }
+                }
+            }
+
+    }
+}
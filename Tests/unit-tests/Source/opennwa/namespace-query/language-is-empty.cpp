@@ -315,6 +315,123 @@ namespace opennwa {
 
                 EXPECT_EQ(expected, *word);
             }
+
+            TEST(opennwa$query$$languageIsEmpty$withWitness, testBatteryOfVariouslyBalancedNwas)
+            {
+                for (unsigned nwa = 0 ; nwa < num_nwas ; ++nwa) {
+                    std::stringstream ss;
+                    ss << "Testing NWA " << nwa;
+                    SCOPED_TRACE(ss.str());
+
+                    NestedWordRefPtr word = new NestedWord();
+                    EXPECT_EQ(expected_answers[nwa], languageIsEmpty(nwas[nwa], word));
+                    if (expected_answers[nwa]) {
+                        EXPECT_TRUE(word == NULL);
+                    }
+                    else {
+                        ASSERT_TRUE(word != NULL);
+                        EXPECT_TRUE(languageContains(nwas[nwa], *word));
+                    }
+                }
+            }
+
+
+            TEST(opennwa$query$$languageIsEmpty$withWitness, testMatchedAndPendingCalls)
+            {
+                //              a(            b             )a/state          a(
+                //  --> (state) ---> (state2) ---> (state3) -------> (state4) ---> ((state5))
+                Nwa nwa;
+                SomeElements e;
+                State state5 = getKey("state5");
+                Symbol b = getKey("b");
+
+                nwa.addInitialState(e.state);
+                nwa.addCallTrans(e.state, e.symbol, e.state2);
+                nwa.addInternalTrans(e.state2, b, e.state3);
+                nwa.addReturnTrans(e.state3, e.state, e.symbol, e.state4);
+                nwa.addCallTrans(e.state4, e.symbol, state5);
+                nwa.addFinalState(state5);
+
+                NestedWordRefPtr word;
+                ASSERT_FALSE(languageIsEmpty(nwa, word));
+
+                NestedWord expected;
+                expected.appendCall(e.symbol);
+                expected.appendInternal(b);
+                expected.appendReturn(e.symbol);
+                expected.appendCall(e.symbol);
+
+                EXPECT_EQ(expected, *word);
+            }
+
+
+            TEST(opennwa$query$$languageIsEmpty$withWitness, testWildSymbolGetsAConcreteSymbol)
+            {
+                Nwa nwa;
+                SomeElements e;
+
+                nwa.addInitialState(e.state);
+                nwa.addInternalTrans(e.state, WILD, e.state2);
+                nwa.addInternalTrans(e.state2, e.symbol, e.state3);
+                nwa.addFinalState(e.state3);
+
+                NestedWordRefPtr word;
+                ASSERT_FALSE(languageIsEmpty(nwa, word));
+                ASSERT_EQ(2u, word->size());
+                EXPECT_NE(WILD, word->begin()->symbol);
+            }
+
+
+            TEST(opennwa$query$$languageIsEmpty$withWitness, testDeeplyNestedWitness)
+            {
+                // a( nested 'depth' deep, then as many )a: the witness is
+                // rebuilt through 'depth' levels and returns
+                unsigned const depth = 20000;
+                Nwa nwa;
+                SomeElements e;
+
+                std::vector<State> calls, rets;
+                for (unsigned i = 0; i <= depth; ++i) {
+                    std::stringstream ss;
+                    ss << i;
+                    calls.push_back(getKey("deep_call_" + ss.str()));
+                    rets.push_back(getKey("deep_ret_" + ss.str()));
+                }
+                nwa.addInitialState(calls[0]);
+                nwa.addFinalState(rets[0]);
+                nwa.addInternalTrans(calls[depth], e.symbol, rets[depth]);
+                for (unsigned i = 0; i < depth; ++i) {
+                    nwa.addCallTrans(calls[i], e.symbol, calls[i + 1]);
+                    nwa.addReturnTrans(rets[i + 1], calls[i], e.symbol, rets[i]);
+                }
+
+                NestedWordRefPtr word;
+                ASSERT_FALSE(languageIsEmpty(nwa, word));
+                EXPECT_EQ(2 * depth + 1, word->size());
+                EXPECT_EQ(NestedWord::Position::CallType, word->begin()->type);
+                EXPECT_EQ(NestedWord::Position::ReturnType, (--word->end())->type);
+            }
+
+
+            TEST(opennwa$query$$languageIsEmpty, randomNwasAgreeWithWpdsWitness)
+            {
+                RandomNwas random(31415);
+
+                for (int round = 0; round < 200; ++round) {
+                    std::stringstream ss;
+                    ss << "Round " << round;
+                    SCOPED_TRACE(ss.str());
+
+                    Nwa nwa = random.next("empty_random_");
+
+                    NestedWordRefPtr word;
+                    bool empty = languageIsEmpty(nwa, word);
+                    EXPECT_EQ(getSomeAcceptedWord(nwa) == NULL, empty);
+                    if (!empty) {
+                        EXPECT_TRUE(languageContains(nwa, *word));
+                    }
+                }
+            }
             
     }
 }
@@ -0,0 +1,158 @@
+#include "gtest/gtest.h"
+
+#include "opennwa/Nwa.hpp"
+#include "opennwa/query/language.hpp"
+#include "opennwa/query/MembershipMonitor.hpp"
+
+#include "Tests/unit-tests/Source/opennwa/fixtures.hpp"
+
+#include <sstream>
+
+using namespace opennwa;
+
+
+namespace {
+
+    /// A random nested word over the symbols RandomNwas uses. Calls and
+    /// returns need not match up.
+    NestedWord
+    random_word(RandomNwas & random)
+    {
+        Symbol const symbols[] = { getKey("a"), getKey("b") };
+        NestedWord word;
+        unsigned const length = random.nextInt(9);
+        for (unsigned i = 0; i < length; ++i) {
+            Symbol sym = symbols[random.nextInt(2)];
+            switch (random.nextInt(3)) {
+            case 0: word.appendCall(sym); break;
+            case 1: word.appendInternal(sym); break;
+            default: word.appendReturn(sym); break;
+            }
+        }
+        return word;
+    }
+
+}
+
+
+namespace opennwa {
+    namespace query {
+
+        TEST(opennwa$query$$MembershipMonitor, agreesWithLanguageContainsOnEveryPrefix)
+        {
+            RandomNwas random(39);
+
+            for (int round = 0; round < 40; ++round) {
+                Nwa nwa = random.next("monitor");
+                MembershipMonitor monitor(nwa);
+
+                for (int w = 0; w < 10; ++w) {
+                    NestedWord word = random_word(random);
+                    std::stringstream ss;
+                    ss << "Round " << round << ", word " << w << ": " << word;
+                    SCOPED_TRACE(ss.str());
+
+                    monitor.reset();
+                    NestedWord prefix;
+                    EXPECT_EQ(languageContains(nwa, prefix), monitor.accepting());
+                    for (NestedWord::const_iterator pos = word.begin(); pos != word.end(); ++pos) {
+                        prefix.append(*pos);
+                        monitor.append(*pos);
+                        EXPECT_EQ(languageContains(nwa, prefix), monitor.accepting());
+                        if (monitor.dead()) {
+                            EXPECT_FALSE(monitor.accepting());
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST(opennwa$query$$MembershipMonitor, agreesWithLanguageContainsOnFixtures)
+        {
+            Nwa const nwas[] = {
+                AcceptsBalancedOnly().nwa,
+                AcceptsStrictlyUnbalancedLeft().nwa,
+                AcceptsPossiblyUnbalancedLeft().nwa,
+                AcceptsStrictlyUnbalancedRight().nwa,
+                AcceptsPossiblyUnbalancedRight().nwa,
+                AcceptsPositionallyConsistentString().nwa
+            };
+            WordCollection words;
+            NestedWord const * const all_words[] = {
+                &words.empty, &words.balanced, &words.balanced0,
+                &words.unbalancedRight, &words.unbalancedRight0,
+                &words.unbalancedLeft, &words.unbalancedLeft0,
+                &words.fullyUnbalanced, &words.fullyUnbalanced0
+            };
+
+            for (size_t i = 0; i < sizeof(nwas) / sizeof(nwas[0]); ++i) {
+                MembershipMonitor monitor(nwas[i]);
+                for (size_t j = 0; j < sizeof(all_words) / sizeof(all_words[0]); ++j) {
+                    std::stringstream ss;
+                    ss << "NWA " << i << ", word " << j;
+                    SCOPED_TRACE(ss.str());
+
+                    monitor.reset();
+                    monitor.append(*all_words[j]);
+                    EXPECT_EQ(languageContains(nwas[i], *all_words[j]), monitor.accepting());
+                }
+            }
+        }
+
+        TEST(opennwa$query$$MembershipMonitor, copiesShareTheStackAndContinueIndependently)
+        {
+            OddNumEvenGroupsNwa fixture;
+            MembershipMonitor monitor(fixture.nwa);
+
+            monitor.call(fixture.call);
+            monitor.internal(fixture.zero);
+            EXPECT_EQ(1u, monitor.depth());
+
+            MembershipMonitor checkpoint = monitor;
+            monitor.ret(fixture.ret);
+            EXPECT_EQ(0u, monitor.depth());
+            EXPECT_EQ(1u, checkpoint.depth());
+
+            checkpoint.internal(fixture.zero);
+            checkpoint.ret(fixture.ret);
+
+            NestedWord one_zero, two_zeros;
+            one_zero.appendCall(fixture.call);
+            one_zero.appendInternal(fixture.zero);
+            one_zero.appendReturn(fixture.ret);
+            two_zeros.appendCall(fixture.call);
+            two_zeros.appendInternal(fixture.zero);
+            two_zeros.appendInternal(fixture.zero);
+            two_zeros.appendReturn(fixture.ret);
+
+            EXPECT_EQ(languageContains(fixture.nwa, one_zero), monitor.accepting());
+            EXPECT_EQ(languageContains(fixture.nwa, two_zeros), checkpoint.accepting());
+            EXPECT_NE(monitor.accepting(), checkpoint.accepting());
+        }
+
+        TEST(opennwa$query$$MembershipMonitor, countsEvents)
+        {
+            OddNumEvenGroupsNwa fixture;
+            MembershipMonitor monitor(fixture.nwa);
+            EXPECT_EQ(0u, monitor.events());
+
+            for (int i = 0; i < 1000; ++i) {
+                monitor.call(fixture.call);
+                monitor.internal(fixture.zero);
+            }
+            EXPECT_EQ(1000u, monitor.depth());
+            for (int i = 0; i < 1000; ++i) {
+                monitor.ret(fixture.ret);
+            }
+            EXPECT_EQ(0u, monitor.depth());
+            EXPECT_EQ(3000u, monitor.events());
+            EXPECT_LE(0.0, monitor.seconds());
+            EXPECT_LE(0.0, monitor.eventsPerSecond());
+
+            monitor.reset();
+            EXPECT_EQ(3000u, monitor.events());
+            EXPECT_EQ(0u, monitor.depth());
+        }
+
+    }
+}
@@ -0,0 +1,190 @@
+#include "gtest/gtest.h"
+
+#include "opennwa/Nwa.hpp"
+#include "opennwa/query/internals.hpp"
+#include "opennwa/query/calls.hpp"
+#include "opennwa/query/returns.hpp"
+#include "opennwa/query/transitions.hpp"
+
+#include "Tests/unit-tests/Source/opennwa/fixtures.hpp"
+
+#include <sstream>
+#include <vector>
+
+using namespace opennwa;
+
+
+namespace {
+
+    /// Checks the symbol-indexed queries against a scan of every
+    /// transition in the NWA
+    void
+    expect_lookups_match_scan(Nwa const & nwa)
+    {
+        std::vector<State> states(nwa.beginStates(), nwa.endStates());
+        std::vector<Symbol> symbols(nwa.beginSymbols(), nwa.endSymbols());
+        symbols.push_back(WILD);
+        symbols.push_back(EPSILON);
+
+        for (size_t j = 0; j < symbols.size(); ++j) {
+            Symbol a = symbols[j];
+
+            StateSet sources, targets, call_sites, entries, exits, preds, rets;
+            for (Nwa::InternalIterator t = nwa.beginInternalTrans(); t != nwa.endInternalTrans(); ++t) {
+                if (t->second == a) {
+                    sources.insert(t->first);
+                    targets.insert(t->third);
+                }
+            }
+            for (Nwa::CallIterator t = nwa.beginCallTrans(); t != nwa.endCallTrans(); ++t) {
+                if (t->second == a) {
+                    call_sites.insert(t->first);
+                    entries.insert(t->third);
+                }
+            }
+            for (Nwa::ReturnIterator t = nwa.beginReturnTrans(); t != nwa.endReturnTrans(); ++t) {
+                if (t->third == a) {
+                    exits.insert(t->first);
+                    preds.insert(t->second);
+                    rets.insert(t->fourth);
+                }
+            }
+            EXPECT_EQ(sources, query::getSources_Sym(nwa, a));
+            EXPECT_EQ(targets, query::getTargets_Sym(nwa, a));
+            EXPECT_EQ(call_sites, query::getCallSites_Sym(nwa, a));
+            EXPECT_EQ(entries, query::getEntries_Sym(nwa, a));
+            EXPECT_EQ(exits, query::getExits_Sym(nwa, a));
+            EXPECT_EQ(preds, query::getCalls_Sym(nwa, a));
+            EXPECT_EQ(rets, query::getReturns_Sym(nwa, a));
+
+            for (size_t i = 0; i < states.size(); ++i) {
+                State q = states[i];
+
+                StateSet from, to, called, entered, exit_to_ret, exit_to_call;
+                StateSet pred_to_exit, pred_to_ret, ret_to_exit, ret_to_call;
+                for (Nwa::InternalIterator t = nwa.beginInternalTrans(); t != nwa.endInternalTrans(); ++t) {
+                    if (t->second == a && t->first == q) to.insert(t->third);
+                    if (t->second == a && t->third == q) from.insert(t->first);
+                }
+                for (Nwa::CallIterator t = nwa.beginCallTrans(); t != nwa.endCallTrans(); ++t) {
+                    if (t->second == a && t->first == q) entered.insert(t->third);
+                    if (t->second == a && t->third == q) called.insert(t->first);
+                }
+                for (Nwa::ReturnIterator t = nwa.beginReturnTrans(); t != nwa.endReturnTrans(); ++t) {
+                    if (t->third != a) continue;
+                    if (t->first == q) { exit_to_ret.insert(t->fourth); exit_to_call.insert(t->second); }
+                    if (t->second == q) { pred_to_exit.insert(t->first); pred_to_ret.insert(t->fourth); }
+                    if (t->fourth == q) { ret_to_exit.insert(t->first); ret_to_call.insert(t->second); }
+                }
+
+                EXPECT_EQ(to, query::getTargets(nwa, q, a));
+                EXPECT_EQ(from, query::getSources(nwa, a, q));
+                EXPECT_EQ(entered, query::getEntries(nwa, q, a));
+                EXPECT_EQ(called, query::getCallSites(nwa, a, q));
+                EXPECT_EQ(exit_to_ret, query::getReturns_Exit(nwa, q, a));
+                EXPECT_EQ(exit_to_call, query::getCalls_Exit(nwa, q, a));
+                EXPECT_EQ(pred_to_exit, query::getExits_Call(nwa, q, a));
+                EXPECT_EQ(pred_to_ret, query::getReturns_Call(nwa, q, a));
+                EXPECT_EQ(ret_to_exit, query::getExits_Ret(nwa, a, q));
+                EXPECT_EQ(ret_to_call, query::getCalls_Ret(nwa, a, q));
+
+                StateSet succs = to;
+                succs.insert(entered.begin(), entered.end());
+                succs.insert(exit_to_ret.begin(), exit_to_ret.end());
+                EXPECT_EQ(succs, query::getSuccessors(nwa, q, a));
+
+                StateSet predecessors = from;
+                predecessors.insert(called.begin(), called.end());
+                predecessors.insert(ret_to_exit.begin(), ret_to_exit.end());
+                EXPECT_EQ(predecessors, query::getPredecessors(nwa, a, q));
+
+                for (size_t k = 0; k < states.size(); ++k) {
+                    State p = states[k];
+                    StateSet exits_between, calls_between, returns_between;
+                    for (Nwa::ReturnIterator t = nwa.beginReturnTrans(); t != nwa.endReturnTrans(); ++t) {
+                        if (t->third != a) continue;
+                        if (t->second == q && t->fourth == p) exits_between.insert(t->first);
+                        if (t->first == q && t->fourth == p) calls_between.insert(t->second);
+                        if (t->first == q && t->second == p) returns_between.insert(t->fourth);
+                    }
+                    EXPECT_EQ(exits_between, query::getExits(nwa, q, a, p));
+                    EXPECT_EQ(calls_between, query::getCalls(nwa, q, a, p));
+                    EXPECT_EQ(returns_between, query::getReturns(nwa, q, p, a));
+                }
+            }
+        }
+    }
+
+}
+
+
+namespace opennwa {
+    namespace query {
+
+        TEST(opennwa$query$$symbolLookups, agreeWithScanOfAllTransitions)
+        {
+            OddNumEvenGroupsNwa fixture;
+            RandomNwas random(35);
+
+            for (int round = 0; round < 10; ++round) {
+                std::stringstream ss;
+                ss << "Round " << round;
+                SCOPED_TRACE(ss.str());
+
+                Nwa nwa = round == 0 ? fixture.nwa : random.next("symbol-lookups");
+                expect_lookups_match_scan(nwa);
+            }
+        }
+
+        TEST(opennwa$query$$symbolLookups, agreeWithScanWhenFrozen)
+        {
+            OddNumEvenGroupsNwa fixture;
+            RandomNwas random(36);
+
+            for (int round = 0; round < 10; ++round) {
+                std::stringstream ss;
+                ss << "Round " << round;
+                SCOPED_TRACE(ss.str());
+
+                Nwa nwa = round == 0 ? fixture.nwa : random.next("symbol-lookups-frozen");
+                nwa.freeze();
+                expect_lookups_match_scan(nwa);
+                EXPECT_TRUE(nwa.isFrozen());
+            }
+        }
+
+        TEST(opennwa$query$$symbolLookups, indexesFollowRemovals)
+        {
+            RandomNwas random(53);
+
+            for (int round = 0; round < 10; ++round) {
+                std::stringstream ss;
+                ss << "Round " << round;
+                SCOPED_TRACE(ss.str());
+
+                Nwa nwa = random.next("symbol-removals");
+
+                std::vector<Nwa::Internal> internals(nwa.beginInternalTrans(), nwa.endInternalTrans());
+                for (size_t i = 0; i < internals.size(); i += 2) {
+                    nwa.removeInternalTrans(internals[i]);
+                }
+                std::vector<Nwa::Call> calls(nwa.beginCallTrans(), nwa.endCallTrans());
+                for (size_t i = 0; i < calls.size(); i += 2) {
+                    nwa.removeCallTrans(calls[i]);
+                }
+                std::vector<Nwa::Return> returns(nwa.beginReturnTrans(), nwa.endReturnTrans());
+                for (size_t i = 0; i < returns.size(); i += 2) {
+                    nwa.removeReturnTrans(returns[i]);
+                }
+                expect_lookups_match_scan(nwa);
+
+                nwa.removeSymbol(*nwa.beginSymbols());
+                expect_lookups_match_scan(nwa);
+
+                nwa.removeState(*nwa.beginStates());
+                expect_lookups_match_scan(nwa);
+            }
+        }
+
+    }
+}
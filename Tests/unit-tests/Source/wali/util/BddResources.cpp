@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+
+#include "buddy/bdd.h"
+#include "wali/util/BddResources.hpp"
+
+#include <cstdlib>
+
+using namespace wali::util;
+
+namespace
+{
+  /// x0 <-> x32, x1 <-> x33, ... for the first 'pairs' pairs. With
+  /// BuDDy's default order this takes about 2^pairs nodes.
+  bdd
+  pairsEqual(int pairs)
+  {
+    bdd acc = bddtrue;
+    for (int i = 0; i < pairs; ++i) {
+      acc &= bdd_biimp(bdd_ithvar(i), bdd_ithvar(i + 32));
+    }
+    return acc;
+  }
+
+  /// Starts each test with BuDDy stopped, whatever ran before, and stops
+  /// it again afterwards
+  class BddInitTest : public ::testing::Test
+  {
+  protected:
+    virtual void SetUp()
+    {
+      if (bdd_isrunning())
+        bdd_done();
+    }
+
+    virtual void TearDown()
+    {
+      if (bdd_isrunning())
+        bdd_done();
+    }
+  };
+
+  int lastOtherError;
+
+  void recordError(int code)
+  {
+    lastOtherError = code;
+  }
+}
+
+
+TEST_F(BddInitTest, ceilingThrowsInsteadOfAborting)
+{
+  BddResources resources(1000);
+  resources.maxNodes = 20000;
+  ASSERT_GE(bddInit(resources), 0);
+  bdd_setvarnum(64);
+
+  bool thrown = false;
+  try {
+    pairsEqual(20);
+  }
+  catch (BddResourceError & e) {
+    thrown = true;
+    EXPECT_EQ(BDD_NODENUM, e.code());
+  }
+  EXPECT_TRUE(thrown);
+  EXPECT_LE(bdd_getallocnum(), 20000);
+
+  // With the big BDD gone, BuDDy carries on
+  bdd small = pairsEqual(8);
+  EXPECT_EQ(small, pairsEqual(8));
+  EXPECT_NE(small, bddfalse);
+
+  bddDone();
+}
+
+
+TEST_F(BddInitTest, otherErrorsGoToThePreviousHandler)
+{
+  ASSERT_GE(bddInit(BddResources(1000)), 0);
+  bdd_setvarnum(8);
+
+  // Replace BuDDy's default handler (which aborts) under the hook
+  details::bddHookState().previousError = recordError;
+  lastOtherError = 0;
+  EXPECT_NO_THROW(bdd_ithvar(100));
+  EXPECT_EQ(BDD_VAR, lastOtherError);
+}
+
+
+TEST_F(BddInitTest, statisticsCountGcsAndResizes)
+{
+  BddResources resources(1000);
+  resources.maxIncrease = 1000;
+  ASSERT_GE(bddInit(resources), 0);
+  bdd_setvarnum(64);
+
+  BddStatistics before = bddStatistics();
+  EXPECT_EQ(0, before.garbageCollections);
+  EXPECT_EQ(0, before.resizes);
+
+  bdd big = pairsEqual(12);
+
+  BddStatistics after = bddStatistics();
+  EXPECT_LT(0, after.garbageCollections);
+  EXPECT_LT(0, after.resizes);
+  EXPECT_LT(before.tableSize, after.tableSize);
+  // Growth is capped at maxIncrease nodes per resize
+  EXPECT_GE(before.tableSize + 1000 * after.resizes + after.resizes, after.tableSize);
+  EXPECT_LT(0, after.largestLiveNodes);
+
+  big = bddfalse;
+  bddDone();
+}
+
+
+#ifndef _MSC_VER
+TEST(wali$util$$BddResources, fromEnvironmentOverridesWhatIsSet)
+{
+  setenv("WALI_BDD_NODES", "12345", 1);
+  setenv("WALI_BDD_MAX_NODES", "not a number", 1);
+  unsetenv("WALI_BDD_CACHE_RATIO");
+
+  BddResources defaults(500);
+  defaults.maxNodes = 99999;
+  BddResources resources = defaults.fromEnvironment();
+
+  EXPECT_EQ(12345, resources.initialNodes);
+  EXPECT_EQ(99999, resources.maxNodes);
+  EXPECT_EQ(defaults.cacheRatio, resources.cacheRatio);
+
+  unsetenv("WALI_BDD_NODES");
+  unsetenv("WALI_BDD_MAX_NODES");
+}
+#endif
+
+
+// Yo, Emacs!
+// Local Variables:
+//   c-file-style: "ellemtel"
+//   c-basic-offset: 2
+// End:
@@ -0,0 +1,247 @@
+#include "gtest/gtest.h"
+#include "wali/wfa/WFA.hpp"
+#include "wali/wfa/State.hpp"
+#include "wali/wfa/BinaryWfa.hpp"
+#include "wali/ShortestPathSemiring.hpp"
+#include "wali/WeightFactory.hpp"
+
+#include "fixtures.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#define NUM_ELEMENTS(array)  (sizeof(array)/sizeof((array)[0]))
+
+using namespace wali::wfa;
+
+static const WFA fas[] = {
+    LoopReject().wfa,
+    LoopAccept().wfa,
+    EvenAsEvenBs().wfa,
+    EpsilonTransitionToAccepting().wfa,
+    EpsilonFull().wfa,
+    EpsilonTransitionToMiddleToAccepting().wfa,
+    ADeterministic().wfa,
+    EpsilonTransitionToMiddleToEpsilonToAccepting().wfa,
+    AcceptAbOrAcNondet().wfa,
+    AEpsilonEpsilonEpsilonA().wfa
+};
+
+static const unsigned num_fas = NUM_ELEMENTS(fas);
+
+
+namespace {
+
+    struct ReachSerializer : wali::wfa::WeightSerializer
+    {
+        virtual void serialize(wali::sem_elem_t weight, std::ostream & out) const {
+            out << (weight->equal(weight->one()) ? '1' : '0');
+        }
+
+        virtual wali::sem_elem_t deserialize(char const * bytes, size_t length) const {
+            EXPECT_EQ(1u, length);
+            return new wali::Reach(bytes[0] == '1');
+        }
+    };
+
+    struct ShortestPathFactory : wali::WeightFactory
+    {
+        virtual wali::sem_elem_t getWeight(std::string s) {
+            unsigned v;
+            EXPECT_EQ(1, std::sscanf(s.c_str(), "ShortestPathSemiring(%u)", &v));
+            return new wali::ShortestPathSemiring(v);
+        }
+    };
+
+    std::string
+    marshall_string(WFA const & wfa)
+    {
+        std::stringstream ss;
+        wfa.marshall(ss);
+        return ss.str();
+    }
+
+    std::string
+    write_binary_string(WFA const & wfa, WeightSerializer const & serializer)
+    {
+        std::stringstream ss;
+        writeBinaryWfa(ss, wfa, serializer);
+        return ss.str();
+    }
+
+}
+
+
+namespace wali {
+    namespace wfa {
+
+        TEST(wali$wfa$$binary, roundTripMatchesXmlBattery)
+        {
+            ReachSerializer serializer;
+
+            for (size_t i=0; i<num_fas; ++i) {
+                std::stringstream ss;
+                ss << "Testing FA " << i;
+                SCOPED_TRACE(ss.str());
+
+                std::string bytes = write_binary_string(fas[i], serializer);
+                EXPECT_EQ(0u, bytes.size() % 8);
+
+                WFA loaded;
+                readBinaryWfa(bytes.data(), bytes.size(), serializer, loaded);
+
+                EXPECT_EQ(marshall_string(fas[i]), marshall_string(loaded));
+                EXPECT_TRUE(fas[i].equal(loaded));
+            }
+        }
+
+        TEST(wali$wfa$$binary, frozenWritesTheSameBytes)
+        {
+            ReachSerializer serializer;
+
+            for (size_t i=0; i<num_fas; ++i) {
+                WFA wfa = fas[i];
+                std::string thawed = write_binary_string(wfa, serializer);
+                wfa.freeze();
+                EXPECT_EQ(thawed, write_binary_string(wfa, serializer));
+            }
+        }
+
+        TEST(wali$wfa$$binary, roundTripWeightsAndQuery)
+        {
+            Key s1 = getKey("bin_state1"),
+                s2 = getKey("bin_state2"),
+                s3 = getKey("bin_state3");
+            Letters l;
+
+            sem_elem_t zero = ShortestPathSemiring(0).zero();
+
+            WFA wfa(WFA::REVERSE);
+            wfa.addState(s1, new ShortestPathSemiring(7));
+            wfa.addState(s2, zero);
+            wfa.addState(s3, zero);
+            wfa.setInitialState(s1);
+            wfa.addFinalState(s3, new ShortestPathSemiring(3));
+
+            wfa.addTrans(s1, l.a, s2, new ShortestPathSemiring(1));
+            wfa.addTrans(s1, l.b, s3, new ShortestPathSemiring(5));
+            wfa.addTrans(s2, WALI_EPSILON, s3, new ShortestPathSemiring(2));
+            // A symbol that is not the name of any state and a key that is
+            // not a string key
+            wfa.addTrans(s3, getKey(l.a, l.b), s1, new ShortestPathSemiring(9));
+
+            ShortestPathFactory factory;
+            MarshallingWeightSerializer serializer(factory);
+
+            std::string bytes = write_binary_string(wfa, serializer);
+            WFA loaded;
+            readBinaryWfa(bytes.data(), bytes.size(), serializer, loaded);
+
+            EXPECT_EQ(WFA::REVERSE, loaded.getQuery());
+            EXPECT_EQ(marshall_string(wfa), marshall_string(loaded));
+
+            EXPECT_TRUE(loaded.getState(s1)->weight()->equal(new ShortestPathSemiring(7)));
+            EXPECT_TRUE(loaded.getState(s3)->acceptWeight()->equal(new ShortestPathSemiring(3)));
+            EXPECT_EQ(4u, loaded.numTransitions());
+        }
+
+        TEST(wali$wfa$$binary, loadingReplacesContents)
+        {
+            ReachSerializer serializer;
+            std::string bytes = write_binary_string(fas[2], serializer);
+
+            WFA loaded = fas[8];
+            readBinaryWfa(bytes.data(), bytes.size(), serializer, loaded);
+
+            EXPECT_TRUE(fas[2].equal(loaded));
+        }
+
+        TEST(wali$wfa$$binary, emptyWfaRoundTrips)
+        {
+            ReachSerializer serializer;
+            WFA empty;
+            std::string bytes = write_binary_string(empty, serializer);
+
+            WFA loaded = fas[2];
+            readBinaryWfa(bytes.data(), bytes.size(), serializer, loaded);
+
+            EXPECT_EQ(0u, loaded.getStates().size());
+            EXPECT_EQ(0u, loaded.numTransitions());
+        }
+
+        TEST(wali$wfa$$binary, roundTripThroughMappedFile)
+        {
+            ReachSerializer serializer;
+            char const * filename = "binary-wfa-test.wfab";
+
+            {
+                std::ofstream out(filename, std::ios::out | std::ios::binary);
+                writeBinaryWfa(out, fas[8], serializer);
+            }
+
+            WFA loaded;
+            readBinaryWfa(std::string(filename), serializer, loaded);
+            std::remove(filename);
+
+            EXPECT_EQ(marshall_string(fas[8]), marshall_string(loaded));
+        }
+
+        TEST(wali$wfa$$binary, rejectsBadInput)
+        {
+            ReachSerializer serializer;
+            std::string bytes = write_binary_string(fas[2], serializer);
+            WFA loaded;
+
+            // Every proper prefix is truncated
+            for (size_t length = 0; length < bytes.size(); length += 8) {
+                EXPECT_THROW(readBinaryWfa(bytes.data(), length, serializer, loaded),
+                             BinaryWfaFormatError);
+            }
+
+            std::string bad_magic = bytes;
+            bad_magic[0] = 'X';
+            EXPECT_THROW(readBinaryWfa(bad_magic.data(), bad_magic.size(), serializer, loaded),
+                         BinaryWfaFormatError);
+
+            std::string bad_version = bytes;
+            bad_version[8] = 99;
+            EXPECT_THROW(readBinaryWfa(bad_version.data(), bad_version.size(), serializer, loaded),
+                         BinaryWfaFormatError);
+
+            // Point the last transition's target past the end of the
+            // state table
+            std::string bad_target = bytes;
+            bad_target[bad_target.size() - 16] = 100;
+            EXPECT_THROW(readBinaryWfa(bad_target.data(), bad_target.size(), serializer, loaded),
+                         BinaryWfaFormatError);
+
+            EXPECT_THROW(readBinaryWfa(std::string("no-such-binary-wfa.wfab"), serializer, loaded),
+                         std::runtime_error);
+        }
+
+        TEST(wali$wfa$$binary, badInputLeavesResultUnchanged)
+        {
+            ReachSerializer serializer;
+            std::string bytes = write_binary_string(fas[2], serializer);
+            WFA loaded = fas[8];
+            std::string before = marshall_string(loaded);
+
+            for (size_t length = 0; length < bytes.size(); length += 8) {
+                EXPECT_THROW(readBinaryWfa(bytes.data(), length, serializer, loaded),
+                             BinaryWfaFormatError);
+                EXPECT_EQ(before, marshall_string(loaded));
+            }
+
+            // The states and the first transitions are fine; only the
+            // last transition is out of range
+            std::string bad_target = bytes;
+            bad_target[bad_target.size() - 16] = 100;
+            EXPECT_THROW(readBinaryWfa(bad_target.data(), bad_target.size(), serializer, loaded),
+                         BinaryWfaFormatError);
+            EXPECT_EQ(before, marshall_string(loaded));
+            EXPECT_TRUE(fas[8].equal(loaded));
+        }
+
+    }
+}
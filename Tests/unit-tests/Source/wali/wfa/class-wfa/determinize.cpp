@@ -453,6 +453,53 @@ namespace wali {
         }
 
 
+        TEST(wali$wfa$$semideterminize_dense, matchesKeySetsBattery)
+        {
+            for (size_t i=0; i<num_fas; ++i) {
+                std::stringstream ss;
+                ss << "Testing FA " << i;
+                SCOPED_TRACE(ss.str());
+
+                AlwaysReturnOneWeightGen wg(Reach(true).one());
+                WFA keysets = fas[i].semideterminize_keysets(wg);
+                WFA dense = fas[i].semideterminize_dense(wg);
+
+                EXPECT_TRUE(keysets.equal(dense));
+            }
+        }
+
+        TEST(wali$wfa$$semideterminize_dense, matchesKeySetsWithWeightGen)
+        {
+            for (size_t i=0; i<num_fas; ++i) {
+                std::stringstream ss;
+                ss << "Testing FA " << i;
+                SCOPED_TRACE(ss.str());
+
+                WFA keysets = fas[i].semideterminize_keysets(TestLifter());
+                WFA dense = fas[i].semideterminize_dense(TestLifter());
+
+                EXPECT_TRUE(keysets.equal(dense));
+            }
+        }
+
+        TEST(wali$wfa$$semideterminize_dense, battery)
+        {
+            for (size_t i=0; i<num_fas_to_determinize; ++i) {
+                std::stringstream ss;
+                ss << "Testing FA " << i;
+                SCOPED_TRACE(ss.str());
+
+                WFA input    = fas_to_determinize_and_answers[i][0];
+                WFA expected = fas_to_determinize_and_answers[i][1];
+
+                AlwaysReturnOneWeightGen wg(input.getSomeWeight());
+                WFA det = input.semideterminize_dense(wg);
+
+                EXPECT_TRUE(expected.isIsomorphicTo(det));
+            }
+        }
+
+
         // FIXME: this isn't a test!
         TEST(wali$wfa$$semideterminize, zeroWeightPathDoesNotAccept)
         {
@@ -0,0 +1,243 @@
+#include "gtest/gtest.h"
+#include "wali/wfa/WFA.hpp"
+#include "wali/wfa/State.hpp"
+#include "wali/wfa/CsrSnapshot.hpp"
+#include "wali/ShortestPathSemiring.hpp"
+
+#include "fixtures.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+#define NUM_ELEMENTS(array)  (sizeof(array)/sizeof((array)[0]))
+
+using namespace wali::wfa;
+
+static const WFA fas[] = {
+    LoopReject().wfa,
+    LoopAccept().wfa,
+    EvenAsEvenBs().wfa,
+    EpsilonTransitionToAccepting().wfa,
+    EpsilonFull().wfa,
+    EpsilonTransitionToMiddleToAccepting().wfa,
+    ADeterministic().wfa,
+    EpsilonTransitionToMiddleToEpsilonToAccepting().wfa,
+    AcceptAbOrAcNondet().wfa,
+    AEpsilonEpsilonEpsilonA().wfa
+};
+
+static const unsigned num_fas = NUM_ELEMENTS(fas);
+
+
+static
+std::vector<std::string>
+sorted_lines(std::string const & str)
+{
+    std::vector<std::string> lines;
+    std::stringstream ss(str);
+    std::string line;
+    while (std::getline(ss, line)) {
+        lines.push_back(line);
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+
+namespace wali {
+    namespace wfa {
+
+        TEST(wali$wfa$$freeze, freezeBuildsSnapshot)
+        {
+            EvenAsEvenBs f;
+
+            EXPECT_FALSE(f.wfa.isFrozen());
+            EXPECT_EQ(NULL, f.wfa.getCsrSnapshot());
+
+            f.wfa.freeze();
+
+            ASSERT_TRUE(f.wfa.isFrozen());
+            CsrSnapshot const * csr = f.wfa.getCsrSnapshot();
+            ASSERT_TRUE(csr != NULL);
+
+            EXPECT_EQ(4u, csr->numStates());
+            EXPECT_EQ(2u, csr->numSymbols());
+            EXPECT_EQ(8u, csr->numTransitions());
+            EXPECT_EQ(8u, f.wfa.numTransitions());
+        }
+
+        TEST(wali$wfa$$freeze, snapshotRowsMatchTransitions)
+        {
+            Letters l;
+            EvenAsEvenBs f;
+            f.wfa.freeze();
+            CsrSnapshot const * csr = f.wfa.getCsrSnapshot();
+
+            Key even_even = getKey("even_even");
+            CsrSnapshot::Index ee = csr->stateIndex(even_even);
+            ASSERT_NE(CsrSnapshot::NoIndex, ee);
+            EXPECT_EQ(even_even, csr->stateKey(ee));
+
+            CsrSnapshot::edge_range out = csr->outgoing(ee);
+            ASSERT_EQ(2, out.second - out.first);
+
+            CsrSnapshot::edge_range out_a = csr->outgoing(ee, csr->symbolIndex(l.a));
+            ASSERT_EQ(1, out_a.second - out_a.first);
+            EXPECT_EQ(getKey("odd_even"), out_a.first->trans->to());
+            EXPECT_EQ(getKey("odd_even"), csr->stateKey(out_a.first->target));
+
+            CsrSnapshot::edge_range in = csr->incoming(ee);
+            ASSERT_EQ(2, in.second - in.first);
+            for ( ; in.first != in.second; ++in.first) {
+                EXPECT_EQ(even_even, in.first->trans->to());
+                EXPECT_EQ(ee, in.first->target);
+            }
+
+            EXPECT_EQ(CsrSnapshot::NoIndex, csr->stateIndex(getKey("not a state")));
+            EXPECT_EQ(CsrSnapshot::NoIndex, csr->symbolIndex(l.c));
+        }
+
+        TEST(wali$wfa$$freeze, mutationThaws)
+        {
+            Letters l;
+            sem_elem_t one = Reach(true).one();
+            sem_elem_t zero = Reach(true).zero();
+            Key other = getKey("freeze other state");
+
+            EvenAsEvenBs f;
+            Key even_even = getKey("even_even");
+            Key odd_even = getKey("odd_even");
+
+            f.wfa.freeze();
+            f.wfa.addTrans(even_even, l.c, even_even, one);
+            EXPECT_FALSE(f.wfa.isFrozen());
+
+            f.wfa.freeze();
+            f.wfa.addState(other, zero);
+            EXPECT_FALSE(f.wfa.isFrozen());
+
+            f.wfa.freeze();
+            f.wfa.erase(even_even, l.c, even_even);
+            EXPECT_FALSE(f.wfa.isFrozen());
+
+            f.wfa.freeze();
+            f.wfa.eraseState(other);
+            EXPECT_FALSE(f.wfa.isFrozen());
+
+            f.wfa.freeze();
+            f.wfa.clear();
+            EXPECT_FALSE(f.wfa.isFrozen());
+
+            EvenAsEvenBs g;
+            g.wfa.freeze();
+            // Adding an existing transition only combines the weight
+            g.wfa.addTrans(even_even, l.a, odd_even, one);
+            EXPECT_TRUE(g.wfa.isFrozen());
+        }
+
+        TEST(wali$wfa$$freeze, copyIsNotFrozen)
+        {
+            EvenAsEvenBs f;
+            f.wfa.freeze();
+
+            WFA copy = f.wfa;
+            EXPECT_FALSE(copy.isFrozen());
+            EXPECT_TRUE(copy.equal(f.wfa));
+        }
+
+        TEST(wali$wfa$$freeze, isIsomorphicToBattery)
+        {
+            for (size_t i=0; i<num_fas; ++i) {
+                for (size_t j=0; j<num_fas; ++j) {
+                    std::stringstream ss;
+                    ss << "Testing FAs " << i << " ~ " << j;
+                    SCOPED_TRACE(ss.str());
+
+                    WFA left = fas[i];
+                    WFA right = fas[j];
+                    left.freeze();
+
+                    EXPECT_EQ(i == j, left.isIsomorphicTo(right));
+                    EXPECT_EQ(i == j, left.isIsomorphicTo(right, false));
+                }
+            }
+        }
+
+        TEST(wali$wfa$$freeze, intersectBattery)
+        {
+            for (size_t i=0; i<num_fas; ++i) {
+                for (size_t j=0; j<num_fas; ++j) {
+                    std::stringstream ss;
+                    ss << "Testing FAs " << i << " ^ " << j;
+                    SCOPED_TRACE(ss.str());
+
+                    WFA left = fas[i];
+                    WFA right = fas[j];
+                    WFA thawed = left.intersect(right);
+
+                    left.freeze();
+                    right.freeze();
+                    WFA frozen = left.intersect(right);
+
+                    EXPECT_TRUE(thawed.equal(frozen));
+                }
+            }
+        }
+
+        TEST(wali$wfa$$freeze, printDotPrintsTheSameThings)
+        {
+            for (size_t i=0; i<num_fas; ++i) {
+                std::stringstream ss;
+                ss << "Testing FA " << i;
+                SCOPED_TRACE(ss.str());
+
+                WFA wfa = fas[i];
+                std::stringstream thawed, frozen;
+
+                wfa.print_dot(thawed, true);
+                wfa.freeze();
+                wfa.print_dot(frozen, true);
+
+                EXPECT_EQ(sorted_lines(thawed.str()), sorted_lines(frozen.str()));
+            }
+        }
+
+        TEST(wali$wfa$$freeze, pathSummaryIterativeOriginal)
+        {
+            // A diamond with a back edge and two final states
+            Key s1 = getKey("ps_state1"),
+                s2 = getKey("ps_state2"),
+                s3 = getKey("ps_state3"),
+                s4 = getKey("ps_state4");
+            Letters l;
+
+            sem_elem_t zero = ShortestPathSemiring(0).zero();
+
+            WFA thawed;
+            thawed.addState(s1, zero);
+            thawed.addState(s2, zero);
+            thawed.addState(s3, zero);
+            thawed.addState(s4, zero);
+            thawed.setInitialState(s1);
+            thawed.addFinalState(s4);
+            thawed.addFinalState(s3);
+
+            thawed.addTrans(s1, l.a, s2, new ShortestPathSemiring(1));
+            thawed.addTrans(s1, l.b, s3, new ShortestPathSemiring(5));
+            thawed.addTrans(s2, l.a, s4, new ShortestPathSemiring(1));
+            thawed.addTrans(s3, l.a, s4, new ShortestPathSemiring(1));
+            thawed.addTrans(s4, l.c, s1, new ShortestPathSemiring(2));
+
+            WFA frozen = thawed;
+            frozen.freeze();
+
+            thawed.path_summary_iterative_original();
+            frozen.path_summary_iterative_original();
+
+            EXPECT_TRUE(frozen.isFrozen());
+            EXPECT_TRUE(thawed.equal(frozen));
+            EXPECT_TRUE(frozen.getState(s1)->weight()->equal(new ShortestPathSemiring(2)));
+        }
+
+    }
+}
@@ -1,10 +1,13 @@
 #include "gtest/gtest.h"
 #include "wali/wfa/WFA.hpp"
+#include "wali/wfa/State.hpp"
 
 #include "fixtures.hpp"
 #include "fixtures/Keys.hpp"
 #include "fixtures/SimpleWeights.hpp"
 
+#include <sstream>
+
 using namespace testing;
 
 namespace wali {
@@ -68,6 +71,121 @@ namespace wali {
             EXPECT_EQ(abc,  AcceptAbOrAcDeterministic().wfa.alphabet());
         }
 
+        TEST(wali$wfa$WFA$$alphabet, frozenMatchesThawed)
+        {
+            WFA const fas[] = {
+                EpsilonTransitionToAccepting().wfa,
+                EpsilonTransitionToMiddleToAccepting().wfa,
+                EvenAsEvenBs().wfa,
+                EpsilonFull().wfa,
+                AcceptAbOrAcNondet().wfa
+            };
+
+            for (size_t i = 0; i < sizeof(fas)/sizeof(fas[0]); ++i) {
+                WFA wfa = fas[i];
+                std::set<Key> thawed = wfa.alphabet();
+                wfa.freeze();
+                EXPECT_EQ(thawed, wfa.alphabet());
+            }
+        }
+
+        // Completes 'wfa' by checking every (state, symbol) pair
+        static void
+        naive_complete(WFA & wfa, std::set<Key> const & symbols, Key sink)
+        {
+            sem_elem_t one = Reach(true).one();
+            std::set<Key> states = wfa.getStates();
+            std::set<Key> all_symbols = symbols;
+            bool need_sink = false;
+
+            for (std::set<Key>::const_iterator q = states.begin(); q != states.end(); ++q) {
+                for (std::set<Key>::const_iterator sym = symbols.begin(); sym != symbols.end(); ++sym) {
+                    if (wfa.outgoingTransSet(*q, *sym) == NULL) {
+                        need_sink = true;
+                        wfa.addState(sink, one->zero());
+                        wfa.addTrans(*q, *sym, sink, one);
+                    }
+                }
+                TransSet const & out = wfa.getState(*q)->getTransSet();
+                for (TransSet::const_iterator t = out.begin(); t != out.end(); ++t) {
+                    all_symbols.insert((*t)->stack());
+                }
+            }
+
+            if (need_sink && states.count(sink) == 0u) {
+                for (std::set<Key>::const_iterator sym = all_symbols.begin();
+                     sym != all_symbols.end(); ++sym)
+                {
+                    wfa.addTrans(sink, *sym, sink, one);
+                }
+            }
+        }
+
+        TEST(wali$wfa$$complete, matchesNaiveCompletion)
+        {
+            Letters l;
+            Key const d = getKey("d");
+            Key const sink = getKey("complete sink");
+
+            WFA const fas[] = {
+                LoopReject().wfa,
+                EvenAsEvenBs().wfa,
+                EpsilonFull().wfa,
+                ADeterministic().wfa,
+                AcceptAbOrAcNondet().wfa,
+                AEpsilonEpsilonEpsilonA().wfa
+            };
+
+            std::set<Key> alphabets[3];
+            alphabets[0].insert(l.a);
+            alphabets[1].insert(l.a);
+            alphabets[1].insert(l.b);
+            alphabets[1].insert(l.c);
+            alphabets[2] = alphabets[1];
+            alphabets[2].insert(d); // not on any transition
+
+            for (size_t i = 0; i < sizeof(fas)/sizeof(fas[0]); ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    std::stringstream ss;
+                    ss << "Testing FA " << i << " with alphabet " << j;
+                    SCOPED_TRACE(ss.str());
+
+                    WFA expected = fas[i];
+                    naive_complete(expected, alphabets[j], sink);
+
+                    WFA actual = fas[i];
+                    actual.complete(alphabets[j], sink);
+
+                    EXPECT_TRUE(expected.equal(actual));
+                }
+            }
+        }
+
+        TEST(wali$wfa$$complete, completeWfaIsUnchanged)
+        {
+            WFA wfa = EvenAsEvenBs().wfa;
+            size_t states = wfa.numStates();
+            size_t transitions = wfa.numTransitions();
+
+            wfa.complete(wfa.alphabet(), getKey("complete sink"));
+
+            EXPECT_EQ(states, wfa.numStates());
+            EXPECT_EQ(transitions, wfa.numTransitions());
+        }
+
+        TEST(wali$wfa$$complete, completeLeavesFrozenStateAlone)
+        {
+            WFA wfa = EvenAsEvenBs().wfa;
+            std::set<Key> alphabet = wfa.alphabet();
+
+            wfa.complete(alphabet, getKey("complete sink"));
+            EXPECT_FALSE(wfa.isFrozen());
+
+            wfa.freeze();
+            wfa.complete(alphabet, getKey("complete sink"));
+            EXPECT_TRUE(wfa.isFrozen());
+        }
+
         TEST(wali$wfa$WFA$$eraseState, eraseStateRemovesIncomingTransitions)
         {
             Keys keys;
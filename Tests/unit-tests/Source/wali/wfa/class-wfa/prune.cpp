@@ -0,0 +1,246 @@
+#include "gtest/gtest.h"
+#include "wali/wfa/WFA.hpp"
+#include "wali/wfa/State.hpp"
+
+#include "fixtures.hpp"
+#include "fixtures/Random.hpp"
+
+#include <set>
+#include <sstream>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+
+#define NUM_ELEMENTS(array)  (sizeof(array)/sizeof((array)[0]))
+
+using namespace wali::wfa;
+using testing::Lcg;
+
+static const WFA fas[] = {
+    LoopReject().wfa,
+    LoopAccept().wfa,
+    EvenAsEvenBs().wfa,
+    EpsilonTransitionToAccepting().wfa,
+    EpsilonFull().wfa,
+    EpsilonTransitionToMiddleToAccepting().wfa,
+    ADeterministic().wfa,
+    EpsilonTransitionToMiddleToEpsilonToAccepting().wfa,
+    AcceptAbOrAcNondet().wfa,
+    AEpsilonEpsilonEpsilonA().wfa
+};
+
+static const unsigned num_fas = NUM_ELEMENTS(fas);
+
+
+namespace {
+
+    typedef std::set<boost::tuple<wali::Key, wali::Key, wali::Key> > TripleSet;
+
+    TripleSet
+    transitions(WFA const & wfa)
+    {
+        TripleSet triples;
+        for (std::set<wali::Key>::const_iterator q = wfa.getStates().begin();
+             q != wfa.getStates().end(); ++q)
+        {
+            TransSet const & out = wfa.getState(*q)->getTransSet();
+            for (TransSet::const_iterator t = out.begin(); t != out.end(); ++t) {
+                triples.insert(boost::make_tuple((*t)->from(), (*t)->stack(), (*t)->to()));
+            }
+        }
+        return triples;
+    }
+
+    /// Full pruning also resets the state weights (as a side effect of
+    /// its worklist setup), so this compares only the structure.
+    ::testing::AssertionResult
+    samePruned(WFA const & full, WFA const & incremental)
+    {
+        if (full.getStates() != incremental.getStates()) {
+            return ::testing::AssertionFailure() << "states differ";
+        }
+        if (full.getFinalStates() != incremental.getFinalStates()) {
+            return ::testing::AssertionFailure() << "final states differ";
+        }
+        if (transitions(full) != transitions(incremental)) {
+            return ::testing::AssertionFailure() << "transitions differ";
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+}
+
+
+namespace wali {
+    namespace wfa {
+
+        TEST(wali$wfa$$prune, incrementalMatchesFullBattery)
+        {
+            // Skip LoopReject: the full prune() keeps an initial state
+            // that cannot reach a final state if it has a self loop,
+            // while the incremental one removes it (see below).
+            for (size_t i=1; i<num_fas; ++i) {
+                std::stringstream ss;
+                ss << "Testing FA " << i;
+                SCOPED_TRACE(ss.str());
+
+                WFA full = fas[i];
+                WFA incremental = fas[i];
+                incremental.setIncrementalPrune(true);
+
+                full.prune();
+                incremental.prune();
+
+                EXPECT_TRUE(samePruned(full, incremental));
+            }
+        }
+
+        TEST(wali$wfa$$prune, incrementalRemovesRejectingLoop)
+        {
+            WFA wfa = LoopReject().wfa;
+            wfa.setIncrementalPrune(true);
+            wfa.prune();
+
+            EXPECT_EQ(0u, wfa.numStates());
+            EXPECT_EQ(0u, wfa.numTransitions());
+        }
+
+        TEST(wali$wfa$$prune, copyIsNotIncremental)
+        {
+            WFA wfa = fas[2];
+            wfa.setIncrementalPrune(true);
+            EXPECT_TRUE(wfa.isIncrementalPrune());
+
+            WFA copy = wfa;
+            EXPECT_FALSE(copy.isIncrementalPrune());
+
+            wfa.setIncrementalPrune(false);
+            EXPECT_FALSE(wfa.isIncrementalPrune());
+        }
+
+        TEST(wali$wfa$$prune, removesDeadStatesAndReportsStatistics)
+        {
+            Letters l;
+            sem_elem_t one = Reach(true).one();
+            sem_elem_t zero = Reach(true).zero();
+            Key init = getKey("prune_init"),
+                acc = getKey("prune_acc"),
+                dead_end = getKey("prune_dead_end"),
+                unreached = getKey("prune_unreached");
+
+            WFA wfa;
+            wfa.setIncrementalPrune(true);
+            wfa.addState(init, zero);
+            wfa.addState(acc, zero);
+            wfa.addState(dead_end, zero);
+            wfa.addState(unreached, zero);
+            wfa.setInitialState(init);
+            wfa.addFinalState(acc);
+
+            wfa.addTrans(init, l.a, acc, one);
+            wfa.addTrans(init, l.b, dead_end, one);
+            wfa.addTrans(unreached, l.a, acc, one);
+            wfa.addTrans(acc, l.c, acc, zero);
+
+            wfa.prune();
+
+            WFA::PruneStatistics const & stats = wfa.getLastPruneStatistics();
+            EXPECT_EQ(2u, stats.states_removed);
+            EXPECT_EQ(3u, stats.transitions_removed);
+
+            EXPECT_EQ(2u, wfa.numStates());
+            EXPECT_EQ(1u, wfa.numTransitions());
+
+            // Cutting the only path to the final state kills everything
+            wfa.erase(init, l.a, acc);
+            wfa.prune();
+            EXPECT_EQ(2u, wfa.getLastPruneStatistics().states_removed);
+            EXPECT_EQ(0u, wfa.numStates());
+        }
+
+        TEST(wali$wfa$$prune, fullPruneReportsStatistics)
+        {
+            Letters l;
+            sem_elem_t one = Reach(true).one();
+            Key extra = getKey("prune_extra");
+
+            WFA wfa = EvenAsEvenBs().wfa;
+            wfa.addTrans(extra, l.a, getKey("even_even"), one);
+            wfa.addTrans(extra, l.b, extra, one);
+
+            wfa.prune();
+
+            EXPECT_EQ(1u, wfa.getLastPruneStatistics().states_removed);
+            EXPECT_EQ(2u, wfa.getLastPruneStatistics().transitions_removed);
+        }
+
+        TEST(wali$wfa$$prune, randomEditsMatchFullPrune)
+        {
+            sem_elem_t one = Reach(true).one();
+            sem_elem_t zero = Reach(true).zero();
+            Letters l;
+            Key const symbols[] = { l.a, l.b, WALI_EPSILON };
+
+            const unsigned num_states = 12;
+            std::vector<Key> states;
+            for (unsigned q = 0; q < num_states; ++q) {
+                std::stringstream ss;
+                ss << "prune_random_" << q;
+                states.push_back(getKey(ss.str()));
+            }
+
+            Lcg rand(12345);
+
+            for (int round = 0; round < 20; ++round) {
+                std::stringstream ss;
+                ss << "Round " << round;
+                SCOPED_TRACE(ss.str());
+
+                WFA incremental;
+                incremental.setIncrementalPrune(true);
+                for (unsigned q = 0; q < num_states; ++q) {
+                    incremental.addState(states[q], zero);
+                }
+                incremental.setInitialState(states[0]);
+                incremental.addFinalState(states[num_states - 1]);
+                incremental.addFinalState(states[num_states / 2]);
+
+                for (int batch = 0; batch < 6; ++batch) {
+                    if (!incremental.getState(states[0])) {
+                        // Everything has been pruned away, and the full
+                        // prune() requires an initial state
+                        break;
+                    }
+                    // Start with enough transitions that the initial state
+                    // usually survives the first few prunes
+                    int const num_edits = (batch == 0) ? 40 : 8;
+                    for (int edit = 0; edit < num_edits; ++edit) {
+                        Key from = states[rand.next(num_states)];
+                        Key sym = symbols[rand.next(NUM_ELEMENTS(symbols))];
+                        Key to = states[rand.next(num_states)];
+                        if (!incremental.getState(from) || !incremental.getState(to)) {
+                            continue;
+                        }
+                        if (rand.next(3) == 0) {
+                            if (incremental.getState(from)->getTransSet().size() > 0) {
+                                ITrans * t = *incremental.getState(from)->getTransSet().begin();
+                                incremental.erase(t->from(), t->stack(), t->to());
+                            }
+                        }
+                        else {
+                            incremental.addTrans(from, sym, to, rand.next(6) == 0 ? zero : one);
+                        }
+                    }
+
+                    WFA full = incremental;
+                    full.prune();
+                    incremental.prune();
+
+                    EXPECT_TRUE(samePruned(full, incremental));
+                    EXPECT_EQ(full.numStates(), incremental.numStates());
+                    EXPECT_EQ(full.numTransitions(), incremental.numTransitions());
+                }
+            }
+        }
+
+    }
+}